@@ -208,7 +208,10 @@ enum KmeansFlags {
         user-supplied labels instead of computing them from the initial centers. For the second and
         further attempts, use the random or semi-random centers. Use one of KMEANS_\*_CENTERS flag
         to specify the exact method.*/
-    KMEANS_USE_INITIAL_LABELS = 1
+    KMEANS_USE_INITIAL_LABELS = 1,
+    /** Update the centers using small random batches of the samples instead of all the samples,
+        see MiniBatchKMeans. criteria.maxCount is the number of the batches in this case.*/
+    KMEANS_MINI_BATCH         = 4
 };
 
 //! type of line
@@ -2983,6 +2986,16 @@ compactness value are returned by the function. Basically, you can use only the
 function, set the number of attempts to 1, initialize labels each time using a custom algorithm,
 pass them with the ( flags = #KMEANS_USE_INITIAL_LABELS ) flag, and then choose the best
 (most-compact) clustering.
+
+The labels are reassigned using the triangle inequality to skip the samples that can't change
+their clusters [Hamerly2010], so the cost of the late iterations is much lower than N*K distances.
+When the number of clusters multiplied by the dimensionality is large, the distances are evaluated
+in blocks using gemm.
+
+With the #KMEANS_MINI_BATCH flag the centers are updated using random batches of
+max(1024, 2*K) samples [Sculley2010], the labels and the compactness are computed for all the
+samples in the end. It's much faster for large datasets, at the cost of slightly worse clustering;
+the clusters may be empty in this mode. See MiniBatchKMeans for the data that doesn't fit in memory.
 */
 CV_EXPORTS_W double kmeans( InputArray data, int K, InputOutputArray bestLabels,
                             TermCriteria criteria, int attempts,
@@ -3265,6 +3278,63 @@ template<> struct ParamType<Scalar>
 
 //! @} core_basic
 
+//! @addtogroup core_cluster
+//!  @{
+
+/** @brief Mini-batch k-means clustering of the data that is passed in chunks.
+
+The centers are moved towards random batches of the samples with per-center learning rates
+[Sculley2010], so the whole dataset never has to be in memory. The samples of every chunk passed to
+partialFit() are shuffled and split into batches; the chunks themselves should come in a random
+order. The centers are initialized (see #KMEANS_PP_CENTERS) once the first K samples arrive.
+
+@code
+    Ptr<MiniBatchKMeans> bow = MiniBatchKMeans::create(100000);
+    while (readDescriptors(chunk))
+        bow->partialFit(chunk);
+    bow->getCenters(vocabulary);
+@endcode
+*/
+class CV_EXPORTS_W MiniBatchKMeans : public Algorithm
+{
+public:
+    /** @brief Updates the centers using a chunk of the samples.
+    @param data The samples in any of the layouts accepted by cv::kmeans.
+    */
+    CV_WRAP virtual void partialFit(InputArray data) = 0;
+
+    /** @brief Finds the closest center for every sample.
+    @param data The samples in any of the layouts accepted by cv::kmeans.
+    @param labels Output vector of the cluster indices.
+    @return The compactness of the samples, see cv::kmeans.
+    */
+    CV_WRAP virtual double predict(InputArray data, OutputArray labels) const = 0;
+
+    /** @brief Returns the matrix of the cluster centers, one row per each center. */
+    CV_WRAP virtual void getCenters(OutputArray centers) const = 0;
+
+    /** @brief Returns true if the centers are initialized. */
+    CV_WRAP virtual bool isTrained() const = 0;
+
+    /** Number of the clusters. */
+    CV_WRAP virtual int getClustersNumber() const = 0;
+
+    /** Number of the samples in a batch, 0 means max(1024, 2*K). */
+    /** @see setBatchSize */
+    CV_WRAP virtual int getBatchSize() const = 0;
+    /** @copybrief getBatchSize @see getBatchSize */
+    CV_WRAP virtual void setBatchSize(int val) = 0;
+
+    /** @brief Creates the empty model.
+    @param K Number of the clusters.
+    @param batchSize Number of the samples in a batch, 0 means max(1024, 2*K).
+    @param flags #KMEANS_PP_CENTERS or #KMEANS_RANDOM_CENTERS.
+    */
+    CV_WRAP static Ptr<MiniBatchKMeans> create(int K, int batchSize = 0, int flags = KMEANS_PP_CENTERS);
+};
+
+//! @} core_cluster
+
 } //namespace cv
 
 #include "opencv2/core/operations.hpp"
@@ -156,12 +156,11 @@ static void generateCentersPP(const Mat& data, Mat& _out_centers,
     }
 }
 
-template<bool onlyDistance>
 class KMeansDistanceComputer : public ParallelLoopBody
 {
 public:
     KMeansDistanceComputer( double *distances_,
-                            int *labels_,
+                            const int *labels_,
                             const Mat& data_,
                             const Mat& centers_)
         : distances(distances_),
@@ -174,52 +173,532 @@ public:
     void operator()(const Range& range) const CV_OVERRIDE
     {
         CV_TRACE_FUNCTION();
-        const int begin = range.start;
-        const int end = range.end;
+        const int dims = centers.cols;
+
+        for (int i = range.start; i < range.end; ++i)
+        {
+            const float* center = centers.ptr<float>(labels[i]);
+            distances[i] = normL2Sqr(data.ptr<float>(i), center, dims);
+        }
+    }
+
+private:
+    KMeansDistanceComputer& operator=(const KMeansDistanceComputer&); // = delete
+
+    double *distances;
+    const int *labels;
+    const Mat& data;
+    const Mat& centers;
+};
+
+static int CV_KMEANS_GEMM_THRESHOLD = (int)utils::getConfigurationParameterSizeT("OPENCV_KMEANS_GEMM_THRESHOLD", 4096);
+
+/*
+Finds the closest center for the samples: all the rows of data, or the rows listed in indices.
+For many centers the distances are ranked in blocks as |c|^2 - 2*x.c with the dot products
+computed by gemm (centerNorms != 0), then the distances to the chosen centers are recomputed exactly.
+The ranking is done in double (centers64f is the copy of the centers), since the differences of
+the distances may be far below the float precision of the norms.
+The distance to the second closest center is optionally returned, it bounds the distances
+to all the other centers and is used for pruning.
+*/
+class KMeansAssigner : public ParallelLoopBody
+{
+public:
+    KMeansAssigner( const Mat& data_, const Mat& centers_, const Mat& centers64f_, const double* centerNorms_,
+                    const int* indices_, int* labels_, double* distances_, double* secondDistances_ )
+        : data(data_), centers(centers_), centers64f(centers64f_), centerNorms(centerNorms_), indices(indices_),
+          labels(labels_), distances(distances_), secondDistances(secondDistances_)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        CV_TRACE_FUNCTION();
+        const int BLOCK_SIZE = 64, CENTERS_BLOCK_SIZE = 1024;
         const int K = centers.rows;
         const int dims = centers.cols;
+        Mat block, dots;
+        int best[BLOCK_SIZE], second[BLOCK_SIZE];
+        double bestDist[BLOCK_SIZE], secondDist[BLOCK_SIZE];
 
-        for (int i = begin; i < end; ++i)
+        for (int i0 = range.start; i0 < range.end; i0 += BLOCK_SIZE)
         {
-            const float *sample = data.ptr<float>(i);
-            if (onlyDistance)
+            const int n = std::min(range.end - i0, BLOCK_SIZE);
+
+            if (centerNorms)
             {
-                const float* center = centers.ptr<float>(labels[i]);
-                distances[i] = normL2Sqr(sample, center, dims);
-                continue;
+                block.create(n, dims, CV_64F);
+                for (int i = 0; i < n; i++)
+                {
+                    const float* x = sample(i0 + i);
+                    double* b = block.ptr<double>(i);
+                    for (int j = 0; j < dims; j++)
+                        b[j] = x[j];
+                }
+                for (int i = 0; i < n; i++)
+                {
+                    best[i] = second[i] = -1;
+                    bestDist[i] = secondDist[i] = DBL_MAX;
+                }
+
+                for (int k0 = 0; k0 < K; k0 += CENTERS_BLOCK_SIZE)
+                {
+                    const int k1 = std::min(k0 + CENTERS_BLOCK_SIZE, K);
+                    gemm(block, centers64f.rowRange(k0, k1), 1, noArray(), 0, dots, GEMM_2_T);
+                    for (int i = 0; i < n; i++)
+                    {
+                        const double* d = dots.ptr<double>(i);
+                        for (int k = k0; k < k1; k++)
+                        {
+                            double dist = centerNorms[k] - 2*d[k - k0];
+                            if (dist < secondDist[i])
+                            {
+                                if (dist < bestDist[i])
+                                {
+                                    second[i] = best[i]; secondDist[i] = bestDist[i];
+                                    best[i] = k; bestDist[i] = dist;
+                                }
+                                else
+                                {
+                                    second[i] = k; secondDist[i] = dist;
+                                }
+                            }
+                        }
+                    }
+                }
             }
-            else
+
+            for (int i = 0; i < n; i++)
             {
+                const float* x = sample(i0 + i);
                 int k_best = 0;
-                double min_dist = DBL_MAX;
+                double min_dist = DBL_MAX, min_dist2 = DBL_MAX;
 
-                for (int k = 0; k < K; k++)
+                if (centerNorms)
                 {
-                    const float* center = centers.ptr<float>(k);
-                    const double dist = normL2Sqr(sample, center, dims);
-
-                    if (min_dist > dist)
+                    k_best = best[i];
+                    min_dist = normL2Sqr(x, centers.ptr<float>(k_best), dims);
+                    if (second[i] >= 0)
+                    {
+                        min_dist2 = normL2Sqr(x, centers.ptr<float>(second[i]), dims);
+                        // the exact distances decide between the two closest centers
+                        if (min_dist2 < min_dist || (min_dist2 == min_dist && second[i] < k_best))
+                        {
+                            std::swap(min_dist, min_dist2);
+                            k_best = second[i];
+                        }
+                    }
+                }
+                else
+                {
+                    for (int k = 0; k < K; k++)
                     {
-                        min_dist = dist;
-                        k_best = k;
+                        const double dist = normL2Sqr(x, centers.ptr<float>(k), dims);
+
+                        if (min_dist > dist)
+                        {
+                            min_dist2 = min_dist;
+                            min_dist = dist;
+                            k_best = k;
+                        }
+                        else if (min_dist2 > dist)
+                            min_dist2 = dist;
                     }
                 }
 
-                distances[i] = min_dist;
-                labels[i] = k_best;
+                const int si = indices ? indices[i0 + i] : i0 + i;
+                labels[si] = k_best;
+                if (distances)
+                    distances[si] = min_dist;
+                if (secondDistances)
+                    secondDistances[si] = min_dist2;
             }
         }
     }
 
 private:
-    KMeansDistanceComputer& operator=(const KMeansDistanceComputer&); // = delete
+    KMeansAssigner& operator=(const KMeansAssigner&); // = delete
+
+    const float* sample(int i) const { return data.ptr<float>(indices ? indices[i] : i); }
 
-    double *distances;
-    int *labels;
     const Mat& data;
     const Mat& centers;
+    const Mat& centers64f;
+    const double* centerNorms;
+    const int* indices;
+    int* labels;
+    double* distances;
+    double* secondDistances;
 };
 
+static void assignCenters(const Mat& data, const Mat& centers, const int* indices, int count,
+                          int* labels, double* distances, double* secondDistances = 0)
+{
+    const int K = centers.rows, dims = centers.cols;
+    Mat centers64f;
+    std::vector<double> norms;
+    if (K > 2 && K*dims >= CV_KMEANS_GEMM_THRESHOLD)
+    {
+        centers.convertTo(centers64f, CV_64F);
+        norms.resize(K);
+        for (int k = 0; k < K; k++)
+            norms[k] = normL2Sqr<double, double>(centers64f.ptr<double>(k), dims);
+    }
+    parallel_for_(Range(0, count),
+                  KMeansAssigner(data, centers, centers64f, norms.empty() ? 0 : &norms[0], indices,
+                                 labels, distances, secondDistances),
+                  (double)divUp((size_t)dims*count*K, CV_KMEANS_PARALLEL_GRANULARITY));
+}
+
+/*
+Pruning of the label assignment using the triangle inequality:
+G. Hamerly (2010) Making k-means even faster.
+Every sample keeps an upper bound of the distance to its center and a lower bound of the distance
+to all the other centers. Both are updated by the center shifts, and the distances are only
+computed when the bounds overlap. Unlike Elkan's algorithm, it needs O(N) memory, not O(N*K).
+*/
+class KMeansBoundsUpdater : public ParallelLoopBody
+{
+public:
+    KMeansBoundsUpdater( const Mat& data_, const Mat& centers_, const int* labels_,
+                         const double* shifts_, const double* halfDistances_, double maxShift_,
+                         double maxShift2_, int maxShiftIdx_, double* upper_, double* lower_, uchar* mask_ )
+        : data(data_), centers(centers_), labels(labels_), shifts(shifts_), halfDistances(halfDistances_),
+          maxShift(maxShift_), maxShift2(maxShift2_), maxShiftIdx(maxShiftIdx_),
+          upper(upper_), lower(lower_), mask(mask_)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        CV_TRACE_FUNCTION();
+        const int dims = centers.cols;
+
+        for (int i = range.start; i < range.end; i++)
+        {
+            const int k = labels[i];
+            upper[i] += shifts[k];
+            lower[i] -= k == maxShiftIdx ? maxShift2 : maxShift;
+
+            double bound = std::max(lower[i], halfDistances[k]);
+            mask[i] = 0;
+            if (upper[i] <= bound)
+                continue;
+            upper[i] = std::sqrt((double)normL2Sqr(data.ptr<float>(i), centers.ptr<float>(k), dims));
+            mask[i] = upper[i] > bound;
+        }
+    }
+
+private:
+    KMeansBoundsUpdater& operator=(const KMeansBoundsUpdater&); // = delete
+
+    const Mat& data;
+    const Mat& centers;
+    const int* labels;
+    const double* shifts;
+    const double* halfDistances;
+    double maxShift, maxShift2;
+    int maxShiftIdx;
+    double* upper;
+    double* lower;
+    uchar* mask;
+};
+
+// half of the distance from every center to the closest other center
+class KMeansHalfDistanceComputer : public ParallelLoopBody
+{
+public:
+    KMeansHalfDistanceComputer(const Mat& centers_, double* halfDistances_)
+        : centers(centers_), halfDistances(halfDistances_)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        CV_TRACE_FUNCTION();
+        const int K = centers.rows, dims = centers.cols;
+
+        for (int k = range.start; k < range.end; k++)
+        {
+            const float* center = centers.ptr<float>(k);
+            double min_dist = DBL_MAX;
+            for (int k1 = 0; k1 < K; k1++)
+            {
+                if (k1 != k)
+                    min_dist = std::min(min_dist, (double)normL2Sqr(center, centers.ptr<float>(k1), dims));
+            }
+            halfDistances[k] = K > 1 ? std::sqrt(min_dist)*0.5 : DBL_MAX;
+        }
+    }
+
+private:
+    KMeansHalfDistanceComputer& operator=(const KMeansHalfDistanceComputer&); // = delete
+
+    const Mat& centers;
+    double* halfDistances;
+};
+
+static Mat getKMeansSamples(const Mat& data0)
+{
+    const bool isrow = data0.rows == 1;
+    const int N = isrow ? data0.cols : data0.rows;
+    const int dims = (isrow ? 1 : data0.cols)*data0.channels();
+
+    CV_Assert( data0.dims <= 2 && data0.depth() == CV_32F );
+    return Mat(N, dims, CV_32F, (void*)data0.ptr(), isrow ? dims * sizeof(float) : static_cast<size_t>(data0.step));
+}
+
+static void computeBox(const Mat& data, Vec2f* box)
+{
+    const int N = data.rows, dims = data.cols;
+    {
+        const float* sample = data.ptr<float>(0);
+        for (int j = 0; j < dims; j++)
+            box[j] = Vec2f(sample[j], sample[j]);
+    }
+    for (int i = 1; i < N; i++)
+    {
+        const float* sample = data.ptr<float>(i);
+        for (int j = 0; j < dims; j++)
+        {
+            float v = sample[j];
+            box[j][0] = std::min(box[j][0], v);
+            box[j][1] = std::max(box[j][1], v);
+        }
+    }
+}
+
+class MiniBatchKMeansImpl CV_FINAL : public MiniBatchKMeans
+{
+public:
+    MiniBatchKMeansImpl(int K_, int batchSize_, int flags_)
+        : K(K_), batchSize(batchSize_), flags(flags_)
+    {
+        CV_Assert( K > 0 && batchSize >= 0 );
+    }
+
+    void clear() CV_OVERRIDE
+    {
+        centers.release();
+        counts.clear();
+        pending.release();
+    }
+
+    int getClustersNumber() const CV_OVERRIDE { return K; }
+    int getBatchSize() const CV_OVERRIDE { return batchSize; }
+    void setBatchSize(int val) CV_OVERRIDE { CV_Assert( val >= 0 ); batchSize = val; }
+    bool isTrained() const CV_OVERRIDE { return !centers.empty(); }
+
+    void getCenters(OutputArray _centers) const CV_OVERRIDE
+    {
+        centers.copyTo(_centers);
+    }
+
+    int realBatchSize() const
+    {
+        return batchSize > 0 ? batchSize : std::max(1024, K*2);
+    }
+
+    // initializes the centers using a random subset of the samples
+    void initCenters(const Mat& data, RNG& rng)
+    {
+        const int N = data.rows, dims = data.cols;
+        const int initSize = std::min(N, std::max(K, realBatchSize()*3));
+        Mat subset = data;
+        if (initSize < N)
+        {
+            subset.create(initSize, dims, CV_32F);
+            for (int i = 0; i < initSize; i++)
+                data.row(rng.uniform(0, N)).copyTo(subset.row(i));
+        }
+
+        centers.create(K, dims, CV_32F);
+        if (flags & KMEANS_PP_CENTERS)
+            generateCentersPP(subset, centers, K, rng, 3);
+        else
+        {
+            cv::AutoBuffer<Vec2f, 64> box(dims);
+            computeBox(subset, box.data());
+            for (int k = 0; k < K; k++)
+                generateRandomCenter(dims, box.data(), centers.ptr<float>(k), rng);
+        }
+        counts.assign(K, 0);
+    }
+
+    // initializes the centers as the means of the labeled samples
+    void initCenters(const Mat& data, const int* labels, RNG& rng)
+    {
+        const int N = data.rows, dims = data.cols;
+        std::vector<int> n(K, 0);
+        centers.create(K, dims, CV_32F);
+        centers = Scalar(0);
+        for (int i = 0; i < N; i++)
+        {
+            const float* sample = data.ptr<float>(i);
+            float* center = centers.ptr<float>(labels[i]);
+            for (int j = 0; j < dims; j++)
+                center[j] += sample[j];
+            n[labels[i]]++;
+        }
+        for (int k = 0; k < K; k++)
+        {
+            if (n[k] == 0)
+                data.row(rng.uniform(0, N)).copyTo(centers.row(k));
+            else
+                centers.row(k) *= 1./n[k];
+        }
+        counts.assign(K, 0);
+    }
+
+    // moves the centers towards the samples of the batch with per-center learning rates,
+    // D. Sculley (2010) Web-scale k-means clustering.
+    // Returns the maximum squared shift of a center.
+    double step(const Mat& data, const int* indices, int count, std::vector<int>& labels)
+    {
+        const int dims = data.cols;
+        labels.resize(count);
+
+        Mat batch(count, dims, CV_32F);
+        for (int i = 0; i < count; i++)
+            memcpy(batch.ptr<float>(i), data.ptr<float>(indices[i]), dims*sizeof(float));
+        assignCenters(batch, centers, 0, count, &labels[0], 0);
+
+        Mat old_centers = centers.clone();
+        std::vector<uchar> changed(K, (uchar)0);
+        for (int i = 0; i < count; i++)
+        {
+            const int k = labels[i];
+            const float* sample = batch.ptr<float>(i);
+            float* center = centers.ptr<float>(k);
+            const float eta = (float)(1./(double)++counts[k]);
+            for (int j = 0; j < dims; j++)
+                center[j] += (sample[j] - center[j])*eta;
+            changed[k] = 1;
+        }
+
+        double max_center_shift = 0;
+        for (int k = 0; k < K; k++)
+        {
+            if (changed[k])
+                max_center_shift = std::max(max_center_shift,
+                    (double)normL2Sqr(centers.ptr<float>(k), old_centers.ptr<float>(k), dims));
+        }
+        return max_center_shift;
+    }
+
+    void partialFit(InputArray _data) CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+        Mat data0 = _data.getMat();
+        if (data0.empty())
+            return;
+        Mat data = getKMeansSamples(data0);
+        const Mat& known = centers.empty() ? pending : centers;
+        CV_Assert( known.empty() || data.cols == known.cols );
+
+        RNG& rng = theRNG();
+        if (centers.empty())
+        {
+            // the samples are kept until there are enough of them for the initialization
+            pending.push_back(data);
+            if (pending.rows < K)
+                return;
+            data = pending;
+            pending.release();
+            initCenters(data, rng);
+        }
+
+        const int N = data.rows, B = realBatchSize();
+        std::vector<int> indices(N), labels;
+        for (int i = 0; i < N; i++)
+            indices[i] = i;
+        randShuffle(indices, 1., &rng);
+        for (int i = 0; i < N; i += B)
+            step(data, &indices[i], std::min(B, N - i), labels);
+    }
+
+    double predict(InputArray _data, OutputArray _labels) const CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+        CV_Assert( !centers.empty() );
+        Mat data = getKMeansSamples(_data.getMat());
+        CV_Assert( data.cols == centers.cols );
+
+        const int N = data.rows;
+        _labels.create(N, 1, CV_32S);
+        Mat labels = _labels.getMat();
+        CV_Assert( labels.isContinuous() );
+        if (N == 0)
+            return 0;
+        cv::AutoBuffer<double, 64> dists(N);
+        assignCenters(data, centers, 0, N, labels.ptr<int>(), dists.data());
+        return sum(Mat(Size(N, 1), CV_64F, &dists[0]))[0];
+    }
+
+    int K, batchSize, flags;
+    Mat centers;
+    std::vector<int64> counts;
+    Mat pending;
+};
+
+Ptr<MiniBatchKMeans> MiniBatchKMeans::create(int K, int batchSize, int flags)
+{
+    return makePtr<MiniBatchKMeansImpl>(K, batchSize, flags);
+}
+
+static double kmeansMiniBatch( const Mat& data, int K, Mat& best_labels,
+                               TermCriteria criteria, int attempts,
+                               int flags, OutputArray _centers )
+{
+    const int N = data.rows;
+    RNG& rng = theRNG();
+
+    if (criteria.type & TermCriteria::EPS)
+        criteria.epsilon = std::max(criteria.epsilon, 0.);
+    else
+        criteria.epsilon = 0;
+    criteria.epsilon *= criteria.epsilon;
+    criteria.maxCount = criteria.type & TermCriteria::COUNT ? std::max(criteria.maxCount, 1) : 100;
+
+    Mat labels(N, 1, CV_32S);
+    double best_compactness = DBL_MAX;
+    for (int a = 0; a < attempts; a++)
+    {
+        MiniBatchKMeansImpl impl(K, 0, flags);
+        const int B = std::min(impl.realBatchSize(), N);
+        if (a == 0 && (flags & KMEANS_USE_INITIAL_LABELS))
+            impl.initCenters(data, best_labels.ptr<int>(), rng);
+        else
+            impl.initCenters(data, rng);
+
+        std::vector<int> indices(B), batch_labels;
+        for (int iter = 0; iter < criteria.maxCount; iter++)
+        {
+            for (int i = 0; i < B; i++)
+                indices[i] = rng.uniform(0, N);
+            double max_center_shift = impl.step(data, &indices[0], B, batch_labels);
+            if (criteria.epsilon > 0 && max_center_shift <= criteria.epsilon)
+                break;
+        }
+
+        double compactness = impl.predict(data, labels);
+        if (compactness < best_compactness)
+        {
+            best_compactness = compactness;
+            if (_centers.needed())
+            {
+                if (_centers.fixedType() && _centers.channels() == data.cols)
+                    impl.centers.reshape(data.cols).copyTo(_centers);
+                else
+                    impl.centers.copyTo(_centers);
+            }
+            labels.reshape(1, best_labels.rows).copyTo(best_labels);
+        }
+    }
+    return best_compactness;
+}
+
 }
 
 double cv::kmeans( InputArray _data, int K,
@@ -230,17 +709,15 @@ double cv::kmeans( InputArray _data, int K,
     CV_INSTRUMENT_REGION()
     const int SPP_TRIALS = 3;
     Mat data0 = _data.getMat();
-    const bool isrow = data0.rows == 1;
-    const int N = isrow ? data0.cols : data0.rows;
-    const int dims = (isrow ? 1 : data0.cols)*data0.channels();
     const int type = data0.depth();
 
     attempts = std::max(attempts, 1);
     CV_Assert( data0.dims <= 2 && type == CV_32F && K > 0 );
+    Mat data = getKMeansSamples(data0);
+    const int N = data.rows;
+    const int dims = data.cols;
     CV_Assert( N >= K );
 
-    Mat data(N, dims, CV_32F, data0.ptr(), isrow ? dims * sizeof(float) : static_cast<size_t>(data0.step));
-
     _bestLabels.create(N, 1, CV_32S, -1, true);
 
     Mat _labels, best_labels = _bestLabels.getMat();
@@ -268,6 +745,10 @@ double cv::kmeans( InputArray _data, int K,
         }
         _labels.create(best_labels.size(), best_labels.type());
     }
+
+    if (flags & KMEANS_MINI_BATCH)
+        return kmeansMiniBatch(data, K, best_labels, criteria, attempts, flags, _centers);
+
     int* labels = _labels.ptr<int>();
 
     Mat centers(K, dims, type), old_centers(K, dims, type), temp(1, dims, type);
@@ -275,6 +756,12 @@ double cv::kmeans( InputArray _data, int K,
     cv::AutoBuffer<double, 64> dists(N);
     RNG& rng = theRNG();
 
+    // bounds of the distances for the pruning, see KMeansBoundsUpdater
+    cv::AutoBuffer<double, 64> upper(N), lower(N), shifts(K), halfDistances(K);
+    std::vector<uchar> mask(N);
+    std::vector<int> active;
+    bool boundsValid = false;
+
     if (criteria.type & TermCriteria::EPS)
         criteria.epsilon = std::max(criteria.epsilon, 0.);
     else
@@ -294,28 +781,13 @@ double cv::kmeans( InputArray _data, int K,
 
     cv::AutoBuffer<Vec2f, 64> box(dims);
     if (!(flags & KMEANS_PP_CENTERS))
-    {
-        {
-            const float* sample = data.ptr<float>(0);
-            for (int j = 0; j < dims; j++)
-                box[j] = Vec2f(sample[j], sample[j]);
-        }
-        for (int i = 1; i < N; i++)
-        {
-            const float* sample = data.ptr<float>(i);
-            for (int j = 0; j < dims; j++)
-            {
-                float v = sample[j];
-                box[j][0] = std::min(box[j][0], v);
-                box[j][1] = std::max(box[j][1], v);
-            }
-        }
-    }
+        computeBox(data, box.data());
 
     double best_compactness = DBL_MAX;
     for (int a = 0; a < attempts; a++)
     {
         double compactness = 0;
+        boundsValid = false;
 
         for (int iter = 0; ;)
         {
@@ -391,6 +863,9 @@ double cv::kmeans( InputArray _data, int K,
                     counters[max_k]--;
                     counters[k]++;
                     labels[farthest_i] = k;
+                    // the bounds of the moved point are unknown, it's always checked
+                    upper[farthest_i] = DBL_MAX;
+                    lower[farthest_i] = 0;
 
                     const float* sample = data.ptr<float>(farthest_i);
                     float* cur_center = centers.ptr<float>(k);
@@ -420,6 +895,7 @@ double cv::kmeans( InputArray _data, int K,
                             dist += t*t;
                         }
                         max_center_shift = std::max(max_center_shift, dist);
+                        shifts[k] = std::sqrt(dist);
                     }
                 }
             }
@@ -429,14 +905,61 @@ double cv::kmeans( InputArray _data, int K,
             if (isLastIter)
             {
                 // don't re-assign labels to avoid creation of empty clusters
-                parallel_for_(Range(0, N), KMeansDistanceComputer<true>(dists.data(), labels, data, centers), (double)divUp((size_t)(dims * N), CV_KMEANS_PARALLEL_GRANULARITY));
+                parallel_for_(Range(0, N), KMeansDistanceComputer(dists.data(), labels, data, centers), (double)divUp((size_t)(dims * N), CV_KMEANS_PARALLEL_GRANULARITY));
                 compactness = sum(Mat(Size(N, 1), CV_64F, &dists[0]))[0];
                 break;
             }
-            else
+            else if (!boundsValid)
             {
                 // assign labels
-                parallel_for_(Range(0, N), KMeansDistanceComputer<false>(dists.data(), labels, data, centers), (double)divUp((size_t)(dims * N * K), CV_KMEANS_PARALLEL_GRANULARITY));
+                assignCenters(data, centers, 0, N, labels, upper.data(), lower.data());
+                for (int i = 0; i < N; i++)
+                {
+                    upper[i] = std::sqrt(upper[i]);
+                    lower[i] = std::sqrt(lower[i]);
+                }
+                boundsValid = K > 1;
+            }
+            else
+            {
+                // assign labels, only the samples with overlapping bounds are checked
+                int maxShiftIdx = 0;
+                double maxShift2 = 0;
+                for (int k = 1; k < K; k++)
+                {
+                    if (shifts[k] > shifts[maxShiftIdx])
+                        maxShiftIdx = k;
+                }
+                for (int k = 0; k < K; k++)
+                {
+                    if (k != maxShiftIdx)
+                        maxShift2 = std::max(maxShift2, shifts[k]);
+                }
+
+                parallel_for_(Range(0, K), KMeansHalfDistanceComputer(centers, halfDistances.data()),
+                              (double)divUp((size_t)dims*K*K, CV_KMEANS_PARALLEL_GRANULARITY));
+                parallel_for_(Range(0, N),
+                              KMeansBoundsUpdater(data, centers, labels, shifts.data(), halfDistances.data(),
+                                                  shifts[maxShiftIdx], maxShift2, maxShiftIdx,
+                                                  upper.data(), lower.data(), &mask[0]),
+                              (double)divUp((size_t)(dims * N), CV_KMEANS_PARALLEL_GRANULARITY));
+
+                active.clear();
+                for (int i = 0; i < N; i++)
+                {
+                    if (mask[i])
+                        active.push_back(i);
+                }
+                if (!active.empty())
+                {
+                    const int count = (int)active.size();
+                    assignCenters(data, centers, &active[0], count, labels, upper.data(), lower.data());
+                    for (int i = 0; i < count; i++)
+                    {
+                        upper[active[i]] = std::sqrt(upper[active[i]]);
+                        lower[active[i]] = std::sqrt(lower[active[i]]);
+                    }
+                }
             }
         }
 
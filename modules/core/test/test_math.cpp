@@ -2947,6 +2947,150 @@ TEST(Core_KMeans, compactness)
     }
 }
 
+static void testKMeansPruning(int N, int dims, int K)
+{
+    const int maxCount = 30;
+    RNG& rng = theRNG();
+    Mat data(N, dims, CV_32F), labels(N, 1, CV_32S);
+    rng.fill(data, RNG::UNIFORM, -100, 100);
+    // initial clusters are the stripes along the first axis, so none of them gets empty
+    for (int i = 0; i < N; i++)
+        labels.at<int>(i) = std::min(cvFloor((data.at<float>(i, 0) + 100)*K/200), K - 1);
+
+    // plain Lloyd iterations starting from the same labels
+    Mat refLabels = labels.clone(), refCenters(K, dims, CV_32F), oldCenters;
+    for (int iter = 0; ; )
+    {
+        refCenters.copyTo(oldCenters);
+        refCenters = Scalar(0);
+        std::vector<int> counts(K, 0);
+        for (int i = 0; i < N; i++)
+        {
+            int k = refLabels.at<int>(i);
+            for (int j = 0; j < dims; j++)
+                refCenters.at<float>(k, j) += data.at<float>(i, j);
+            counts[k]++;
+        }
+        double shift = iter == 0 ? DBL_MAX : 0;
+        for (int k = 0; k < K; k++)
+        {
+            ASSERT_GT(counts[k], 0);
+            float scale = 1.f/counts[k];
+            double dist = 0;
+            for (int j = 0; j < dims; j++)
+            {
+                refCenters.at<float>(k, j) *= scale;
+                double t = refCenters.at<float>(k, j) - oldCenters.at<float>(k, j);
+                dist += t*t;
+            }
+            if (iter > 0)
+                shift = std::max(shift, dist);
+        }
+        if (++iter == maxCount || shift <= 0)
+            break;
+        for (int i = 0; i < N; i++)
+        {
+            int best = 0;
+            float bestDist = FLT_MAX;
+            for (int k = 0; k < K; k++)
+            {
+                float d = normL2Sqr(data.ptr<float>(i), refCenters.ptr<float>(k), dims);
+                if (d < bestDist)
+                {
+                    bestDist = d;
+                    best = k;
+                }
+            }
+            refLabels.at<int>(i) = best;
+        }
+    }
+
+    Mat centers;
+    kmeans(data, K, labels, TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, maxCount, 0),
+           1, KMEANS_USE_INITIAL_LABELS, centers);
+    EXPECT_EQ(0, cvtest::norm(refLabels, labels, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(refCenters, centers, NORM_INF));
+}
+
+TEST(Core_KMeans, pruning_matches_lloyd)
+{
+    testKMeansPruning(3000, 3, 20);
+}
+
+// the distances to many centers are ranked with gemm (K*dims is above OPENCV_KMEANS_GEMM_THRESHOLD)
+TEST(Core_KMeans, pruning_matches_lloyd_gemm)
+{
+    testKMeansPruning(2000, 32, 160);
+}
+
+static void makeKMeansBlobs(int N, int dims, int K, Mat& data)
+{
+    RNG& rng = theRNG();
+    Mat means(K, dims, CV_32F);
+    rng.fill(means, RNG::UNIFORM, -50, 50);
+    data.create(N, dims, CV_32F);
+    rng.fill(data, RNG::NORMAL, 0, 1);
+    for (int i = 0; i < N; i++)
+        data.row(i) += means.row(rng.uniform(0, K));
+}
+
+TEST(Core_KMeans, mini_batch)
+{
+    const int N = 20000, dims = 16, K = 10;
+    Mat data, labels, centers;
+    makeKMeansBlobs(N, dims, K, data);
+    const TermCriteria crit(TermCriteria::COUNT, 100, 0);
+
+    double exact = kmeans(data, K, labels, crit, 3, KMEANS_PP_CENTERS, centers);
+    double miniBatch = kmeans(data, K, labels, crit, 3, KMEANS_PP_CENTERS | KMEANS_MINI_BATCH, centers);
+    ASSERT_EQ(K, centers.rows);
+    ASSERT_EQ(N, labels.rows);
+    EXPECT_LE(miniBatch, exact*1.1);
+
+    double expected = 0;
+    for (int i = 0; i < N; i++)
+        expected += normL2Sqr(data.ptr<float>(i), centers.ptr<float>(labels.at<int>(i)), dims);
+    EXPECT_NEAR(expected, miniBatch, expected*1e-6);
+
+    // the data comes in chunks
+    Ptr<MiniBatchKMeans> stream = MiniBatchKMeans::create(K, 256);
+    EXPECT_FALSE(stream->isTrained());
+    stream->partialFit(data.rowRange(0, 5));
+    EXPECT_FALSE(stream->isTrained());
+    for (int i = 5; i < N; i += 4000)
+        stream->partialFit(data.rowRange(i, std::min(i + 4000, N)));
+    ASSERT_TRUE(stream->isTrained());
+    stream->getCenters(centers);
+    EXPECT_EQ(Size(dims, K), centers.size());
+    EXPECT_LE(stream->predict(data, labels), exact*1.1);
+}
+
+TEST(Core_KMeans, gemm_distances)
+{
+    const int N = 2000, dims = 32, K = 200;
+    Mat data;
+    makeKMeansBlobs(N, dims, K, data);
+
+    Ptr<MiniBatchKMeans> model = MiniBatchKMeans::create(K);
+    model->partialFit(data);
+    Mat labels, centers;
+    double compactness = model->predict(data, labels);
+    model->getCenters(centers);
+
+    double expected = 0;
+    for (int i = 0; i < N; i++)
+    {
+        const float* sample = data.ptr<float>(i);
+        float bestDist = FLT_MAX;
+        for (int k = 0; k < K; k++)
+            bestDist = std::min(bestDist, normL2Sqr(sample, centers.ptr<float>(k), dims));
+        float dist = normL2Sqr(sample, centers.ptr<float>(labels.at<int>(i)), dims);
+        EXPECT_LE(dist, bestDist*(1 + 1e-4) + 1e-4);
+        expected += bestDist;
+    }
+    EXPECT_NEAR(expected, compactness, expected*1e-4);
+}
+
 TEST(CovariationMatrixVectorOfMat, accuracy)
 {
     unsigned int col_problem_size = 8, row_problem_size = 8, vector_size = 16;
@@ -332,6 +332,35 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
         virtual ~Layer();
     };
 
+    /** @brief Detailed performance statistics of a single network layer.
+     * @see Net::profile, writePerfProfile
+     */
+    struct CV_EXPORTS LayerProfile
+    {
+        LayerProfile();
+
+        int id;                               //!< Layer identifier.
+        String name;                          //!< Layer name.
+        String type;                          //!< Layer type.
+        /** Backend, target and instruction set used to compute the layer,
+         *  e.g. `OCV/CPU/AVX2`, `OCV/OPENCL_FP16`, `HALIDE/CPU` or `DLIE/MYRIAD`. */
+        String implementation;
+        bool fused;                           //!< Layer computation is merged into another layer.
+        std::vector<MatShape> inputShapes;    //!< Shapes of layer inputs.
+        std::vector<MatShape> outputShapes;   //!< Shapes of layer outputs.
+        int64 flops;                          //!< Floating point operations per single forward pass.
+        size_t weightsMemory;                 //!< Bytes of learned parameters.
+        size_t blobsMemory;                   //!< Bytes of output and internal blobs allocated by the layer.
+        int runs;                             //!< Number of forward passes statistics were collected over.
+        double meanMs;                        //!< Mean time per forward pass in milliseconds.
+        double minMs;                         //!< Minimal time per forward pass in milliseconds.
+        double medianMs;                      //!< 50th percentile of time per forward pass in milliseconds.
+        double p90Ms;                         //!< 90th percentile of time per forward pass in milliseconds.
+        double p99Ms;                         //!< 99th percentile of time per forward pass in milliseconds.
+        double maxMs;                         //!< Maximal time per forward pass in milliseconds.
+        double gflopsPerSec;                  //!< Throughput computed from #flops and #medianMs.
+    };
+
     /** @brief This class allows to create and manipulate comprehensive artificial neural networks.
      *
      * Neural network is presented as directed acyclic graph (DAG), where vertices are Layer instances,
@@ -496,6 +525,33 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
          */
         CV_WRAP void setInput(InputArray blob, const String& name = "");
 
+        /** @brief Sets the number of input shape configurations the network keeps allocated.
+         *  @param size number of the most recently used configurations to keep.
+         *  @details A change of input shapes requires shapes inference and memory allocation
+         *  for every layer. If @p size is not zero, inferred shapes and allocated memory of
+         *  @p size recently used input shapes are kept, so switching between them skips
+         *  shapes inference and memory allocation. Layers are still finalized for the new
+         *  shapes, and layers fusion and backend initialization run again. Memory of all the
+         *  kept configurations is held by the network. The cache is dropped when layers,
+         *  their parameters (see setParam), backend, target or fusion mode change.
+         *  The default value is taken from the OPENCV_DNN_ALLOCATION_CACHE_SIZE environment
+         *  variable (0 if it's not set).
+         *  @note Blobs returned by forward() share memory with the network and are overwritten
+         *  by the next run with the same input shapes.
+         */
+        CV_WRAP void setAllocationCacheSize(int size);
+
+        /** @brief Allocates the network for the given input shapes in advance.
+         *  @param inputShapes shapes of all the network inputs.
+         *  @param outBlobNames names of outputs which will be requested by forward().
+         *  If empty, output of the last layer is used.
+         *  @details The configuration is put into allocation cache (see setAllocationCacheSize)
+         *  so the following forward() calls with inputs of these shapes reuse it.
+         *  Current network inputs are not changed.
+         */
+        CV_WRAP void preallocate(const std::vector<MatShape>& inputShapes,
+                                 const std::vector<String>& outBlobNames = std::vector<String>());
+
         /** @brief Sets the new value for the learned param of the layer.
          *  @param layer name or id of the layer.
          *  @param numParam index of the layer parameter in the Layer::blobs array.
@@ -510,6 +566,9 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
          *  @param layer name or id of the layer.
          *  @param numParam index of the layer parameter in the Layer::blobs array.
          *  @see Layer::blobs
+         *  @note Convolution and InnerProduct layers may keep their weights in reduced precision
+         *  (see `weights_precision` parameter and OPENCV_DNN_CPU_WEIGHTS_PRECISION). Such weights
+         *  are returned expanded to a new CV_32F blob, modifying it doesn't change the layer.
          */
         CV_WRAP Mat getParam(LayerId layer, int numParam = 0);
 
@@ -623,6 +682,21 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
          */
         CV_WRAP void enableFusion(bool fusion);
 
+        /** @brief Dump net to String.
+         * @returns String with structure, fused and skipped layers and their implementations
+         * in the <a href="https://graphviz.org">Graphviz</a> DOT format.
+         * Call method after setInput() and forward() to see the optimized graph.
+         * @note Graph optimization passes can be disabled by `OPENCV_DNN_DISABLE_GRAPH_PASSES`
+         * configuration parameter, i.e. `OPENCV_DNN_DISABLE_GRAPH_PASSES=FoldPadding,SkipViewLayers`.
+         */
+        CV_WRAP String dump();
+
+        /** @brief Dump net structure to a file in DOT format.
+         * @param path path to output file with .dot extension
+         * @see dump()
+         */
+        CV_WRAP void dumpToFile(const String& path);
+
         /** @brief Returns overall time for inference and timings (in ticks) for layers.
          * Indexes in returned vector correspond to layers ids. Some layers can be fused with others,
          * in this case zero ticks count will be return for that skipped layers.
@@ -631,6 +705,17 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
          */
         CV_WRAP int64 getPerfProfile(CV_OUT std::vector<double>& timings);
 
+        /** @brief Runs forward pass several times and collects detailed per-layer statistics.
+         * Network inputs must be set by setInput() beforehand.
+         * @param profiles output vector of statistics for every layer except the network input one.
+         * @param nruns number of forward passes to aggregate timings over.
+         * @param outputName name for layer which output is needed to get. By default whole network is computed.
+         * @return overall median time of forward pass in milliseconds.
+         * @see writePerfProfile
+         */
+        double profile(CV_OUT std::vector<LayerProfile>& profiles, int nruns = 10,
+                       const String& outputName = String());
+
     private:
         struct Impl;
         Ptr<Impl> impl;
@@ -646,7 +731,8 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
 
     /** @brief Reads a network model stored in <a href="http://caffe.berkeleyvision.org">Caffe</a> framework's format.
       * @param prototxt   path to the .prototxt file with text description of the network architecture.
-      * @param caffeModel path to the .caffemodel file with learned network.
+      * @param caffeModel path to the .caffemodel file with learned network
+      *                   or weights converted by convertCaffeModelToNative.
       * @returns Net object.
       */
     CV_EXPORTS_W Net readNetFromCaffe(const String &prototxt, const String &caffeModel = String());
@@ -803,6 +889,48 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
                                    double scalefactor=1.0, Size size = Size(),
                                    const Scalar& mean = Scalar(), bool swapRB=true, bool crop=true);
 
+    /** @brief Processing params of image to blob.
+     *
+     * The blob is computed as `blob(n, c, y, x) = scalefactor[c] * (image(y, x)[c'] - mean[c])`,
+     * where `c'` is a source channel (first and last channels swapped if @p swapRB is set).
+     * Both @p scalefactor and @p mean are specified in the order of output channels.
+     * For example, per-channel standard deviation @p std may be applied by
+     * `scalefactor = Scalar(1.0 / std[0], 1.0 / std[1], 1.0 / std[2])`.
+     *
+     * @see blobFromImagesWithParams
+     */
+    struct CV_EXPORTS Image2BlobParams
+    {
+        Image2BlobParams();
+        Image2BlobParams(const Scalar& scalefactor, const Size& size = Size(), const Scalar& mean = Scalar(),
+                         bool swapRB = false, bool crop = false, int ddepth = CV_32F);
+
+        Scalar scalefactor; //!< per-channel multiplier for image values.
+        Size size;          //!< spatial size for output image. Empty size means size of the first image.
+        Scalar mean;        //!< per-channel mean values which are subtracted from channels.
+        bool swapRB;        //!< flag which indicates that swap first and last channels.
+        bool crop;          //!< flag which indicates whether image will be cropped after resize or not.
+        int ddepth;         //!< depth of output blob: CV_32F or CV_16S (half precision floating point).
+    };
+
+    /** @brief Creates 4-dimensional blob from series of images with given preprocessing params.
+     *  @param images input images (all with 1-, 3- or 4-channels) of CV_8U or CV_32F depth.
+     *  @param blob output 4-dimensional blob with NCHW dimensions order.
+     *  @param params preprocessing params, see Image2BlobParams.
+     *  @details Unlike blobFromImages, mean subtraction, scaling, channels swap and conversion
+     *  to the output depth are done in a single multi-threaded pass which writes directly
+     *  into the blob. Source images are not modified and no full-size temporary copies are made
+     *  except for resized images. If @p blob is already allocated with the expected shape
+     *  and type (for example, it's a header over user's buffer), it's filled in place.
+     *  Regions of interest may be passed as input images.
+     */
+    CV_EXPORTS void blobFromImagesWithParams(InputArrayOfArrays images, OutputArray blob,
+                                             const Image2BlobParams& params = Image2BlobParams());
+
+    /** @overload */
+    CV_EXPORTS void blobFromImageWithParams(InputArray image, OutputArray blob,
+                                            const Image2BlobParams& params = Image2BlobParams());
+
     /** @brief Parse a 4D blob and output the images it contains as 2D arrays through a simpler data structure
      *  (std::vector<cv::Mat>).
      *  @param[in] blob_ 4 dimensional array (images, channels, height, width) in floating point precision (CV_32F) from
@@ -829,6 +957,25 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
     CV_EXPORTS_W void shrinkCaffeModel(const String& src, const String& dst,
                                        const std::vector<String>& layersTypes = std::vector<String>());
 
+    /** @brief Convert weights of Caffe network to OpenCV native format.
+     * @param src Path to origin model from Caffe framework (usually has `.caffemodel` extension).
+     * @param dst Path to destination weights file.
+     *
+     * Resulting file is passed to readNetFromCaffe instead of origin model.
+     * It is memory mapped at loading and layers use weights in place,
+     * so there is no parsing and copying of weights.
+     * Pages of the file are read by operating system on the first access.
+     * @note The file has native byte order and alignment, it is not intended
+     *       to be moved between platforms.
+     */
+    CV_EXPORTS_W void convertCaffeModelToNative(const String& src, const String& dst);
+
+    /** @brief Writes per-layer statistics collected by Net::profile into a file.
+     * @param filename output file path. Format is determined by extension: `.json` or `.csv`.
+     * @param profiles statistics obtained from Net::profile.
+     */
+    CV_EXPORTS void writePerfProfile(const String& filename, const std::vector<LayerProfile>& profiles);
+
     /** @brief Performs non maximum suppression given boxes and corresponding scores.
 
      * @param bboxes a set of bounding boxes to apply NMS.
@@ -849,6 +996,24 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
                              CV_OUT std::vector<int>& indices,
                              const float eta = 1.f, const int top_k = 0);
 
+    /** @brief Performs batched non maximum suppression given boxes and corresponding scores across different classes.
+     *
+     * Boxes of different classes never suppress each other. Classes are processed in parallel.
+     * @param bboxes a set of bounding boxes to apply NMS.
+     * @param scores a set of corresponding confidences.
+     * @param class_ids a set of corresponding class ids.
+     * @param score_threshold a threshold used to filter boxes by score.
+     * @param nms_threshold a threshold used in non maximum suppression.
+     * @param indices the kept indices of bboxes after NMS sorted by descending scores.
+     * @param eta a coefficient in adaptive threshold formula: \f$nms\_threshold_{i+1}=eta\cdot nms\_threshold_i\f$.
+     * @param top_k if `>0`, keep at most @p top_k picked indices per class and in total.
+     */
+    CV_EXPORTS_W void NMSBoxesBatched(const std::vector<Rect>& bboxes, const std::vector<float>& scores,
+                                      const std::vector<int>& class_ids,
+                                      const float score_threshold, const float nms_threshold,
+                                      CV_OUT std::vector<int>& indices,
+                                      const float eta = 1.f, const int top_k = 0);
+
 //! @}
 CV__DNN_EXPERIMENTAL_NS_END
 }
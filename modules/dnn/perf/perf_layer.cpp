@@ -0,0 +1,99 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include <opencv2/dnn/shape_utils.hpp>
+
+namespace opencv_test {
+
+static Net initNet(const String& type, LayerParams& lp, const MatShape& inpShape)
+{
+    lp.type = type;
+    lp.name = "testLayer";
+
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+
+    Mat input(inpShape, CV_32F);
+    randu(input, -1.0f, 1.0f);
+    net.setInput(input);
+    net.forward();  // warmup
+    return net;
+}
+
+typedef TestBaseWithParam<tuple<MatShape, int> > Layer_Softmax;
+PERF_TEST_P_(Layer_Softmax, softmax)
+{
+    LayerParams lp;
+    lp.set("axis", get<1>(GetParam()));
+    Net net = initNet("Softmax", lp, get<0>(GetParam()));
+
+    TEST_CYCLE() net.forward();
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Softmax, Values(
+    make_tuple(shape(1, 21, 512, 512), 1),  // segmentation
+    make_tuple(shape(1, 1000), 1),          // classification
+    make_tuple(shape(1, 8732, 21), 2)       // SSD
+));
+
+typedef TestBaseWithParam<tuple<MatShape, String> > Layer_LRN;
+PERF_TEST_P_(Layer_LRN, lrn)
+{
+    LayerParams lp;
+    lp.set("local_size", 5);
+    lp.set("alpha", 1e-4);
+    lp.set("beta", 0.75);
+    lp.set("norm_region", get<1>(GetParam()));
+    Net net = initNet("LRN", lp, get<0>(GetParam()));
+
+    TEST_CYCLE() net.forward();
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Layer_LRN, Combine(
+    Values(shape(1, 96, 55, 55), shape(1, 256, 27, 27)),
+    Values("ACROSS_CHANNELS", "WITHIN_CHANNEL")
+));
+
+typedef TestBaseWithParam<tuple<MatShape, int> > Layer_Permute;
+PERF_TEST_P_(Layer_Permute, permute)
+{
+    // 0: NCHW -> NHWC, 1: NHWC -> NCHW, 2: swap spatial dimensions
+    static const int orders[][4] = { {0, 2, 3, 1}, {0, 3, 1, 2}, {0, 1, 3, 2} };
+    const int* order = orders[get<1>(GetParam())];
+
+    LayerParams lp;
+    lp.set("order", DictValue::arrayInt(order, 4));
+    Net net = initNet("Permute", lp, get<0>(GetParam()));
+
+    TEST_CYCLE() net.forward();
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Permute, Combine(
+    Values(shape(1, 64, 128, 128), shape(1, 512, 19, 19)),
+    Values(0, 1, 2)
+));
+
+typedef TestBaseWithParam<tuple<MatShape, String> > Layer_Resize;
+PERF_TEST_P_(Layer_Resize, resize)
+{
+    LayerParams lp;
+    lp.set("zoom_factor", 2);
+    lp.set("interpolation", get<1>(GetParam()));
+    Net net = initNet("Resize", lp, get<0>(GetParam()));
+
+    TEST_CYCLE() net.forward();
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Resize, Combine(
+    Values(shape(1, 21, 128, 128), shape(1, 256, 32, 32)),
+    Values("nearest", "bilinear")
+));
+
+} // namespace
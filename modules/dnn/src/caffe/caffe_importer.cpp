@@ -50,6 +50,7 @@
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include "caffe_io.hpp"
+#include "../native_weights.hpp"
 #endif
 
 namespace cv {
@@ -79,21 +80,37 @@ class CaffeImporter
 {
     caffe::NetParameter net;
     caffe::NetParameter netBinary;
+    // Memory mapped weights (see convertCaffeModelToNative) used instead of netBinary.
+    bool useNativeWeights;
+    LayersBlobs nativeWeights;
 
 public:
 
-    CaffeImporter(const char *pototxt, const char *caffeModel)
+    CaffeImporter(const char *pototxt, const char *caffeModel) : useNativeWeights(false)
     {
         CV_TRACE_FUNCTION();
 
         ReadNetParamsFromTextFileOrDie(pototxt, &net);
 
         if (caffeModel && caffeModel[0])
-            ReadNetParamsFromBinaryFileOrDie(caffeModel, &netBinary);
+        {
+            useNativeWeights = isNativeWeightsFile(caffeModel);
+            if (useNativeWeights)
+                readNativeWeights(caffeModel, nativeWeights);
+            else
+                ReadNetParamsFromBinaryFileOrDie(caffeModel, &netBinary);
+        }
+    }
+
+    explicit CaffeImporter(const char *caffeModel) : useNativeWeights(false)
+    {
+        CV_TRACE_FUNCTION();
+
+        ReadNetParamsFromBinaryFileOrDie(caffeModel, &netBinary);
     }
 
     CaffeImporter(const char *dataProto, size_t lenProto,
-                  const char *dataModel, size_t lenModel)
+                  const char *dataModel, size_t lenModel) : useNativeWeights(false)
     {
         CV_TRACE_FUNCTION();
 
@@ -275,6 +292,18 @@ public:
     {
         const std::string &name = layer.name();
 
+        if (useNativeWeights)
+        {
+            // Blobs are taken once like from netBinary below.
+            LayersBlobs::iterator it = nativeWeights.find(name);
+            if (it != nativeWeights.end())
+            {
+                layerParams.blobs.swap(it->second);
+                nativeWeights.erase(it);
+            }
+            return;
+        }
+
         int li;
         for (li = 0; li != netBinary.layer_size(); li++)
         {
@@ -300,6 +329,21 @@ public:
         }
     }
 
+    void convertToNative(const String& dst)
+    {
+        LayersBlobs layersBlobs;
+        for (int li = 0; li < netBinary.layer_size(); li++)
+        {
+            const caffe::LayerParameter& layer = netBinary.layer(li);
+            if (layer.blobs_size() == 0 || layersBlobs.count(layer.name()))
+                continue;
+            LayerParams layerParams;
+            extractBinaryLayerParams(layer, layerParams);
+            layersBlobs[layer.name()].swap(layerParams.blobs);
+        }
+        writeNativeWeights(dst, layersBlobs);
+    }
+
     struct BlobNote
     {
         BlobNote(const std::string &_name, int _layerId, int _outNum) :
@@ -453,6 +497,13 @@ Net readNetFromCaffe(const char *bufferProto, size_t lenProto,
     return net;
 }
 
+void convertCaffeModelToNative(const String& src, const String& dst)
+{
+    CV_TRACE_FUNCTION();
+    CaffeImporter caffeImporter(src.c_str());
+    caffeImporter.convertToNative(dst);
+}
+
 #endif //HAVE_PROTOBUF
 
 CV__DNN_EXPERIMENTAL_NS_END
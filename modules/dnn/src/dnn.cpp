@@ -43,14 +43,18 @@
 #include "op_halide.hpp"
 #include "op_inf_engine.hpp"
 #include "halide_scheduler.hpp"
+#include "layers/layers_common.hpp"
 #include <set>
+#include <list>
 #include <algorithm>
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <iterator>
 #include <numeric>
 #include <opencv2/dnn/shape_utils.hpp>
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 
 #include <opencv2/core/utils/configuration.private.hpp>
 #include <opencv2/core/utils/logger.hpp>
@@ -62,6 +66,12 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
 // this option is useful to run valgrind memory errors detection
 static bool DNN_DISABLE_MEMORY_OPTIMIZATIONS = utils::getConfigurationParameterBool("OPENCV_DNN_DISABLE_MEMORY_OPTIMIZATIONS", false);
 
+// default number of input shape configurations kept allocated (see Net::setAllocationCacheSize)
+static size_t DNN_ALLOCATION_CACHE_SIZE = utils::getConfigurationParameterSizeT("OPENCV_DNN_ALLOCATION_CACHE_SIZE", 0);
+
+// comma-separated list of graph optimization passes to disable (see Net::Impl::runGraphPasses)
+static String DNN_DISABLE_GRAPH_PASSES = utils::getConfigurationParameterString("OPENCV_DNN_DISABLE_GRAPH_PASSES", "");
+
 #ifdef HAVE_OPENCL
 static bool DNN_OPENCL_ALLOW_ALL_DEVICES = utils::getConfigurationParameterBool("OPENCV_DNN_OPENCL_ALLOW_ALL_DEVICES", false);
 #endif
@@ -126,84 +136,215 @@ void blobFromImages(InputArrayOfArrays images_, OutputArray blob_, double scalef
                     Size size, const Scalar& mean_, bool swapRB, bool crop)
 {
     CV_TRACE_FUNCTION();
+    Image2BlobParams params(Scalar::all(scalefactor), size, mean_, swapRB, crop, CV_32F);
+    blobFromImagesWithParams(images_, blob_, params);
+}
+
+Image2BlobParams::Image2BlobParams()
+    : scalefactor(Scalar::all(1.0)), size(Size()), mean(Scalar()),
+      swapRB(false), crop(false), ddepth(CV_32F)
+{}
+
+Image2BlobParams::Image2BlobParams(const Scalar& scalefactor_, const Size& size_, const Scalar& mean_,
+                                   bool swapRB_, bool crop_, int ddepth_)
+    : scalefactor(scalefactor_), size(size_), mean(mean_),
+      swapRB(swapRB_), crop(crop_), ddepth(ddepth_)
+{}
+
+namespace
+{
+
+#if CV_SIMD128
+static inline void storeScaled(const v_uint8x16& v, float* dst,
+                               const v_float32x4& vmean, const v_float32x4& vscale)
+{
+    v_uint16x8 w0, w1;
+    v_expand(v, w0, w1);
+    v_uint32x4 d0, d1, d2, d3;
+    v_expand(w0, d0, d1);
+    v_expand(w1, d2, d3);
+    v_store(dst, (v_cvt_f32(v_reinterpret_as_s32(d0)) - vmean) * vscale);
+    v_store(dst + 4, (v_cvt_f32(v_reinterpret_as_s32(d1)) - vmean) * vscale);
+    v_store(dst + 8, (v_cvt_f32(v_reinterpret_as_s32(d2)) - vmean) * vscale);
+    v_store(dst + 12, (v_cvt_f32(v_reinterpret_as_s32(d3)) - vmean) * vscale);
+}
+#endif
+
+// Converts rows of interleaved 8U/32F images to planes of NCHW blob
+// subtracting mean, scaling and swapping channels at once.
+class BlobFromImagesInvoker : public ParallelLoopBody
+{
+public:
+    BlobFromImagesInvoker(const std::vector<Mat>& images, Mat& blob,
+                          const float* mean, const float* scale, const int* srcCn, int nstripes)
+        : images_(images), blob_(blob), nstripes_(nstripes)
+    {
+        nch_ = blob.size[1];
+        for (int c = 0; c < nch_; ++c)
+        {
+            mean_[c] = mean[c];
+            scale_[c] = scale[c];
+            srcCn_[c] = srcCn[c];
+        }
+    }
+
+    void operator()(const Range& r) const CV_OVERRIDE
+    {
+        const int height = blob_.size[2], width = blob_.size[3];
+        const int nrows = (int)images_.size() * height;
+        const int rowStart = (int)((int64)r.start * nrows / nstripes_);
+        const int rowEnd = (int)((int64)r.end * nrows / nstripes_);
+        const bool toHalf = blob_.depth() == CV_16S;
+
+        AutoBuffer<float> buf(toHalf ? width * nch_ : 0);
+        float* dst[4];
+        for (int row = rowStart; row < rowEnd; ++row)
+        {
+            const int n = row / height, y = row % height;
+            const Mat& image = images_[n];
+            for (int c = 0; c < nch_; ++c)
+                dst[c] = toHalf ? buf.data() + c * width : blob_.ptr<float>(n, c) + y * width;
+
+            if (image.depth() == CV_8U)
+                processRow(image.ptr<uchar>(y), dst, width);
+            else
+                processRow(image.ptr<float>(y), dst, width);
+
+            if (toHalf)
+            {
+                for (int c = 0; c < nch_; ++c)
+                {
+                    Mat dstRow(1, width, CV_16S, blob_.ptr<short>(n, c) + y * width);
+                    convertFp16(Mat(1, width, CV_32F, dst[c]), dstRow);
+                }
+            }
+        }
+    }
+
+private:
+    template <typename T>
+    void processRowScalar(const T* src, float** dst, int x, int width) const
+    {
+        for (int c = 0; c < nch_; ++c)
+        {
+            const T* s = src + srcCn_[c];
+            float* d = dst[c];
+            const float m = mean_[c], sc = scale_[c];
+            for (int j = x; j < width; ++j)
+                d[j] = ((float)s[j * nch_] - m) * sc;
+        }
+    }
+
+    void processRow(const float* src, float** dst, int width) const
+    {
+        processRowScalar(src, dst, 0, width);
+    }
+
+    void processRow(const uchar* src, float** dst, int width) const
+    {
+        int x = 0;
+#if CV_SIMD128
+        v_float32x4 vmean[4], vscale[4];
+        for (int c = 0; c < nch_; ++c)
+        {
+            vmean[c] = v_setall_f32(mean_[c]);
+            vscale[c] = v_setall_f32(scale_[c]);
+        }
+        v_uint8x16 v[4];
+        for (; x <= width - 16; x += 16)
+        {
+            const uchar* s = src + x * nch_;
+            if (nch_ == 1)
+                v[0] = v_load(s);
+            else if (nch_ == 3)
+                v_load_deinterleave(s, v[0], v[1], v[2]);
+            else
+                v_load_deinterleave(s, v[0], v[1], v[2], v[3]);
+            for (int c = 0; c < nch_; ++c)
+                storeScaled(v[srcCn_[c]], dst[c] + x, vmean[c], vscale[c]);
+        }
+#endif
+        processRowScalar(src, dst, x, width);
+    }
+
+    const std::vector<Mat>& images_;
+    Mat& blob_;
+    int nstripes_;  // the rows are split into this many stripes, as passed to parallel_for_
+    int nch_;
+    float mean_[4], scale_[4];
+    int srcCn_[4];
+};
+
+}  // namespace
+
+void blobFromImagesWithParams(InputArrayOfArrays images_, OutputArray blob_, const Image2BlobParams& params)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(params.ddepth == CV_32F || params.ddepth == CV_16S);
     std::vector<Mat> images;
     images_.getMatVector(images);
     CV_Assert(!images.empty());
-    for (int i = 0; i < images.size(); i++)
+
+    Size size = params.size;
+    if (size == Size())
+        size = images[0].size();
+    const int nch = images[0].channels();
+    CV_Assert(nch == 1 || nch == 3 || nch == 4);
+
+    for (size_t i = 0; i < images.size(); i++)
     {
+        CV_Assert(images[i].dims == 2, images[i].channels() == nch);
+        // Only resize makes a copy of an image. Crop is a header.
         Size imgSize = images[i].size();
-        if (size == Size())
-            size = imgSize;
         if (size != imgSize)
         {
-            if(crop)
+            if (params.crop)
             {
-              float resizeFactor = std::max(size.width / (float)imgSize.width,
-                                            size.height / (float)imgSize.height);
-              resize(images[i], images[i], Size(), resizeFactor, resizeFactor, INTER_LINEAR);
-              Rect crop(Point(0.5 * (images[i].cols - size.width),
-                              0.5 * (images[i].rows - size.height)),
-                        size);
-              images[i] = images[i](crop);
+                float resizeFactor = std::max(size.width / (float)imgSize.width,
+                                              size.height / (float)imgSize.height);
+                resize(images[i], images[i], Size(), resizeFactor, resizeFactor, INTER_LINEAR);
+                Rect crop(Point(0.5 * (images[i].cols - size.width),
+                                0.5 * (images[i].rows - size.height)),
+                          size);
+                images[i] = images[i](crop);
             }
             else
-              resize(images[i], images[i], size, 0, 0, INTER_LINEAR);
+                resize(images[i], images[i], size, 0, 0, INTER_LINEAR);
         }
-        if(images[i].depth() == CV_8U)
+        CV_Assert(images[i].size() == size);
+        if (images[i].depth() != CV_8U && images[i].depth() != CV_32F)
             images[i].convertTo(images[i], CV_32F);
-        Scalar mean = mean_;
-        if (swapRB)
-            std::swap(mean[0], mean[2]);
-
-        images[i] -= mean;
-        images[i] *= scalefactor;
     }
 
-    size_t i, nimages = images.size();
-    Mat image0 = images[0];
-    int nch = image0.channels();
-    CV_Assert(image0.dims == 2);
-    Mat image;
-    if (nch == 3 || nch == 4)
-    {
-        int sz[] = { (int)nimages, nch, image0.rows, image0.cols };
-        blob_.create(4, sz, CV_32F);
-        Mat blob = blob_.getMat();
-        Mat ch[4];
-
-        for( i = 0; i < nimages; i++ )
-        {
-            image = images[i];
-            CV_Assert(image.depth() == CV_32F);
-            nch = image.channels();
-            CV_Assert(image.dims == 2 && (nch == 3 || nch == 4));
-            CV_Assert(image.size() == image0.size());
+    int sz[] = { (int)images.size(), nch, size.height, size.width };
+    blob_.create(4, sz, params.ddepth);
+    Mat blob = blob_.getMat();
+    CV_Assert(blob.isContinuous());
 
-            for( int j = 0; j < nch; j++ )
-                ch[j] = Mat(image.rows, image.cols, CV_32F, blob.ptr((int)i, j));
-            if(swapRB)
-                std::swap(ch[0], ch[2]);
-            split(image, ch);
-        }
-    }
-    else
+    float mean[4], scale[4];
+    int srcCn[4];
+    for (int c = 0; c < nch; ++c)
     {
-       CV_Assert(nch == 1);
-       int sz[] = { (int)nimages, 1, image0.rows, image0.cols };
-       blob_.create(4, sz, CV_32F);
-       Mat blob = blob_.getMat();
+        mean[c] = saturate_cast<float>(params.mean[c]);
+        scale[c] = saturate_cast<float>(params.scalefactor[c]);
+        srcCn[c] = c;
+    }
+    if (params.swapRB && nch >= 3)
+        std::swap(srcCn[0], srcCn[2]);
+    else if (params.swapRB)
+        mean[0] = saturate_cast<float>(params.mean[2]); // the mean is swapped even if the channels aren't
 
-       for( i = 0; i < nimages; i++ )
-       {
-           Mat image = images[i];
-           CV_Assert(image.depth() == CV_32F);
-           nch = image.channels();
-           CV_Assert(image.dims == 2 && (nch == 1));
-           CV_Assert(image.size() == image0.size());
+    const int nrows = (int)images.size() * size.height;
+    const int nstripes = std::min(nrows, std::max(getNumThreads(), 1) * 4);
+    BlobFromImagesInvoker invoker(images, blob, mean, scale, srcCn, nstripes);
+    parallel_for_(Range(0, nstripes), invoker, nstripes);
+}
 
-           image.copyTo(Mat(image.rows, image.cols, CV_32F, blob.ptr((int)i, 0)));
-       }
-    }
+void blobFromImageWithParams(InputArray image, OutputArray blob, const Image2BlobParams& params)
+{
+    CV_TRACE_FUNCTION();
+    std::vector<Mat> images(1, image.getMat());
+    blobFromImagesWithParams(images, blob, params);
 }
 
 void imagesFromBlob(const cv::Mat& blob_, OutputArrayOfArrays images_)
@@ -586,16 +727,48 @@ public:
         }
 
         {
-            // if dst already has been allocated with total(shape) elements,
-            // it won't be recreated and pointer of dst.data remains the same.
-            dst.create(shape, use_half ? CV_16S : CV_32F);
+            const int type = use_half ? CV_16S : CV_32F;
+            // Network inputs share memory with Net::setInput() data so they are never cached.
+            const bool cacheable = lp.lid != 0;
+            if (cacheable && numUsedCachedHosts < cachedHosts.size() &&
+                cachedHosts[numUsedCachedHosts].total() == (size_t)total(shape) &&
+                cachedHosts[numUsedCachedHosts].type() == type)
+            {
+                dst = cachedHosts[numUsedCachedHosts].reshape(1, shape);
+            }
+            else
+            {
+                // if dst already has been allocated with total(shape) elements,
+                // it won't be recreated and pointer of dst.data remains the same.
+                dst.create(shape, type);
+            }
+            if (cacheable)
+            {
+                numUsedCachedHosts++;
+                allocatedHosts.push_back(dst);
+            }
             addHost(lp, dst);
         }
     }
 
+    // Memory allocated before for the same network configuration. Allocation order
+    // is deterministic so blobs are taken in order if their sizes match.
+    void setCachedHosts(const std::vector<Mat>& hosts)
+    {
+        cachedHosts = hosts;
+        numUsedCachedHosts = 0;
+    }
+
+    // Memory allocated (or taken from cached hosts) since the last reset.
+    const std::vector<Mat>& getAllocatedHosts() const
+    {
+        return allocatedHosts;
+    }
+
     void allocateBlobsForLayer(LayerData &ld, const LayerShapes& layerShapes,
                                std::vector<LayerPin>& pinsForInternalBlobs,
-                               bool forceCreate = false, bool use_half = false)
+                               bool forceCreate = false, bool use_half = false,
+                               bool outputsAliasInput = false)
     {
         CV_TRACE_FUNCTION();
 
@@ -624,6 +797,14 @@ public:
                 inPlace = numRef == 1;
             }
         }
+        // Layers which only change a view of data (i.e. Reshape or Split) might
+        // share memory with their input regardless of the number of its consumers.
+        // The input memory is kept alive by references to the outputs.
+        if (outputsAliasInput && !forceCreate && !DNN_DISABLE_MEMORY_OPTIMIZATIONS &&
+            ld.inputBlobs.size() == 1)
+        {
+            inPlace = true;
+        }
 
         ShapesVec shapes(outShapes);
         shapes.insert(shapes.end(), internalShapes.begin(), internalShapes.end());
@@ -680,6 +861,9 @@ public:
         refCounter.clear();
         reuseMap.clear();
         memHosts.clear();
+        cachedHosts.clear();
+        allocatedHosts.clear();
+        numUsedCachedHosts = 0;
     }
 
 private:
@@ -691,6 +875,8 @@ private:
         memHosts[lp] = mat;
     }
 
+    std::vector<Mat> cachedHosts, allocatedHosts;
+    size_t numUsedCachedHosts;
     std::map<LayerPin, int> refCounter;
     // Maps pin to origin blob (for whom memory was allocated firstly).
     // For origin blobs key == value.
@@ -750,6 +936,7 @@ struct Net::Impl
         preferableBackend = DNN_BACKEND_DEFAULT;
         preferableTarget = DNN_TARGET_CPU;
         skipInfEngineInit = false;
+        allocationCacheSize = DNN_ALLOCATION_CACHE_SIZE;
     }
 
     Ptr<DataLayer> netInputLayer;
@@ -768,9 +955,28 @@ struct Net::Impl
 
     bool netWasAllocated;
     bool fusion;
+    // Padding layers folded into the following convolutions, reverted by clear().
+    struct FoldedPadding
+    {
+        int paddingId, convId;
+        Size convPad;
+    };
+    std::vector<FoldedPadding> foldedPaddings;
     std::vector<int64> layersTimings;
     Mat output_blob;
 
+    // Inferred shapes and allocated memory of recently used input shapes,
+    // most recently used first.
+    struct AllocationCacheEntry
+    {
+        ShapesVec inputShapes;
+        std::vector<LayerPin> blobsToKeep;
+        LayersShapesMap layersShapes;
+        std::vector<Mat> hosts;
+    };
+    std::list<AllocationCacheEntry> allocationCache;
+    size_t allocationCacheSize;
+
     Ptr<BackendWrapper> wrap(Mat& host)
     {
         if (preferableBackend == DNN_BACKEND_OPENCV && preferableTarget == DNN_TARGET_CPU)
@@ -886,6 +1092,10 @@ struct Net::Impl
             }
         }
 
+        for (int i = (int)foldedPaddings.size() - 1; i >= 0; --i)
+            unfoldPadding(foldedPaddings[i]);
+        foldedPaddings.clear();
+
         layersTimings.clear();
     }
 
@@ -1063,6 +1273,7 @@ struct Net::Impl
         addLayerInput(ldInp, inNum, LayerPin(outLayerId, outNum));
         ldOut.requiredOutputs.insert(outNum);
         ldOut.consumers.push_back(LayerPin(inLayerId, outNum));
+        allocationCache.clear();
     }
 
     void initBackend()
@@ -1420,7 +1631,9 @@ struct Net::Impl
         blobManager.allocateBlobsForLayer(ld, layerShapesIt->second, pinsForInternalBlobs,
                                           preferableBackend == DNN_BACKEND_INFERENCE_ENGINE,
                                           preferableBackend == DNN_BACKEND_OPENCV &&
-                                          preferableTarget == DNN_TARGET_OPENCL_FP16);
+                                          preferableTarget == DNN_TARGET_OPENCL_FP16,
+                                          fusion && preferableBackend == DNN_BACKEND_OPENCV &&
+                                          preferableTarget == DNN_TARGET_CPU && isViewLayer(ld));
         ld.outputBlobsWrappers.resize(ld.outputBlobs.size());
         for (int i = 0; i < ld.outputBlobs.size(); ++i)
         {
@@ -1434,8 +1647,15 @@ struct Net::Impl
 
         Ptr<Layer> layerPtr = ld.getLayerInstance();
         {
-            layerPtr->finalize(ld.inputBlobs, ld.outputBlobs);
             layerPtr->preferableTarget = preferableTarget;
+            layerPtr->finalize(ld.inputBlobs, ld.outputBlobs);
+            // Layers may replace weights by a reduced precision copy (see
+            // OPENCV_DNN_CPU_WEIGHTS_PRECISION), don't keep the original ones alive.
+            for (size_t i = 0; i < ld.params.blobs.size() && i < layerPtr->blobs.size(); i++)
+            {
+                if (ld.params.blobs[i].type() != layerPtr->blobs[i].type())
+                    ld.params.blobs[i] = layerPtr->blobs[i];
+            }
 #if 0
             std::cout << "\toutputs:";
             size_t noutputs = ld.outputBlobs.size();
@@ -1460,7 +1680,17 @@ struct Net::Impl
 #define printf_(args)
 #endif
 
-    void fuseLayers(const std::vector<LayerPin>& blobsToKeep_)
+    typedef void (Impl::*GraphPass)(const std::set<LayerPin>& pinsToKeep);
+
+    struct GraphPassInfo
+    {
+        const char* name;
+        GraphPass pass;
+        bool beforeAllocation;  // pass changes graph topology so it is applied before memory allocation
+    };
+
+    // Applies graph optimization passes of the specified stage in order of registration.
+    void runGraphPasses(bool beforeAllocation, const std::vector<LayerPin>& blobsToKeep_)
     {
         if( !fusion || preferableBackend != DNN_BACKEND_OPENCV &&
                        preferableBackend != DNN_BACKEND_INFERENCE_ENGINE)
@@ -1468,10 +1698,145 @@ struct Net::Impl
 
         CV_TRACE_FUNCTION();
 
-        // scan through all the layers. If there is convolution layer followed by the activation layer,
-        // we try to embed this activation into the convolution and disable separate execution of the activation
+        static const GraphPassInfo passes[] = {
+            { "FoldPadding", &Impl::foldPaddingPass, true },
+            { "FuseLayers", &Impl::fuseLayers, false },
+            { "SkipViewLayers", &Impl::skipViewLayersPass, false }
+        };
+
         std::set<LayerPin> pinsToKeep(blobsToKeep_.begin(),
                                       blobsToKeep_.end());
+        for (size_t i = 0; i < sizeof(passes) / sizeof(passes[0]); ++i)
+        {
+            const GraphPassInfo& info = passes[i];
+            if (info.beforeAllocation != beforeAllocation || isGraphPassDisabled(info.name))
+                continue;
+            printf_(("graph pass %s\n", info.name));
+            (this->*info.pass)(pinsToKeep);
+        }
+    }
+
+    static bool isGraphPassDisabled(const String& name)
+    {
+        std::istringstream ss(DNN_DISABLE_GRAPH_PASSES);
+        std::string token;
+        while (std::getline(ss, token, ','))
+        {
+            if (token == name)
+                return true;
+        }
+        return false;
+    }
+
+    // Zero padding of spatial dimensions followed by convolution is replaced
+    // by convolution's own padding: (pad) -> (conv) => (conv with bigger pad).
+    void foldPaddingPass(const std::set<LayerPin>& pinsToKeep)
+    {
+        if (preferableBackend != DNN_BACKEND_OPENCV || preferableTarget != DNN_TARGET_CPU)
+            return;
+
+        for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); ++it)
+        {
+            LayerData& ld = it->second;
+            if (ld.type != "Padding" || ld.skip || ld.inputBlobsId.size() != 1 ||
+                ld.consumers.size() != 1 || pinsToKeep.count(LayerPin(ld.id, 0)) != 0)
+                continue;
+
+            LayerData& convData = layers[ld.consumers[0].lid];
+            Ptr<ConvolutionLayer> conv = convData.getLayerInstance().dynamicCast<ConvolutionLayer>();
+            if (conv.empty() || convData.type != "Convolution" || !conv->padMode.empty() ||
+                convData.inputBlobsId.size() != 1)
+                continue;
+
+            // Paddings are stored as (before, after) pairs per dimension.
+            const LayerParams& params = ld.params;
+            if (params.get<String>("type", "constant") != "constant" ||
+                params.get<float>("value", 0) != 0 ||
+                params.get<int>("input_dims", -1) > 4 ||
+                !params.has("paddings") || params.get("paddings").size() != 8)
+                continue;
+            const DictValue& paddings = params.get("paddings");
+            if (paddings.get<int>(0) != 0 || paddings.get<int>(1) != 0 ||  // batch
+                paddings.get<int>(2) != 0 || paddings.get<int>(3) != 0 ||  // channels
+                paddings.get<int>(4) != paddings.get<int>(5) ||             // height
+                paddings.get<int>(6) != paddings.get<int>(7))               // width
+                continue;
+
+            FoldedPadding folded;
+            folded.paddingId = ld.id;
+            folded.convId = convData.id;
+            folded.convPad = conv->pad;
+
+            conv->pad.height += paddings.get<int>(4);
+            conv->pad.width += paddings.get<int>(6);
+
+            LayerPin inpPin = ld.inputBlobsId[0];
+            convData.inputBlobsId[0] = inpPin;
+            layers[inpPin.lid].consumers.push_back(LayerPin(convData.id, inpPin.oid));
+            ld.consumers.clear();
+            ld.skip = true;
+            foldedPaddings.push_back(folded);
+            printf_(("\tfolded %s into %s\n", ld.name.c_str(), convData.name.c_str()));
+        }
+    }
+
+    void unfoldPadding(const FoldedPadding& folded)
+    {
+        LayerData& ld = layers[folded.paddingId];
+        LayerData& convData = layers[folded.convId];
+        LayerPin inpPin = ld.inputBlobsId[0];
+
+        std::vector<LayerPin>& consumers = layers[inpPin.lid].consumers;
+        for (size_t i = 0; i < consumers.size(); ++i)
+        {
+            if (consumers[i].lid == convData.id)
+            {
+                consumers.erase(consumers.begin() + i);
+                break;
+            }
+        }
+        ld.consumers.assign(1, LayerPin(convData.id, 0));
+        convData.inputBlobsId[0] = LayerPin(ld.id, 0);
+        convData.getLayerInstance().dynamicCast<ConvolutionLayer>()->pad = folded.convPad;
+    }
+
+    static bool isViewLayer(const LayerData& ld)
+    {
+        return ld.inputBlobsId.size() == 1 &&
+               (ld.type == "Reshape" || ld.type == "Flatten" || ld.type == "Split");
+    }
+
+    // Reshape, Flatten and Split layers which outputs share memory with input
+    // have nothing to compute.
+    void skipViewLayersPass(const std::set<LayerPin>&)
+    {
+        if (preferableBackend != DNN_BACKEND_OPENCV || preferableTarget != DNN_TARGET_CPU)
+            return;
+
+        for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); ++it)
+        {
+            LayerData& ld = it->second;
+            if (ld.skip || !isViewLayer(ld) || ld.inputBlobs.size() != 1)
+                continue;
+
+            bool aliased = !ld.outputBlobs.empty();
+            for (size_t i = 0; i < ld.outputBlobs.size() && aliased; ++i)
+                aliased = ld.outputBlobs[i].data == ld.inputBlobs[0]->data &&
+                          ld.outputBlobs[i].total() == ld.inputBlobs[0]->total();
+            if (aliased)
+            {
+                ld.skip = true;
+                printf_(("\tskipped view layer %s\n", ld.name.c_str()));
+            }
+        }
+    }
+
+    void fuseLayers(const std::set<LayerPin>& pinsToKeep)
+    {
+        CV_TRACE_FUNCTION();
+
+        // scan through all the layers. If there is convolution layer followed by the activation layer,
+        // we try to embed this activation into the convolution and disable separate execution of the activation
         MapIdToLayerData::iterator it;
         for (it = layers.begin(); it != layers.end(); it++)
         {
@@ -1771,7 +2136,11 @@ struct Net::Impl
 
         MapIdToLayerData::iterator it;
         for (it = layers.begin(); it != layers.end(); it++)
+        {
             it->second.flag = 0;
+            // shapes of internal buffers may depend on the target
+            it->second.getLayerInstance()->preferableTarget = preferableTarget;
+        }
 
         CV_Assert(!layers[0].outputBlobs.empty());
         ShapesVec inputShapes;
@@ -1786,10 +2155,24 @@ struct Net::Impl
             }
             inputShapes.push_back(shape(inp));
         }
+        runGraphPasses(true, blobsToKeep_);
+
+        std::list<AllocationCacheEntry>::iterator cached = allocationCache.begin();
+        for (; cached != allocationCache.end(); ++cached)
+        {
+            if (cached->inputShapes == inputShapes && cached->blobsToKeep == blobsToKeep_)
+                break;
+        }
+
         LayersShapesMap layersShapes;
-        getLayersShapes(inputShapes, layersShapes);
+        if (cached != allocationCache.end())
+            layersShapes = cached->layersShapes;
+        else
+            getLayersShapes(inputShapes, layersShapes);
 
         blobManager.reset();
+        if (cached != allocationCache.end())
+            blobManager.setCachedHosts(cached->hosts);
         backendWrappers.clear();
         // Fake references to input blobs.
         for (int i = 0; i < layers[0].outputBlobs.size(); ++i)
@@ -1811,8 +2194,24 @@ struct Net::Impl
             allocateLayer(lid, layersShapes);
         }
 
+        if (allocationCacheSize > 0)
+        {
+            if (cached == allocationCache.end())
+            {
+                cached = allocationCache.insert(allocationCache.begin(), AllocationCacheEntry());
+                cached->inputShapes = inputShapes;
+                cached->blobsToKeep = blobsToKeep_;
+                cached->layersShapes = layersShapes;
+            }
+            else
+                allocationCache.splice(allocationCache.begin(), allocationCache, cached);
+            cached->hosts = blobManager.getAllocatedHosts();
+            while (allocationCache.size() > allocationCacheSize)
+                allocationCache.pop_back();
+        }
+
         layersTimings.resize(lastLayerId + 1, 0);
-        fuseLayers(blobsToKeep_);
+        runGraphPasses(false, blobsToKeep_);
     }
 
     void forwardLayer(LayerData &ld)
@@ -1880,6 +2279,26 @@ struct Net::Impl
         ld.flag = 1;
     }
 
+    String getLayerImplementation(LayerData &ld)
+    {
+        static const char* backendNames[] = {"DEFAULT", "HALIDE", "DLIE", "OCV"};
+        static const char* targetNames[] = {"CPU", "OPENCL", "OPENCL_FP16", "MYRIAD"};
+
+        Ptr<Layer> layer = ld.layerInstance;
+        if (preferableBackend == DNN_BACKEND_OPENCV ||
+            layer.empty() || !layer->supportBackend(preferableBackend))
+        {
+            if (preferableBackend == DNN_BACKEND_OPENCV && IS_DNN_OPENCL_TARGET(preferableTarget))
+                return format("OCV/%s", targetNames[preferableTarget]);
+
+            String impl = "OCV/CPU";
+            if (ld.type == "Convolution" || ld.type == "Deconvolution" || ld.type == "InnerProduct")
+                impl += "/" + getFastKernelsDispatchName();
+            return impl;
+        }
+        return format("%s/%s", backendNames[preferableBackend], targetNames[preferableTarget]);
+    }
+
     void forwardToLayer(LayerData &ld, bool clearFlags = true)
     {
         CV_TRACE_FUNCTION();
@@ -2078,6 +2497,7 @@ int Net::addLayer(const String &name, const String &type, LayerParams &params)
     int id = ++impl->lastLayerId;
     impl->layerNameToId.insert(std::make_pair(name, id));
     impl->layers.insert(std::make_pair(id, LayerData(id, name, type, params)));
+    impl->allocationCache.clear();
 
     return id;
 }
@@ -2263,6 +2683,7 @@ void Net::setPreferableBackend(int backendId)
     {
         impl->preferableBackend = backendId;
         impl->netWasAllocated = false;
+        impl->allocationCache.clear();
         impl->clear();
     }
 }
@@ -2292,6 +2713,7 @@ void Net::setPreferableTarget(int targetId)
 #endif
         }
         impl->netWasAllocated = false;
+        impl->allocationCache.clear();
         impl->clear();
     }
 }
@@ -2341,13 +2763,66 @@ void Net::setInput(InputArray blob, const String& name)
     impl->netWasAllocated = impl->netWasAllocated && oldShape;
 }
 
+void Net::setAllocationCacheSize(int size)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(size >= 0);
+
+    impl->allocationCacheSize = size;
+    while (impl->allocationCache.size() > impl->allocationCacheSize)
+        impl->allocationCache.pop_back();
+}
+
+void Net::preallocate(const std::vector<MatShape>& inputShapes, const std::vector<String>& outBlobNames)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(!inputShapes.empty());
+
+    std::vector<LayerPin> pins;
+    if (outBlobNames.empty())
+        pins.push_back(impl->getPinByAlias(getLayerNames().back()));
+    for (size_t i = 0; i < outBlobNames.size(); i++)
+        pins.push_back(impl->getPinByAlias(outBlobNames[i]));
+
+    // Allocate the network for fake inputs and restore the current ones.
+    LayerData &ld = impl->layers[0];
+    std::vector<Mat> inputsData = impl->netInputLayer->inputsData;
+    std::vector<Mat> outputBlobs = ld.outputBlobs;
+    std::vector<Ptr<BackendWrapper> > outputBlobsWrappers = ld.outputBlobsWrappers;
+
+    ld.outputBlobs.resize(inputShapes.size());
+    ld.outputBlobsWrappers.resize(inputShapes.size());
+    impl->netInputLayer->inputsData.resize(inputShapes.size());
+    for (size_t i = 0; i < inputShapes.size(); i++)
+    {
+        ld.outputBlobs[i] = Mat(inputShapes[i], CV_32F, Scalar(0));
+        impl->netInputLayer->inputsData[i] = ld.outputBlobs[i];
+    }
+    impl->netWasAllocated = false;
+    impl->setUpNet(pins);
+
+    impl->netInputLayer->inputsData = inputsData;
+    ld.outputBlobs = outputBlobs;
+    ld.outputBlobsWrappers = outputBlobsWrappers;
+    impl->netWasAllocated = false;
+}
+
 Mat Net::getParam(LayerId layer, int numParam)
 {
     LayerData &ld = impl->getLayerData(layer);
 
     std::vector<Mat> &layerBlobs = ld.layerInstance->blobs;
     CV_Assert(numParam < (int)layerBlobs.size());
-    return layerBlobs[numParam];
+    const Mat& blob = layerBlobs[numParam];
+    // weights kept in reduced precision (see OPENCV_DNN_CPU_WEIGHTS_PRECISION) are expanded to FP32
+    if (numParam == 0 && (blob.depth() == CV_16S || blob.depth() == CV_16U) &&
+        (ld.layerInstance.dynamicCast<ConvolutionLayer>() || ld.layerInstance.dynamicCast<InnerProductLayer>()))
+    {
+        Mat weights;
+        decompressWeights(blob, weights);
+        return weights;
+    }
+    return blob;
 }
 
 void Net::setParam(LayerId layer, int numParam, const Mat &blob)
@@ -2358,6 +2833,9 @@ void Net::setParam(LayerId layer, int numParam, const Mat &blob)
     CV_Assert(numParam < (int)layerBlobs.size());
     //we don't make strong checks, use this function carefully
     layerBlobs[numParam] = blob;
+    // layers prepare their parameters once allocated
+    impl->netWasAllocated = false;
+    impl->allocationCache.clear();
 }
 
 int Net::getLayerId(const String &layer)
@@ -2660,6 +3138,7 @@ void Net::enableFusion(bool fusion)
     {
         impl->fusion = fusion;
         impl->netWasAllocated = false;
+        impl->allocationCache.clear();
         impl->clear();
     }
 }
@@ -2679,6 +3158,257 @@ int64 Net::getPerfProfile(std::vector<double>& timings)
     return total;
 }
 
+LayerProfile::LayerProfile()
+    : id(-1), fused(false), flops(0), weightsMemory(0), blobsMemory(0), runs(0),
+      meanMs(0), minMs(0), medianMs(0), p90Ms(0), p99Ms(0), maxMs(0), gflopsPerSec(0) {}
+
+// Nearest-rank percentile of sorted values.
+static double getPercentile(const std::vector<double>& sorted, double q)
+{
+    CV_Assert(!sorted.empty());
+    int idx = (int)std::ceil(q * sorted.size()) - 1;
+    return sorted[std::min(std::max(idx, 0), (int)sorted.size() - 1)];
+}
+
+double Net::profile(std::vector<LayerProfile>& profiles, int nruns, const String& outputName)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(nruns > 0);
+
+    const double tickToMs = 1e3 / getTickFrequency();
+    std::vector<std::vector<double> > layersMs;
+    std::vector<double> totalMs(nruns, 0);
+    for (int run = 0; run < nruns; ++run)
+    {
+        std::fill(impl->layersTimings.begin(), impl->layersTimings.end(), 0);
+        forward(outputName);
+
+        const std::vector<int64>& timings = impl->layersTimings;
+        if (layersMs.empty())
+            layersMs.resize(timings.size(), std::vector<double>(nruns, 0));
+        CV_Assert(layersMs.size() == timings.size());
+        for (size_t i = 1; i < timings.size(); ++i)
+        {
+            layersMs[i][run] = timings[i] * tickToMs;
+            totalMs[run] += layersMs[i][run];
+        }
+    }
+
+    profiles.clear();
+    for (Impl::MapIdToLayerData::iterator it = impl->layers.begin(); it != impl->layers.end(); ++it)
+    {
+        LayerData& ld = it->second;
+        if (ld.id == 0 || ld.id >= (int)layersMs.size())
+            continue;
+
+        LayerProfile p;
+        p.id = ld.id;
+        p.name = ld.name;
+        p.type = ld.type;
+        p.fused = ld.skip;
+        p.implementation = impl->getLayerImplementation(ld);
+
+        for (size_t i = 0; i < ld.inputBlobs.size(); ++i)
+            p.inputShapes.push_back(shape(*ld.inputBlobs[i]));
+        for (size_t i = 0; i < ld.outputBlobs.size(); ++i)
+        {
+            p.outputShapes.push_back(shape(ld.outputBlobs[i]));
+            p.blobsMemory += ld.outputBlobs[i].total() * ld.outputBlobs[i].elemSize();
+        }
+        for (size_t i = 0; i < ld.internals.size(); ++i)
+            p.blobsMemory += ld.internals[i].total() * ld.internals[i].elemSize();
+        for (size_t i = 0; i < ld.params.blobs.size(); ++i)
+            p.weightsMemory += ld.params.blobs[i].total() * ld.params.blobs[i].elemSize();
+        if (!ld.layerInstance.empty())
+            p.flops = ld.layerInstance->getFLOPS(p.inputShapes, p.outputShapes);
+
+        std::vector<double> sorted = layersMs[ld.id];
+        std::sort(sorted.begin(), sorted.end());
+        p.runs = nruns;
+        p.meanMs = std::accumulate(sorted.begin(), sorted.end(), 0.0) / nruns;
+        p.minMs = sorted.front();
+        p.maxMs = sorted.back();
+        p.medianMs = getPercentile(sorted, 0.5);
+        p.p90Ms = getPercentile(sorted, 0.9);
+        p.p99Ms = getPercentile(sorted, 0.99);
+        p.gflopsPerSec = p.medianMs > 0 ? p.flops / (p.medianMs * 1e6) : 0;
+        profiles.push_back(p);
+    }
+
+    std::sort(totalMs.begin(), totalMs.end());
+    return getPercentile(totalMs, 0.5);
+}
+
+static std::string shapesToString(const std::vector<MatShape>& shapes, const char* delim)
+{
+    std::ostringstream ss;
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        if (i > 0)
+            ss << delim;
+        for (size_t j = 0; j < shapes[i].size(); ++j)
+            ss << (j > 0 ? "x" : "") << shapes[i][j];
+    }
+    return ss.str();
+}
+
+static std::string escapeQuotes(const String& str)
+{
+    std::string res;
+    for (size_t i = 0; i < str.size(); ++i)
+    {
+        char c = str[i];
+        if (c == '"' || c == '\\')
+            res += '\\';
+        res += c;
+    }
+    return res;
+}
+
+static std::string escapeJSON(const String& str)
+{
+    std::string res;
+    for (size_t i = 0; i < str.size(); ++i)
+    {
+        unsigned char c = (unsigned char)str[i];
+        if (c < 0x20)
+        {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            res += buf;
+            continue;
+        }
+        if (c == '"' || c == '\\')
+            res += '\\';
+        res += (char)c;
+    }
+    return res;
+}
+
+static std::string escapeCSV(const String& str)
+{
+    std::string res = "\"";
+    for (size_t i = 0; i < str.size(); ++i)
+    {
+        if (str[i] == '"')
+            res += '"';
+        res += str[i];
+    }
+    return res + "\"";
+}
+
+static std::string shapesToJSON(const std::vector<MatShape>& shapes)
+{
+    std::ostringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        ss << (i > 0 ? ", [" : "[");
+        for (size_t j = 0; j < shapes[i].size(); ++j)
+            ss << (j > 0 ? ", " : "") << shapes[i][j];
+        ss << "]";
+    }
+    ss << "]";
+    return ss.str();
+}
+
+String Net::dump()
+{
+    CV_Assert(!empty());
+
+    std::ostringstream out;
+    out << "digraph G {\n";
+    for (Impl::MapIdToLayerData::iterator it = impl->layers.begin(); it != impl->layers.end(); ++it)
+    {
+        LayerData& ld = it->second;
+        out << "  \"" << ld.id << "\" [label=\"" << escapeQuotes(ld.name) << "\\n" << escapeQuotes(ld.type);
+        if (impl->netWasAllocated && ld.id != 0)
+            out << "\\n" << impl->getLayerImplementation(ld);
+        if (ld.skip)
+            out << "\\n(skipped)\", style=dashed";
+        else
+            out << "\"";
+        out << "];\n";
+    }
+    for (Impl::MapIdToLayerData::iterator it = impl->layers.begin(); it != impl->layers.end(); ++it)
+    {
+        const LayerData& ld = it->second;
+        for (size_t i = 0; i < ld.inputBlobsId.size(); ++i)
+        {
+            out << "  \"" << ld.inputBlobsId[i].lid << "\" -> \"" << ld.id << "\"";
+            if (ld.inputBlobsId[i].oid != 0)
+                out << " [label=\"" << ld.inputBlobsId[i].oid << "\"]";
+            out << ";\n";
+        }
+    }
+    out << "}\n";
+    return out.str();
+}
+
+void Net::dumpToFile(const String& path)
+{
+    std::ofstream file(path.c_str());
+    if (!file.is_open())
+        CV_Error(Error::StsError, "Failed to open file " + path);
+    file << dump();
+}
+
+void writePerfProfile(const String& filename, const std::vector<LayerProfile>& profiles)
+{
+    CV_TRACE_FUNCTION();
+
+    String ext = filename.substr(filename.rfind('.') + 1).toLowerCase();
+    if (ext != "json" && ext != "csv")
+        CV_Error(Error::StsNotImplemented, "Unsupported performance report format: " + filename);
+
+    std::ofstream ofs(filename.c_str());
+    if (!ofs.is_open())
+        CV_Error(Error::StsError, "Failed to open file " + filename);
+
+    if (ext == "csv")
+    {
+        ofs << "id,name,type,implementation,fused,inputs,outputs,flops,weights_bytes,blobs_bytes,"
+               "runs,mean_ms,min_ms,median_ms,p90_ms,p99_ms,max_ms,gflops_per_sec\n";
+        for (size_t i = 0; i < profiles.size(); ++i)
+        {
+            const LayerProfile& p = profiles[i];
+            ofs << p.id << "," << escapeCSV(p.name) << "," << escapeCSV(p.type) << "," << p.implementation << ","
+                << (p.fused ? 1 : 0) << "," << shapesToString(p.inputShapes, ";") << ","
+                << shapesToString(p.outputShapes, ";") << "," << p.flops << ","
+                << p.weightsMemory << "," << p.blobsMemory << "," << p.runs << ","
+                << p.meanMs << "," << p.minMs << "," << p.medianMs << "," << p.p90Ms << ","
+                << p.p99Ms << "," << p.maxMs << "," << p.gflopsPerSec << "\n";
+        }
+        return;
+    }
+
+    ofs << "{\n  \"layers\": [";
+    for (size_t i = 0; i < profiles.size(); ++i)
+    {
+        const LayerProfile& p = profiles[i];
+        ofs << (i > 0 ? "," : "") << "\n    {"
+            << "\"id\": " << p.id
+            << ", \"name\": \"" << escapeJSON(p.name) << "\""
+            << ", \"type\": \"" << escapeJSON(p.type) << "\""
+            << ", \"implementation\": \"" << p.implementation << "\""
+            << ", \"fused\": " << (p.fused ? "true" : "false")
+            << ", \"inputs\": " << shapesToJSON(p.inputShapes)
+            << ", \"outputs\": " << shapesToJSON(p.outputShapes)
+            << ", \"flops\": " << p.flops
+            << ", \"weights_bytes\": " << p.weightsMemory
+            << ", \"blobs_bytes\": " << p.blobsMemory
+            << ", \"runs\": " << p.runs
+            << ", \"mean_ms\": " << p.meanMs
+            << ", \"min_ms\": " << p.minMs
+            << ", \"median_ms\": " << p.medianMs
+            << ", \"p90_ms\": " << p.p90Ms
+            << ", \"p99_ms\": " << p.p99Ms
+            << ", \"max_ms\": " << p.maxMs
+            << ", \"gflops_per_sec\": " << p.gflopsPerSec << "}";
+    }
+    ofs << "\n  ]\n}\n";
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 Layer::Layer() { preferableTarget = DNN_TARGET_CPU; }
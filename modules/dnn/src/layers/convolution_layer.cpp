@@ -191,6 +191,7 @@ public:
     Ptr<ActivationLayer> activ;
     bool newWeightAndBias;
     bool fusedBias;
+    int weightsDepth;
 
 #ifdef HAVE_OPENCL
     Ptr<OCL4DNNConvSpatial<float> > convolutionOp;
@@ -203,6 +204,7 @@ public:
     {
         newWeightAndBias = false;
         fusedBias = false;
+        weightsDepth = getWeightsDepth(params);
 #ifdef HAVE_OPENCL
         newActiv = false;
         activType = OCL4DNN_CONV_FUSED_ACTIV_NONE;
@@ -261,21 +263,7 @@ public:
 
         CV_Assert(!blobs.empty());
         const int outCn = blobs[0].size[0];
-        // prepare weightsMat where each row is aligned and has enough zero padding on the right to
-        // use vectorized (i.e. with intrinsics) loops without tail processing
-        Mat wm = blobs[0].reshape(1, outCn).clone();
-        if( wm.step1() % VEC_ALIGN != 0 )
-        {
-            int newcols = (int)alignSize(wm.step1(), VEC_ALIGN);
-            Mat wm_buffer = Mat(outCn, newcols, wm.type());
-            Mat wm_padding = wm_buffer.colRange(wm.cols, newcols);
-            wm_padding.setTo(Scalar::all(0.));
-            Mat wm_aligned = wm_buffer.colRange(0, wm.cols);
-            wm.copyTo(wm_aligned);
-            wm = wm_aligned;
-        }
-        weightsMat = wm;
-        weightsMultipliers.assign(outCn, 1.0);
+        initWeights(weightsDepth != CV_32F && preferableTarget == DNN_TARGET_CPU);
 
         Mat biasMat = hasBias() ? blobs[1].reshape(1, outCn) : Mat();
         biasvec.resize(outCn+2);
@@ -294,6 +282,73 @@ public:
 #endif
     }
 
+    // Reduced precision weights replace the original blobs[0] and are used by the CPU kernels
+    // in place. Floating point weights are copied to weightsMat where each row is aligned and
+    // has enough zero padding on the right to use vectorized (i.e. with intrinsics) loops
+    // without tail processing.
+    void initWeights(bool compress)
+    {
+        const int outCn = blobs[0].size[0];
+        if (compress && blobs[0].depth() == CV_32F)
+        {
+            Mat compressed;
+            compressWeights(blobs[0], compressed, weightsDepth);
+            blobs[0] = compressed;
+        }
+        else if (!compress && blobs[0].depth() != CV_32F)
+        {
+            Mat expanded;
+            decompressWeights(blobs[0], expanded);
+            blobs[0] = expanded;
+        }
+#ifdef HAVE_OPENCL
+        // don't keep the original floating point weights alive in UMat
+        if (compress)
+            umat_blobs.clear();
+        else if (umat_blobs.empty())
+        {
+            umat_blobs.resize(blobs.size());
+            for (size_t i = 0; i < blobs.size(); i++)
+                umat_blobs[i] = blobs[i].getUMat(ACCESS_READ);
+        }
+#endif
+
+        if (compress)
+            weightsMat = blobs[0].reshape(1, outCn);
+        else
+        {
+            Mat wm = blobs[0].reshape(1, outCn).clone();
+            if( wm.step1() % VEC_ALIGN != 0 )
+            {
+                int newcols = (int)alignSize(wm.step1(), VEC_ALIGN);
+                Mat wm_buffer = Mat(outCn, newcols, wm.type());
+                Mat wm_padding = wm_buffer.colRange(wm.cols, newcols);
+                wm_padding.setTo(Scalar::all(0.));
+                Mat wm_aligned = wm_buffer.colRange(0, wm.cols);
+                wm.copyTo(wm_aligned);
+                wm = wm_aligned;
+            }
+            weightsMat = wm;
+        }
+        weightsMultipliers.assign(outCn, 1.0);
+    }
+
+    // Other backends take floating point weights: expand them and apply fused multipliers again.
+    void restoreWeights()
+    {
+        if (blobs[0].depth() == CV_32F)
+            return;
+        std::vector<double> multipliers = weightsMultipliers;
+        initWeights(false);
+        Mat originWeights = blobs[0].reshape(1, weightsMat.rows);
+        for (int i = 0; i < weightsMat.rows; ++i)
+        {
+            if (multipliers[i] != 1.0)
+                cv::multiply(originWeights.row(i), multipliers[i], weightsMat.row(i));
+        }
+        weightsMultipliers = multipliers;
+    }
+
     bool setActivation(const Ptr<ActivationLayer>& layer) CV_OVERRIDE
     {
         activ = layer;
@@ -352,11 +407,25 @@ public:
         if (!w.empty())
         {
             Mat originWeights = blobs[0].reshape(1, outCn);
+            const bool compressed = weightsMat.depth() != CV_32F;
+            // reduced precision weightsMat shares data with blobs[0] until the first fusion
+            if (compressed && weightsMat.data == originWeights.data)
+                weightsMat = Mat(originWeights.size(), originWeights.type());
+            AutoBuffer<float> rowbuf(compressed ? originWeights.cols : 1);
             for (int i = 0; i < outCn; ++i)
             {
                 double wi = w.at<float>(i);
                 weightsMultipliers[i] *= wi;
-                cv::multiply(originWeights.row(i), weightsMultipliers[i], weightsMat.row(i));
+                if (compressed)
+                {
+                    Mat row(1, originWeights.cols, CV_32F, rowbuf.data());
+                    expandWeights(originWeights, i, 0, row.cols, row.ptr<float>());
+                    row.convertTo(row, CV_32F, weightsMultipliers[i]);
+                    Mat dstRow = weightsMat.row(i);
+                    compressWeights(row, dstRow, weightsMat.depth());
+                }
+                else
+                    cv::multiply(originWeights.row(i), weightsMultipliers[i], weightsMat.row(i));
                 biasvec[i] *= wi;
             }
         }
@@ -375,6 +444,7 @@ public:
     virtual Ptr<BackendNode> initHalide(const std::vector<Ptr<BackendWrapper> > &inputs) CV_OVERRIDE
     {
 #ifdef HAVE_HALIDE
+        restoreWeights();
         Halide::Buffer<float> inputBuffer = halideBuffer(inputs[0]);
 
         const int inpCn = inputBuffer.channels();
@@ -423,6 +493,7 @@ public:
     virtual Ptr<BackendNode> initInfEngine(const std::vector<Ptr<BackendWrapper> > &inputs) CV_OVERRIDE
     {
 #ifdef HAVE_INF_ENGINE
+        restoreWeights();
         InferenceEngine::DataPtr input = infEngineDataNode(inputs[0]);
         CV_Assert(input->dims.size() == 4);
 
@@ -514,7 +585,7 @@ public:
                        weights.rows == output.size[1],
                        weights.cols == (input.size[1]/ngroups)*kernel.width*kernel.height,
                        input.type() == output.type(),
-                       input.type() == weights.type(),
+                       weights.type() == CV_32F || weights.type() == CV_16S || weights.type() == CV_16U,
                        input.type() == CV_32F,
                        input.isContinuous(),
                        output.isContinuous(),
@@ -593,8 +664,14 @@ public:
 
             const float* data_inp0_ = input_->ptr<float>();
             const int* ofstab = &ofstab_[0];
-            const float* wptr_orig_ = weights_->ptr<float>();
-            size_t wstep = weights_->step1();
+            // reduced precision weights are converted to floats by panels
+            // of BLK_SIZE_CN input channels before each of them is used
+            const bool expandW = weights_->depth() != CV_32F;
+            const float* wptr_orig_ = expandW ? 0 : weights_->ptr<float>();
+            size_t wstep = expandW ? alignSize(alignSize(std::min(inpCn, (int)BLK_SIZE_CN)*karea, valign), 16)
+                                   : weights_->step1();
+            AutoBuffer<float> wbuf_(expandW ? outCn*wstep + 16 : 1);
+            float* wbuf = alignPtr(wbuf_.data(), (int)(16*sizeof(float)));
             const float* biasptr_ = &biasvec_->at(0);
             const float* reluptr_ = reluslope_->empty() ? 0 : &reluslope_->at(0);
             float* data_out0_ = output_->ptr<float>();
@@ -623,7 +700,7 @@ public:
                 const float* data_inp0 = data_inp0_ + subsampleIdx*inpPlaneSize*inpCn;
                 float* data_out0 = data_out0_ + subsampleIdx*outPlaneSize*outCn;
                 int startOutCn = (subsampleIdx % ngroups)*outCn;
-                const float* wptr_orig = wptr_orig_ + wstep*startOutCn;
+                const float* wptr_orig = expandW ? 0 : wptr_orig_ + wstep*startOutCn;
                 const float* biasptr = biasptr_ + startOutCn;
 
                 for( int cn0 = 0; cn0 < inpCn; cn0 += BLK_SIZE_CN )
@@ -631,7 +708,19 @@ public:
                     int cn1 = std::min(cn0 + BLK_SIZE_CN, inpCn);
                     int ncn = cn1 - cn0, vsz = karea*ncn;
                     int vsz_a = (int)alignSize(vsz, valign);
-                    const float* wptr = wptr_orig + cn0*karea;
+                    const float* wptr = wbuf;
+                    if( expandW )
+                    {
+                        for( i = 0; i < outCn; i++ )
+                        {
+                            float* wrow = wbuf + i*wstep;
+                            expandWeights(*weights_, startOutCn + i, cn0*karea, vsz, wrow);
+                            for( k = vsz; k < vsz_a; k++ )
+                                wrow[k] = 0.f;
+                        }
+                    }
+                    else
+                        wptr = wptr_orig + cn0*karea;
                     // we apply [Channels][P]ReLU (if any) during the final pass only.
                     const float* relu = cn1 == inpCn && reluptr_ ? reluptr_ + startOutCn : 0;
 
@@ -852,6 +941,183 @@ public:
         }
     };
 
+    // Depthwise convolution (one input and one output channel per group).
+    // im2row is not used here: every output plane is computed directly from the
+    // corresponding input plane, vectorized along the rows and parallelized
+    // across planes and rows.
+    class ParallelDepthwiseConv : public cv::ParallelLoopBody
+    {
+    public:
+        const Mat* input_;
+        const Mat* weights_;
+        Mat* output_;
+        Size kernel_, pad_, stride_, dilation_;
+        int nstripes_;
+        const std::vector<float>* biasvec_;
+        const std::vector<float>* reluslope_;
+        const ActivationLayer* activ_;
+
+        ParallelDepthwiseConv()
+            : input_(0), weights_(0), output_(0), nstripes_(0),
+              biasvec_(0), reluslope_(0), activ_(0)
+        {}
+
+        static bool isApplicable(const Mat& input, const Mat& output, int ngroups)
+        {
+            return ngroups > 1 && input.size[1] == ngroups && output.size[1] == ngroups;
+        }
+
+        static void run( const Mat& input, Mat& output, const Mat& weights,
+                         const std::vector<float>& biasvec,
+                         const std::vector<float>& reluslope,
+                         Size kernel, Size pad, Size stride, Size dilation,
+                         const ActivationLayer* activ, int nstripes )
+        {
+            CV_Assert( input.dims == 4 && output.dims == 4,
+                       input.size[0] == output.size[0],
+                       input.size[1] == output.size[1],
+                       weights.rows == output.size[1],
+                       weights.cols >= kernel.width*kernel.height,
+                       input.type() == CV_32F && output.type() == CV_32F,
+                       weights.type() == CV_32F || weights.type() == CV_16S || weights.type() == CV_16U,
+                       input.isContinuous(),
+                       output.isContinuous(),
+                       biasvec.size() == (size_t)output.size[1]+2);
+            ParallelDepthwiseConv p;
+
+            p.input_ = &input;
+            p.weights_ = &weights;
+            p.output_ = &output;
+            p.kernel_ = kernel; p.pad_ = pad; p.stride_ = stride; p.dilation_ = dilation;
+            p.biasvec_ = &biasvec;
+            p.reluslope_ = &reluslope;
+            p.activ_ = reluslope.empty() ? activ : 0;
+
+            // each stripe processes a range of planes; split planes by rows only
+            // if there are less planes than threads.
+            int nplanes = input.size[0]*input.size[1];
+            p.nstripes_ = std::max(nplanes, std::min(nstripes, nplanes*output.size[2]));
+            parallel_for_(Range(0, p.nstripes_), p, p.nstripes_);
+        }
+
+        virtual void operator ()(const Range &r) const CV_OVERRIDE
+        {
+            const int channels = output_->size[1];
+            const int outH = output_->size[2], outW = output_->size[3];
+            const int height = input_->size[2], width = input_->size[3];
+            const int kernel_h = kernel_.height, kernel_w = kernel_.width;
+            const int pad_h = pad_.height, pad_w = pad_.width;
+            const int stride_h = stride_.height, stride_w = stride_.width;
+            const int dilation_h = dilation_.height, dilation_w = dilation_.width;
+            const int nplanes = input_->size[0]*channels;
+            const size_t inpPlaneSize = (size_t)width*height, outPlaneSize = (size_t)outW*outH;
+            const int stripesPerPlane = nstripes_ / nplanes;
+            const int rowsPerStripe = (outH + stripesPerPlane - 1) / stripesPerPlane;
+            AutoBuffer<float> wbuf(kernel_h*kernel_w);
+
+            // range of output columns where the whole kernel row is inside the input
+            int j0 = std::min((pad_w + stride_w - 1) / stride_w, outW);
+            int j1 = std::max(std::min((width - 1 - (kernel_w - 1)*dilation_w + pad_w) / stride_w + 1, outW), j0);
+            if (width - 1 - (kernel_w - 1)*dilation_w + pad_w < 0)
+                j1 = j0;
+
+            for (int stripe = r.start; stripe < r.end; stripe++)
+            {
+                int plane = stripe / stripesPerPlane;
+                if (plane >= nplanes)
+                    break;
+                int c = plane % channels;
+                int rowStart = (stripe % stripesPerPlane) * rowsPerStripe;
+                int rowEnd = std::min(rowStart + rowsPerStripe, outH);
+                if (rowStart >= rowEnd)
+                    continue;
+
+                const float* inptr = input_->ptr<float>() + plane*inpPlaneSize;
+                float* outptr = output_->ptr<float>() + plane*outPlaneSize;
+                const float* wptr = wbuf.data();
+                if (weights_->depth() == CV_32F)
+                    wptr = weights_->ptr<float>(c);
+                else
+                    expandWeights(*weights_, c, 0, kernel_h*kernel_w, wbuf.data());
+                float bias = biasvec_->at(c);
+                bool relu = !reluslope_->empty();
+                float slope = relu ? reluslope_->at(c) : 1.f;
+
+                for (int out_i = rowStart; out_i < rowEnd; out_i++)
+                {
+                    int in_i = out_i * stride_h - pad_h;
+                    int i0 = std::max(0, (-in_i + dilation_h - 1) / dilation_h);
+                    int i1 = std::min(kernel_h, (height - in_i + dilation_h - 1) / dilation_h);
+                    float* outrow = outptr + out_i*outW;
+
+                    for (int out_j = 0; out_j < outW; out_j++)
+                    {
+                        if (out_j == j0 && j0 < j1)
+                        {
+                            // all the kernel columns are inside the input
+                            int j = j0;
+                        #if CV_SIMD128
+                            if (stride_w == 1)
+                            {
+                                v_float32x4 vbias = v_setall_f32(bias);
+                                for (; j <= j1 - 4; j += 4)
+                                {
+                                    v_float32x4 s = vbias;
+                                    for (int ki = i0; ki < i1; ki++)
+                                    {
+                                        const float* inrow = inptr + (in_i + ki*dilation_h)*width + j - pad_w;
+                                        const float* wrow = wptr + ki*kernel_w;
+                                        for (int kj = 0; kj < kernel_w; kj++)
+                                            s = v_muladd(v_load(inrow + kj*dilation_w), v_setall_f32(wrow[kj]), s);
+                                    }
+                                    v_store(outrow + j, s);
+                                }
+                            }
+                        #endif
+                            for (; j < j1; j++)
+                            {
+                                float s = bias;
+                                for (int ki = i0; ki < i1; ki++)
+                                {
+                                    const float* inrow = inptr + (in_i + ki*dilation_h)*width + j*stride_w - pad_w;
+                                    const float* wrow = wptr + ki*kernel_w;
+                                    for (int kj = 0; kj < kernel_w; kj++)
+                                        s += inrow[kj*dilation_w]*wrow[kj];
+                                }
+                                outrow[j] = s;
+                            }
+                            out_j = j1 - 1;
+                            continue;
+                        }
+
+                        int in_j = out_j * stride_w - pad_w;
+                        int kj0 = std::max(0, (-in_j + dilation_w - 1) / dilation_w);
+                        int kj1 = std::min(kernel_w, (width - in_j + dilation_w - 1) / dilation_w);
+                        float s = bias;
+                        for (int ki = i0; ki < i1; ki++)
+                        {
+                            const float* inrow = inptr + (in_i + ki*dilation_h)*width + in_j;
+                            const float* wrow = wptr + ki*kernel_w;
+                            for (int kj = kj0; kj < kj1; kj++)
+                                s += inrow[kj*dilation_w]*wrow[kj];
+                        }
+                        outrow[out_j] = s;
+                    }
+
+                    if (relu)
+                    {
+                        for (int j = 0; j < outW; j++)
+                            outrow[j] = outrow[j] > 0.f ? outrow[j] : outrow[j]*slope;
+                    }
+                }
+
+                if (activ_)
+                    activ_->forwardSlice(outptr + rowStart*outW, outptr + rowStart*outW,
+                                         (rowEnd - rowStart)*outW, outPlaneSize, c, c + 1);
+            }
+        }
+    };
+
 #ifdef HAVE_OPENCL
     bool forward_ocl(InputArrayOfArrays inps, OutputArrayOfArrays outs, OutputArrayOfArrays internals)
     {
@@ -1027,8 +1293,12 @@ public:
 
         int nstripes = std::max(getNumThreads(), 1);
 
-        ParallelConv::run(*inputs[0], outputs[0], weightsMat, biasvec, reluslope,
-                          kernel, pad, stride, dilation, activ.get(), ngroups, nstripes);
+        if (ParallelDepthwiseConv::isApplicable(*inputs[0], outputs[0], ngroups))
+            ParallelDepthwiseConv::run(*inputs[0], outputs[0], weightsMat, biasvec, reluslope,
+                                       kernel, pad, stride, dilation, activ.get(), nstripes);
+        else
+            ParallelConv::run(*inputs[0], outputs[0], weightsMat, biasvec, reluslope,
+                              kernel, pad, stride, dilation, activ.get(), ngroups, nstripes);
     }
 
     virtual int64 getFLOPS(const std::vector<MatShape> &inputs,
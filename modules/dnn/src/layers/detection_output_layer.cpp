@@ -442,6 +442,11 @@ public:
             // Retrieve all confidences
             GetConfidenceScores(confidenceData, num, numPriors, _numClasses, allConfidenceScores);
 
+            // Only the boxes which may pass score threshold and top_k filtering are decoded
+            std::vector<std::vector<uchar> > decodeMasks(num);
+            for (int i = 0; i < num; ++i)
+                GetCandidatesMask(allConfidenceScores[i], decodeMasks[i]);
+
             // Retrieve all prior bboxes
             std::vector<util::NormalizedBBox> priorBBoxes;
             std::vector<std::vector<float> > priorVariances;
@@ -466,7 +471,7 @@ public:
             DecodeBBoxesAll(allLocationPredictions, priorBBoxes, priorVariances, num,
                             _shareLocation, _numLocClasses, _backgroundLabelId,
                             _codeType, _varianceEncodedInTarget, _clip, clipBounds,
-                            _bboxesNormalized, allDecodedBBoxes);
+                            _bboxesNormalized, allDecodedBBoxes, decodeMasks);
         }
 
         size_t numKept = 0;
@@ -532,6 +537,83 @@ public:
         return count;
     }
 
+    // Marks priors which have a score higher than confidence threshold and
+    // are in top_k of at least one class.
+    void GetCandidatesMask(const Mat& confidenceScores, std::vector<uchar>& mask) const
+    {
+        const int numPriors = confidenceScores.cols;
+        mask.assign(numPriors, 0);
+        std::vector<float> candidates;
+        for (int c = 0; c < std::min((int)_numClasses, confidenceScores.rows); ++c)
+        {
+            if (c == _backgroundLabelId)
+                continue;
+            const float* scores = confidenceScores.ptr<float>(c);
+            candidates.clear();
+            for (int p = 0; p < numPriors; ++p)
+            {
+                if (scores[p] > _confidenceThreshold)
+                    candidates.push_back(scores[p]);
+            }
+            float minScore = _confidenceThreshold;
+            if (_topK > 0 && _topK < (int)candidates.size())
+            {
+                std::nth_element(candidates.begin(), candidates.begin() + _topK - 1, candidates.end(),
+                                 std::greater<float>());
+                minScore = candidates[_topK - 1];
+                for (int p = 0; p < numPriors; ++p)
+                    mask[p] |= scores[p] >= minScore;
+            }
+            else
+            {
+                for (int p = 0; p < numPriors; ++p)
+                    mask[p] |= scores[p] > minScore;
+            }
+        }
+    }
+
+    // Boxes of a single location label as a structure of arrays for NMSFastSoA_.
+    void BBoxesToSoA(const std::vector<util::NormalizedBBox>& bboxes, BoxesSoA& boxes) const
+    {
+        boxes.resize(bboxes.size());
+        for (size_t i = 0; i < bboxes.size(); ++i)
+        {
+            const util::NormalizedBBox& b = bboxes[i];
+            boxes.set(i, b.xmin, b.ymin, b.xmax, b.ymax, BBoxSize(b, _bboxesNormalized));
+        }
+    }
+
+    class NMSInvoker : public ParallelLoopBody
+    {
+    public:
+        NMSInvoker(const DetectionOutputLayerImpl& layer, const std::vector<int>& labels,
+                   const std::map<int, BoxesSoA>& boxes, const Mat& confidenceScores,
+                   std::vector<std::vector<int>*>& indices)
+            : layer_(layer), labels_(labels), boxes_(boxes),
+              confidenceScores_(confidenceScores), indices_(indices)
+        {}
+
+        void operator()(const Range& r) const CV_OVERRIDE
+        {
+            for (int i = r.start; i < r.end; ++i)
+            {
+                int c = labels_[i];
+                const std::vector<float> scores = confidenceScores_.row(c);
+                const BoxesSoA& boxes = boxes_.find(layer_._shareLocation ? -1 : c)->second;
+                // see JaccardOverlap
+                NMSFastSoA_(boxes, scores, layer_._confidenceThreshold, layer_._nmsThreshold, 1.0, layer_._topK,
+                            *indices_[i], layer_._bboxesNormalized ? 0.f : 1.f, 0.f);
+            }
+        }
+
+    private:
+        const DetectionOutputLayerImpl& layer_;
+        const std::vector<int>& labels_;
+        const std::map<int, BoxesSoA>& boxes_;
+        const Mat& confidenceScores_;
+        std::vector<std::vector<int>*>& indices_;
+    };
+
     size_t processDetections_(
             const LabelBBox& decodeBBoxes, Mat& confidenceScores,
             std::vector<std::map<int, std::vector<int> > >& allIndices
@@ -539,6 +621,9 @@ public:
     {
         std::map<int, std::vector<int> > indices;
         size_t numDetections = 0;
+        std::vector<int> labels;
+        std::vector<std::vector<int>*> labelIndices;
+        std::map<int, BoxesSoA> boxes;
         for (int c = 0; c < (int)_numClasses; ++c)
         {
             if (c == _backgroundLabelId)
@@ -546,20 +631,23 @@ public:
             if (c >= confidenceScores.rows)
                 CV_Error_(cv::Error::StsError, ("Could not find confidence predictions for label %d", c));
 
-            const std::vector<float> scores = confidenceScores.row(c);
             int label = _shareLocation ? -1 : c;
 
             LabelBBox::const_iterator label_bboxes = decodeBBoxes.find(label);
             if (label_bboxes == decodeBBoxes.end())
                 CV_Error_(cv::Error::StsError, ("Could not find location predictions for label %d", label));
-            if (_bboxesNormalized)
-                NMSFast_(label_bboxes->second, scores, _confidenceThreshold, _nmsThreshold, 1.0, _topK,
-                         indices[c], util::caffe_norm_box_overlap);
-            else
-                NMSFast_(label_bboxes->second, scores, _confidenceThreshold, _nmsThreshold, 1.0, _topK,
-                         indices[c], util::caffe_box_overlap);
-            numDetections += indices[c].size();
+            if (boxes.find(label) == boxes.end())
+                BBoxesToSoA(label_bboxes->second, boxes[label]);
+            labels.push_back(c);
+            labelIndices.push_back(&indices[c]);
         }
+
+        // Classes are processed independently
+        parallel_for_(Range(0, (int)labels.size()),
+                      NMSInvoker(*this, labels, boxes, confidenceScores, labelIndices));
+        for (size_t i = 0; i < labelIndices.size(); ++i)
+            numDetections += labelIndices[i]->size();
+
         if (_keepTopK > -1 && numDetections > (size_t)_keepTopK)
         {
             std::vector<std::pair<float, std::pair<int, int> > > scoreIndexPairs;
@@ -703,26 +791,29 @@ public:
         const cv::String& code_type, const bool variance_encoded_in_target,
         const bool clip_bbox, const util::NormalizedBBox& clip_bounds,
         const bool normalized_bbox, const std::vector<util::NormalizedBBox>& bboxes,
-        std::vector<util::NormalizedBBox>& decode_bboxes)
+        std::vector<util::NormalizedBBox>& decode_bboxes, const std::vector<uchar>& mask)
     {
         CV_Assert(prior_bboxes.size() == prior_variances.size());
         CV_Assert(prior_bboxes.size() == bboxes.size());
         size_t num_bboxes = prior_bboxes.size();
         CV_Assert(num_bboxes == 0 || prior_variances[0].size() == 4);
+        CV_Assert(mask.empty() || mask.size() == num_bboxes);
         decode_bboxes.clear(); decode_bboxes.resize(num_bboxes);
         if(variance_encoded_in_target)
         {
             for (int i = 0; i < num_bboxes; ++i)
-                DecodeBBox<true>(prior_bboxes[i], prior_variances[i], code_type,
-                                 clip_bbox, clip_bounds, normalized_bbox,
-                                 bboxes[i], decode_bboxes[i]);
+                if (mask.empty() || mask[i])
+                    DecodeBBox<true>(prior_bboxes[i], prior_variances[i], code_type,
+                                     clip_bbox, clip_bounds, normalized_bbox,
+                                     bboxes[i], decode_bboxes[i]);
         }
         else
         {
             for (int i = 0; i < num_bboxes; ++i)
-                DecodeBBox<false>(prior_bboxes[i], prior_variances[i], code_type,
-                                  clip_bbox, clip_bounds, normalized_bbox,
-                                  bboxes[i], decode_bboxes[i]);
+                if (mask.empty() || mask[i])
+                    DecodeBBox<false>(prior_bboxes[i], prior_variances[i], code_type,
+                                      clip_bbox, clip_bounds, normalized_bbox,
+                                      bboxes[i], decode_bboxes[i]);
         }
     }
 
@@ -734,9 +825,10 @@ public:
         const int num_loc_classes, const int background_label_id,
         const cv::String& code_type, const bool variance_encoded_in_target,
         const bool clip, const util::NormalizedBBox& clip_bounds,
-        const bool normalized_bbox, std::vector<LabelBBox>& all_decode_bboxes)
+        const bool normalized_bbox, std::vector<LabelBBox>& all_decode_bboxes,
+        const std::vector<std::vector<uchar> >& decode_masks)
     {
-        CV_Assert(all_loc_preds.size() == num);
+        CV_Assert(all_loc_preds.size() == num, decode_masks.size() == num);
         all_decode_bboxes.clear();
         all_decode_bboxes.resize(num);
         for (int i = 0; i < num; ++i)
@@ -754,7 +846,8 @@ public:
                     CV_Error_(cv::Error::StsError, ("Could not find location predictions for label %d", label));
                 DecodeBBoxes(prior_bboxes, prior_variances,
                              code_type, variance_encoded_in_target, clip, clip_bounds,
-                             normalized_bbox, label_loc_preds->second, decode_bboxes[label]);
+                             normalized_bbox, label_loc_preds->second, decode_bboxes[label],
+                             decode_masks[i]);
             }
         }
     }
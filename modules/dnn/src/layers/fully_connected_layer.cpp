@@ -80,9 +80,36 @@ public:
         CV_Assert(blobs[0].dims >= 2 && (size_t)(innerSize * numOutput) == blobs[0].total());
         CV_Assert(!bias || (blobs.size() == 2 && (size_t)numOutput == blobs[1].total()));
 
-        weightsMat = blobs[0] = blobs[0].reshape(1, numOutput);
+        blobs[0] = blobs[0].reshape(1, numOutput);
+        if (bias)
+            biasMat = blobs[1] = blobs[1].reshape(1, 1);
+        else
+            biasMat = Mat::zeros(1, numOutput, CV_32F);
+
+        weightsDepth = getWeightsDepth(params);
+        initWeights(false);
+    }
+
+    // Reduced precision weights replace the original blobs[0] and are used by the CPU kernel
+    // in place. Floating point weights rows are padded with zeros to VEC_ALIGN.
+    void initWeights(bool compress)
+    {
+        if (compress && blobs[0].depth() == CV_32F)
+        {
+            Mat compressed;
+            compressWeights(blobs[0], compressed, weightsDepth);
+            blobs[0] = compressed;
+        }
+        else if (!compress && blobs[0].depth() != CV_32F)
+        {
+            Mat expanded;
+            decompressWeights(blobs[0], expanded);
+            blobs[0] = expanded;
+        }
+
+        weightsMat = blobs[0];
         int vecsize = weightsMat.cols;
-        if( vecsize % VEC_ALIGN != 0 )
+        if( !compress && vecsize % VEC_ALIGN != 0 )
         {
             int vecsize_aligned = (int)alignSize(vecsize, VEC_ALIGN);
             Mat weightsBuf(weightsMat.rows, vecsize_aligned, weightsMat.type());
@@ -92,15 +119,16 @@ public:
             blobs[0].copyTo(weightsMat);
         }
 
-        if (bias)
-            biasMat = blobs[1] = blobs[1].reshape(1, 1);
-        else
-            biasMat = Mat::zeros(1, numOutput, weightsMat.type());
-
 #ifdef HAVE_OPENCL
-        size_t n = blobs.size();
-        umat_blobs.resize(n);
-        for (int i = 0; i < n; i++) umat_blobs[i] = blobs[i].getUMat(ACCESS_READ);
+        // don't keep the original floating point weights alive in UMat
+        umat_blobs.clear();
+        half_blobs.clear();
+        if (!compress)
+        {
+            size_t n = blobs.size();
+            umat_blobs.resize(n);
+            for (int i = 0; i < n; i++) umat_blobs[i] = blobs[i].getUMat(ACCESS_READ);
+        }
 #endif
     }
 
@@ -142,6 +170,8 @@ public:
     class FullyConnected : public ParallelLoopBody
     {
     public:
+        enum { BLK_SIZE = 64 };
+
         FullyConnected() : srcMat(0), weights(0), biasMat(0), activ(0), dstMat(0), nstripes(0), useAVX(false), useAVX2(false), useAVX512(false) {}
 
         static void run(const Mat& srcMat, const Mat& weights, const Mat& biasMat,
@@ -149,8 +179,8 @@ public:
         {
             CV_Assert( srcMat.dims == 2 && srcMat.cols == weights.cols &&
                        dstMat.rows == srcMat.rows && dstMat.cols == weights.rows &&
-                       srcMat.type() == weights.type() && weights.type() == dstMat.type() &&
-                       srcMat.type() == CV_32F &&
+                       srcMat.type() == dstMat.type() && srcMat.type() == CV_32F &&
+                       (weights.type() == CV_32F || weights.type() == CV_16S || weights.type() == CV_16U) &&
                        (biasMat.empty() || (biasMat.type() == srcMat.type() &&
                                            biasMat.isContinuous() && (int)biasMat.total() == dstMat.cols)) );
 
@@ -180,23 +210,38 @@ public:
             size_t stripeSize = (total + nstripes - 1)/nstripes;
             size_t stripeStart = r.start*stripeSize;
             size_t stripeEnd = r.end == nstripes ? total : std::min(r.end*stripeSize, total);
-            size_t wstep = weights->step1();
             AutoBuffer<float> srcbuf(vecsize_aligned + valign);
             float* sptr = alignPtr(srcbuf.data(), (int)(valign*sizeof(float)));
 
+            // reduced precision weights are converted to floats by blocks of BLK_SIZE rows
+            const bool expandW = weights->depth() != CV_32F;
+            size_t wstep = expandW ? alignSize(vecsize_aligned, 16) : weights->step1();
+            AutoBuffer<float> wbuf_(expandW ? BLK_SIZE*wstep + 16 : 1);
+            float* wbuf = alignPtr(wbuf_.data(), (int)(16*sizeof(float)));
+
             for( k = vecsize; k < vecsize_aligned; k++ )
                 sptr[k] = 0.f;
+            for( int i = 0; expandW && i < BLK_SIZE; i++ )
+                for( k = vecsize; k < vecsize_aligned; k++ )
+                    wbuf[i*wstep + k] = 0.f;
 
             for( size_t ofs = stripeStart; ofs < stripeEnd; )
             {
                 int sampleIdx = (int)(ofs / nw0);
                 int delta = (int)(ofs - (size_t)sampleIdx*nw0);
                 const float* sptr_ = srcMat->ptr<float>(sampleIdx);
-                const float* wptr = weights->ptr<float>(delta);
+                const float* wptr = expandW ? wbuf : weights->ptr<float>(delta);
                 float* dptr = dstMat->ptr<float>(sampleIdx) + delta;
                 const float* biasptr = biasMat->ptr<float>() + delta;
                 int nw = std::min(nw0 - delta, (int)(stripeEnd - ofs));
 
+                if( expandW )
+                {
+                    nw = std::min(nw, (int)BLK_SIZE);
+                    for( int i = 0; i < nw; i++ )
+                        expandWeights(*weights, delta + i, 0, vecsize, wbuf + i*wstep);
+                }
+
                 memcpy(sptr, sptr_, vecsize*sizeof(sptr[0]));
 
             #if CV_TRY_AVX512_SKX
@@ -267,12 +312,17 @@ public:
         bool useAVX512;
     };
 
-#ifdef HAVE_OPENCL
-    void finalize(const std::vector<Mat*> &inputs, std::vector<Mat> &outputs) CV_OVERRIDE
+    void finalize(const std::vector<Mat*>&, std::vector<Mat>&) CV_OVERRIDE
     {
+        if (weightsDepth != CV_32F || blobs[0].depth() != CV_32F)
+            initWeights(weightsDepth != CV_32F && preferableTarget == DNN_TARGET_CPU);
+#ifdef HAVE_OPENCL
         innerProductOp.release();
+#endif
     }
 
+#ifdef HAVE_OPENCL
+
     bool forward_ocl(InputArrayOfArrays inps, OutputArrayOfArrays outs, InputArrayOfArrays internals)
     {
         std::vector<UMat> inputs;
@@ -396,6 +446,8 @@ public:
     virtual Ptr<BackendNode> initHalide(const std::vector<Ptr<BackendWrapper> > &inputs) CV_OVERRIDE
     {
 #ifdef HAVE_HALIDE
+        if (blobs[0].depth() != CV_32F)
+            initWeights(false);
         int inW, inH, inC, inN, outC = blobs[0].size[0];
         Halide::Buffer<float> inputBuffer = halideBuffer(inputs[0]);
         getCanonicalSize(inputBuffer, &inW, &inH, &inC, &inN);
@@ -420,6 +472,8 @@ public:
     virtual Ptr<BackendNode> initInfEngine(const std::vector<Ptr<BackendWrapper> >&) CV_OVERRIDE
     {
 #ifdef HAVE_INF_ENGINE
+        if (blobs[0].depth() != CV_32F)
+            initWeights(false);
         InferenceEngine::LayerParams lp;
         lp.name = name;
         lp.type = "FullyConnected";
@@ -452,6 +506,7 @@ public:
     }
 
     bool bias;
+    int weightsDepth;
     Mat weightsMat, biasMat;
     Ptr<ActivationLayer> activ;
 };
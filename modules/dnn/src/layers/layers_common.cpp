@@ -42,6 +42,9 @@
 
 #include "../precomp.hpp"
 #include "layers_common.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utils/configuration.private.hpp>
+#include <opencv2/core/utils/logger.hpp>
 
 namespace cv
 {
@@ -217,5 +220,96 @@ void getConvPoolPaddings(const Size& inp, const Size& out,
     }
 }
 
+String getFastKernelsDispatchName()
+{
+#if CV_TRY_AVX512_SKX
+    if (CV_CPU_HAS_SUPPORT_AVX512_SKX)
+        return "AVX512_SKX";
+#endif
+#if CV_TRY_AVX2
+    if (checkHardwareSupport(CPU_AVX2))
+        return "AVX2";
+#endif
+#if CV_TRY_AVX
+    if (checkHardwareSupport(CPU_AVX))
+        return "AVX";
+#endif
+    return "baseline";
+}
+
+int getWeightsDepth(const LayerParams& params)
+{
+    String precision = params.get<String>("weights_precision",
+            utils::getConfigurationParameterString("OPENCV_DNN_CPU_WEIGHTS_PRECISION", "FP32"));
+    if (precision == "FP16")
+        return CV_16S;
+    if (precision == "BF16")
+        return CV_16U;
+    if (precision != "FP32")
+        CV_LOG_WARNING(NULL, "DNN: unknown weights precision '" << precision << "' of layer '"
+                             << params.name << "', using FP32.");
+    return CV_32F;
+}
+
+void compressWeights(const Mat& src, Mat& dst, int depth)
+{
+    CV_Assert(src.type() == CV_32F, src.dims == 2 || src.isContinuous());
+    Mat src2d = src.dims == 2 ? src : src.reshape(1, src.size[0]);
+    dst.create(src.dims, src.size.p, depth);
+    Mat dst2d = dst.dims == 2 ? dst : dst.reshape(1, src2d.rows);
+    if (depth == CV_16S)
+    {
+        convertFp16(src2d, dst2d);
+        return;
+    }
+    CV_Assert(depth == CV_16U);
+    for (int i = 0; i < src2d.rows; ++i)
+    {
+        const unsigned* srcptr = src2d.ptr<unsigned>(i);
+        ushort* dstptr = dst2d.ptr<ushort>(i);
+        for (int j = 0; j < src2d.cols; ++j)
+        {
+            // round to nearest even
+            unsigned v = srcptr[j];
+            dstptr[j] = (ushort)((v + 0x7fff + ((v >> 16) & 1)) >> 16);
+        }
+    }
+}
+
+void decompressWeights(const Mat& src, Mat& dst)
+{
+    CV_Assert(src.dims == 2 || src.isContinuous());
+    Mat src2d = src.dims == 2 ? src : src.reshape(1, src.size[0]);
+    dst.create(src.dims, src.size.p, CV_32F);
+    Mat dst2d = dst.dims == 2 ? dst : dst.reshape(1, src2d.rows);
+    for (int i = 0; i < src2d.rows; ++i)
+        expandWeights(src2d, i, 0, src2d.cols, dst2d.ptr<float>(i));
+}
+
+void expandWeights(const Mat& weights, int row, int col, int n, float* dst)
+{
+    if (weights.depth() == CV_16S)
+    {
+        Mat dstMat(1, n, CV_32F, dst);
+        convertFp16(Mat(1, n, CV_16S, (void*)weights.ptr<short>(row, col)), dstMat);
+        return;
+    }
+    CV_Assert(weights.depth() == CV_16U);
+    const ushort* src = weights.ptr<ushort>(row, col);
+    unsigned* dst32 = (unsigned*)dst;
+    int i = 0;
+#if CV_SIMD128
+    for (; i <= n - 8; i += 8)
+    {
+        v_uint32x4 lo, hi;
+        v_expand(v_load(src + i), lo, hi);
+        v_store(dst32 + i, lo << 16);
+        v_store(dst32 + i + 4, hi << 16);
+    }
+#endif
+    for (; i < n; ++i)
+        dst32[i] = (unsigned)src[i] << 16;
+}
+
 }
 }
@@ -44,6 +44,7 @@
 #define __OPENCV_DNN_LAYERS_LAYERS_COMMON_HPP__
 #include <opencv2/dnn.hpp>
 #include <opencv2/dnn/shape_utils.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 
 #define CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
 // dispatched AVX/AVX2 optimizations
@@ -74,6 +75,83 @@ void getConvPoolPaddings(const Size& inp, const Size& out,
                          const Size &kernel, const Size &stride,
                          const String &padMode, const Size &dilation, Size &pad);
 
+// Returns name of instruction set used by dispatched fastConv/fastGEMM kernels.
+String getFastKernelsDispatchName();
+
+// Depth of weights kept by CPU implementations of Convolution and InnerProduct layers:
+// CV_32F (default), CV_16S for half precision or CV_16U for bfloat16. Set by the layer's
+// "weights_precision" parameter or OPENCV_DNN_CPU_WEIGHTS_PRECISION, both FP32|FP16|BF16.
+int getWeightsDepth(const LayerParams& params);
+
+// Converts CV_32F weights to the reduced precision depth (CV_16S or CV_16U) keeping the shape.
+void compressWeights(const Mat& src, Mat& dst, int depth);
+
+// Converts reduced precision weights back to CV_32F keeping the shape.
+void decompressWeights(const Mat& src, Mat& dst);
+
+// Converts n values of reduced precision weights row starting from column col to floats.
+void expandWeights(const Mat& weights, int row, int col, int n, float* dst);
+
+#if CV_SIMD128
+// Vectorized exp and log with relative error about 1e-7 (polynomial approximations
+// from Cephes library). Inputs of exp are clamped to [-88.37, 88.37], log of
+// non-positive values is undefined.
+static inline v_float32x4 v_fastExp(const v_float32x4& x_)
+{
+    const v_float32x4 c1 = v_setall_f32(0.693359375f), c2 = v_setall_f32(-2.12194440e-4f);
+    v_float32x4 x = v_min(v_max(x_, v_setall_f32(-88.3762626647949f)), v_setall_f32(88.3762626647949f));
+
+    v_int32x4 n = v_floor(v_muladd(x, v_setall_f32(1.44269504088896341f), v_setall_f32(0.5f)));
+    v_float32x4 fn = v_cvt_f32(n);
+    x = x - fn * c1 - fn * c2;
+
+    v_float32x4 z = x * x;
+    v_float32x4 y = v_setall_f32(1.9875691500E-4f);
+    y = v_muladd(y, x, v_setall_f32(1.3981999507E-3f));
+    y = v_muladd(y, x, v_setall_f32(8.3334519073E-3f));
+    y = v_muladd(y, x, v_setall_f32(4.1665795894E-2f));
+    y = v_muladd(y, x, v_setall_f32(1.6666665459E-1f));
+    y = v_muladd(y, x, v_setall_f32(5.0000001201E-1f));
+    y = v_muladd(y, z, x) + v_setall_f32(1.f);
+
+    // 2^n
+    v_float32x4 pow2n = v_reinterpret_as_f32((n + v_setall_s32(127)) << 23);
+    return y * pow2n;
+}
+
+static inline v_float32x4 v_fastLog(const v_float32x4& x_)
+{
+    const v_float32x4 one = v_setall_f32(1.f);
+    v_int32x4 bits = v_reinterpret_as_s32(x_);
+
+    // x = m * 2^e, m in [0.5, 1)
+    v_int32x4 e = (bits >> 23) - v_setall_s32(126);
+    v_float32x4 m = v_reinterpret_as_f32((bits & v_setall_s32(0x007fffff)) | v_setall_s32(0x3f000000));
+    v_float32x4 fe = v_cvt_f32(e);
+
+    // m in [sqrt(0.5), sqrt(2))
+    v_float32x4 mask = m < v_setall_f32(0.707106781186547524f);
+    fe = fe - (one & mask);
+    v_float32x4 x = m + (m & mask) - one;
+
+    v_float32x4 z = x * x;
+    v_float32x4 y = v_setall_f32(7.0376836292E-2f);
+    y = v_muladd(y, x, v_setall_f32(-1.1514610310E-1f));
+    y = v_muladd(y, x, v_setall_f32(1.1676998740E-1f));
+    y = v_muladd(y, x, v_setall_f32(-1.2420140846E-1f));
+    y = v_muladd(y, x, v_setall_f32(1.4249322787E-1f));
+    y = v_muladd(y, x, v_setall_f32(-1.6668057665E-1f));
+    y = v_muladd(y, x, v_setall_f32(2.0000714765E-1f));
+    y = v_muladd(y, x, v_setall_f32(-2.4999993993E-1f));
+    y = v_muladd(y, x, v_setall_f32(3.3333331174E-1f));
+    y = y * x * z;
+
+    y = v_muladd(fe, v_setall_f32(-2.12194440e-4f), y);
+    y = v_muladd(z, v_setall_f32(-0.5f), y);
+    return x + y + fe * v_setall_f32(0.693359375f);
+}
+#endif
+
 }
 }
 
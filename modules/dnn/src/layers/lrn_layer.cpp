@@ -187,67 +187,95 @@ public:
     class ChannelLRN : public ParallelLoopBody
     {
     public:
+        enum { BLOCK_SIZE = 64 };
+
         ChannelLRN(const float* src, float* dst, int channels, int ksize,
                    float alpha1, float bias1, float beta1,
-                   size_t planeSize, int nsamples, int nstripes)
+                   size_t planeSize, int nsamples)
         {
             src_ = src; dst_ = dst;
             channels_ = channels;
             ksize_ = ksize;
             alpha1_ = alpha1; bias1_ = bias1; beta1_ = beta1;
-            planeSize_ = planeSize; nsamples_ = nsamples; nstripes_ = nstripes;
+            planeSize_ = planeSize; nsamples_ = nsamples;
+            nblocks_ = (planeSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
         }
 
+        // Every item is a block of BLOCK_SIZE spatial positions of one sample. Sums of squares
+        // over the sliding window of channels are computed for all positions of the block at once.
         void operator()(const Range& r) const CV_OVERRIDE
         {
-            int nsamples = nsamples_, nstripes = nstripes_;
-            size_t planeSize = planeSize_, planeSize_n = planeSize * nsamples;
-            size_t elemsPerStripe = (planeSize_n + nstripes - 1)/nstripes;
-            size_t rstart = r.start*elemsPerStripe;
-            size_t rend = r.end == nstripes ? planeSize_n : r.end*elemsPerStripe;
-            rstart = std::min(rstart, planeSize_n);
-            rend = std::min(rend, planeSize_n);
-            float alpha1 = alpha1_, bias1 = bias1_, beta1 = beta1_;
-            int k, channels = channels_, ksize = ksize_;
-
-            AutoBuffer<float> buf_((channels + ksize + 1)*2);
-            float* acc = buf_.data();
-            float* buf = acc + channels + ksize + 1;
-            for( k = 0; k <= ksize; k++ )
-                buf[-k-1] = buf[channels + k] = 0.f;
-
-            for( size_t ofs = rstart; ofs < rend; )
+            const int channels = channels_, ksize = ksize_;
+            const float alpha1 = alpha1_, bias1 = bias1_, beta1 = beta1_;
+            const size_t planeSize = planeSize_;
+
+            // Squares of inputs are kept because output may share memory with input.
+            AutoBuffer<float> buf_((channels + 1) * BLOCK_SIZE);
+            float* sum = buf_.data();
+            float* sqr = sum + BLOCK_SIZE;
+
+            for (int item = r.start; item < r.end; item++)
             {
-                int sampleIdx = (int)(ofs/planeSize);
-                if( sampleIdx >= nsamples )
-                    break;
-                size_t ofs0 = ofs - sampleIdx*planeSize;
-                size_t ofs1 = std::min(planeSize - ofs0, rend - ofs) + ofs;
-                const float* src = src_ + sampleIdx*planeSize*channels + ofs0;
-                float* dst = dst_ + sampleIdx*planeSize*channels + ofs0;
+                int sampleIdx = (int)(item / nblocks_);
+                size_t ofs0 = (item % nblocks_) * BLOCK_SIZE;
+                int len = (int)std::min((size_t)BLOCK_SIZE, planeSize - ofs0);
+                const float* src = src_ + sampleIdx * planeSize * channels + ofs0;
+                float* dst = dst_ + sampleIdx * planeSize * channels + ofs0;
+                int i, k;
+
+                for (k = 0; k < channels; k++)
+                {
+                    const float* srcPtr = src + k * planeSize;
+                    float* sqrPtr = sqr + k * BLOCK_SIZE;
+                    for (i = 0; i < len; i++)
+                        sqrPtr[i] = srcPtr[i] * srcPtr[i];
+                }
 
-                for( ; ofs < ofs1; ofs++, src++, dst++ )
+                memset(sum, 0, len * sizeof(float));
+                for (k = 0; k < std::min(ksize, channels); k++)
                 {
-                    for( k = 0; k < channels; k++ )
-                        buf[k] = src[k*planeSize];
-                    float s = 0;
-                    for( k = 0; k < ksize; k++ )
-                        s += buf[k]*buf[k];
-                    for( k = 0; k < channels; k++ )
+                    const float* sqrPtr = sqr + k * BLOCK_SIZE;
+                    for (i = 0; i < len; i++)
+                        sum[i] += sqrPtr[i];
+                }
+
+                for (k = 0; k < channels; k++)
+                {
+                    // window of channels [k - ksize, k + ksize]
+                    const float* sqrAdd = k + ksize < channels ? sqr + (k + ksize) * BLOCK_SIZE : 0;
+                    const float* sqrSub = k - ksize - 1 >= 0 ? sqr + (k - ksize - 1) * BLOCK_SIZE : 0;
+                    const float* srcPtr = src + k * planeSize;
+                    float* dstPtr = dst + k * planeSize;
+
+                    i = 0;
+#if CV_SIMD128
+                    const v_float32x4 valpha = v_setall_f32(alpha1), vbias = v_setall_f32(bias1),
+                                      vbeta = v_setall_f32(beta1), vzero = v_setzero_f32();
+                    for (; i + 4 <= len; i += 4)
                     {
-                        float x1 = buf[k + ksize];
-                        float x0 = buf[k - ksize - 1];
-                        s = std::max(s + (x1 + x0)*(x1 - x0), 0.f);
-                        acc[k] = (float)(alpha1*s + bias1);
+                        v_float32x4 s = v_load(sum + i);
+                        if (sqrAdd)
+                            s += v_load(sqrAdd + i);
+                        if (sqrSub)
+                            s -= v_load(sqrSub + i);
+                        s = v_max(s, vzero);
+                        v_store(sum + i, s);
+                        // x * (alpha * s + bias)^beta, beta < 0
+                        v_float32x4 scale = v_fastExp(vbeta * v_fastLog(v_muladd(valpha, s, vbias)));
+                        v_store(dstPtr + i, v_load(srcPtr + i) * scale);
+                    }
+#endif
+                    for (; i < len; i++)
+                    {
+                        float s = sum[i];
+                        if (sqrAdd)
+                            s += sqrAdd[i];
+                        if (sqrSub)
+                            s -= sqrSub[i];
+                        s = std::max(s, 0.f);
+                        sum[i] = s;
+                        dstPtr[i] = srcPtr[i] * std::pow(alpha1 * s + bias1, beta1);
                     }
-
-                    hal::log32f(acc, acc, channels);
-                    for( k = 0; k < channels; k++ )
-                        acc[k] *= beta1;
-                    hal::exp32f(acc, acc, channels);
-
-                    for( k = 0; k < channels; k++ )
-                        dst[k*planeSize] = buf[k]*acc[k];
                 }
             }
         }
@@ -255,8 +283,8 @@ public:
         const float* src_;
         float* dst_;
         float alpha1_, bias1_, beta1_;
-        size_t planeSize_;
-        int channels_, ksize_, nsamples_, nstripes_;
+        size_t planeSize_, nblocks_;
+        int channels_, ksize_, nsamples_;
     };
 
     void channelNormalization(Mat &srcBlob, Mat &dstBlob)
@@ -267,42 +295,50 @@ public:
         int sizeNormFactor = normBySize ? size : 1;
         size_t planeSize = srcBlob.size[2]*srcBlob.size[3];
 
-        int nstripes = std::max(getNumThreads(), 1);
-
         ChannelLRN clrn(srcBlob.ptr<float>(), dstBlob.ptr<float>(), channels,
-                        ksize, alpha/sizeNormFactor, bias, -beta, planeSize, num, nstripes);
-        parallel_for_(Range(0, nstripes), clrn, nstripes);
+                        ksize, alpha/sizeNormFactor, bias, -beta, planeSize, num);
+        int numItems = (int)(num * clrn.nblocks_);
+        parallel_for_(Range(0, numItems), clrn, std::min(numItems, getNumThreads() * 4));
     }
 
-    void sqrBoxFilter_(const Mat &src, Mat &dst)
+    void sqrBoxFilter_(const Mat &src, Mat &dst) const
     {
         Mat srcRawWrapper(src.rows, src.cols, src.type(), src.data, src.step[0]);
         cv::sqrBoxFilter(srcRawWrapper, dst, dst.depth(), Size(size, size), Point(-1, -1), false, BORDER_CONSTANT);
     }
 
-    void spatialNormalization(Mat &srcBlob, Mat &dstBlob)
+    class SpatialLRN : public ParallelLoopBody
     {
-        int num = srcBlob.size[0];
-        int channels = srcBlob.size[1];
-        int sizeNormFactor = normBySize ? size*size : 1;
-
-        Mat srcMat = srcBlob;
-        Mat dstMat = dstBlob;
+    public:
+        SpatialLRN(const LRNLayerImpl* layer, const Mat& src, Mat& dst)
+            : layer_(layer), src_(&src), dst_(&dst) {}
 
-        for (int n = 0; n < num; n++)
+        void operator()(const Range& r) const CV_OVERRIDE
         {
-            for (int cn = 0; cn < channels; cn++)
+            const int channels = src_->size[1];
+            const int sizeNormFactor = layer_->normBySize ? layer_->size * layer_->size : 1;
+            for (int plane = r.start; plane < r.end; plane++)
             {
-                Mat src = getPlane(srcMat, n, cn);
-                Mat dst = getPlane(dstMat, n, cn);
+                Mat src = getPlane(*src_, plane / channels, plane % channels);
+                Mat dst = getPlane(*dst_, plane / channels, plane % channels);
 
-                sqrBoxFilter_(src, dst);
+                layer_->sqrBoxFilter_(src, dst);
 
-                dst.convertTo(dst, dst.type(), alpha/sizeNormFactor, bias);
-                cv::pow(dst, beta, dst);
+                dst.convertTo(dst, dst.type(), layer_->alpha/sizeNormFactor, layer_->bias);
+                cv::pow(dst, layer_->beta, dst);
                 cv::divide(src, dst, dst);
             }
         }
+
+        const LRNLayerImpl* layer_;
+        const Mat* src_;
+        Mat* dst_;
+    };
+
+    void spatialNormalization(Mat &srcBlob, Mat &dstBlob)
+    {
+        int numPlanes = srcBlob.size[0] * srcBlob.size[1];
+        parallel_for_(Range(0, numPlanes), SpatialLRN(this, srcBlob, dstBlob));
     }
 
     virtual Ptr<BackendNode> initHalide(const std::vector<Ptr<BackendWrapper> > &inputs) CV_OVERRIDE
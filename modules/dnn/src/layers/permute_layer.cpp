@@ -207,6 +207,8 @@ public:
     class PermuteInvoker : public ParallelLoopBody
     {
     public:
+        enum { BLOCK_SIZE = 32 };
+
         const Mat* inp;
         Mat* out;
         const std::vector<size_t>* order;
@@ -230,14 +232,17 @@ public:
 
         PermuteInvoker() : inp(0), out(0), order(0), nstripes(0) {}
 
+        // Output rows are processed by tiles of BLOCK_SIZE x BLOCK_SIZE elements over the last two
+        // output dimensions so both reads and writes of a tile stay in cache.
         void operator()(const Range& r) const CV_OVERRIDE
         {
             int n0 = out->size[0], n1 = out->size[1], n2 = out->size[2], n3 = out->size[3];
 
-            size_t orows = (size_t)n0*n1*n2;
-            size_t stripeSize = (orows + nstripes - 1)/nstripes;
+            size_t nblocks2 = (n2 + BLOCK_SIZE - 1)/BLOCK_SIZE;
+            size_t nitems = (size_t)n0*n1*nblocks2;
+            size_t stripeSize = (nitems + nstripes - 1)/nstripes;
             size_t stripeStart = r.start*stripeSize;
-            size_t stripeEnd = std::min(r.end*stripeSize, orows);
+            size_t stripeEnd = std::min(r.end*stripeSize, nitems);
 
             const size_t esz = sizeof(float);
             size_t ostep0 = out->step[0]/esz, ostep1 = out->step[1]/esz, ostep2 = out->step[2]/esz;
@@ -245,31 +250,66 @@ public:
             size_t istep0 = inp->step[ord[0]]/esz, istep1 = inp->step[ord[1]]/esz,
             istep2 = inp->step[ord[2]]/esz, istep3 = inp->step[ord[3]]/esz;
 
-            size_t val = stripeStart;
-            int i2 = (int)(val % n2);
-            val /= n2;
-            int i1 = (int)(val % n1);
-            int i0 = (int)(val / n1);
-
             const float* inptr_orig = inp->ptr<float>();
             float* outptr_orig = out->ptr<float>();
 
-            for( size_t ofs = stripeStart; ofs < stripeEnd; ofs++ )
+            for( size_t item = stripeStart; item < stripeEnd; item++ )
             {
-                const float* inptr = inptr_orig + i0*istep0 + i1*istep1 + i2*istep2;
-                float* outptr = outptr_orig + i0*ostep0 + i1*ostep1 + i2*ostep2;
+                size_t val = item;
+                int i2start = (int)(val % nblocks2)*BLOCK_SIZE;
+                int i2end = std::min(i2start + BLOCK_SIZE, n2);
+                val /= nblocks2;
+                int i1 = (int)(val % n1);
+                int i0 = (int)(val / n1);
+
+                const float* inptr = inptr_orig + i0*istep0 + i1*istep1;
+                float* outptr = outptr_orig + i0*ostep0 + i1*ostep1;
 
-                for( int i3 = 0; i3 < n3; i3++ )
-                    outptr[i3] = inptr[i3*istep3];
+                if( istep3 == 1 )
+                {
+                    for( int i2 = i2start; i2 < i2end; i2++ )
+                        memcpy(outptr + i2*ostep2, inptr + i2*istep2, n3*esz);
+                    continue;
+                }
 
-                if( ++i2 >= n2 )
+                for( int i3start = 0; i3start < n3; i3start += BLOCK_SIZE )
                 {
-                    i2 = 0;
-                    if( ++i1 >= n1 )
+                    int i3end = std::min(i3start + BLOCK_SIZE, n3);
+                    int i2 = i2start;
+#if CV_SIMD128
+                    // 2D transpose: input is contiguous along output rows.
+                    if( istep2 == 1 )
+                    {
+                        for( ; i2 + 4 <= i2end; i2 += 4 )
+                        {
+                            int i3 = i3start;
+                            for( ; i3 + 4 <= i3end; i3 += 4 )
+                            {
+                                const float* src = inptr + i3*istep3 + i2;
+                                float* dst = outptr + i2*ostep2 + i3;
+                                v_float32x4 r0 = v_load(src), r1 = v_load(src + istep3),
+                                            r2 = v_load(src + istep3*2), r3 = v_load(src + istep3*3);
+                                v_float32x4 t0, t1, t2, t3;
+                                v_transpose4x4(r0, r1, r2, r3, t0, t1, t2, t3);
+                                v_store(dst, t0);
+                                v_store(dst + ostep2, t1);
+                                v_store(dst + ostep2*2, t2);
+                                v_store(dst + ostep2*3, t3);
+                            }
+                            for( ; i3 < i3end; i3++ )
+                            {
+                                for( int k = 0; k < 4; k++ )
+                                    outptr[(i2 + k)*ostep2 + i3] = inptr[i3*istep3 + i2 + k];
+                            }
+                        }
+                    }
+#endif
+                    for( ; i2 < i2end; i2++ )
                     {
-                        i1 = 0;
-                        if( ++i0 >= n0 )
-                            break;
+                        const float* src = inptr + i2*istep2;
+                        float* dst = outptr + i2*ostep2;
+                        for( int i3 = i3start; i3 < i3end; i3++ )
+                            dst[i3] = src[i3*istep3];
                     }
                 }
             }
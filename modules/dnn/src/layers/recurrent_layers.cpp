@@ -41,6 +41,8 @@
 //M*/
 
 #include "../precomp.hpp"
+#include "opencv2/core/hal/hal.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <iostream>
 #include <iterator>
 #include <cmath>
@@ -80,6 +82,156 @@ static void sigmoid(const Mat &src, Mat &dst)
     cv::pow(1 + dst, -1, dst);
 }
 
+// Computes 2 / (1 + exp(-2x)) - 1 = tanh(x) in-place, exp values are expected in @p e.
+static inline void tanhFromExp(const float* e, float* dst, int len)
+{
+    int k = 0;
+#if CV_SIMD128
+    v_float32x4 one = v_setall_f32(1.f), two = v_setall_f32(2.f);
+    for (; k <= len - 4; k += 4)
+        v_store(dst + k, two / (one + v_load(e + k)) - one);
+#endif
+    for (; k < len; k++)
+        dst[k] = 2.f / (1.f + e[k]) - 1.f;
+}
+
+// Fused LSTM cell update over pre-activated gates (without bias) stored as [I F O G]:
+// c_t = sigmoid(F) (*) c_{t-1} + sigmoid(I) (*) tanh(G), h_t = sigmoid(O) (*) tanh(c_t).
+// Work is split across both samples and hidden units.
+class LSTMCellInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    enum { BLOCK_SIZE = 64 };
+
+    LSTMCellInvoker(const Mat& gates_, const Mat& bias_, Mat& c_, Mat& h_,
+                    bool useCellClip_, float cellClip_, int nstripes_)
+        : gates(gates_), bias(bias_), c(c_), h(h_),
+          useCellClip(useCellClip_), cellClip(cellClip_), nstripes(nstripes_) {}
+
+    void operator()(const Range& r) const CV_OVERRIDE
+    {
+        const int numOut = c.cols;
+        const size_t total = (size_t)c.rows * numOut;
+        const size_t stripeSize = (total + nstripes - 1) / nstripes;
+        const size_t stripeStart = r.start * stripeSize;
+        const size_t stripeEnd = std::min(r.end * stripeSize, total);
+        const float* bptr = bias.ptr<float>();
+        float buf[5 * BLOCK_SIZE];
+
+        for (size_t ofs = stripeStart; ofs < stripeEnd; )
+        {
+            int row = (int)(ofs / numOut), col = (int)(ofs % numOut);
+            int len = (int)std::min(std::min((size_t)BLOCK_SIZE, (size_t)(numOut - col)), stripeEnd - ofs);
+            const float* gptr = gates.ptr<float>(row) + col;
+            const float* b = bptr + col;
+            float* cptr = c.ptr<float>(row) + col;
+            float* hptr = h.ptr<float>(row) + col;
+            float *ei = buf, *ef = buf + len, *eo = buf + 2 * len, *eg = buf + 3 * len, *ec = buf + 4 * len;
+
+            for (int k = 0; k < len; k++)
+            {
+                ei[k] = -(gptr[k] + b[k]);
+                ef[k] = -(gptr[k + numOut] + b[k + numOut]);
+                eo[k] = -(gptr[k + 2 * numOut] + b[k + 2 * numOut]);
+                eg[k] = -2.f * (gptr[k + 3 * numOut] + b[k + 3 * numOut]);
+            }
+            hal::exp32f(buf, buf, 4 * len);
+            tanhFromExp(eg, eg, len);
+
+            int k = 0;
+#if CV_SIMD128
+            v_float32x4 one = v_setall_f32(1.f), minus2 = v_setall_f32(-2.f);
+            v_float32x4 clipHi = v_setall_f32(cellClip), clipLo = v_setall_f32(-cellClip);
+            for (; k <= len - 4; k += 4)
+            {
+                v_float32x4 i = one / (one + v_load(ei + k));
+                v_float32x4 f = one / (one + v_load(ef + k));
+                v_float32x4 ct = f * v_load(cptr + k) + i * v_load(eg + k);
+                if (useCellClip)
+                    ct = v_min(v_max(ct, clipLo), clipHi);
+                v_store(cptr + k, ct);
+                v_store(ec + k, ct * minus2);
+            }
+#endif
+            for (; k < len; k++)
+            {
+                float ct = cptr[k] / (1.f + ef[k]) + eg[k] / (1.f + ei[k]);
+                if (useCellClip)
+                    ct = std::min(std::max(ct, -cellClip), cellClip);
+                cptr[k] = ct;
+                ec[k] = -2.f * ct;
+            }
+
+            hal::exp32f(ec, ec, len);
+            tanhFromExp(ec, ec, len);
+            k = 0;
+#if CV_SIMD128
+            for (; k <= len - 4; k += 4)
+                v_store(hptr + k, v_load(ec + k) / (one + v_load(eo + k)));
+#endif
+            for (; k < len; k++)
+                hptr[k] = ec[k] / (1.f + eo[k]);
+
+            ofs += len;
+        }
+    }
+
+    static void run(const Mat& gates, const Mat& bias, Mat& c, Mat& h, bool useCellClip, float cellClip)
+    {
+        CV_Assert(gates.type() == CV_32F && c.type() == CV_32F && h.type() == CV_32F);
+        CV_Assert(gates.rows == c.rows && gates.cols == 4 * c.cols && bias.total() == (size_t)gates.cols);
+        const size_t total = (size_t)c.rows * c.cols;
+        const int nstripes = (int)std::max((size_t)1, std::min((size_t)getNumThreads(), total / BLOCK_SIZE));
+        LSTMCellInvoker invoker(gates, bias, c, h, useCellClip, cellClip, nstripes);
+        parallel_for_(Range(0, nstripes), invoker, nstripes);
+    }
+
+private:
+    const Mat& gates;
+    const Mat& bias;
+    Mat& c;
+    Mat& h;
+    bool useCellClip;
+    float cellClip;
+    int nstripes;
+};
+
+// Computes dst = tanh(src + bias) row by row in parallel, bias is a single row.
+class BiasTanhInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    BiasTanhInvoker(const Mat& src_, const Mat& bias_, Mat& dst_)
+        : src(src_), bias(bias_), dst(dst_) {}
+
+    void operator()(const Range& r) const CV_OVERRIDE
+    {
+        const int cols = src.cols;
+        const float* bptr = bias.ptr<float>();
+        for (int row = r.start; row < r.end; row++)
+        {
+            const float* sptr = src.ptr<float>(row);
+            float* dptr = dst.ptr<float>(row);
+            for (int k = 0; k < cols; k++)
+                dptr[k] = -2.f * (sptr[k] + bptr[k]);
+            hal::exp32f(dptr, dptr, cols);
+            tanhFromExp(dptr, dptr, cols);
+        }
+    }
+
+    static void run(const Mat& src, const Mat& bias, Mat& dst)
+    {
+        CV_Assert(src.type() == CV_32F && dst.type() == CV_32F && src.size == dst.size);
+        CV_Assert(bias.total() == (size_t)src.cols);
+        BiasTanhInvoker invoker(src, bias, dst);
+        parallel_for_(Range(0, src.rows), invoker, getNumThreads());
+    }
+
+private:
+    const Mat& src;
+    const Mat& bias;
+    Mat& dst;
+};
+
 class LSTMLayerImpl CV_FINAL : public LSTMLayer
 {
     int numTimeStamps, numSamples;
@@ -213,7 +365,7 @@ public:
         internals.assign(1, shape(_numSamples, _numOut)); // hInternal
         internals.push_back(shape(_numSamples, _numOut)); // cInternal
         internals.push_back(shape(_numSamples, 1)); // dummyOnes
-        internals.push_back(shape(_numSamples, 4*_numOut)); // gates
+        internals.push_back(shape(_numTimeStamps*_numSamples, 4*_numOut)); // gates of all timestamps
 
         return false;
     }
@@ -273,7 +425,7 @@ public:
         int numOut = Wh.size[1];
 
         Mat hInternal = internals[0], cInternal = internals[1],
-                dummyOnes = internals[2], gates = internals[3];
+                dummyOnes = internals[2], gatesTs = internals[3];
         hInternal.setTo(0.);
         cInternal.setTo(0.);
         dummyOnes.setTo(1.);
@@ -284,12 +436,40 @@ public:
         Mat hOutTs = output[0].reshape(1, numSamplesTotal);
         Mat cOutTs = produceCellOutput ? output[1].reshape(1, numSamplesTotal) : Mat();
 
+        // Input projections don't depend on the recurrence so they are computed
+        // for all the timestamps at once.
+        gemm(xTs, Wx, 1, noArray(), 0, gatesTs, GEMM_2_T);  // Wx * x_t
+
+        if (!usePeephole && gatesTs.type() == CV_32F)
+        {
+            Mat fusedBias = bias.clone();
+            if (forgetBias)
+                add(fusedBias.colRange(numOut, 2*numOut), forgetBias, fusedBias.colRange(numOut, 2*numOut));
+
+            for (int ts = 0; ts < numTimeStamps; ts++)
+            {
+                Range curRowRange(ts*numSamples, (ts + 1)*numSamples);
+                Mat gates = gatesTs.rowRange(curRowRange);
+                Mat hCurr = hOutTs.rowRange(curRowRange);
+
+                if (ts > 0)  // h_{-1} is zero
+                {
+                    Mat hPrev = hOutTs.rowRange((ts - 1)*numSamples, ts*numSamples);
+                    gemm(hPrev, Wh, 1, gates, 1, gates, GEMM_2_T);  //+Wh * h_{t-1}
+                }
+                LSTMCellInvoker::run(gates, fusedBias, cInternal, hCurr, useCellClip, cellClip);
+
+                if (produceCellOutput)
+                    cInternal.copyTo(cOutTs.rowRange(curRowRange));
+            }
+            return;
+        }
+
         for (int ts = 0; ts < numTimeStamps; ts++)
         {
             Range curRowRange(ts*numSamples, (ts + 1)*numSamples);
-            Mat xCurr = xTs.rowRange(curRowRange);
+            Mat gates = gatesTs.rowRange(curRowRange);
 
-            gemm(xCurr, Wx, 1, gates, 0, gates, GEMM_2_T);      // Wx * x_t
             gemm(hInternal, Wh, 1, gates, 1, gates, GEMM_2_T);  //+Wh * h_{t-1}
             gemm(dummyOnes, bias, 1, gates, 1, gates);          //+b
 
@@ -428,8 +608,7 @@ public:
         if (produceH)
             outputs.push_back(shape(dims, 3));
 
-        internals.assign(2, shape(numSamples_, numH_));
-        internals.push_back(shape(numSamples_, 1));
+        internals.assign(1, shape(numTimestamps_*numSamples_, numH_));  // hidden states of all timestamps
 
         return false;
     }
@@ -489,32 +668,28 @@ public:
 
         Mat xTs = input[0]->reshape(1, numSamplesTotal);
         Mat oTs = output[0].reshape(1, numSamplesTotal);
-        Mat hTs = produceH ? output[1].reshape(1, numSamplesTotal) : Mat();
-        Mat hCurr = internals[0];
-        Mat hPrev = internals[1];
-        Mat dummyBiasOnes = internals[2];
+        Mat hTs = produceH ? output[1].reshape(1, numSamplesTotal) : internals[0];
 
-        hPrev.setTo(0.);
-        dummyBiasOnes.setTo(1.);
+        // Input projections for all the timestamps are computed by a single GEMM
+        // and then replaced by hidden states step by step.
+        gemm(xTs, Wxh, 1, noArray(), 0, hTs, GEMM_2_T);  // W_{xh} * x_{curr}
 
         for (int ts = 0; ts < numTimestamps; ts++)
         {
             Range curRowRange = Range(ts * numSamples, (ts + 1) * numSamples);
-            Mat xCurr = xTs.rowRange(curRowRange);
-
-            gemm(hPrev, Whh, 1, hCurr, 0, hCurr, GEMM_2_T); // W_{hh} * h_{prev}
-            gemm(xCurr, Wxh, 1, hCurr, 1, hCurr, GEMM_2_T); //+W_{xh} * x_{curr}
-            gemm(dummyBiasOnes, bh, 1, hCurr, 1, hCurr);    //+bh
-            tanh(hCurr, hPrev);
-
-            Mat oCurr = oTs.rowRange(curRowRange);
-            gemm(hPrev, Who, 1, oCurr, 0, oCurr, GEMM_2_T); // W_{ho} * h_{prev}
-            gemm(dummyBiasOnes, bo, 1, oCurr, 1, oCurr);    //+b_o
-            tanh(oCurr, oCurr);
+            Mat hCurr = hTs.rowRange(curRowRange);
 
-            if (produceH)
-                hPrev.copyTo(hTs.rowRange(curRowRange));
+            if (ts > 0)  // h_{-1} is zero
+            {
+                Mat hPrev = hTs.rowRange((ts - 1) * numSamples, ts * numSamples);
+                gemm(hPrev, Whh, 1, hCurr, 1, hCurr, GEMM_2_T);  //+W_{hh} * h_{prev}
+            }
+            BiasTanhInvoker::run(hCurr, bh, hCurr);  // tanh(... + bh)
         }
+
+        // Outputs depend only on hidden states of the same timestamp.
+        gemm(hTs, Who, 1, noArray(), 0, oTs, GEMM_2_T);  // W_{ho} * h_{curr}
+        BiasTanhInvoker::run(oTs, bo, oTs);              // tanh(... + b_o)
     }
 };
 
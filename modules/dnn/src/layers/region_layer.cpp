@@ -269,24 +269,20 @@ public:
         }
     }
 
-    static inline float rectOverlap(const Rect2f& a, const Rect2f& b)
-    {
-        return 1.0f - jaccardDistance(a, b);
-    }
-
     void do_nms_sort(float *detections, int total, float score_thresh, float nms_thresh)
     {
-        std::vector<Rect2f> boxes(total);
+        BoxesSoA boxes;
+        boxes.resize(total);
         std::vector<float> scores(total);
 
         for (int i = 0; i < total; ++i)
         {
-            Rect2f &b = boxes[i];
             int box_index = i * (classes + coords + 1);
-            b.width = detections[box_index + 2];
-            b.height = detections[box_index + 3];
-            b.x = detections[box_index + 0] - b.width / 2;
-            b.y = detections[box_index + 1] - b.height / 2;
+            float width = detections[box_index + 2];
+            float height = detections[box_index + 3];
+            float x = detections[box_index + 0] - width / 2;
+            float y = detections[box_index + 1] - height / 2;
+            boxes.set(i, x, y, x + width, y + height, width * height);
         }
 
         std::vector<int> indices;
@@ -299,7 +295,8 @@ public:
                 scores[i] = detections[class_index + k];
                 detections[class_index + k] = 0;
             }
-            NMSFast_(boxes, scores, score_thresh, nms_thresh, 1, 0, indices, rectOverlap);
+            // Equal to 1 - jaccardDistance: empty boxes are the same, intersection has no offset.
+            NMSFastSoA_(boxes, scores, score_thresh, nms_thresh, 1, 0, indices, 0.f, 1.f);
             for (int i = 0, n = indices.size(); i < n; ++i)
             {
                 int box_index = indices[i] * (classes + coords + 1);
@@ -90,58 +90,122 @@ public:
         Mat& out = outputs[0];
         if (interpolation == "nearest")
         {
-            for (size_t n = 0; n < inputs[0]->size[0]; ++n)
-            {
-                for (size_t ch = 0; ch < inputs[0]->size[1]; ++ch)
-                {
-                    resize(getPlane(inp, n, ch), getPlane(out, n, ch),
-                           Size(outWidth, outHeight), 0, 0, INTER_NEAREST);
-                }
-            }
+            ResizeNearestInvoker::run(inp, out);
         }
         else if (interpolation == "bilinear")
         {
-            const int inpHeight = inp.size[2];
-            const int inpWidth = inp.size[3];
-            const int inpSpatialSize = inpHeight * inpWidth;
-            const int outSpatialSize = outHeight * outWidth;
-            const int numPlanes = inp.size[0] * inp.size[1];
             CV_Assert(inp.isContinuous(), out.isContinuous());
+            ResizeBilinearInvoker::run(inp, out, scaleHeight, scaleWidth);
+        }
+        else
+            CV_Error(Error::StsNotImplemented, "Unknown interpolation: " + interpolation);
+    }
+
+    class ResizeNearestInvoker : public ParallelLoopBody
+    {
+    public:
+        const Mat* inp;
+        Mat* out;
+
+        static void run(const Mat& inp, Mat& out)
+        {
+            ResizeNearestInvoker p;
+            p.inp = &inp;
+            p.out = &out;
+            parallel_for_(Range(0, inp.size[0] * inp.size[1]), p);
+        }
+
+        void operator()(const Range& r) const CV_OVERRIDE
+        {
+            const int channels = inp->size[1];
+            Size outSize(out->size[3], out->size[2]);
+            for (int plane = r.start; plane < r.end; plane++)
+            {
+                Mat outPlane = getPlane(*out, plane / channels, plane % channels);
+                resize(getPlane(*inp, plane / channels, plane % channels), outPlane,
+                       outSize, 0, 0, INTER_NEAREST);
+            }
+        }
+    };
 
-            Mat inpPlanes = inp.reshape(1, numPlanes * inpHeight);
-            Mat outPlanes = out.reshape(1, numPlanes * outHeight);
-            for (int y = 0; y < outHeight; ++y)
+    // Every output row is interpolated horizontally from two input rows
+    // which are then blended vertically.
+    class ResizeBilinearInvoker : public ParallelLoopBody
+    {
+    public:
+        const Mat* inp;
+        Mat* out;
+        float scaleHeight;
+        std::vector<int> xofs;    // pairs of left and right input columns
+        std::vector<float> alpha; // horizontal weights of right columns
+
+        static void run(const Mat& inp, Mat& out, float scaleHeight, float scaleWidth)
+        {
+            const int inpWidth = inp.size[3], outWidth = out.size[3];
+            ResizeBilinearInvoker p;
+            p.inp = &inp;
+            p.out = &out;
+            p.scaleHeight = scaleHeight;
+            p.xofs.resize(outWidth * 2);
+            p.alpha.resize(outWidth);
+            for (int x = 0; x < outWidth; ++x)
+            {
+                float input_x = x * scaleWidth;
+                int x0 = static_cast<int>(input_x);
+                p.xofs[x * 2] = x0;
+                p.xofs[x * 2 + 1] = std::min(x0 + 1, inpWidth - 1);
+                p.alpha[x] = input_x - x0;
+            }
+            int numRows = inp.size[0] * inp.size[1] * out.size[2];
+            parallel_for_(Range(0, numRows), p, std::min(numRows, getNumThreads() * 4));
+        }
+
+        void operator()(const Range& r) const CV_OVERRIDE
+        {
+            const int inpHeight = inp->size[2], inpWidth = inp->size[3];
+            const int outHeight = out->size[2], outWidth = out->size[3];
+            const float* inpData = inp->ptr<float>();
+            float* outData = out->ptr<float>();
+            const int* xofs_ = &xofs[0];
+            const float* alpha_ = &alpha[0];
+
+            AutoBuffer<float> buf_(outWidth * 2);
+            float* row0 = buf_.data();
+            float* row1 = row0 + outWidth;
+
+            for (int row = r.start; row < r.end; row++)
             {
+                int plane = row / outHeight, y = row % outHeight;
                 float input_y = y * scaleHeight;
                 int y0 = static_cast<int>(input_y);
-                const float* inpData_row0 = inpPlanes.ptr<float>(y0);
-                const float* inpData_row1 = inpPlanes.ptr<float>(std::min(y0 + 1, inpHeight - 1));
+                int y1 = std::min(y0 + 1, inpHeight - 1);
+                float beta = input_y - y0;
+
+                const float* inpRow0 = inpData + ((size_t)plane * inpHeight + y0) * inpWidth;
+                const float* inpRow1 = inpData + ((size_t)plane * inpHeight + y1) * inpWidth;
+                float* outRow = outData + (size_t)row * outWidth;
+
                 for (int x = 0; x < outWidth; ++x)
                 {
-                    float input_x = x * scaleWidth;
-                    int x0 = static_cast<int>(input_x);
-                    int x1 = std::min(x0 + 1, inpWidth - 1);
-
-                    float* outData = outPlanes.ptr<float>(y, x);
-                    const float* inpData_row0_c = inpData_row0;
-                    const float* inpData_row1_c = inpData_row1;
-                    for (int c = 0; c < numPlanes; ++c)
-                    {
-                        *outData = inpData_row0_c[x0] +
-                            (input_y - y0) * (inpData_row1_c[x0] - inpData_row0_c[x0]) +
-                            (input_x - x0) * (inpData_row0_c[x1] - inpData_row0_c[x0] +
-                            (input_y - y0) * (inpData_row1_c[x1] - inpData_row0_c[x1] - inpData_row1_c[x0] + inpData_row0_c[x0]));
-
-                        inpData_row0_c += inpSpatialSize;
-                        inpData_row1_c += inpSpatialSize;
-                        outData += outSpatialSize;
-                    }
+                    int x0 = xofs_[x * 2], x1 = xofs_[x * 2 + 1];
+                    row0[x] = inpRow0[x0] + alpha_[x] * (inpRow0[x1] - inpRow0[x0]);
+                    row1[x] = inpRow1[x0] + alpha_[x] * (inpRow1[x1] - inpRow1[x0]);
                 }
+
+                int x = 0;
+#if CV_SIMD128
+                v_float32x4 vbeta = v_setall_f32(beta);
+                for (; x + 4 <= outWidth; x += 4)
+                {
+                    v_float32x4 v0 = v_load(row0 + x);
+                    v_store(outRow + x, v_muladd(v_load(row1 + x) - v0, vbeta, v0));
+                }
+#endif
+                for (; x < outWidth; ++x)
+                    outRow[x] = row0[x] + beta * (row1[x] - row0[x]);
             }
         }
-        else
-            CV_Error(Error::StsNotImplemented, "Unknown interpolation: " + interpolation);
-    }
+    };
 
     virtual Ptr<BackendNode> initInfEngine(const std::vector<Ptr<BackendWrapper> >&) CV_OVERRIDE
     {
@@ -29,6 +29,7 @@ public:
         hasBias = params.get<bool>("bias_term", false);
         axis = params.get<int>("axis", 1);
         hasWeights = false;
+        originHasBias = hasBias;
     }
 
     bool getMemoryShapes(const std::vector<MatShape> &inputs,
@@ -227,6 +228,61 @@ public:
         shift = hasBias ? blobs.back() : Mat();
     }
 
+    // Fuses the following channel-wise transformation (i.e. another Scale layer):
+    // w2 * (w1 * x + b1) + b2 = (w2 * w1) * x + (w2 * b1 + b2)
+    virtual bool tryFuse(Ptr<Layer>& top) CV_OVERRIDE
+    {
+        if (blobs.empty() || axis != 1)
+            return false;
+
+        Ptr<ScaleLayer> topScale = top.dynamicCast<ScaleLayer>();
+        if (!topScale.empty() && topScale->axis != 1)
+            return false;
+
+        Mat w, b;
+        top->getScaleShift(w, b);
+        if (w.empty() && b.empty())
+            return false;
+
+        const int numWeights = hasWeights ? blobs[0].total() : blobs.back().total();
+        if ((!w.empty() && (int)w.total() != numWeights) || (!b.empty() && (int)b.total() != numWeights))
+            return false;
+
+        if (originBlobs.empty())
+        {
+            originBlobs = blobs;
+            originHasBias = hasBias;
+        }
+
+        Mat fusedWeights = hasWeights ? blobs[0].reshape(1, 1).clone() : Mat::ones(1, numWeights, CV_32F);
+        Mat fusedBias = hasBias ? blobs.back().reshape(1, 1).clone() : Mat::zeros(1, numWeights, CV_32F);
+        if (!w.empty())
+        {
+            multiply(fusedWeights, w.reshape(1, 1), fusedWeights);
+            multiply(fusedBias, w.reshape(1, 1), fusedBias);
+        }
+        if (!b.empty())
+            add(fusedBias, b.reshape(1, 1), fusedBias);
+
+        blobs.resize(2);
+        blobs[0] = fusedWeights;
+        blobs[1] = fusedBias;
+        hasWeights = hasBias = true;
+        return true;
+    }
+
+    virtual void unsetAttached() CV_OVERRIDE
+    {
+        Layer::unsetAttached();
+        if (!originBlobs.empty())
+        {
+            blobs = originBlobs;
+            hasBias = originHasBias;
+            hasWeights = blobs.size() == 2 || (blobs.size() == 1 && !hasBias);
+            originBlobs.clear();
+        }
+    }
+
     virtual int64 getFLOPS(const std::vector<MatShape> &inputs,
                            const std::vector<MatShape> &outputs) const CV_OVERRIDE
     {
@@ -241,6 +297,9 @@ public:
 
 private:
     bool hasWeights;
+    // Parameters before fusion with the following layers.
+    std::vector<Mat> originBlobs;
+    bool originHasBias;
 };
 
 
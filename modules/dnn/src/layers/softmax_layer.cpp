@@ -79,10 +79,14 @@ public:
                          std::vector<MatShape> &internals) const CV_OVERRIDE
     {
         bool inplace = Layer::getMemoryShapes(inputs, requiredOutputs, outputs, internals);
-        MatShape shape = inputs[0];
-        int cAxis = clamp(axisRaw, shape.size());
-        shape[cAxis] = 1;
-        internals.assign(1, shape);
+        // the buffer is used by OpenCL implementation only
+        if (IS_DNN_OPENCL_TARGET(preferableTarget))
+        {
+            MatShape shape = inputs[0];
+            int cAxis = clamp(axisRaw, shape.size());
+            shape[cAxis] = 1;
+            internals.assign(1, shape);
+        }
         return inplace;
     }
 
@@ -195,92 +199,203 @@ public:
         Layer::forward_fallback(inputs_arr, outputs_arr, internals_arr);
     }
 
-    void forward(std::vector<Mat*> &inputs, std::vector<Mat> &outputs, std::vector<Mat> &internals) CV_OVERRIDE
+    class SoftmaxInvoker : public ParallelLoopBody
     {
-        CV_TRACE_FUNCTION();
-        CV_TRACE_ARG_VALUE(name, "name", name.c_str());
+    public:
+        enum { BLOCK_SIZE = 256 };
 
-        const Mat &src = *inputs[0];
-        Mat &dst = outputs[0];
-
-        int axis = clamp(axisRaw, src.dims);
-        size_t outerSize = src.total(0, axis), channels = src.size[axis],
-                innerSize = src.total(axis + 1);
+        const float* src;
+        float* dst;
+        size_t channels, innerSize, numBlocks;
+        bool logSoftMax;
 
-        CV_Assert(src.type() == CV_32F);
-        CV_Assert(src.isContinuous() && dst.isContinuous());
-
-        const float *srcPtr = src.ptr<float>();
-        float *dstPtr = dst.ptr<float>();
-        float *bufPtr = internals[0].ptr<float>();
-
-        size_t outerStep = src.total(axis);
-        size_t cnStep = src.total(axis + 1);
-
-        //compute max along axis
-        for (size_t outerDim = 0; outerDim < outerSize; outerDim++)
+        static void run(const Mat& src, Mat& dst, int axis, bool logSoftMax)
         {
-            size_t srcOffset = outerDim * outerStep;
-            size_t bufOffset = outerDim * cnStep;
+            SoftmaxInvoker p;
+            p.src = src.ptr<float>();
+            p.dst = dst.ptr<float>();
+            p.channels = src.size[axis];
+            p.innerSize = src.total(axis + 1);
+            p.numBlocks = (p.innerSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            p.logSoftMax = logSoftMax;
+
+            // Every (outer index, block of inner positions) pair is processed independently.
+            size_t outerSize = src.total(0, axis);
+            size_t numItems = outerSize * p.numBlocks;
+            double nstripes = std::min((double)numItems, (double)getNumThreads() * 4);
+            parallel_for_(Range(0, (int)numItems), p, nstripes);
+        }
 
-            memcpy(bufPtr + bufOffset, srcPtr + srcOffset, innerSize * sizeof(float));
+        SoftmaxInvoker() : src(0), dst(0), channels(0), innerSize(0), numBlocks(0), logSoftMax(false) {}
 
-            for (size_t cnDim = 1; cnDim < channels; cnDim++)
+        // Softmax over contiguous channels.
+        void processRow(const float* srcRow, float* dstRow) const
+        {
+            size_t c = 0, n = channels;
+            float maxVal = srcRow[0];
+#if CV_SIMD128
+            if (n >= 4)
             {
-                for (size_t i = 0; i < innerSize; i++)
-                    bufPtr[bufOffset + i] = std::max(bufPtr[bufOffset + i], srcPtr[srcOffset + cnDim * cnStep + i]);
+                v_float32x4 vmax = v_load(srcRow);
+                for (c = 4; c + 4 <= n; c += 4)
+                    vmax = v_max(vmax, v_load(srcRow + c));
+                maxVal = v_reduce_max(vmax);
+            }
+#endif
+            for (; c < n; c++)
+                maxVal = std::max(maxVal, srcRow[c]);
+
+            float sum = 0.f;
+            c = 0;
+#if CV_SIMD128
+            v_float32x4 vmax = v_setall_f32(maxVal), vsum = v_setzero_f32();
+            for (; c + 4 <= n; c += 4)
+            {
+                v_float32x4 v = v_fastExp(v_load(srcRow + c) - vmax);
+                if (!logSoftMax)
+                    v_store(dstRow + c, v);
+                vsum += v;
+            }
+            sum = v_reduce_sum(vsum);
+#endif
+            for (; c < n; c++)
+            {
+                float v = std::exp(srcRow[c] - maxVal);
+                if (!logSoftMax)
+                    dstRow[c] = v;
+                sum += v;
             }
-        }
-
-        //subtract max
-        for (size_t outerDim = 0; outerDim < outerSize; outerDim++)
-        {
-            size_t srcOffset = outerDim * outerStep;
-            size_t bufOffset = outerDim * cnStep;
 
-            for (size_t cnDim = 0; cnDim < channels; cnDim++)
+            if (logSoftMax)
             {
-                const int offset = srcOffset + cnDim * cnStep;
-                for (size_t i = 0; i < innerSize; i++)
-                    dstPtr[offset + i] = srcPtr[offset + i] - bufPtr[bufOffset + i];
+                float shift = maxVal + std::log(sum);
+                for (c = 0; c < n; c++)
+                    dstRow[c] = srcRow[c] - shift;
+            }
+            else
+            {
+                float scale = 1.f / sum;
+                for (c = 0; c < n; c++)
+                    dstRow[c] *= scale;
             }
         }
 
-        cv::exp(dst, dst);
-
-        for (size_t outerDim = 0; outerDim < outerSize; outerDim++)
+        // Softmax over channels of len inner positions. Channels are placed with innerSize step.
+        void processBlock(const float* srcBlock, float* dstBlock, size_t len, float* maxBuf, float* sumBuf) const
         {
-            size_t srcOffset = outerDim * outerStep;
-            size_t bufOffset = outerDim * cnStep;
+            size_t c, i;
+            memcpy(maxBuf, srcBlock, len * sizeof(float));
+            for (c = 1; c < channels; c++)
+            {
+                const float* srcPtr = srcBlock + c * innerSize;
+                i = 0;
+#if CV_SIMD128
+                for (; i + 4 <= len; i += 4)
+                    v_store(maxBuf + i, v_max(v_load(maxBuf + i), v_load(srcPtr + i)));
+#endif
+                for (; i < len; i++)
+                    maxBuf[i] = std::max(maxBuf[i], srcPtr[i]);
+            }
 
-            //sum exp along axis
-            for (size_t i = 0; i < innerSize; i++)
-                bufPtr[bufOffset + i] = 0.f;
+            memset(sumBuf, 0, len * sizeof(float));
+            for (c = 0; c < channels; c++)
+            {
+                const float* srcPtr = srcBlock + c * innerSize;
+                float* dstPtr = dstBlock + c * innerSize;
+                i = 0;
+#if CV_SIMD128
+                for (; i + 4 <= len; i += 4)
+                {
+                    v_float32x4 v = v_fastExp(v_load(srcPtr + i) - v_load(maxBuf + i));
+                    if (!logSoftMax)
+                        v_store(dstPtr + i, v);
+                    v_store(sumBuf + i, v_load(sumBuf + i) + v);
+                }
+#endif
+                for (; i < len; i++)
+                {
+                    float v = std::exp(srcPtr[i] - maxBuf[i]);
+                    if (!logSoftMax)
+                        dstPtr[i] = v;
+                    sumBuf[i] += v;
+                }
+            }
 
-            for (size_t cnDim = 0; cnDim < channels; cnDim++)
+            // Softmax: dst = exp(src - max) / sum, log softmax: dst = src - (max + log(sum)).
+            i = 0;
+            if (logSoftMax)
             {
-                const int offset = srcOffset + cnDim * cnStep;
-                for (size_t i = 0; i < innerSize; i++)
-                    bufPtr[bufOffset + i] += dstPtr[offset + i];
+#if CV_SIMD128
+                for (; i + 4 <= len; i += 4)
+                    v_store(sumBuf + i, v_load(maxBuf + i) + v_fastLog(v_load(sumBuf + i)));
+#endif
+                for (; i < len; i++)
+                    sumBuf[i] = maxBuf[i] + std::log(sumBuf[i]);
+            }
+            else
+            {
+#if CV_SIMD128
+                for (; i + 4 <= len; i += 4)
+                    v_store(sumBuf + i, v_setall_f32(1.f) / v_load(sumBuf + i));
+#endif
+                for (; i < len; i++)
+                    sumBuf[i] = 1.f / sumBuf[i];
             }
 
-            //divide by computed sum
-            for (size_t cnDim = 0; cnDim < channels; cnDim++)
+            for (c = 0; c < channels; c++)
             {
-                const int offset = srcOffset + cnDim * cnStep;
-                for (size_t i = 0; i < innerSize; i++)
-                    dstPtr[offset + i] /= bufPtr[bufOffset + i];
+                const float* srcPtr = srcBlock + c * innerSize;
+                float* dstPtr = dstBlock + c * innerSize;
+                i = 0;
+#if CV_SIMD128
+                if (logSoftMax)
+                {
+                    for (; i + 4 <= len; i += 4)
+                        v_store(dstPtr + i, v_load(srcPtr + i) - v_load(sumBuf + i));
+                }
+                else
+                {
+                    for (; i + 4 <= len; i += 4)
+                        v_store(dstPtr + i, v_load(dstPtr + i) * v_load(sumBuf + i));
+                }
+#endif
+                for (; i < len; i++)
+                    dstPtr[i] = logSoftMax ? srcPtr[i] - sumBuf[i] : dstPtr[i] * sumBuf[i];
             }
-            if (logSoftMax)
+        }
+
+        void operator()(const Range& r) const CV_OVERRIDE
+        {
+            float maxBuf[BLOCK_SIZE], sumBuf[BLOCK_SIZE];
+            for (int item = r.start; item < r.end; item++)
             {
-                for (size_t cnDim = 0; cnDim < channels; cnDim++)
+                size_t outerIdx = item / numBlocks, block = item % numBlocks;
+                size_t ofs = outerIdx * channels * innerSize + block * BLOCK_SIZE;
+                if (innerSize == 1)
+                    processRow(src + ofs, dst + ofs);
+                else
                 {
-                    const int offset = srcOffset + cnDim * cnStep;
-                    for (size_t i = 0; i < innerSize; i++)
-                        dstPtr[offset + i] = log(dstPtr[offset + i]);
+                    size_t len = std::min((size_t)BLOCK_SIZE, innerSize - block * BLOCK_SIZE);
+                    processBlock(src + ofs, dst + ofs, len, maxBuf, sumBuf);
                 }
             }
         }
+    };
+
+    void forward(std::vector<Mat*> &inputs, std::vector<Mat> &outputs, std::vector<Mat> &internals) CV_OVERRIDE
+    {
+        CV_TRACE_FUNCTION();
+        CV_TRACE_ARG_VALUE(name, "name", name.c_str());
+
+        const Mat &src = *inputs[0];
+        Mat &dst = outputs[0];
+
+        int axis = clamp(axisRaw, src.dims);
+
+        CV_Assert(src.type() == CV_32F);
+        CV_Assert(src.isContinuous() && dst.isContinuous());
+
+        SoftmaxInvoker::run(src, dst, axis, logSoftMax);
     }
 
     virtual Ptr<BackendNode> initHalide(const std::vector<Ptr<BackendWrapper> > &inputs) CV_OVERRIDE
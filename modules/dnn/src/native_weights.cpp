@@ -0,0 +1,297 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "native_weights.hpp"
+#include <fstream>
+
+#if defined _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define OPENCV_DNN_HAVE_MMAP 1
+#elif defined __unix__ || defined __APPLE__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OPENCV_DNN_HAVE_MMAP 1
+#endif
+
+namespace cv
+{
+namespace dnn
+{
+
+static const char kMagic[] = "CVDNNW01";
+static const size_t kMagicSize = sizeof(kMagic) - 1;
+static const uint32_t kByteOrderMark = 0x01020304;
+static const size_t kDataAlignment = 64;
+
+// Whole file mapped copy-on-write. If memory mapping is not available,
+// the file is read into a buffer.
+class MappedFile
+{
+public:
+    explicit MappedFile(const String& path) : data_(0), size_(0)
+    {
+#if defined _WIN32
+        mapping_ = NULL;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            CV_Error(Error::StsError, "Can't open \"" + path + "\"");
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            size_ = (size_t)fileSize.QuadPart;
+            mapping_ = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+            if (mapping_)
+                data_ = (uchar*)MapViewOfFile(mapping_, FILE_MAP_COPY, 0, 0, 0);
+        }
+        CloseHandle(file);
+#elif defined OPENCV_DNN_HAVE_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            CV_Error(Error::StsError, "Can't open \"" + path + "\"");
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            size_ = (size_t)st.st_size;
+            void* ptr = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED)
+                data_ = (uchar*)ptr;
+        }
+        close(fd);
+#endif
+        if (!data_)
+        {
+            std::ifstream ifs(path.c_str(), std::ios::binary);
+            if (!ifs.is_open())
+                CV_Error(Error::StsError, "Can't open \"" + path + "\"");
+            ifs.seekg(0, std::ios::end);
+            size_ = (size_t)ifs.tellg();
+            ifs.seekg(0, std::ios::beg);
+            buffer_.resize(size_);
+            if (size_)
+                ifs.read((char*)&buffer_[0], size_);
+            CV_Assert(!ifs.fail());
+            data_ = buffer_.empty() ? 0 : &buffer_[0];
+        }
+    }
+
+    ~MappedFile()
+    {
+        if (!buffer_.empty() || !data_)
+            return;
+#if defined _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+#elif defined OPENCV_DNN_HAVE_MMAP
+        munmap(data_, size_);
+#endif
+    }
+
+    uchar* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uchar* data_;
+    size_t size_;
+#if defined _WIN32
+    HANDLE mapping_;
+#endif
+    std::vector<uchar> buffer_;
+};
+
+// Mats which wrap memory of mapped file keep a reference to it
+// (the same way as Python bindings keep numpy arrays).
+class MappedFileAllocator : public MatAllocator
+{
+public:
+    MappedFileAllocator() { stdAllocator = Mat::getStdAllocator(); }
+
+    UMatData* allocate(const Ptr<MappedFile>& file, uchar* data, size_t size) const
+    {
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = data;
+        u->size = size;
+        u->userdata = new Ptr<MappedFile>(file);
+        return u;
+    }
+
+    UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                       int flags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        return stdAllocator->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(UMatData* u, int accessFlags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        return stdAllocator->allocate(u, accessFlags, usageFlags);
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if (!u)
+            return;
+        CV_Assert(u->urefcount >= 0);
+        CV_Assert(u->refcount >= 0);
+        if (u->refcount == 0)
+        {
+            delete (Ptr<MappedFile>*)u->userdata;
+            delete u;
+        }
+    }
+
+    const MatAllocator* stdAllocator;
+};
+
+static MappedFileAllocator& getMappedFileAllocator()
+{
+    // Never destroyed: blobs of global networks may outlive static objects.
+    static MappedFileAllocator* allocator = new MappedFileAllocator();
+    return *allocator;
+}
+
+template <typename T>
+static T readValue(const uchar* data, size_t size, size_t& pos)
+{
+    if (pos + sizeof(T) > size)
+        CV_Error(Error::StsParseError, "Native weights file is truncated");
+    T value;
+    memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+template <typename T>
+static void writeValue(std::ostream& os, T value)
+{
+    os.write((const char*)&value, sizeof(T));
+}
+
+static size_t alignOffset(size_t offset)
+{
+    return (offset + kDataAlignment - 1) & ~(kDataAlignment - 1);
+}
+
+bool isNativeWeightsFile(const String& path)
+{
+    std::ifstream ifs(path.c_str(), std::ios::binary);
+    char magic[kMagicSize];
+    return ifs.read(magic, kMagicSize) && memcmp(magic, kMagic, kMagicSize) == 0;
+}
+
+void readNativeWeights(const String& path, LayersBlobs& layersBlobs)
+{
+    CV_TRACE_FUNCTION();
+
+    Ptr<MappedFile> file = makePtr<MappedFile>(path);
+    uchar* data = file->data();
+    const size_t size = file->size();
+    if (size < kMagicSize || memcmp(data, kMagic, kMagicSize) != 0)
+        CV_Error(Error::StsParseError, "\"" + path + "\" is not a native weights file");
+
+    size_t pos = kMagicSize;
+    if (readValue<uint32_t>(data, size, pos) != kByteOrderMark)
+        CV_Error(Error::StsNotImplemented, "Native weights file has different byte order");
+
+    MappedFileAllocator& allocator = getMappedFileAllocator();
+    const uint32_t numLayers = readValue<uint32_t>(data, size, pos);
+    for (uint32_t i = 0; i < numLayers; ++i)
+    {
+        const uint32_t nameLength = readValue<uint32_t>(data, size, pos);
+        if (pos + nameLength > size)
+            CV_Error(Error::StsParseError, "Native weights file is truncated");
+        String name((const char*)data + pos, nameLength);
+        pos += nameLength;
+
+        std::vector<Mat>& blobs = layersBlobs[name];
+        blobs.resize(readValue<uint32_t>(data, size, pos));
+        for (size_t j = 0; j < blobs.size(); ++j)
+        {
+            const int type = readValue<int32_t>(data, size, pos);
+            const int dims = readValue<int32_t>(data, size, pos);
+            CV_Assert(type == CV_MAT_TYPE(type), dims > 0);
+            AutoBuffer<int> sizes(dims);
+            size_t total = CV_ELEM_SIZE(type);
+            for (int k = 0; k < dims; ++k)
+            {
+                sizes[k] = readValue<int32_t>(data, size, pos);
+                CV_Assert(sizes[k] >= 0);
+                total *= sizes[k];
+            }
+            const uint64_t offset = readValue<uint64_t>(data, size, pos);
+            if (offset > size || total > size - offset)
+                CV_Error(Error::StsParseError, "Native weights file is truncated");
+
+            Mat& blob = blobs[j];
+            blob = Mat(dims, sizes.data(), type, data + offset);
+            blob.u = allocator.allocate(file, data + offset, total);
+            blob.addref();
+            blob.allocator = &allocator;
+        }
+    }
+}
+
+void writeNativeWeights(const String& path, const LayersBlobs& layersBlobs)
+{
+    CV_TRACE_FUNCTION();
+
+    size_t headerSize = kMagicSize + 2 * sizeof(uint32_t);
+    for (LayersBlobs::const_iterator it = layersBlobs.begin(); it != layersBlobs.end(); ++it)
+    {
+        headerSize += 2 * sizeof(uint32_t) + it->first.size();
+        for (size_t j = 0; j < it->second.size(); ++j)
+            headerSize += (2 + it->second[j].dims) * sizeof(int32_t) + sizeof(uint64_t);
+    }
+
+    std::ofstream ofs(path.c_str(), std::ios::binary);
+    if (!ofs.is_open())
+        CV_Error(Error::StsError, "Can't open \"" + path + "\"");
+
+    ofs.write(kMagic, kMagicSize);
+    writeValue<uint32_t>(ofs, kByteOrderMark);
+    writeValue<uint32_t>(ofs, (uint32_t)layersBlobs.size());
+    size_t offset = alignOffset(headerSize);
+    for (LayersBlobs::const_iterator it = layersBlobs.begin(); it != layersBlobs.end(); ++it)
+    {
+        writeValue<uint32_t>(ofs, (uint32_t)it->first.size());
+        ofs.write(it->first.c_str(), it->first.size());
+        writeValue<uint32_t>(ofs, (uint32_t)it->second.size());
+        for (size_t j = 0; j < it->second.size(); ++j)
+        {
+            const Mat& blob = it->second[j];
+            writeValue<int32_t>(ofs, blob.type());
+            writeValue<int32_t>(ofs, blob.dims);
+            for (int k = 0; k < blob.dims; ++k)
+                writeValue<int32_t>(ofs, blob.size[k]);
+            writeValue<uint64_t>(ofs, offset);
+            offset = alignOffset(offset + blob.total() * blob.elemSize());
+        }
+    }
+
+    const char zeros[kDataAlignment] = {0};
+    size_t pos = headerSize;
+    for (LayersBlobs::const_iterator it = layersBlobs.begin(); it != layersBlobs.end(); ++it)
+    {
+        for (size_t j = 0; j < it->second.size(); ++j)
+        {
+            ofs.write(zeros, alignOffset(pos) - pos);
+            pos = alignOffset(pos);
+
+            Mat blob = it->second[j].isContinuous() ? it->second[j] : it->second[j].clone();
+            const size_t blobSize = blob.total() * blob.elemSize();
+            ofs.write((const char*)blob.data, blobSize);
+            pos += blobSize;
+        }
+    }
+    if (!ofs.good())
+        CV_Error(Error::StsError, "Failed to write \"" + path + "\"");
+}
+
+}  // namespace dnn
+}  // namespace cv
@@ -0,0 +1,42 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_DNN_NATIVE_WEIGHTS_HPP__
+#define __OPENCV_DNN_NATIVE_WEIGHTS_HPP__
+
+#include <opencv2/dnn.hpp>
+#include <map>
+
+namespace cv
+{
+namespace dnn
+{
+
+// Native weights file keeps blobs of every layer as raw arrays aligned to
+// 64 bytes so they are used in place after the file is memory mapped.
+// Layout (native byte order):
+//   char[8]  magic "CVDNNW01"
+//   uint32   byte order mark 0x01020304
+//   uint32   number of layers
+//   for every layer:
+//     uint32 name length, name characters, uint32 number of blobs
+//     for every blob: int32 type, int32 dims, int32 sizes[dims], uint64 data offset
+//   blobs data
+
+typedef std::map<String, std::vector<Mat> > LayersBlobs;
+
+// Returns true if file at the specified path starts with the native weights magic.
+bool isNativeWeightsFile(const String& path);
+
+// Maps the file into memory. Returned blobs reference the mapped memory which
+// is released with the last of them. The mapping is private (copy-on-write),
+// so blobs may be modified.
+void readNativeWeights(const String& path, LayersBlobs& layersBlobs);
+
+void writeNativeWeights(const String& path, const LayersBlobs& layersBlobs);
+
+}  // namespace dnn
+}  // namespace cv
+
+#endif  // __OPENCV_DNN_NATIVE_WEIGHTS_HPP__
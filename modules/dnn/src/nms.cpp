@@ -16,9 +16,14 @@ namespace dnn
 {
 CV__DNN_EXPERIMENTAL_NS_BEGIN
 
-static inline float rectOverlap(const Rect& a, const Rect& b)
+static void rectsToSoA(const std::vector<Rect>& bboxes, BoxesSoA& boxes)
 {
-    return 1.f - static_cast<float>(jaccardDistance(a, b));
+    boxes.resize(bboxes.size());
+    for (size_t i = 0; i < bboxes.size(); ++i)
+    {
+        const Rect& r = bboxes[i];
+        boxes.set(i, (float)r.x, (float)r.y, (float)r.x + r.width, (float)r.y + r.height, (float)r.area());
+    }
 }
 
 void NMSBoxes(const std::vector<Rect>& bboxes, const std::vector<float>& scores,
@@ -27,7 +32,108 @@ void NMSBoxes(const std::vector<Rect>& bboxes, const std::vector<float>& scores,
 {
     CV_Assert(bboxes.size() == scores.size(), score_threshold >= 0,
         nms_threshold >= 0, eta > 0);
-    NMSFast_(bboxes, scores, score_threshold, nms_threshold, eta, top_k, indices, rectOverlap);
+    BoxesSoA boxes;
+    rectsToSoA(bboxes, boxes);
+    // Equal to rectOverlap: empty boxes are the same, intersection has no offset.
+    NMSFastSoA_(boxes, scores, score_threshold, nms_threshold, eta, top_k, indices, 0.f, 1.f);
+}
+
+namespace
+{
+
+class NMSBatchedInvoker : public ParallelLoopBody
+{
+public:
+    NMSBatchedInvoker(const BoxesSoA& boxes, const std::vector<float>& scores,
+                      const std::vector<std::vector<int> >& classIndices,
+                      float score_threshold, float nms_threshold, float eta, int top_k,
+                      std::vector<std::vector<int> >& classKept)
+        : boxes_(boxes), scores_(scores), classIndices_(classIndices),
+          score_threshold_(score_threshold), nms_threshold_(nms_threshold),
+          eta_(eta), top_k_(top_k), classKept_(classKept)
+    {}
+
+    void operator()(const Range& r) const CV_OVERRIDE
+    {
+        BoxesSoA classBoxes;
+        std::vector<float> classScores;
+        for (int c = r.start; c < r.end; ++c)
+        {
+            const std::vector<int>& ids = classIndices_[c];
+            classBoxes = BoxesSoA();
+            classScores.resize(ids.size());
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                classBoxes.push_back(boxes_, ids[i]);
+                classScores[i] = scores_[ids[i]];
+            }
+            std::vector<int>& kept = classKept_[c];
+            NMSFastSoA_(classBoxes, classScores, score_threshold_, nms_threshold_,
+                        eta_, top_k_, kept, 0.f, 1.f);
+            for (size_t i = 0; i < kept.size(); ++i)
+                kept[i] = ids[kept[i]];
+        }
+    }
+
+private:
+    const BoxesSoA& boxes_;
+    const std::vector<float>& scores_;
+    const std::vector<std::vector<int> >& classIndices_;
+    float score_threshold_, nms_threshold_, eta_;
+    int top_k_;
+    std::vector<std::vector<int> >& classKept_;
+};
+
+}  // namespace
+
+void NMSBoxesBatched(const std::vector<Rect>& bboxes, const std::vector<float>& scores,
+                     const std::vector<int>& class_ids,
+                     const float score_threshold, const float nms_threshold,
+                     std::vector<int>& indices, const float eta, const int top_k)
+{
+    CV_Assert(bboxes.size() == scores.size(), bboxes.size() == class_ids.size(),
+        score_threshold >= 0, nms_threshold >= 0, eta > 0);
+    indices.clear();
+
+    // Group candidates by classes. Low-scored boxes are skipped at once.
+    std::map<int, int> classes;
+    std::vector<std::vector<int> > classIndices;
+    for (size_t i = 0; i < bboxes.size(); ++i)
+    {
+        if (!(scores[i] > score_threshold))
+            continue;
+        std::map<int, int>::iterator it = classes.find(class_ids[i]);
+        if (it == classes.end())
+        {
+            it = classes.insert(std::make_pair(class_ids[i], (int)classIndices.size())).first;
+            classIndices.push_back(std::vector<int>());
+        }
+        classIndices[it->second].push_back((int)i);
+    }
+    if (classIndices.empty())
+        return;
+
+    BoxesSoA boxes;
+    rectsToSoA(bboxes, boxes);
+
+    std::vector<std::vector<int> > classKept(classIndices.size());
+    NMSBatchedInvoker invoker(boxes, scores, classIndices, score_threshold, nms_threshold,
+                              eta, top_k, classKept);
+    parallel_for_(Range(0, (int)classIndices.size()), invoker);
+
+    // Merge per-class results in descending order of scores.
+    std::vector<std::pair<float, int> > scoreIndexPairs;
+    for (size_t c = 0; c < classKept.size(); ++c)
+    {
+        for (size_t i = 0; i < classKept[c].size(); ++i)
+            scoreIndexPairs.push_back(std::make_pair(scores[classKept[c][i]], classKept[c][i]));
+    }
+    std::stable_sort(scoreIndexPairs.begin(), scoreIndexPairs.end(), SortScorePairDescend<int>);
+    if (top_k > 0 && top_k < (int)scoreIndexPairs.size())
+        scoreIndexPairs.resize(top_k);
+    indices.resize(scoreIndexPairs.size());
+    for (size_t i = 0; i < scoreIndexPairs.size(); ++i)
+        indices[i] = scoreIndexPairs[i].second;
 }
 
 static inline float rotatedRectIOU(const RotatedRect& a, const RotatedRect& b)
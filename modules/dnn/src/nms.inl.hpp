@@ -9,6 +9,8 @@
 #define OPENCV_DNN_NMS_INL_HPP
 
 #include <opencv2/dnn.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <functional>
 
 namespace cv {
 namespace dnn {
@@ -43,15 +45,34 @@ inline void GetMaxScoreIndex(const std::vector<float>& scores, const float thres
         }
     }
 
-    // Sort the score pair according to the scores in descending order
-    std::stable_sort(score_index_vec.begin(), score_index_vec.end(),
-                     SortScorePairDescend<int>);
-
-    // Keep top_k scores if needed.
+    // Select top_k scores before sorting. Candidates with the same score as
+    // the top_k-th one are kept in the order of indices (as stable_sort does).
     if (top_k > 0 && top_k < (int)score_index_vec.size())
     {
-        score_index_vec.resize(top_k);
+        std::vector<float> topScores(score_index_vec.size());
+        for (size_t i = 0; i < score_index_vec.size(); ++i)
+            topScores[i] = score_index_vec[i].first;
+        std::nth_element(topScores.begin(), topScores.begin() + top_k - 1, topScores.end(),
+                         std::greater<float>());
+        const float minScore = topScores[top_k - 1];
+        int numGreater = 0;
+        for (int i = 0; i < top_k; ++i)
+            numGreater += topScores[i] > minScore;
+
+        int numEqual = top_k - numGreater;
+        size_t j = 0;
+        for (size_t i = 0; i < score_index_vec.size(); ++i)
+        {
+            float score = score_index_vec[i].first;
+            if (score > minScore || (score == minScore && numEqual-- > 0))
+                score_index_vec[j++] = score_index_vec[i];
+        }
+        score_index_vec.resize(j);
     }
+
+    // Sort the score pair according to the scores in descending order
+    std::stable_sort(score_index_vec.begin(), score_index_vec.end(),
+                     SortScorePairDescend<int>);
 }
 
 // Do non maximum suppression given bboxes and scores.
@@ -94,6 +115,105 @@ inline void NMSFast_(const std::vector<BoxType>& bboxes,
     }
 }
 
+// Axis-aligned boxes stored as a structure of arrays.
+struct BoxesSoA
+{
+    std::vector<float> x1, y1, x2, y2, area;
+
+    void resize(size_t n)
+    {
+        x1.resize(n); y1.resize(n); x2.resize(n); y2.resize(n); area.resize(n);
+    }
+
+    void set(size_t i, float xmin, float ymin, float xmax, float ymax, float area_)
+    {
+        x1[i] = xmin; y1[i] = ymin; x2[i] = xmax; y2[i] = ymax; area[i] = area_;
+    }
+
+    void push_back(const BoxesSoA& src, size_t i)
+    {
+        x1.push_back(src.x1[i]); y1.push_back(src.y1[i]);
+        x2.push_back(src.x2[i]); y2.push_back(src.y2[i]);
+        area.push_back(src.area[i]);
+    }
+
+    size_t size() const { return area.size(); }
+};
+
+// Checks if any of boxes has an overlap greater than threshold with the given box.
+// Intersection of boxes has (x2 - x1 + offset) * (y2 - y1 + offset) area if x2 >= x1 and y2 >= y1.
+// Boxes with zero total area have emptyOverlap overlap.
+inline bool HasOverlap(const BoxesSoA& boxes, float x1, float y1, float x2, float y2, float area,
+                       float threshold, float offset, float emptyOverlap)
+{
+    const int n = (int)boxes.size();
+    const float *bx1 = boxes.x1.empty() ? 0 : &boxes.x1[0], *by1 = boxes.y1.empty() ? 0 : &boxes.y1[0];
+    const float *bx2 = boxes.x2.empty() ? 0 : &boxes.x2[0], *by2 = boxes.y2.empty() ? 0 : &boxes.y2[0];
+    const float *barea = boxes.area.empty() ? 0 : &boxes.area[0];
+    int k = 0;
+#if CV_SIMD128
+    v_float32x4 vx1 = v_setall_f32(x1), vy1 = v_setall_f32(y1);
+    v_float32x4 vx2 = v_setall_f32(x2), vy2 = v_setall_f32(y2);
+    v_float32x4 varea = v_setall_f32(area), vthr = v_setall_f32(threshold);
+    v_float32x4 voffset = v_setall_f32(offset), vempty = v_setall_f32(emptyOverlap);
+    v_float32x4 vzero = v_setzero_f32(), veps = v_setall_f32(FLT_EPSILON);
+    for (; k <= n - 4; k += 4)
+    {
+        v_float32x4 dw = v_min(vx2, v_load(bx2 + k)) - v_max(vx1, v_load(bx1 + k));
+        v_float32x4 dh = v_min(vy2, v_load(by2 + k)) - v_max(vy1, v_load(by1 + k));
+        v_float32x4 inter = (dw + voffset) * (dh + voffset);
+        inter = v_select((dw >= vzero) & (dh >= vzero), inter, vzero);
+        v_float32x4 sumArea = varea + v_load(barea + k);
+        v_float32x4 overlap = v_select(inter > vzero, inter / (sumArea - inter),
+                                       v_select(sumArea <= veps, vempty, vzero));
+        if (v_check_any(overlap > vthr))
+            return true;
+    }
+#endif
+    for (; k < n; ++k)
+    {
+        float dw = std::min(x2, bx2[k]) - std::max(x1, bx1[k]);
+        float dh = std::min(y2, by2[k]) - std::max(y1, by1[k]);
+        float inter = dw >= 0 && dh >= 0 ? (dw + offset) * (dh + offset) : 0.f;
+        float sumArea = area + barea[k];
+        float overlap = inter > 0 ? inter / (sumArea - inter) : (sumArea <= FLT_EPSILON ? emptyOverlap : 0.f);
+        if (overlap > threshold)
+            return true;
+    }
+    return false;
+}
+
+// The same as NMSFast_ but for axis-aligned boxes. Coordinates of already kept boxes
+// are stored contiguously so a candidate is compared with several of them at once.
+// See HasOverlap for offset and emptyOverlap.
+inline void NMSFastSoA_(const BoxesSoA& bboxes,
+      const std::vector<float>& scores, const float score_threshold,
+      const float nms_threshold, const float eta, const int top_k,
+      std::vector<int>& indices, float offset, float emptyOverlap)
+{
+    CV_Assert(bboxes.size() == scores.size());
+
+    std::vector<std::pair<float, int> > score_index_vec;
+    GetMaxScoreIndex(scores, score_threshold, top_k, score_index_vec);
+
+    float adaptive_threshold = nms_threshold;
+    indices.clear();
+    BoxesSoA kept;
+    for (size_t i = 0; i < score_index_vec.size(); ++i) {
+        const int idx = score_index_vec[i].second;
+        bool keep = !HasOverlap(kept, bboxes.x1[idx], bboxes.y1[idx], bboxes.x2[idx], bboxes.y2[idx],
+                                bboxes.area[idx], adaptive_threshold, offset, emptyOverlap);
+        if (keep)
+        {
+            indices.push_back(idx);
+            kept.push_back(bboxes, idx);
+        }
+        if (keep && eta < 1 && adaptive_threshold > 0.5) {
+          adaptive_threshold *= eta;
+        }
+    }
+}
+
 }// dnn
 }// cv
 
@@ -319,6 +319,28 @@ TEST(Reproducibility_AlexNet_fp16, Accuracy)
     normAssert(ref, out, "", l1, lInf);
 }
 
+TEST(Reproducibility_AlexNet_native, Accuracy)
+{
+    const string proto = findDataFile("dnn/bvlc_alexnet.prototxt", false);
+    const string model = findDataFile("dnn/bvlc_alexnet.caffemodel", false);
+
+    const string nativeModel = cv::tempfile(".cvdnn");
+    convertCaffeModelToNative(model, nativeModel);
+    {
+        // the weights file stays mapped while the network is alive
+        Net net = readNetFromCaffe(proto, nativeModel);
+        net.setPreferableBackend(DNN_BACKEND_OPENCV);
+
+        Mat sample = imread(findDataFile("dnn/grace_hopper_227.png", false));
+
+        net.setInput(blobFromImage(sample, 1.0f, Size(227, 227), Scalar(), false));
+        Mat out = net.forward();
+        Mat ref = blobFromNPY(findDataFile("dnn/caffe_alexnet_prob.npy", false));
+        normAssert(ref, out);
+    }
+    remove(nativeModel.c_str());
+}
+
 TEST(Reproducibility_GoogLeNet_fp16, Accuracy)
 {
     const float l1 = 1e-5;
@@ -519,6 +519,102 @@ TEST_F(Layer_RNN_Test, get_set_test)
     EXPECT_EQ(shape(outputs[1]), shape(nT, nS, nH));
 }
 
+static Mat sigmoidRef(const Mat& m)
+{
+    Mat res;
+    exp(-m, res);
+    return 1.0 / (1.0 + res);
+}
+
+static Mat tanhRef(const Mat& m)
+{
+    Mat res = m.clone();
+    for (MatIterator_<float> it = res.begin<float>(); it != res.end<float>(); ++it)
+        *it = std::tanh(*it);
+    return res;
+}
+
+TEST(Layer_LSTM_Test_Accuracy_with_, Reference)
+{
+    const int numTs = 4, numSamples = 3, numInp = 5, numOut = 7;
+    const float forgetBias = 0.5f, cellClip = 0.9f;
+    Mat Wh(4 * numOut, numOut, CV_32F), Wx(4 * numOut, numInp, CV_32F), b(1, 4 * numOut, CV_32F);
+    randu(Wh, -1.f, 1.f);
+    randu(Wx, -1.f, 1.f);
+    randu(b, -1.f, 1.f);
+
+    LayerParams lp;
+    lp.blobs.push_back(Wh);
+    lp.blobs.push_back(Wx);
+    lp.blobs.push_back(b);
+    lp.set("produce_cell_output", true);
+    lp.set("forget_bias", forgetBias);
+    lp.set("use_cell_clip", true);
+    lp.set("cell_clip", cellClip);
+    Ptr<LSTMLayer> layer = LSTMLayer::create(lp);
+
+    int inpShape[] = {numTs, numSamples, numInp};
+    Mat inp(3, inpShape, CV_32F);
+    randu(inp, -1.f, 1.f);
+    std::vector<Mat> inputs(1, inp), outputs;
+    runLayer(layer, inputs, outputs);
+    ASSERT_EQ(2u, outputs.size());
+
+    Mat h = Mat::zeros(numSamples, numOut, CV_32F), c = h.clone();
+    Mat x = inp.reshape(1, numTs * numSamples);
+    Mat hOut = outputs[0].reshape(1, numTs * numSamples);
+    Mat cOut = outputs[1].reshape(1, numTs * numSamples);
+    for (int ts = 0; ts < numTs; ts++)
+    {
+        Range rows(ts * numSamples, (ts + 1) * numSamples);
+        Mat gates = x.rowRange(rows) * Wx.t() + h * Wh.t() + repeat(b, numSamples, 1);
+        Mat i = sigmoidRef(gates.colRange(0, numOut));
+        Mat f = sigmoidRef(gates.colRange(numOut, 2 * numOut) + forgetBias);
+        Mat o = sigmoidRef(gates.colRange(2 * numOut, 3 * numOut));
+        Mat g = tanhRef(gates.colRange(3 * numOut, 4 * numOut));
+        c = f.mul(c) + i.mul(g);
+        c = cv::max(cv::min(c, cellClip), -cellClip);
+        h = o.mul(tanhRef(c));
+        normAssert(h, hOut.rowRange(rows), "h");
+        normAssert(c, cOut.rowRange(rows), "c");
+    }
+}
+
+TEST(Layer_RNN_Test_Accuracy_with_, Reference)
+{
+    const int nT = 4, nS = 3, nX = 5, nH = 7, nO = 6;
+    Mat Wxh(nH, nX, CV_32F), bh(1, nH, CV_32F), Whh(nH, nH, CV_32F), Who(nO, nH, CV_32F), bo(1, nO, CV_32F);
+    randu(Wxh, -1.f, 1.f);
+    randu(bh, -1.f, 1.f);
+    randu(Whh, -1.f, 1.f);
+    randu(Who, -1.f, 1.f);
+    randu(bo, -1.f, 1.f);
+
+    Ptr<RNNLayer> layer = RNNLayer::create(LayerParams());
+    layer->setProduceHiddenOutput(true);
+    layer->setWeights(Wxh, bh, Whh, Who, bo);
+
+    int inpShape[] = {nT, nS, nX};
+    Mat inp(3, inpShape, CV_32F);
+    randu(inp, -1.f, 1.f);
+    std::vector<Mat> inputs(1, inp), outputs;
+    runLayer(layer, inputs, outputs);
+    ASSERT_EQ(2u, outputs.size());
+
+    Mat h = Mat::zeros(nS, nH, CV_32F);
+    Mat x = inp.reshape(1, nT * nS);
+    Mat oOut = outputs[0].reshape(1, nT * nS);
+    Mat hOut = outputs[1].reshape(1, nT * nS);
+    for (int ts = 0; ts < nT; ts++)
+    {
+        Range rows(ts * nS, (ts + 1) * nS);
+        h = tanhRef(h * Whh.t() + x.rowRange(rows) * Wxh.t() + repeat(bh, nS, 1));
+        Mat o = tanhRef(h * Who.t() + repeat(bo, nS, 1));
+        normAssert(h, hOut.rowRange(rows), "h");
+        normAssert(o, oOut.rowRange(rows), "o");
+    }
+}
+
 TEST(Layer_Test_ROIPooling, Accuracy)
 {
     Net net = readNetFromCaffe(_tf("net_roi_pooling.prototxt"));
@@ -914,6 +1010,408 @@ TEST_P(Layer_Test_DWconv_Prelu, Accuracy)
 }
 INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_DWconv_Prelu, Combine(Values(3, 6), Values(3, 6)));
 
+// Depthwise convolution with a following ReLU against a naive implementation.
+typedef TestWithParam<tuple<int, int, int, int, int> > Layer_Test_DWconv;
+TEST_P(Layer_Test_DWconv, Accuracy)
+{
+    const int kernel = get<0>(GetParam());
+    const int stride = get<1>(GetParam());
+    const int pad = get<2>(GetParam());
+    const int dilation = get<3>(GetParam());
+    const int width = get<4>(GetParam());
+    const int inpShape[] = {2, 5, 9, width};
+    const int channels = inpShape[1];
+
+    int weightsShape[] = {channels, 1, kernel, kernel};
+    Mat weights(4, &weightsShape[0], CV_32F), bias(1, channels, CV_32F);
+    randu(weights, -1.0f, 1.0f);
+    randu(bias, -1.0f, 1.0f);
+
+    Net net;
+    {
+        LayerParams lp;
+        lp.set("kernel_size", kernel);
+        lp.set("stride", stride);
+        lp.set("pad", pad);
+        lp.set("dilation", dilation);
+        lp.set("num_output", channels);
+        lp.set("group", channels);
+        lp.set("bias_term", true);
+        lp.type = "Convolution";
+        lp.name = "testDWConv";
+        lp.blobs.push_back(weights);
+        lp.blobs.push_back(bias);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    {
+        LayerParams lp;
+        lp.set("negative_slope", 0.1f);
+        lp.type = "ReLU";
+        lp.name = "testReLU";
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+
+    Mat input(4, &inpShape[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    const int kextent = (kernel - 1) * dilation + 1;
+    const int outH = (inpShape[2] + 2 * pad - kextent) / stride + 1;
+    const int outW = (inpShape[3] + 2 * pad - kextent) / stride + 1;
+    int outShape[] = {inpShape[0], channels, outH, outW};
+    Mat ref(4, &outShape[0], CV_32F);
+    for (int n = 0; n < inpShape[0]; ++n)
+    {
+        for (int c = 0; c < channels; ++c)
+        {
+            const float* w = weights.ptr<float>(c);
+            for (int y = 0; y < outH; ++y)
+            {
+                for (int x = 0; x < outW; ++x)
+                {
+                    float s = bias.at<float>(c);
+                    for (int ky = 0; ky < kernel; ++ky)
+                    {
+                        for (int kx = 0; kx < kernel; ++kx)
+                        {
+                            int iy = y * stride - pad + ky * dilation;
+                            int ix = x * stride - pad + kx * dilation;
+                            if (0 <= iy && iy < inpShape[2] && 0 <= ix && ix < inpShape[3])
+                            {
+                                int idx[] = {n, c, iy, ix};
+                                s += input.at<float>(idx) * w[ky * kernel + kx];
+                            }
+                        }
+                    }
+                    int idx[] = {n, c, y, x};
+                    ref.at<float>(idx) = s > 0 ? s : 0.1f * s;
+                }
+            }
+        }
+    }
+
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    Mat out = net.forward();
+    normAssert(ref, out, "", 1e-5, 1e-4);
+}
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_DWconv, Combine(
+/*kernel*/   Values(1, 3, 5),
+/*stride*/   Values(1, 2),
+/*pad*/      Values(0, 2),
+/*dilation*/ Values(1, 2),
+/*width*/    Values(14)
+));
+// the input is narrower than the kernel, no output column has the whole kernel row inside
+INSTANTIATE_TEST_CASE_P(Narrow, Layer_Test_DWconv, Combine(
+/*kernel*/   Values(3, 5),
+/*stride*/   Values(1),
+/*pad*/      Values(2),
+/*dilation*/ Values(1),
+/*width*/    Values(2, 3, 4)
+));
+
+// Softmax over different axes against a naive implementation.
+typedef TestWithParam<tuple<int, bool> > Layer_Test_Softmax;
+TEST_P(Layer_Test_Softmax, Accuracy)
+{
+    const int axis = get<0>(GetParam());
+    const bool logSoftMax = get<1>(GetParam());
+    // inner size is not a multiple of vector and block sizes
+    const int inpShape[] = {2, 7, 19, 17};
+
+    Mat input(4, &inpShape[0], CV_32F);
+    randu(input, -10.0f, 10.0f);
+
+    const size_t outerSize = input.total(0, axis), channels = input.size[axis],
+                 innerSize = input.total(axis + 1);
+    Mat ref(4, &inpShape[0], CV_32F);
+    const float* src = input.ptr<float>();
+    float* dst = ref.ptr<float>();
+    for (size_t i = 0; i < outerSize; ++i)
+    {
+        for (size_t j = 0; j < innerSize; ++j)
+        {
+            const size_t ofs = i * channels * innerSize + j;
+            double maxVal = src[ofs], sum = 0;
+            for (size_t c = 1; c < channels; ++c)
+                maxVal = std::max(maxVal, (double)src[ofs + c * innerSize]);
+            for (size_t c = 0; c < channels; ++c)
+                sum += std::exp(src[ofs + c * innerSize] - maxVal);
+            for (size_t c = 0; c < channels; ++c)
+            {
+                double v = src[ofs + c * innerSize] - maxVal;
+                dst[ofs + c * innerSize] = (float)(logSoftMax ? v - std::log(sum) : std::exp(v) / sum);
+            }
+        }
+    }
+
+    LayerParams lp;
+    lp.set("axis", axis);
+    lp.set("log_softmax", logSoftMax);
+    lp.type = "Softmax";
+    lp.name = "testSoftmax";
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    Mat out = net.forward();
+    normAssert(ref, out, "", 1e-6, logSoftMax ? 1e-5 : 1e-6);
+}
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_Softmax, Combine(Values(1, 2, 3), testing::Bool()));
+
+// Permute with all orders of 4D blob against a naive implementation.
+typedef TestWithParam<int> Layer_Test_Permute;
+TEST_P(Layer_Test_Permute, Accuracy)
+{
+    int order[] = {0, 1, 2, 3};
+    for (int i = 0; i < GetParam(); ++i)
+        std::next_permutation(order, order + 4);
+    const int inpShape[] = {2, 35, 6, 37};
+
+    Mat input(4, &inpShape[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    int outShape[4];
+    for (int i = 0; i < 4; ++i)
+        outShape[i] = inpShape[order[i]];
+    Mat ref(4, &outShape[0], CV_32F);
+    int idx[4], inpIdx[4];
+    for (idx[0] = 0; idx[0] < outShape[0]; ++idx[0])
+        for (idx[1] = 0; idx[1] < outShape[1]; ++idx[1])
+            for (idx[2] = 0; idx[2] < outShape[2]; ++idx[2])
+                for (idx[3] = 0; idx[3] < outShape[3]; ++idx[3])
+                {
+                    for (int i = 0; i < 4; ++i)
+                        inpIdx[order[i]] = idx[i];
+                    ref.at<float>(idx) = input.at<float>(inpIdx);
+                }
+
+    LayerParams lp;
+    lp.set("order", DictValue::arrayInt(order, 4));
+    lp.type = "Permute";
+    lp.name = "testPermute";
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    Mat out = net.forward();
+    normAssert(ref, out, "", 0, 0);
+}
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_Permute, testing::Range(0, 24));
+
+// LRN across and within channels against a naive implementation.
+typedef TestWithParam<tuple<std::string, int, bool> > Layer_Test_LRN;
+TEST_P(Layer_Test_LRN, Accuracy)
+{
+    const std::string region = get<0>(GetParam());
+    const int size = get<1>(GetParam());
+    const bool normBySize = get<2>(GetParam());
+    const float alpha = 0.5f, beta = 0.75f, bias = 2.0f;
+    const int inpShape[] = {2, 17, 9, 11};
+    const int channels = inpShape[1], height = inpShape[2], width = inpShape[3];
+    const int k = size / 2;
+
+    Mat input(4, &inpShape[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    Mat ref(4, &inpShape[0], CV_32F);
+    const bool acrossChannels = region == "ACROSS_CHANNELS";
+    const float alphaSize = alpha / (normBySize ? (acrossChannels ? size : size * size) : 1);
+    for (int n = 0; n < inpShape[0]; ++n)
+        for (int c = 0; c < channels; ++c)
+            for (int y = 0; y < height; ++y)
+                for (int x = 0; x < width; ++x)
+                {
+                    double sum = 0;
+                    if (acrossChannels)
+                    {
+                        for (int i = std::max(c - k, 0); i <= std::min(c + k, channels - 1); ++i)
+                            sum += std::pow(input.ptr<float>(n, i, y)[x], 2);
+                    }
+                    else
+                    {
+                        for (int i = std::max(y - k, 0); i <= std::min(y + k, height - 1); ++i)
+                            for (int j = std::max(x - k, 0); j <= std::min(x + k, width - 1); ++j)
+                                sum += std::pow(input.ptr<float>(n, c, i)[j], 2);
+                    }
+                    ref.ptr<float>(n, c, y)[x] = (float)(input.ptr<float>(n, c, y)[x] /
+                                                         std::pow(bias + alphaSize * sum, beta));
+                }
+
+    LayerParams lp;
+    lp.set("norm_region", region);
+    lp.set("local_size", size);
+    lp.set("alpha", alpha);
+    lp.set("beta", beta);
+    lp.set("bias", bias);
+    lp.set("norm_by_size", normBySize);
+    lp.type = "LRN";
+    lp.name = "testLRN";
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    Mat out = net.forward();
+    normAssert(ref, out, "", 1e-6, 1e-5);
+}
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_LRN, Combine(
+    Values("ACROSS_CHANNELS", "WITHIN_CHANNEL"), Values(3, 5), testing::Bool()
+));
+
+// Nearest and bilinear Resize (up and down) against a naive implementation.
+typedef TestWithParam<tuple<std::string, Vec2i> > Layer_Test_Resize;
+TEST_P(Layer_Test_Resize, Accuracy)
+{
+    const std::string interpolation = get<0>(GetParam());
+    const int outHeight = get<1>(GetParam())[0], outWidth = get<1>(GetParam())[1];
+    const int inpShape[] = {2, 3, 7, 9};
+    const int inpHeight = inpShape[2], inpWidth = inpShape[3];
+
+    Mat input(4, &inpShape[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    const int outShape[] = {inpShape[0], inpShape[1], outHeight, outWidth};
+    Mat ref(4, &outShape[0], CV_32F);
+    const float scaleHeight = static_cast<float>(inpHeight) / outHeight;
+    const float scaleWidth = static_cast<float>(inpWidth) / outWidth;
+    for (int n = 0; n < outShape[0]; ++n)
+        for (int c = 0; c < outShape[1]; ++c)
+            for (int y = 0; y < outHeight; ++y)
+                for (int x = 0; x < outWidth; ++x)
+                {
+                    float& dst = ref.ptr<float>(n, c, y)[x];
+                    if (interpolation == "nearest")
+                    {
+                        int y0 = std::min(cvFloor(y * (double)inpHeight / outHeight), inpHeight - 1);
+                        int x0 = std::min(cvFloor(x * (double)inpWidth / outWidth), inpWidth - 1);
+                        dst = input.ptr<float>(n, c, y0)[x0];
+                        continue;
+                    }
+                    float inpY = y * scaleHeight, inpX = x * scaleWidth;
+                    int y0 = static_cast<int>(inpY), x0 = static_cast<int>(inpX);
+                    int y1 = std::min(y0 + 1, inpHeight - 1), x1 = std::min(x0 + 1, inpWidth - 1);
+                    float dy = inpY - y0, dx = inpX - x0;
+                    const float* row0 = input.ptr<float>(n, c, y0);
+                    const float* row1 = input.ptr<float>(n, c, y1);
+                    dst = (1 - dy) * ((1 - dx) * row0[x0] + dx * row0[x1]) +
+                          dy * ((1 - dx) * row1[x0] + dx * row1[x1]);
+                }
+
+    LayerParams lp;
+    lp.set("interpolation", interpolation);
+    lp.set("height", outHeight);
+    lp.set("width", outWidth);
+    lp.type = "Resize";
+    lp.name = "testResize";
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    Mat out = net.forward();
+    normAssert(ref, out, "", 1e-6, 1e-5);
+}
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_Resize, Combine(
+    Values("nearest", "bilinear"), Values(Vec2i(13, 17), Vec2i(5, 4), Vec2i(14, 18), Vec2i(7, 20))
+));
+
+// weightsDepth is the depth of the weights kept by the layer, weights are returned by getParam().
+static Mat forwardWithWeightsPrecision(const std::vector<LayerParams>& layers, const Mat& input,
+                                       const std::string& precision, int& weightsDepth, Mat& weights)
+{
+    Net net;
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+        LayerParams lp = layers[i];
+        lp.set("weights_precision", precision);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    Mat out = net.forward().clone();
+    const int id = net.getLayerId(layers[0].name);
+    weightsDepth = net.getLayer(id)->blobs[0].depth();
+    weights = net.getParam(id, 0);
+    return out;
+}
+
+// Convolution (regular, depthwise, fused with Scale) and InnerProduct layers with
+// FP16 and BF16 weights against FP32 ones.
+typedef TestWithParam<tuple<std::string, int> > Layer_Test_WeightsPrecision;
+TEST_P(Layer_Test_WeightsPrecision, Accuracy)
+{
+    const std::string precision = get<0>(GetParam());
+    const int testCase = get<1>(GetParam());
+    const int inpCn = 5;
+    int outCn = testCase == 1 ? inpCn : 12;
+
+    LayerParams lp;
+    lp.name = "testLayer";
+    if (testCase == 2)
+    {
+        lp.type = "InnerProduct";
+        lp.set("num_output", outCn);
+        Mat weights(outCn, inpCn*7*7, CV_32F);
+        randu(weights, -1.0f, 1.0f);
+        lp.blobs.push_back(weights);
+    }
+    else
+    {
+        const int group = testCase == 1 ? inpCn : 1;
+        lp.type = "Convolution";
+        lp.set("kernel_size", 3);
+        lp.set("pad", 1);
+        lp.set("num_output", outCn);
+        lp.set("group", group);
+        const int weightsShape[] = {outCn, inpCn / group, 3, 3};
+        Mat weights(4, &weightsShape[0], CV_32F);
+        randu(weights, -1.0f, 1.0f);
+        lp.blobs.push_back(weights);
+    }
+    Mat bias(1, outCn, CV_32F);
+    randu(bias, -1.0f, 1.0f);
+    lp.blobs.push_back(bias);
+
+    std::vector<LayerParams> layers(1, lp);
+    if (testCase == 3)
+    {
+        LayerParams scale;
+        scale.name = "testScale";
+        scale.type = "Scale";
+        Mat weights(1, outCn, CV_32F);
+        randu(weights, 0.5f, 2.0f);
+        scale.blobs.push_back(weights);
+        layers.push_back(scale);
+    }
+
+    const int inpShape[] = {2, inpCn, 7, 7};
+    Mat input(4, &inpShape[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    int depth = -1;
+    Mat weights;
+    Mat ref = forwardWithWeightsPrecision(layers, input, "FP32", depth, weights);
+    ASSERT_EQ(CV_32F, depth);
+
+    Mat out = forwardWithWeightsPrecision(layers, input, precision, depth, weights);
+    EXPECT_EQ(precision == "FP16" ? CV_16S : CV_16U, depth);
+    const double maxRef = cvtest::norm(ref, NORM_INF);
+    const double lInf = (precision == "FP16" ? 1e-3 : 1e-2) * maxRef;
+    normAssert(ref, out, precision.c_str(), 0.25 * lInf, lInf);
+
+    // getParam() expands the weights back to FP32.
+    ASSERT_EQ(CV_32F, weights.type());
+    if (testCase != 3)
+        normAssert(lp.blobs[0], weights, "getParam", 1e-2, 1e-2);
+
+    // Unknown precision falls back to FP32.
+    out = forwardWithWeightsPrecision(layers, input, "FP8", depth, weights);
+    EXPECT_EQ(CV_32F, depth);
+    normAssert(ref, out, "FP8", 0, 0);
+}
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_WeightsPrecision, Combine(
+    Values("FP16", "BF16"), Values(0, 1, 2, 3)
+));
+
 #ifdef HAVE_INF_ENGINE
 // Using Intel's Model Optimizer generate .xml and .bin files:
 // ./ModelOptimizer -w /path/to/caffemodel -d /path/to/prototxt \
@@ -1294,4 +1792,153 @@ TEST(Layer_Test_Convolution, relu_fusion)
     normAssert(input, output);
 }
 
+// input -> padding -> conv -> relu -> scale -> scale
+TEST(Layer_Test_Fusion, FoldPadding_FuseScales)
+{
+    Net net;
+    {
+        LayerParams lp;
+        lp.type = "Padding";
+        lp.name = "testPad";
+        int paddings[] = {0, 0, 0, 0, 1, 1, 2, 2};
+        lp.set("paddings", DictValue::arrayInt<int*>(&paddings[0], 8));
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    {
+        LayerParams lp;
+        lp.set("kernel_size", 3);
+        lp.set("num_output", 4);
+        lp.set("pad", 1);
+        lp.set("bias_term", false);
+        lp.type = "Convolution";
+        lp.name = "testConv";
+
+        int weightsShape[] = {4, 3, 3, 3};
+        Mat weights(4, &weightsShape[0], CV_32F);
+        randu(weights, -1.0f, 1.0f);
+        lp.blobs.push_back(weights);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    {
+        LayerParams lp;
+        lp.type = "ReLU";
+        lp.name = "testReLU";
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        LayerParams lp;
+        lp.type = "Scale";
+        lp.name = format("testScale%d", i);
+        lp.set("bias_term", true);
+        Mat weights(1, 4, CV_32F), bias(1, 4, CV_32F);
+        randu(weights, -1.0f, 1.0f);
+        randu(bias, -1.0f, 1.0f);
+        lp.blobs.push_back(weights);
+        lp.blobs.push_back(bias);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    int sz[] = {1, 3, 5, 6};
+    Mat input(4, &sz[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+
+    net.enableFusion(false);
+    Mat ref = net.forward().clone();
+    EXPECT_EQ(std::string::npos, net.dump().find("(skipped)"));
+
+    net.enableFusion(true);
+    Mat out = net.forward().clone();
+    normAssert(ref, out);
+
+    std::vector<double> timings;
+    net.getPerfProfile(timings);
+    ASSERT_EQ(5u, timings.size());
+    EXPECT_EQ(0, timings[0]);  // padding
+    EXPECT_EQ(0, timings[2]);  // relu
+    EXPECT_EQ(0, timings[4]);  // second scale
+
+    // Fusion is reverted.
+    net.enableFusion(false);
+    out = net.forward();
+    normAssert(ref, out);
+}
+
+// input -> conv -> split -> relu    -> eltwise
+//                        -> reshape -> reshape -^
+TEST(Layer_Test_Fusion, SkipViewLayers)
+{
+    Net net;
+    {
+        LayerParams lp;
+        lp.set("kernel_size", 1);
+        lp.set("num_output", 2);
+        lp.set("bias_term", false);
+        lp.type = "Convolution";
+        lp.name = "testConv";
+
+        int weightsShape[] = {2, 2, 1, 1};
+        Mat weights(4, &weightsShape[0], CV_32F);
+        randu(weights, -1.0f, 1.0f);
+        lp.blobs.push_back(weights);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    {
+        LayerParams lp;
+        lp.type = "Split";
+        lp.name = "testSplit";
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    int splitId = net.getLayerId("testSplit"), reluId, reshapeId;
+    {
+        LayerParams lp;
+        lp.type = "ReLU";
+        lp.name = "testReLU";
+        reluId = net.addLayer(lp.name, lp.type, lp);
+        net.connect(splitId, 0, reluId, 0);
+    }
+    {
+        LayerParams lp;
+        lp.type = "Reshape";
+        lp.name = "testReshape0";
+        int newShape[] = {1, 2, 12};
+        lp.set("dim", DictValue::arrayInt<int*>(&newShape[0], 3));
+        int id = net.addLayer(lp.name, lp.type, lp);
+        net.connect(splitId, 1, id, 0);
+
+        lp.name = "testReshape1";
+        int origShape[] = {1, 2, 3, 4};
+        lp.set("dim", DictValue::arrayInt<int*>(&origShape[0], 4));
+        reshapeId = net.addLayer(lp.name, lp.type, lp);
+        net.connect("testReshape0", lp.name);
+    }
+    {
+        LayerParams lp;
+        lp.type = "Eltwise";
+        lp.name = "testEltwise";
+        int id = net.addLayer(lp.name, lp.type, lp);
+        net.connect(reluId, 0, id, 0);
+        net.connect(reshapeId, 0, id, 1);
+    }
+    int sz[] = {1, 2, 3, 4};
+    Mat input(4, &sz[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+    net.setInput(input);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+
+    net.enableFusion(false);
+    Mat ref = net.forward().clone();
+
+    net.enableFusion(true);
+    Mat out = net.forward().clone();
+    normAssert(ref, out);
+
+    std::vector<double> timings;
+    net.getPerfProfile(timings);
+    EXPECT_EQ(0, timings[net.getLayerId("testSplit") - 1]);
+    EXPECT_EQ(0, timings[net.getLayerId("testReshape0") - 1]);
+    EXPECT_EQ(0, timings[net.getLayerId("testReshape1") - 1]);
+}
+
 }} // namespace
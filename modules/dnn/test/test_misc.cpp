@@ -8,6 +8,7 @@
 #include "test_precomp.hpp"
 
 #include <opencv2/dnn/layer.details.hpp>  // CV_DNN_REGISTER_LAYER_CLASS
+#include <opencv2/dnn/shape_utils.hpp>
 
 namespace opencv_test { namespace {
 
@@ -28,6 +29,54 @@ TEST(blobFromImage_4ch, Regression)
     }
 }
 
+TEST(blobFromImagesWithParams, Regression)
+{
+    Mat img(17, 29, CV_8UC3);
+    randu(img, 0, 256);
+    Mat roi = img(Rect(3, 2, 23, 13));
+
+    Scalar mean(10, 20, 30), std(50, 60, 70);
+    Image2BlobParams params(Scalar(1.0 / std[0], 1.0 / std[1], 1.0 / std[2]), Size(), mean, true);
+    Mat blob;
+    dnn::blobFromImagesWithParams(std::vector<Mat>(2, roi), blob, params);
+    ASSERT_EQ(shape(blob), shape(2, 3, roi.rows, roi.cols));
+
+    Mat ref;
+    roi.convertTo(ref, CV_32F);
+    std::vector<Mat> ch;
+    split(ref, ch);
+    std::swap(ch[0], ch[2]);
+    for (int n = 0; n < 2; ++n)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            Mat plane(roi.rows, roi.cols, CV_32F, blob.ptr(n, c));
+            normAssert((ch[c] - mean[c]) / std[c], plane);
+        }
+    }
+
+    // Half precision output into preallocated buffer.
+    std::vector<short> buffer(total(shape(blob)));
+    Mat blobFP16(4, blob.size.p, CV_16S, &buffer[0]);
+    params.ddepth = CV_16S;
+    dnn::blobFromImagesWithParams(std::vector<Mat>(2, roi), blobFP16, params);
+    ASSERT_EQ((void*)&buffer[0], (void*)blobFP16.data);
+    Mat blobFP32;
+    convertFp16(blobFP16, blobFP32);
+    normAssert(blob, blobFP32, "", 1e-2, 1e-2);
+}
+
+TEST(blobFromImage, swapRB_1ch_mean)
+{
+    Mat img(4, 5, CV_8UC1, Scalar(100));
+    Mat blob = dnn::blobFromImage(img, 1., Size(), Scalar(10, 20, 30), true, false);
+    ASSERT_EQ(shape(blob), shape(1, 1, 4, 5));
+    EXPECT_EQ(0, cvtest::norm(blob.reshape(1, 4), Mat(4, 5, CV_32F, Scalar(70)), NORM_INF));
+
+    blob = dnn::blobFromImage(img, 1., Size(), Scalar(10, 20, 30), false, false);
+    EXPECT_EQ(0, cvtest::norm(blob.reshape(1, 4), Mat(4, 5, CV_32F, Scalar(90)), NORM_INF));
+}
+
 TEST(blobFromImage, allocated)
 {
     int size[] = {1, 3, 4, 5};
@@ -138,4 +187,157 @@ TEST(LayerFactory, custom_layers)
     LayerFactory::unregisterLayer("CustomType");
 }
 
+TEST(Net, allocationCache)
+{
+    Net net, refNet;
+    {
+        LayerParams lp;
+        lp.set("kernel_size", 3);
+        lp.set("num_output", 2);
+        lp.set("pad", 1);
+        lp.set("bias_term", false);
+        lp.type = "Convolution";
+        lp.name = "testConv";
+
+        int weightsShape[] = {2, 3, 3, 3};
+        Mat weights(4, &weightsShape[0], CV_32F);
+        randu(weights, -1.0f, 1.0f);
+        lp.blobs.push_back(weights);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+        refNet.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    {
+        LayerParams lp;
+        lp.type = "ReLU";
+        lp.name = "testReLU";
+        net.addLayerToPrev(lp.name, lp.type, lp);
+        refNet.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    refNet.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setAllocationCacheSize(2);
+    net.preallocate(std::vector<MatShape>(1, shape(1, 3, 10, 12)));
+    net.preallocate(std::vector<MatShape>(1, shape(2, 3, 5, 7)));
+
+    Mat inputs[2];
+    inputs[0].create(shape(1, 3, 10, 12), CV_32F);
+    inputs[1].create(shape(2, 3, 5, 7), CV_32F);
+    const void* outputsData[2] = {0, 0};
+    for (int iter = 0; iter < 4; ++iter)
+    {
+        Mat& input = inputs[iter % 2];
+        randu(input, -1.0f, 1.0f);
+        net.setInput(input);
+        Mat out = net.forward();
+        refNet.setInput(input);
+        normAssert(refNet.forward(), out);
+
+        // memory is allocated once per input shape
+        if (iter < 2)
+            outputsData[iter] = out.data;
+        else
+            EXPECT_EQ(outputsData[iter % 2], (const void*)out.data);
+    }
+
+    // new weights change output shape, cached configurations must not be used
+    int weightsShape[] = {4, 3, 3, 3};
+    Mat weights(4, &weightsShape[0], CV_32F);
+    randu(weights, -1.0f, 1.0f);
+    net.setParam(net.getLayerId("testConv"), 0, weights);
+    refNet.setParam(refNet.getLayerId("testConv"), 0, weights);
+    for (int i = 0; i < 2; ++i)
+    {
+        net.setInput(inputs[i]);
+        Mat out = net.forward();
+        ASSERT_EQ(4, out.size[1]);
+        refNet.setInput(inputs[i]);
+        normAssert(refNet.forward(), out);
+    }
+}
+
+TEST(Net, profile)
+{
+    LayerParams conv;
+    conv.name = "conv";
+    conv.type = "Convolution";
+    conv.set("kernel_size", 3);
+    conv.set("num_output", 2);
+    conv.set("bias_term", false);
+    int weightsShape[] = {2, 3, 3, 3};
+    conv.blobs.push_back(Mat(4, weightsShape, CV_32F));
+    randu(conv.blobs[0], -1.0f, 1.0f);
+
+    LayerParams relu;
+    relu.name = "relu";
+    relu.type = "ReLU";
+
+    LayerParams pool;
+    pool.name = "pool";
+    pool.type = "Pooling";
+    pool.set("kernel_size", 2);
+    pool.set("stride", 2);
+
+    Net net;
+    net.addLayerToPrev(conv.name, conv.type, conv);
+    net.addLayerToPrev(relu.name, relu.type, relu);
+    net.addLayerToPrev(pool.name, pool.type, pool);
+
+    int inpShape[] = {1, 3, 8, 8};
+    Mat inp(4, inpShape, CV_32F);
+    randu(inp, -1.0f, 1.0f);
+    net.setInput(inp);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    std::vector<LayerProfile> profiles;
+    double total = net.profile(profiles, 5);
+    EXPECT_GE(total, 0);
+    ASSERT_EQ(3u, profiles.size());
+
+    const LayerProfile& p = profiles[0];
+    EXPECT_EQ("conv", p.name);
+    EXPECT_FALSE(p.fused);
+    EXPECT_EQ(0u, p.implementation.find("OCV/CPU"));
+    EXPECT_EQ(5, p.runs);
+    EXPECT_EQ(shape(1, 3, 8, 8), p.inputShapes[0]);
+    EXPECT_EQ(shape(1, 2, 6, 6), p.outputShapes[0]);
+    EXPECT_GT(p.flops, 0);
+    EXPECT_EQ(2u * 3 * 3 * 3 * sizeof(float), p.weightsMemory);
+    EXPECT_LE(p.minMs, p.medianMs);
+    EXPECT_LE(p.medianMs, p.p90Ms);
+    EXPECT_LE(p.p90Ms, p.p99Ms);
+    EXPECT_LE(p.p99Ms, p.maxMs);
+
+    EXPECT_EQ("relu", profiles[1].name);
+    EXPECT_TRUE(profiles[1].fused);
+    EXPECT_EQ(0, profiles[1].maxMs);
+
+    EXPECT_EQ("pool", profiles[2].name);
+    EXPECT_FALSE(profiles[2].fused);
+    EXPECT_EQ(shape(1, 2, 3, 3), profiles[2].outputShapes[0]);
+}
+
+TEST(Net, writePerfProfile_escaping)
+{
+    std::vector<LayerProfile> profiles(1);
+    profiles[0].id = 1;
+    profiles[0].name = "a\"b\\c\td\x01";
+    profiles[0].type = "Conv\n";
+
+    String filename = cv::tempfile(".json");
+    writePerfProfile(filename, profiles);
+    std::ifstream ifs(filename.c_str());
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    ifs.close();
+    remove(filename.c_str());
+
+    EXPECT_NE(std::string::npos, content.find("\"name\": \"a\\\"b\\\\c\\u0009d\\u0001\""));
+    EXPECT_NE(std::string::npos, content.find("\"type\": \"Conv\\u000a\""));
+    for (size_t i = 0; i < content.size(); ++i)
+    {
+        if (content[i] != '\n')
+            EXPECT_GE((unsigned char)content[i], 0x20) << i;
+    }
+}
+
 }} // namespace
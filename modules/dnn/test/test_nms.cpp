@@ -37,4 +37,76 @@ TEST(NMS, Accuracy)
         ASSERT_EQ(indices[i], ref_indices[i]);
 }
 
+static void referenceNMS(const std::vector<Rect>& bboxes, const std::vector<float>& scores,
+                         float score_thresh, float nms_thresh, int top_k, std::vector<int>& indices)
+{
+    std::vector<std::pair<float, int> > candidates;
+    for (size_t i = 0; i < scores.size(); ++i)
+        if (scores[i] > score_thresh)
+            candidates.push_back(std::make_pair(-scores[i], (int)i));
+    std::stable_sort(candidates.begin(), candidates.end());
+    if (top_k > 0 && top_k < (int)candidates.size())
+        candidates.resize(top_k);
+
+    indices.clear();
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        const Rect& box = bboxes[candidates[i].second];
+        bool keep = true;
+        for (size_t j = 0; j < indices.size() && keep; ++j)
+            keep = 1.f - (float)jaccardDistance(box, bboxes[indices[j]]) <= nms_thresh;
+        if (keep)
+            indices.push_back(candidates[i].second);
+    }
+}
+
+TEST(NMS, Random)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    const int numBoxes = 2000;
+    std::vector<Rect> bboxes(numBoxes);
+    std::vector<float> scores(numBoxes);
+    std::vector<int> classIds(numBoxes);
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        bboxes[i] = Rect(rng.uniform(0, 300), rng.uniform(0, 300), rng.uniform(0, 60), rng.uniform(0, 60));
+        // repeated scores check order of equal candidates
+        scores[i] = rng.uniform(0, 100) / 100.f;
+        classIds[i] = rng.uniform(0, 5);
+    }
+
+    for (int top_k = 0; top_k <= 300; top_k += 150)
+    {
+        std::vector<int> indices, refIndices;
+        cv::dnn::NMSBoxes(bboxes, scores, 0.2f, 0.4f, indices, 1.f, top_k);
+        referenceNMS(bboxes, scores, 0.2f, 0.4f, top_k, refIndices);
+        EXPECT_EQ(refIndices, indices) << "top_k=" << top_k;
+
+        // Batched NMS is equal to NMS applied to every class separately.
+        cv::dnn::NMSBoxesBatched(bboxes, scores, classIds, 0.2f, 0.4f, indices, 1.f, top_k);
+        std::vector<std::pair<float, int> > refBatched;
+        for (int c = 0; c < 5; ++c)
+        {
+            std::vector<float> classScores(scores);
+            for (int i = 0; i < numBoxes; ++i)
+                if (classIds[i] != c)
+                    classScores[i] = 0;
+            referenceNMS(bboxes, classScores, 0.2f, 0.4f, top_k, refIndices);
+            for (size_t i = 0; i < refIndices.size(); ++i)
+                refBatched.push_back(std::make_pair(scores[refIndices[i]], refIndices[i]));
+        }
+        ASSERT_EQ(top_k > 0 ? std::min((int)refBatched.size(), top_k) : (int)refBatched.size(),
+                  (int)indices.size());
+        for (size_t i = 1; i < indices.size(); ++i)
+            ASSERT_GE(scores[indices[i - 1]], scores[indices[i]]);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            bool found = false;
+            for (size_t j = 0; j < refBatched.size() && !found; ++j)
+                found = refBatched[j].second == indices[i];
+            ASSERT_TRUE(found) << indices[i];
+        }
+    }
+}
+
 }} // namespace
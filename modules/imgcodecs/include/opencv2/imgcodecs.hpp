@@ -85,9 +85,11 @@ enum ImwriteFlags {
        IMWRITE_JPEG_RST_INTERVAL   = 4,  //!< JPEG restart interval, 0 - 65535, default is 0 - no restart.
        IMWRITE_JPEG_LUMA_QUALITY   = 5,  //!< Separate luma quality level, 0 - 100, default is 0 - don't use.
        IMWRITE_JPEG_CHROMA_QUALITY = 6,  //!< Separate chroma quality level, 0 - 100, default is 0 - don't use.
+       IMWRITE_JPEG_PARALLEL       = 7,  //!< Encode bands of rows in parallel, 0 or 1, default is 0. Bands are aligned to restart intervals, by default one interval per band is used. Ignored for progressive and optimized JPEG.
        IMWRITE_PNG_COMPRESSION     = 16, //!< For PNG, it can be the compression level from 0 to 9. A higher value means a smaller size and longer compression time. If specified, strategy is changed to IMWRITE_PNG_STRATEGY_DEFAULT (Z_DEFAULT_STRATEGY). Default value is 1 (best speed setting).
        IMWRITE_PNG_STRATEGY        = 17, //!< One of cv::ImwritePNGFlags, default is IMWRITE_PNG_STRATEGY_RLE.
        IMWRITE_PNG_BILEVEL         = 18, //!< Binary level PNG, 0 or 1, default is 0.
+       IMWRITE_PNG_FAST            = 19, //!< Fast PNG encoder which filters and compresses bands of rows in parallel, one of cv::ImwritePNGFastModes, default is IMWRITE_PNG_FAST_NONE (libpng). Level and strategy are taken from IMWRITE_PNG_COMPRESSION and IMWRITE_PNG_STRATEGY. Not used for bilevel images.
        IMWRITE_PXM_BINARY          = 32, //!< For PPM, PGM, or PBM, it can be a binary format flag, 0 or 1. Default value is 1.
        IMWRITE_EXR_TYPE            = (3 << 4) + 0, /* 48 */ //!< override EXR storage type (FLOAT (FP32) is default)
        IMWRITE_WEBP_QUALITY        = 64, //!< For WEBP, it can be a quality from 1 to 100 (the higher is the better). By default (without any parameter) and for quality above 100 the lossless compression is used.
@@ -119,6 +121,17 @@ enum ImwritePNGFlags {
        IMWRITE_PNG_STRATEGY_FIXED        = 4  //!< Using this value prevents the use of dynamic Huffman codes, allowing for a simpler decoder for special applications.
      };
 
+//! Imwrite PNG fast encoder modes, from the fastest to the one producing the smallest files.
+/** The fast encoder splits the image into bands of rows which are filtered and deflated in parallel.
+Deflate streams of the bands are primed with the end of the previous band and concatenated,
+so the result is a regular PNG file with one IDAT chunk per band.
+*/
+enum ImwritePNGFastModes {
+       IMWRITE_PNG_FAST_NONE     = 0, //!< Use libpng.
+       IMWRITE_PNG_FAST_SUB      = 1, //!< Use the Sub filter for all rows (the same as the default libpng setup).
+       IMWRITE_PNG_FAST_ADAPTIVE = 2  //!< Choose the filter for each row by the minimum sum of absolute differences heuristic.
+     };
+
 //! Imwrite PAM specific tupletype flags used to define the 'TUPETYPE' field of a PAM file.
 enum ImwritePAMFlags {
        IMWRITE_PAM_FORMAT_NULL = 0,
@@ -129,6 +142,22 @@ enum ImwritePAMFlags {
        IMWRITE_PAM_FORMAT_RGB_ALPHA = 5,
      };
 
+/** @brief Source of encoded image data for cv::imdecode.
+
+Implement the interface to decode an image from a stream or from non-contiguous memory (e.g. a
+list of network buffers) without concatenating the data first.
+*/
+class CV_EXPORTS IStreamReader
+{
+public:
+    virtual ~IStreamReader();
+
+    /** @brief Reads up to size bytes of the stream into buffer.
+    @return Number of bytes read, 0 at the end of the stream.
+    */
+    virtual size_t read(char* buffer, size_t size) = 0;
+};
+
 /** @brief Loads an image from a file.
 
 @anchor imread
@@ -175,6 +204,24 @@ Currently, the following file formats are supported:
 */
 CV_EXPORTS_W Mat imread( const String& filename, int flags = IMREAD_COLOR );
 
+/** @brief Loads a region of an image from a file.
+
+The function is equivalent to `imread(filename, flags)(roi).clone()`, but TIFF, JPEG and PNG
+decoders read only the part of the file required for the region: TIFF decodes only the tiles or
+strips intersecting the region, JPEG skips the rows above the region and does not convert the
+columns outside of it (when built with libjpeg-turbo), and PNG stops decoding after the last row of
+the region. Other formats are decoded completely and cropped.
+
+The region is specified in the coordinates of the image stored in the file (after the reduction
+requested by IMREAD_REDUCED_* flags), so EXIF orientation is not applied. The function throws an
+exception if the region is empty or does not fit into the image.
+@param filename Name of file to be loaded.
+@param roi Region of the image to load.
+@param flags Flag that can take values of cv::ImreadModes
+@sa cv::imread
+*/
+CV_EXPORTS_W Mat imread( const String& filename, const Rect& roi, int flags = IMREAD_COLOR );
+
 /** @brief Loads a multi-page image from a file.
 
 The function imreadmulti loads a multi-page image from the specified file into a vector of Mat objects.
@@ -229,6 +276,73 @@ reallocations when the function is called repeatedly for images of the same size
 */
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+/** @overload
+@param stream Source of the encoded image. JPEG and PNG images are decoded while they are read,
+other formats are read into memory completely first.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+*/
+CV_EXPORTS Mat imdecode( IStreamReader& stream, int flags );
+
+/** @brief Reads an image from a buffer in memory into the caller-owned matrix.
+
+Unlike cv::imdecode, the function never reallocates dst: it must have the size and type of the
+image being decoded with the given flags (IMREAD_REDUCED_* and EXIF orientation included). dst
+may be a part of a bigger matrix, e.g. a slice of a batch. Decoders write into dst directly except
+when the image should be resized (IMREAD_REDUCED_* for the formats which can't decode a reduced
+image natively, unlike JPEG) or transposed according to EXIF orientation.
+@param buf Input array or vector of bytes.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@param dst Destination matrix.
+@return true if the image is decoded, false if it can't be decoded or doesn't match dst.
+*/
+CV_EXPORTS bool imdecodeTo( InputArray buf, int flags, Mat& dst );
+
+/** @overload
+@param stream Source of the encoded image, see cv::IStreamReader.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@param dst Destination matrix.
+*/
+CV_EXPORTS bool imdecodeTo( IStreamReader& stream, int flags, Mat& dst );
+
+/** @brief Reads a region of an image from a buffer in memory.
+
+See cv::imread for the description of region decoding and cv::imdecode for the other parameters.
+@param buf Input array or vector of bytes.
+@param roi Region of the image to decode.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+*/
+CV_EXPORTS_W Mat imdecode( InputArray buf, const Rect& roi, int flags );
+
+/** @brief Loads a batch of images from files.
+
+The images are loaded concurrently on the OpenCV thread pool (see cv::setNumThreads). An image
+which can't be loaded doesn't stop loading of the others: its element of mats is released and
+its status is set to 0.
+@param filenames Names of files to be loaded.
+@param mats Loaded images. Matrices which already have the required size and type are reused.
+@param status Per image status: 1 if the image is loaded, 0 otherwise.
+@param flags Flag that can take values of cv::ImreadModes, the same for all images.
+@return Number of loaded images.
+@sa cv::imread
+*/
+CV_EXPORTS_W int imreadBatch( const std::vector<String>& filenames, CV_IN_OUT std::vector<Mat>& mats,
+                              CV_OUT std::vector<int>& status, int flags = IMREAD_COLOR );
+
+/** @brief Reads a batch of images from buffers in memory.
+
+The buffers are decoded concurrently on the OpenCV thread pool. Empty or invalid buffers don't
+stop decoding of the others: the corresponding element of mats is released and its status is
+set to 0.
+@param bufs Vector of input arrays (vectors of bytes).
+@param mats Decoded images. Matrices which already have the required size and type are reused.
+@param status Per image status: 1 if the image is decoded, 0 otherwise.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@return Number of decoded images.
+@sa cv::imdecode
+*/
+CV_EXPORTS_W int imdecodeBatch( InputArrayOfArrays bufs, CV_IN_OUT std::vector<Mat>& mats,
+                                CV_OUT std::vector<int>& status, int flags = IMREAD_COLOR );
+
 /** @brief Encodes an image into a memory buffer.
 
 The function imencode compresses the image and stores it in the memory buffer that is resized to fit the
@@ -243,6 +357,69 @@ CV_EXPORTS_W bool imencode( const String& ext, InputArray img,
                             CV_OUT std::vector<uchar>& buf,
                             const std::vector<int>& params = std::vector<int>());
 
+/** @brief Streaming writer of tiled multi-resolution (pyramidal) TIFF images.
+
+The image is passed tile by tile in raster order, so only one row of tiles of every pyramid level is kept
+in memory. Reduced resolution levels are generated on the fly with cv::pyrDown and stored as subsequent
+directories with FILETYPE_REDUCEDIMAGE subfile type. The lower levels are written to temporary files and
+appended to the output file by release(). BigTIFF is used when the image data doesn't fit into classic TIFF.
+*/
+class CV_EXPORTS TiledTiffWriter
+{
+public:
+    virtual ~TiledTiffWriter();
+
+    /** @brief Creates the writer.
+
+    @param filename Name of the file.
+    @param size Size of the full resolution image.
+    @param type Type of the image: CV_8U or CV_16U with 1, 3 (BGR) or 4 (BGRA) channels.
+    @param levels Number of pyramid levels including the full resolution one. 0 means as many levels as
+    needed to fit the smallest one into a single tile.
+    @param tileSize Size of tiles, multiples of 16.
+    @param params TIFFTAG_COMPRESSION, TIFFTAG_PREDICTOR, IMWRITE_TIFF_RESUNIT, IMWRITE_TIFF_XDPI and
+    IMWRITE_TIFF_YDPI pairs. LZW compression with horizontal predictor is used by default.
+    */
+    static Ptr<TiledTiffWriter> create( const String& filename, Size size, int type, int levels = 0,
+                                        Size tileSize = Size(256, 256),
+                                        const std::vector<int>& params = std::vector<int>() );
+
+    /** @brief Writes the next tile of the full resolution image.
+
+    Tiles go left to right, top to bottom. Tiles of the last column and row are cropped to the image.
+    */
+    virtual void writeTile( InputArray tile ) = 0;
+
+    /** @brief Writes the pyramid levels and closes the file. All the tiles must be written before. */
+    virtual void release() = 0;
+};
+
+/** @brief Reader of tiles and regions of multi-resolution TIFF images written by cv::TiledTiffWriter.
+
+The first directory of the file is the level 0, the following directories with FILETYPE_REDUCEDIMAGE
+subfile type are the next levels. Only the tiles covering the requested region are decoded.
+Images are returned the same way cv::imread with IMREAD_UNCHANGED flag does.
+*/
+class CV_EXPORTS TiledTiffReader
+{
+public:
+    virtual ~TiledTiffReader();
+
+    static Ptr<TiledTiffReader> create( const String& filename );
+
+    virtual int getLevels() const = 0;
+    virtual int getType() const = 0;
+    virtual Size getSize( int level ) const = 0;
+    //! Size of tiles of the level. Stripped images have tiles of the image width and rows per strip height.
+    virtual Size getTileSize( int level ) const = 0;
+
+    /** @brief Reads the tile with the given column and row indices. Edge tiles are cropped to the image. */
+    virtual void readTile( int level, Point tile, OutputArray dst ) = 0;
+
+    /** @brief Reads a region of the level. The region must be non-empty and inside the level. */
+    virtual void readRegion( int level, const Rect& roi, OutputArray dst ) = 0;
+};
+
 //! @} imgcodecs
 
 } // cv
@@ -47,11 +47,88 @@
 namespace cv
 {
 
+IStreamReader::~IStreamReader() {}
+
+ImageStream::ImageStream( IStreamReader& reader, size_t headLimit )
+    : m_reader(reader), m_headLimit(headLimit), m_pos(0)
+{
+}
+
+size_t ImageStream::read( uchar* buf, size_t size )
+{
+    size_t count = 0;
+    if( m_pos < m_head.size() )
+    {
+        count = std::min(size, m_head.size() - m_pos);
+        memcpy( buf, &m_head[m_pos], count );
+    }
+    while( count < size )
+    {
+        size_t n = m_reader.read( (char*)buf + count, size - count );
+        if( n == 0 )
+            break;
+        // keep the beginning of the stream
+        if( m_pos + count == m_head.size() && m_head.size() < m_headLimit )
+            m_head.insert( m_head.end(), buf + count, buf + count + std::min(n, m_headLimit - m_head.size()) );
+        count += n;
+    }
+    m_pos += count;
+    return count;
+}
+
+size_t ImageStream::skip( size_t size )
+{
+    uchar buf[1 << 12];
+    size_t count = 0;
+    while( count < size )
+    {
+        size_t n = read( buf, std::min(size - count, sizeof(buf)) );
+        if( n == 0 )
+            break;
+        count += n;
+    }
+    return count;
+}
+
+const std::vector<uchar>& ImageStream::peek( size_t size )
+{
+    CV_Assert( m_pos <= m_head.size() || size <= m_head.size() );
+    while( m_head.size() < size )
+    {
+        size_t start = m_head.size();
+        m_head.resize( size );
+        size_t n = m_reader.read( (char*)&m_head[start], size - start );
+        m_head.resize( start + n );
+        if( n == 0 )
+            break;
+    }
+    return m_head;
+}
+
+Mat ImageStream::readAll()
+{
+    std::vector<uchar> data;
+    const size_t chunk = 1 << 16;
+    for( ;; )
+    {
+        size_t start = data.size();
+        data.resize( start + chunk );
+        size_t n = read( &data[start], chunk );
+        data.resize( start + n );
+        if( n < chunk )
+            break;
+    }
+    return Mat( data, true ).reshape( 1, 1 );
+}
+
 BaseImageDecoder::BaseImageDecoder()
 {
     m_width = m_height = 0;
     m_type = -1;
     m_buf_supported = false;
+    m_stream = 0;
+    m_stream_supported = false;
+    m_roi_supported = false;
     m_scale_denom = 1;
 }
 
@@ -59,6 +136,7 @@ bool BaseImageDecoder::setSource( const String& filename )
 {
     m_filename = filename;
     m_buf.release();
+    m_stream = 0;
     return true;
 }
 
@@ -68,6 +146,17 @@ bool BaseImageDecoder::setSource( const Mat& buf )
         return false;
     m_filename = String();
     m_buf = buf;
+    m_stream = 0;
+    return true;
+}
+
+bool BaseImageDecoder::setSource( ImageStream* stream )
+{
+    if( !m_stream_supported )
+        return false;
+    m_filename = String();
+    m_buf.release();
+    m_stream = stream;
     return true;
 }
 
@@ -89,6 +178,15 @@ int BaseImageDecoder::setScale( const int& scale_denom )
     return temp;
 }
 
+bool BaseImageDecoder::setROI( const Rect& roi )
+{
+    if( !m_roi_supported )
+        return false;
+    CV_Assert( (roi & Rect(0, 0, m_width, m_height)) == roi );
+    m_roi = roi;
+    return true;
+}
+
 ImageDecoder BaseImageDecoder::newDecoder() const
 {
     return ImageDecoder();
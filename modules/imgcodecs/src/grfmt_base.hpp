@@ -51,6 +51,30 @@ namespace cv
 
 class BaseImageDecoder;
 class BaseImageEncoder;
+
+// Encoded image read sequentially from the user stream. The first bytes of the stream
+// (which contain the signature and EXIF data) are kept, so they may be read again.
+class ImageStream
+{
+public:
+    ImageStream( IStreamReader& reader, size_t headLimit );
+
+    /// Reads up to size bytes, returns less only at the end of the stream.
+    size_t read( uchar* buf, size_t size );
+    size_t skip( size_t size );
+    /// Returns at least the first size bytes of the stream (unless it is shorter).
+    /// The read position is not changed.
+    const std::vector<uchar>& peek( size_t size );
+    /// Reads the rest of the stream into a single row of bytes.
+    Mat readAll();
+
+protected:
+    IStreamReader& m_reader;
+    std::vector<uchar> m_head;
+    size_t m_headLimit;
+    size_t m_pos;
+};
+
 typedef Ptr<BaseImageEncoder> ImageEncoder;
 typedef Ptr<BaseImageDecoder> ImageDecoder;
 
@@ -67,7 +91,11 @@ public:
 
     virtual bool setSource( const String& filename );
     virtual bool setSource( const Mat& buf );
+    virtual bool setSource( ImageStream* stream );
     virtual int setScale( const int& scale_denom );
+    /// Restricts readData to the region of the image. Returns false if the decoder
+    /// can decode only the whole image. Must be called after readHeader.
+    virtual bool setROI( const Rect& roi );
     virtual bool readHeader() = 0;
     virtual bool readData( Mat& img ) = 0;
 
@@ -83,10 +111,14 @@ protected:
     int  m_height; // height of the image ( filled by readHeader )
     int  m_type;
     int  m_scale_denom;
+    Rect m_roi;    // region to decode, empty for the whole image ( set by setROI )
     String m_filename;
     String m_signature;
     Mat m_buf;
     bool m_buf_supported;
+    ImageStream* m_stream;
+    bool m_stream_supported;
+    bool m_roi_supported;
 };
 
 
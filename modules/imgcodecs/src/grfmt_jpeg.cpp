@@ -88,6 +88,8 @@ struct JpegSource
 {
     struct jpeg_source_mgr pub;
     int skip;
+    ImageStream* stream;
+    JOCTET buffer[1 << 12];
 };
 
 struct JpegState
@@ -151,6 +153,62 @@ static void jpeg_buffer_src(j_decompress_ptr cinfo, JpegSource* source)
 }
 
 
+// reading from the user stream
+
+METHODDEF(boolean)
+fill_stream_buffer(j_decompress_ptr cinfo)
+{
+    JpegSource* source = (JpegSource*) cinfo->src;
+    size_t count = source->stream->read( source->buffer, sizeof(source->buffer) );
+    if( count == 0 )
+    {
+        // premature end of the stream, insert a fake EOI marker (as jdatasrc.c does)
+        source->buffer[0] = (JOCTET)0xFF;
+        source->buffer[1] = (JOCTET)JPEG_EOI;
+        count = 2;
+    }
+    source->pub.next_input_byte = source->buffer;
+    source->pub.bytes_in_buffer = count;
+    return TRUE;
+}
+
+METHODDEF(void)
+skip_stream_data(j_decompress_ptr cinfo, long num_bytes)
+{
+    JpegSource* source = (JpegSource*) cinfo->src;
+
+    if( num_bytes <= 0 )
+        return;
+    if( num_bytes > (long)source->pub.bytes_in_buffer )
+    {
+        source->stream->skip( num_bytes - source->pub.bytes_in_buffer );
+        source->pub.next_input_byte += source->pub.bytes_in_buffer;
+        source->pub.bytes_in_buffer = 0;
+    }
+    else
+    {
+        source->pub.bytes_in_buffer -= num_bytes;
+        source->pub.next_input_byte += num_bytes;
+    }
+}
+
+
+static void jpeg_stream_src(j_decompress_ptr cinfo, JpegSource* source, ImageStream* stream)
+{
+    cinfo->src = &source->pub;
+
+    source->pub.init_source = stub;
+    source->pub.fill_input_buffer = fill_stream_buffer;
+    source->pub.skip_input_data = skip_stream_data;
+    source->pub.resync_to_restart = jpeg_resync_to_restart;
+    source->pub.term_source = stub;
+    source->pub.bytes_in_buffer = 0; // forces fill_input_buffer on first read
+
+    source->skip = 0;
+    source->stream = stream;
+}
+
+
 METHODDEF(void)
 error_exit( j_common_ptr cinfo )
 {
@@ -170,6 +228,8 @@ JpegDecoder::JpegDecoder()
     m_state = 0;
     m_f = 0;
     m_buf_supported = true;
+    m_stream_supported = true;
+    m_roi_supported = true;
 }
 
 
@@ -218,7 +278,11 @@ bool  JpegDecoder::readHeader()
     {
         jpeg_create_decompress( &state->cinfo );
 
-        if( !m_buf.empty() )
+        if( m_stream )
+        {
+            jpeg_stream_src(&state->cinfo, &state->source, m_stream);
+        }
+        else if( !m_buf.empty() )
         {
             jpeg_buffer_src(&state->cinfo, &state->source);
             state->source.pub.next_input_byte = m_buf.ptr();
@@ -446,28 +510,56 @@ bool  JpegDecoder::readData( Mat& img )
             buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
                                               JPOOL_IMAGE, m_width*4, 1 );
 
+            const Rect roi = m_roi.empty() ? Rect(0, 0, m_width, m_height) : m_roi;
+            int xofs = roi.x;
+#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+            // libjpeg-turbo doesn't decode the columns and the iMCU rows outside of the region.
+            // Chroma upsampling replicates the edges of the cropped area, so it is extended
+            // by one iMCU to keep the result the same as for the whole image.
+            if( !m_roi.empty() )
+            {
+                const int margin = cinfo->max_h_samp_factor * DCTSIZE;
+                const int x0 = std::max(roi.x - margin, 0);
+                const int x1 = std::min(roi.x + roi.width + margin, m_width);
+                JDIMENSION xoffset = x0, width = x1 - x0;
+                jpeg_crop_scanline( cinfo, &xoffset, &width );
+                xofs = roi.x - (int)xoffset;
+                if( roi.y > 0 )
+                    jpeg_skip_scanlines( cinfo, roi.y );
+            }
+#endif
+            const uchar* src = buffer[0] + xofs*cinfo->out_color_components;
+            const CvSize size = cvSize(roi.width, 1);
+
             uchar* data = img.ptr();
-            for( ; m_height--; data += step )
+            for( int y = (int)cinfo->output_scanline; y < roi.y + roi.height; y++ )
             {
                 jpeg_read_scanlines( cinfo, buffer, 1 );
+                if( y < roi.y )
+                    continue;
                 if( color )
                 {
                     if( cinfo->out_color_components == 3 )
-                        icvCvt_RGB2BGR_8u_C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                        icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, size );
                     else
-                        icvCvt_CMYK2BGR_8u_C4C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                        icvCvt_CMYK2BGR_8u_C4C3R( src, 0, data, 0, size );
                 }
                 else
                 {
                     if( cinfo->out_color_components == 1 )
-                        memcpy( data, buffer[0], m_width );
+                        memcpy( data, src, roi.width );
                     else
-                        icvCvt_CMYK2Gray_8u_C4C1R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                        icvCvt_CMYK2Gray_8u_C4C1R( src, 0, data, 0, size );
                 }
+                data += step;
             }
 
             result = true;
-            jpeg_finish_decompress( cinfo );
+            // the rows below the region are not decoded
+            if( cinfo->output_scanline < cinfo->output_height )
+                jpeg_abort_decompress( cinfo );
+            else
+                jpeg_finish_decompress( cinfo );
         }
     }
 
@@ -540,24 +632,75 @@ ImageEncoder JpegEncoder::newEncoder() const
     return makePtr<JpegEncoder>();
 }
 
-bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+struct JpegEncoderParams
 {
-    m_last_error.clear();
+    JpegEncoderParams() : quality(95), progressive(0), optimize(0), rst_interval(0),
+                          luma_quality(-1), chroma_quality(-1), parallel(0) {}
+
+    int quality;
+    int progressive;
+    int optimize;
+    int rst_interval;
+    int luma_quality;
+    int chroma_quality;
+    int parallel;
+};
 
-    struct fileWrapper
+static void setupCompress( jpeg_compress_struct& cinfo, int width, int height, int _channels,
+                           const JpegEncoderParams& p )
+{
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+
+    int channels = _channels > 1 ? 3 : 1;
+    cinfo.input_components = channels;
+    cinfo.in_color_space = channels > 1 ? JCS_RGB : JCS_GRAYSCALE;
+
+    jpeg_set_defaults( &cinfo );
+    cinfo.restart_interval = p.rst_interval;
+
+    jpeg_set_quality( &cinfo, p.quality,
+                      TRUE /* limit to baseline-JPEG values */ );
+    if( p.progressive )
+        jpeg_simple_progression( &cinfo );
+    if( p.optimize )
+        cinfo.optimize_coding = TRUE;
+
+#if JPEG_LIB_VERSION >= 70
+    if (p.luma_quality >= 0 && p.chroma_quality >= 0)
     {
-        FILE* f;
+        cinfo.q_scale_factor[0] = jpeg_quality_scaling(p.luma_quality);
+        cinfo.q_scale_factor[1] = jpeg_quality_scaling(p.chroma_quality);
+        if ( p.luma_quality != p.chroma_quality )
+        {
+            /* disable subsampling - ref. Libjpeg.txt */
+            cinfo.comp_info[0].v_samp_factor = 1;
+            cinfo.comp_info[0].h_samp_factor = 1;
+            cinfo.comp_info[1].v_samp_factor = 1;
+            cinfo.comp_info[1].h_samp_factor = 1;
+        }
+        jpeg_default_qtables( &cinfo, TRUE );
+    }
+#endif // #if JPEG_LIB_VERSION >= 70
 
-        fileWrapper() : f(0) {}
-        ~fileWrapper() { if(f) fclose(f); }
-    };
+#ifdef JCS_EXTENSIONS
+    // libjpeg-turbo converts BGR to YCbCr and downsamples chroma with SIMD, so rows are passed as is
+    if( _channels > 1 )
+    {
+        cinfo.input_components = _channels;
+        cinfo.in_color_space = _channels == 3 ? JCS_EXT_BGR : JCS_EXT_BGRX;
+    }
+#endif
+}
+
+// Encodes img to the file or appends it to the buffer
+static bool encodeJpeg( const Mat& img, const JpegEncoderParams& p, FILE* f,
+                        std::vector<uchar>* dst, String& error )
+{
     volatile bool result = false;
-    fileWrapper fw;
     int width = img.cols, height = img.rows;
 
     std::vector<uchar> out_buf(1 << 12);
-    AutoBuffer<uchar> _buffer;
-    uchar* buffer;
 
     struct jpeg_compress_struct cinfo;
     JpegErrorMgr jerr;
@@ -567,16 +710,11 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
     cinfo.err = jpeg_std_error(&jerr.pub);
     jerr.pub.error_exit = error_exit;
 
-    if( !m_buf )
-    {
-        fw.f = fopen( m_filename.c_str(), "wb" );
-        if( !fw.f )
-            goto _exit_;
-        jpeg_stdio_dest( &cinfo, fw.f );
-    }
+    if( f )
+        jpeg_stdio_dest( &cinfo, f );
     else
     {
-        dest.dst = m_buf;
+        dest.dst = dst;
         dest.buf = &out_buf;
 
         jpeg_buffer_dest( &cinfo, &dest );
@@ -587,135 +725,325 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
 
     if( setjmp( jerr.setjmp_buffer ) == 0 )
     {
-        cinfo.image_width = width;
-        cinfo.image_height = height;
-
         int _channels = img.channels();
-        int channels = _channels > 1 ? 3 : 1;
-        cinfo.input_components = channels;
-        cinfo.in_color_space = channels > 1 ? JCS_RGB : JCS_GRAYSCALE;
-
-        int quality = 95;
-        int progressive = 0;
-        int optimize = 0;
-        int rst_interval = 0;
-        int luma_quality = -1;
-        int chroma_quality = -1;
-
-        for( size_t i = 0; i < params.size(); i += 2 )
+        setupCompress( cinfo, width, height, _channels, p );
+
+        jpeg_start_compress( &cinfo, TRUE );
+
+#ifdef JCS_EXTENSIONS
+        const int batch = 16;
+        JSAMPROW rows[batch];
+        for( int y = 0; y < height; )
         {
-            if( params[i] == CV_IMWRITE_JPEG_QUALITY )
-            {
-                quality = params[i+1];
-                quality = MIN(MAX(quality, 0), 100);
-            }
+            int n = std::min(batch, height - y);
+            for( int i = 0; i < n; i++ )
+                rows[i] = (JSAMPROW)img.ptr(y + i);
+            y += jpeg_write_scanlines( &cinfo, rows, n );
+        }
+#else
+        AutoBuffer<uchar> _buffer;
+        if( _channels > 1 )
+            _buffer.allocate(width*3);
+        uchar* buffer = _buffer.data();
 
-            if( params[i] == CV_IMWRITE_JPEG_PROGRESSIVE )
+        for( int y = 0; y < height; y++ )
+        {
+            uchar *data = img.data + img.step*y, *ptr = data;
+
+            if( _channels == 3 )
             {
-                progressive = params[i+1];
+                icvCvt_BGR2RGB_8u_C3R( data, 0, buffer, 0, cvSize(width,1) );
+                ptr = buffer;
             }
-
-            if( params[i] == CV_IMWRITE_JPEG_OPTIMIZE )
+            else if( _channels == 4 )
             {
-                optimize = params[i+1];
+                icvCvt_BGRA2BGR_8u_C4C3R( data, 0, buffer, 0, cvSize(width,1), 2 );
+                ptr = buffer;
             }
 
-            if( params[i] == CV_IMWRITE_JPEG_LUMA_QUALITY )
-            {
-                if (params[i+1] >= 0)
-                {
-                    luma_quality = MIN(MAX(params[i+1], 0), 100);
+            jpeg_write_scanlines( &cinfo, &ptr, 1 );
+        }
+#endif
 
-                    quality = luma_quality;
+        jpeg_finish_compress( &cinfo );
+        result = true;
+    }
 
-                    if (chroma_quality < 0)
-                    {
-                        chroma_quality = luma_quality;
-                    }
-                }
-            }
+    if(!result)
+    {
+        char jmsg_buf[JMSG_LENGTH_MAX];
+        jerr.pub.format_message((j_common_ptr)&cinfo, jmsg_buf);
+        error = jmsg_buf;
+    }
 
-            if( params[i] == CV_IMWRITE_JPEG_CHROMA_QUALITY )
-            {
-                if (params[i+1] >= 0)
-                {
-                    chroma_quality = MIN(MAX(params[i+1], 0), 100);
-                }
-            }
+    jpeg_destroy_compress( &cinfo );
 
-            if( params[i] == CV_IMWRITE_JPEG_RST_INTERVAL )
+    return result;
+}
+
+// Size of MCU in pixels and number of MCUs in a row for the given encoder settings
+static bool getMcuLayout( int width, int channels, const JpegEncoderParams& p, Size& mcu, int& mcusPerRow )
+{
+    struct jpeg_compress_struct cinfo;
+    JpegErrorMgr jerr;
+    volatile bool result = false;
+
+    jpeg_create_compress(&cinfo);
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = error_exit;
+
+    if( setjmp( jerr.setjmp_buffer ) == 0 )
+    {
+        setupCompress( cinfo, width, 1, channels, p );
+        // a single component scan is not interleaved, its MCU is one block
+        int max_h = 1, max_v = 1;
+        if( cinfo.num_components > 1 )
+        {
+            for( int i = 0; i < cinfo.num_components; i++ )
             {
-                rst_interval = params[i+1];
-                rst_interval = MIN(MAX(rst_interval, 0), 65535L);
+                max_h = std::max(max_h, cinfo.comp_info[i].h_samp_factor);
+                max_v = std::max(max_v, cinfo.comp_info[i].v_samp_factor);
             }
         }
+        mcu = Size(max_h*DCTSIZE, max_v*DCTSIZE);
+        mcusPerRow = (width + mcu.width - 1)/mcu.width;
+        result = true;
+    }
 
-        jpeg_set_defaults( &cinfo );
-        cinfo.restart_interval = rst_interval;
+    jpeg_destroy_compress( &cinfo );
+    return result;
+}
 
-        jpeg_set_quality( &cinfo, quality,
-                          TRUE /* limit to baseline-JPEG values */ );
-        if( progressive )
-            jpeg_simple_progression( &cinfo );
-        if( optimize )
-            cinfo.optimize_coding = TRUE;
+// Encodes bands of rows to separate JPEG images, bands are aligned to the restart intervals
+class JpegBandEncoder : public ParallelLoopBody
+{
+public:
+    JpegBandEncoder( const Mat& img, const JpegEncoderParams& p, int bandHeight,
+                     std::vector<std::vector<uchar> >& bands, std::vector<String>& errors )
+        : img_(img), p_(p), bandHeight_(bandHeight), bands_(bands), errors_(errors) {}
 
-#if JPEG_LIB_VERSION >= 70
-        if (luma_quality >= 0 && chroma_quality >= 0)
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        for( int b = range.start; b < range.end; b++ )
         {
-            cinfo.q_scale_factor[0] = jpeg_quality_scaling(luma_quality);
-            cinfo.q_scale_factor[1] = jpeg_quality_scaling(chroma_quality);
-            if ( luma_quality != chroma_quality )
-            {
-                /* disable subsampling - ref. Libjpeg.txt */
-                cinfo.comp_info[0].v_samp_factor = 1;
-                cinfo.comp_info[0].h_samp_factor = 1;
-                cinfo.comp_info[1].v_samp_factor = 1;
-                cinfo.comp_info[1].h_samp_factor = 1;
-            }
-            jpeg_default_qtables( &cinfo, TRUE );
+            int y0 = b*bandHeight_, y1 = std::min(y0 + bandHeight_, img_.rows);
+            encodeJpeg( img_.rowRange(y0, y1), p_, 0, &bands_[b], errors_[b] );
         }
-#endif // #if JPEG_LIB_VERSION >= 70
+    }
 
-        jpeg_start_compress( &cinfo, TRUE );
+private:
+    const Mat& img_;
+    JpegEncoderParams p_;
+    int bandHeight_;
+    std::vector<std::vector<uchar> >& bands_;
+    std::vector<String>& errors_;
+};
+
+static int gcd( int a, int b )
+{
+    while( b != 0 )
+    {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
 
-        if( channels > 1 )
-            _buffer.allocate(width*channels);
-        buffer = _buffer.data();
+// Finds the SOF segment and the beginning of entropy coded data of a baseline JPEG image
+static bool findScanData( const std::vector<uchar>& buf, size_t& sof, size_t& data )
+{
+    sof = 0;
+    for( size_t pos = 2; pos + 4 <= buf.size(); )
+    {
+        if( buf[pos] != 0xFF )
+            return false;
+        int marker = buf[pos + 1];
+        size_t length = (buf[pos + 2] << 8) | buf[pos + 3];
+        if( marker == 0xC0 || marker == 0xC1 )
+            sof = pos;
+        pos += 2 + length;
+        if( marker == 0xDA )
+        {
+            data = pos;
+            return sof != 0 && data + 2 <= buf.size();
+        }
+    }
+    return false;
+}
 
-        for( int y = 0; y < height; y++ )
+bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+{
+    m_last_error.clear();
+
+    struct fileWrapper
+    {
+        FILE* f;
+
+        fileWrapper() : f(0) {}
+        ~fileWrapper() { if(f) fclose(f); }
+    };
+    fileWrapper fw;
+    JpegEncoderParams p;
+
+    for( size_t i = 0; i < params.size(); i += 2 )
+    {
+        if( params[i] == CV_IMWRITE_JPEG_QUALITY )
         {
-            uchar *data = img.data + img.step*y, *ptr = data;
+            p.quality = params[i+1];
+            p.quality = MIN(MAX(p.quality, 0), 100);
+        }
 
-            if( _channels == 3 )
+        if( params[i] == CV_IMWRITE_JPEG_PROGRESSIVE )
+        {
+            p.progressive = params[i+1];
+        }
+
+        if( params[i] == CV_IMWRITE_JPEG_OPTIMIZE )
+        {
+            p.optimize = params[i+1];
+        }
+
+        if( params[i] == CV_IMWRITE_JPEG_LUMA_QUALITY )
+        {
+            if (params[i+1] >= 0)
             {
-                icvCvt_BGR2RGB_8u_C3R( data, 0, buffer, 0, cvSize(width,1) );
-                ptr = buffer;
+                p.luma_quality = MIN(MAX(params[i+1], 0), 100);
+
+                p.quality = p.luma_quality;
+
+                if (p.chroma_quality < 0)
+                {
+                    p.chroma_quality = p.luma_quality;
+                }
             }
-            else if( _channels == 4 )
+        }
+
+        if( params[i] == CV_IMWRITE_JPEG_CHROMA_QUALITY )
+        {
+            if (params[i+1] >= 0)
             {
-                icvCvt_BGRA2BGR_8u_C4C3R( data, 0, buffer, 0, cvSize(width,1), 2 );
-                ptr = buffer;
+                p.chroma_quality = MIN(MAX(params[i+1], 0), 100);
             }
+        }
 
-            jpeg_write_scanlines( &cinfo, &ptr, 1 );
+        if( params[i] == CV_IMWRITE_JPEG_RST_INTERVAL )
+        {
+            p.rst_interval = params[i+1];
+            p.rst_interval = MIN(MAX(p.rst_interval, 0), 65535L);
         }
 
-        jpeg_finish_compress( &cinfo );
-        result = true;
+        if( params[i] == IMWRITE_JPEG_PARALLEL )
+        {
+            p.parallel = params[i+1];
+        }
     }
 
-_exit_:
+    if( p.parallel && !p.progressive && !p.optimize && img.rows <= 65535 && writeParallel( img, p ) )
+        return true;
 
-    if(!result)
+    if( !m_buf )
     {
-        char jmsg_buf[JMSG_LENGTH_MAX];
-        jerr.pub.format_message((j_common_ptr)&cinfo, jmsg_buf);
-        m_last_error = jmsg_buf;
+        fw.f = fopen( m_filename.c_str(), "wb" );
+        if( !fw.f )
+            return false;
     }
 
-    jpeg_destroy_compress( &cinfo );
+    return encodeJpeg( img, p, fw.f, m_buf, m_last_error );
+}
+
+// Bands of MCU rows are encoded in parallel, each band starts with a new restart interval, so its
+// entropy coded segments don't depend on the previous bands (DC predictors are reset at restart markers).
+// Huffman tables are the standard ones, so the segments are concatenated under the header of the first band,
+// with restart markers between them and renumbered restart markers inside them.
+bool JpegEncoder::writeParallel( const Mat& img, const JpegEncoderParams& _p )
+{
+    JpegEncoderParams p = _p;
+    Size mcu;
+    int mcusPerRow = 0;
+    if( !getMcuLayout( img.cols, img.channels(), p, mcu, mcusPerRow ) || mcusPerRow > 65535 )
+        return false;
+
+    // bands of about 256K pixels, aligned to the restart interval, which is one band by default
+    int mcuRows = (img.rows + mcu.height - 1)/mcu.height;
+    int bandMcuRows = std::max(1, (1 << 18)/(img.cols*mcu.height));
+    if( p.rst_interval > 0 )
+    {
+        int step = p.rst_interval/gcd(p.rst_interval, mcusPerRow);
+        bandMcuRows = (bandMcuRows + step - 1)/step*step;
+    }
+    else
+    {
+        bandMcuRows = std::min(bandMcuRows, 65535/mcusPerRow);
+        p.rst_interval = bandMcuRows*mcusPerRow;
+    }
+    int nbands = (mcuRows + bandMcuRows - 1)/bandMcuRows;
+    if( nbands < 2 )
+        return false;
+
+    std::vector<std::vector<uchar> > bands(nbands);
+    std::vector<String> errors(nbands);
+    parallel_for_( Range(0, nbands), JpegBandEncoder(img, p, bandMcuRows*mcu.height, bands, errors), nbands );
+
+    std::vector<uchar> out;
+    for( int b = 0; b < nbands; b++ )
+    {
+        if( !errors[b].empty() )
+        {
+            m_last_error = errors[b];
+            return false;
+        }
+        std::vector<uchar>& band = bands[b];
+        size_t sof = 0, data = 0;
+        if( !findScanData( band, sof, data ) )
+            CV_Error( Error::StsInternal, "Unexpected layout of JPEG band" );
+
+        // intervals before the band
+        int intervals = b*bandMcuRows*mcusPerRow/p.rst_interval;
+        if( b == 0 )
+        {
+            band[sof + 5] = (uchar)(img.rows >> 8);
+            band[sof + 6] = (uchar)img.rows;
+            out.reserve( band.size()*nbands );
+            out.insert( out.end(), band.begin(), band.begin() + data );
+        }
+        else
+        {
+            out.push_back( 0xFF );
+            out.push_back( (uchar)(JPEG_RST0 + (intervals - 1) % 8) );
+        }
+
+        size_t end = band.size() - 2; // EOI
+        if( intervals % 8 != 0 )
+        {
+            // 0xFF bytes of entropy coded data are followed by stuffed zero bytes, so any other pair is a marker
+            for( size_t i = data; i + 1 < end; i++ )
+            {
+                if( band[i] == 0xFF )
+                {
+                    int marker = band[++i];
+                    if( marker >= JPEG_RST0 && marker < JPEG_RST0 + 8 )
+                        band[i] = (uchar)(JPEG_RST0 + (marker - JPEG_RST0 + intervals) % 8);
+                }
+            }
+        }
+        out.insert( out.end(), band.begin() + data, band.begin() + end );
+        std::vector<uchar>().swap( band );
+    }
+    out.push_back( 0xFF );
+    out.push_back( (uchar)JPEG_EOI );
+
+    if( m_buf )
+    {
+        m_buf->swap( out );
+        return true;
+    }
 
+    FILE* f = fopen( m_filename.c_str(), "wb" );
+    if( !f )
+        return false;
+    bool result = fwrite( &out[0], 1, out.size(), f ) == out.size();
+    result = fclose( f ) == 0 && result;
     return result;
 }
 
@@ -77,6 +77,8 @@ private:
 };
 
 
+struct JpegEncoderParams;
+
 class JpegEncoder CV_FINAL : public BaseImageEncoder
 {
 public:
@@ -85,6 +87,9 @@ public:
 
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
     ImageEncoder newEncoder() const CV_OVERRIDE;
+
+protected:
+    bool  writeParallel( const Mat& img, const JpegEncoderParams& params );
 };
 
 }
@@ -66,6 +66,7 @@
 #include <zlib.h>
 
 #include "grfmt_png.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #if defined _MSC_VER && _MSC_VER >= 1200
     // interaction between '_setjmp' and C++ object destruction is non-portable
@@ -90,6 +91,8 @@ PngDecoder::PngDecoder()
     m_info_ptr = m_end_info = 0;
     m_f = 0;
     m_buf_supported = true;
+    m_stream_supported = true;
+    m_roi_supported = true;
     m_buf_pos = 0;
     m_bit_depth = 0;
 }
@@ -139,6 +142,15 @@ void  PngDecoder::readDataFromBuf( void* _png_ptr, uchar* dst, size_t size )
     decoder->m_buf_pos += size;
 }
 
+void  PngDecoder::readDataFromStream( void* _png_ptr, uchar* dst, size_t size )
+{
+    png_structp png_ptr = (png_structp)_png_ptr;
+    PngDecoder* decoder = (PngDecoder*)(png_get_io_ptr(png_ptr));
+    CV_Assert( decoder && decoder->m_stream );
+    if( decoder->m_stream->read( dst, size ) != size )
+        png_error(png_ptr, "PNG input stream is incomplete");
+}
+
 bool  PngDecoder::readHeader()
 {
     volatile bool result = false;
@@ -160,7 +172,9 @@ bool  PngDecoder::readHeader()
         {
             if( setjmp( png_jmpbuf( png_ptr ) ) == 0 )
             {
-                if( !m_buf.empty() )
+                if( m_stream )
+                    png_set_read_fn(png_ptr, this, (png_rw_ptr)readDataFromStream );
+                else if( !m_buf.empty() )
                     png_set_read_fn(png_ptr, this, (png_rw_ptr)readDataFromBuf );
                 else
                 {
@@ -169,7 +183,7 @@ bool  PngDecoder::readHeader()
                         png_init_io( png_ptr, m_f );
                 }
 
-                if( !m_buf.empty() || m_f )
+                if( m_stream || !m_buf.empty() || m_f )
                 {
                     png_uint_32 wdth, hght;
                     int bit_depth, color_type, num_trans=0;
@@ -226,6 +240,8 @@ bool  PngDecoder::readData( Mat& img )
     volatile bool result = false;
     AutoBuffer<uchar*> _buffer(m_height);
     uchar** buffer = _buffer.data();
+    AutoBuffer<uchar> row;
+    Mat full;
     int color = img.channels() > 1;
 
     png_structp png_ptr = (png_structp)m_png_ptr;
@@ -275,14 +291,37 @@ bool  PngDecoder::readData( Mat& img )
             else
                 png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
 
-            png_set_interlace_handling( png_ptr );
+            int passes = png_set_interlace_handling( png_ptr );
             png_read_update_info( png_ptr, info_ptr );
 
-            for( y = 0; y < m_height; y++ )
-                buffer[y] = img.data + y*img.step;
+            if( m_roi.empty() || passes > 1 )
+            {
+                // interlaced image has to be decoded completely to get any of its rows
+                if( !m_roi.empty() )
+                    full.create( m_height, m_width, img.type() );
+                Mat& dst = m_roi.empty() ? img : full;
+
+                for( y = 0; y < m_height; y++ )
+                    buffer[y] = dst.data + y*dst.step;
 
-            png_read_image( png_ptr, buffer );
-            png_read_end( png_ptr, end_info );
+                png_read_image( png_ptr, buffer );
+                png_read_end( png_ptr, end_info );
+
+                if( !m_roi.empty() )
+                    full(m_roi).copyTo(img);
+            }
+            else
+            {
+                // the rows below the region are not decoded
+                row.allocate( png_get_rowbytes( png_ptr, info_ptr ) );
+                const size_t esz = img.elemSize();
+                for( y = 0; y < m_roi.y + m_roi.height; y++ )
+                {
+                    png_read_row( png_ptr, row.data(), NULL );
+                    if( y >= m_roi.y )
+                        memcpy( img.ptr(y - m_roi.y), row.data() + m_roi.x*esz, m_roi.width*esz );
+                }
+            }
 
             result = true;
         }
@@ -295,6 +334,260 @@ bool  PngDecoder::readData( Mat& img )
 
 /////////////////////// PngEncoder ///////////////////
 
+enum { PNG_FILTER_VALUE_NONE_ = 0, PNG_FILTER_VALUE_SUB_, PNG_FILTER_VALUE_UP_,
+       PNG_FILTER_VALUE_AVG_, PNG_FILTER_VALUE_PAETH_, PNG_FILTER_VALUE_COUNT_ };
+
+static inline int paethPredictor( int a, int b, int c )
+{
+    int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2*c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+#if CV_SIMD128
+static inline v_uint16x8 paethPredictor( const v_uint16x8& a, const v_uint16x8& b, const v_uint16x8& c )
+{
+    v_int16x8 sa = v_reinterpret_as_s16(a), sb = v_reinterpret_as_s16(b), sc = v_reinterpret_as_s16(c);
+    v_uint16x8 pa = v_abs(sb - sc), pb = v_abs(sa - sc), pc = v_abs(sa + sb - sc - sc);
+    return v_select((pa <= pb) & (pa <= pc), a, v_select(pb <= pc, b, c));
+}
+#endif
+
+// Filters a row of bytes in PNG byte order. prev is the unfiltered previous row (zeros for the first one)
+static void filterRow( int filter, const uchar* cur, const uchar* prev, int bpp, int len, uchar* dst )
+{
+    int i = 0;
+    switch( filter )
+    {
+    case PNG_FILTER_VALUE_NONE_:
+        memcpy( dst, cur, len );
+        return;
+    case PNG_FILTER_VALUE_SUB_:
+        for( ; i < bpp; i++ )
+            dst[i] = cur[i];
+#if CV_SIMD128
+        for( ; i <= len - 16; i += 16 )
+            v_store( dst + i, v_sub_wrap(v_load(cur + i), v_load(cur + i - bpp)) );
+#endif
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(cur[i] - cur[i - bpp]);
+        return;
+    case PNG_FILTER_VALUE_UP_:
+#if CV_SIMD128
+        for( ; i <= len - 16; i += 16 )
+            v_store( dst + i, v_sub_wrap(v_load(cur + i), v_load(prev + i)) );
+#endif
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(cur[i] - prev[i]);
+        return;
+    case PNG_FILTER_VALUE_AVG_:
+        for( ; i < bpp; i++ )
+            dst[i] = (uchar)(cur[i] - (prev[i] >> 1));
+#if CV_SIMD128
+        for( ; i <= len - 16; i += 16 )
+        {
+            v_uint16x8 a0, a1, b0, b1;
+            v_expand( v_load(cur + i - bpp), a0, a1 );
+            v_expand( v_load(prev + i), b0, b1 );
+            v_store( dst + i, v_sub_wrap(v_load(cur + i), v_pack((a0 + b0) >> 1, (a1 + b1) >> 1)) );
+        }
+#endif
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(cur[i] - ((cur[i - bpp] + prev[i]) >> 1));
+        return;
+    case PNG_FILTER_VALUE_PAETH_:
+        for( ; i < bpp; i++ )
+            dst[i] = (uchar)(cur[i] - prev[i]);
+#if CV_SIMD128
+        for( ; i <= len - 16; i += 16 )
+        {
+            v_uint16x8 a0, a1, b0, b1, c0, c1;
+            v_expand( v_load(cur + i - bpp), a0, a1 );
+            v_expand( v_load(prev + i), b0, b1 );
+            v_expand( v_load(prev + i - bpp), c0, c1 );
+            v_store( dst + i, v_sub_wrap(v_load(cur + i), v_pack(paethPredictor(a0, b0, c0),
+                                                                 paethPredictor(a1, b1, c1))) );
+        }
+#endif
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(cur[i] - paethPredictor(cur[i - bpp], prev[i], prev[i - bpp]));
+        return;
+    default:
+        CV_Error( Error::StsBadArg, "Unknown PNG filter" );
+    }
+}
+
+// Sum of absolute values of the filtered bytes taken as signed, the heuristic libpng uses to choose the filter
+static size_t filteredRowCost( const uchar* row, int len )
+{
+    int i = 0;
+    size_t cost = 0;
+#if CV_SIMD128
+    v_uint8x16 z = v_setzero_u8();
+    for( ; i <= len - 16; )
+    {
+        // u32 lanes don't overflow for rows of any reasonable length
+        v_uint32x4 s = v_setzero_u32();
+        for( int j = 0; j < 1024 && i <= len - 16; j++, i += 16 )
+        {
+            v_uint8x16 v = v_load(row + i);
+            v_uint16x8 w0, w1;
+            v_expand( v_min(v, v_sub_wrap(z, v)), w0, w1 );
+            v_uint32x4 d0, d1;
+            v_expand( w0 + w1, d0, d1 );
+            s += d0 + d1;
+        }
+        cost += v_reduce_sum(s);
+    }
+#endif
+    for( ; i < len; i++ )
+        cost += row[i] < 128 ? row[i] : 256 - row[i];
+    return cost;
+}
+
+struct PngBand
+{
+    std::vector<uchar> data;  // deflate stream of the band
+    uLong adler;              // adler32 of the filtered rows
+    size_t length;            // size of the filtered rows
+};
+
+// Filters and deflates bands of rows independently. Every band is compressed to a separate raw deflate stream
+// with the last filtered bytes of the previous band as dictionary, and all but the last streams are ended with
+// a sync flush, so the concatenation of the streams is a valid deflate stream (the same way pigz does it).
+class PngBandEncoder : public ParallelLoopBody
+{
+public:
+    PngBandEncoder( const Mat& img, int mode, int level, int strategy, int bandRows, std::vector<PngBand>& bands )
+        : img_(img), mode_(mode), level_(level), strategy_(strategy), bandRows_(bandRows), bands_(bands)
+    {
+        bpp_ = (int)img.elemSize();
+        rowBytes_ = img.cols*bpp_;
+    }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        const int dictSize = 1 << MAX_WBITS;
+        const int filteredRowBytes = rowBytes_ + 1;
+        AutoBuffer<uchar> zeros(rowBytes_), candidate(rowBytes_);
+        memset( zeros.data(), 0, rowBytes_ );
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = b*bandRows_, y1 = std::min(y0 + bandRows_, img_.rows);
+            // rows of the previous band which cover the dictionary, plus one more row to filter them
+            int ydict = y0 - std::min(y0, (dictSize + filteredRowBytes - 1)/filteredRowBytes);
+            int yraw = std::max(ydict - 1, 0);
+
+            AutoBuffer<uchar> raw((size_t)(y1 - yraw)*rowBytes_);
+            AutoBuffer<uchar> filtered((size_t)(y1 - ydict)*filteredRowBytes);
+            convertRows( yraw, y1, raw.data() );
+
+            for( int y = ydict; y < y1; y++ )
+            {
+                const uchar* cur = raw.data() + (size_t)(y - yraw)*rowBytes_;
+                const uchar* prev = y > 0 ? cur - rowBytes_ : zeros.data();
+                uchar* dst = filtered.data() + (size_t)(y - ydict)*filteredRowBytes;
+
+                int best = PNG_FILTER_VALUE_SUB_;
+                if( mode_ == IMWRITE_PNG_FAST_ADAPTIVE )
+                {
+                    size_t bestCost = 0;
+                    for( int f = PNG_FILTER_VALUE_NONE_; f < PNG_FILTER_VALUE_COUNT_; f++ )
+                    {
+                        filterRow( f, cur, prev, bpp_, rowBytes_, candidate.data() );
+                        size_t cost = filteredRowCost( candidate.data(), rowBytes_ );
+                        if( f == PNG_FILTER_VALUE_NONE_ || cost < bestCost )
+                        {
+                            best = f;
+                            bestCost = cost;
+                            memcpy( dst + 1, candidate.data(), rowBytes_ );
+                        }
+                    }
+                }
+                else
+                    filterRow( best, cur, prev, bpp_, rowBytes_, dst + 1 );
+                dst[0] = (uchar)best;
+            }
+
+            size_t dictBytes = (size_t)(y0 - ydict)*filteredRowBytes;
+            const uchar* data = filtered.data() + dictBytes;
+            size_t length = (size_t)(y1 - y0)*filteredRowBytes;
+            CV_Assert( length <= (size_t)INT_MAX );
+
+            PngBand& band = bands_[b];
+            band.length = length;
+            band.adler = adler32( adler32(0, 0, 0), data, (uInt)length );
+
+            z_stream strm;
+            memset( &strm, 0, sizeof(strm) );
+            if( deflateInit2(&strm, level_, Z_DEFLATED, -MAX_WBITS, 8, strategy_) != Z_OK )
+                CV_Error( Error::StsError, "Can't initialize deflate stream" );
+            if( dictBytes > 0 )
+            {
+                size_t n = std::min(dictBytes, (size_t)dictSize);
+                deflateSetDictionary( &strm, data - n, (uInt)n );
+            }
+            // deflateBound() doesn't count the empty stored block emitted by the sync flush
+            band.data.resize( deflateBound(&strm, (uLong)length) + 16 );
+            strm.next_in = (Bytef*)data;
+            strm.avail_in = (uInt)length;
+            strm.next_out = &band.data[0];
+            strm.avail_out = (uInt)band.data.size();
+            int status = deflate( &strm, y1 == img_.rows ? Z_FINISH : Z_SYNC_FLUSH );
+            size_t total = strm.total_out;
+            deflateEnd( &strm );
+            if( (status != Z_OK && status != Z_STREAM_END) || strm.avail_in != 0 )
+                CV_Error( Error::StsError, "Can't deflate PNG image data" );
+            band.data.resize( total );
+        }
+    }
+
+private:
+    // Converts rows to PNG byte order: RGB(A) instead of BGR(A) and big endian 16-bit samples
+    void convertRows( int y0, int y1, uchar* dst ) const
+    {
+        Mat src = img_.rowRange(y0, y1);
+        Mat rows(y1 - y0, img_.cols, img_.type(), dst, rowBytes_);
+        if( img_.channels() == 3 )
+            cvtColor( src, rows, COLOR_BGR2RGB );
+        else if( img_.channels() == 4 )
+            cvtColor( src, rows, COLOR_BGRA2RGBA );
+        else
+            src.copyTo( rows );
+
+        if( img_.depth() == CV_16U && !isBigEndian() )
+        {
+            ushort* p = (ushort*)dst;
+            for( size_t i = 0, n = (size_t)(y1 - y0)*rowBytes_/2; i < n; i++ )
+                p[i] = (ushort)((p[i] >> 8) | (p[i] << 8));
+        }
+    }
+
+    const Mat& img_;
+    int mode_, level_, strategy_, bandRows_, bpp_, rowBytes_;
+    std::vector<PngBand>& bands_;
+};
+
+static void putUInt32BE( std::vector<uchar>& out, unsigned v )
+{
+    uchar bytes[] = { (uchar)(v >> 24), (uchar)(v >> 16), (uchar)(v >> 8), (uchar)v };
+    out.insert( out.end(), bytes, bytes + 4 );
+}
+
+static void writeChunk( std::vector<uchar>& out, const char* type, const uchar* data, size_t size )
+{
+    CV_Assert( size <= (size_t)INT_MAX );
+    putUInt32BE( out, (unsigned)size );
+    out.insert( out.end(), type, type + 4 );
+    uLong crc = crc32( crc32(0, 0, 0), (const Bytef*)type, 4 );
+    if( size > 0 )
+    {
+        out.insert( out.end(), data, data + size );
+        crc = crc32( crc, data, (uInt)size );
+    }
+    putUInt32BE( out, (unsigned)crc );
+}
+
 
 PngEncoder::PngEncoder()
 {
@@ -372,6 +665,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                 int compression_level = -1; // Invalid value to allow setting 0-9 as valid
                 int compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
                 bool isBilevel = false;
+                int fast_mode = IMWRITE_PNG_FAST_NONE;
 
                 for( size_t i = 0; i < params.size(); i += 2 )
                 {
@@ -390,6 +684,23 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     {
                         isBilevel = params[i+1] != 0;
                     }
+                    if( params[i] == IMWRITE_PNG_FAST )
+                    {
+                        fast_mode = MIN(MAX(params[i+1], (int)IMWRITE_PNG_FAST_NONE), (int)IMWRITE_PNG_FAST_ADAPTIVE);
+                    }
+                }
+
+                if( fast_mode != IMWRITE_PNG_FAST_NONE && !isBilevel && channels != 2 && (m_buf || f) )
+                {
+                    if( f )
+                    {
+                        fclose( (FILE*)f );
+                        f = 0;
+                    }
+                    png_destroy_write_struct( &png_ptr, &info_ptr );
+                    return writeFast( img, fast_mode,
+                                      compression_level >= 0 ? compression_level : Z_BEST_SPEED,
+                                      compression_strategy );
                 }
 
                 if( m_buf || f )
@@ -441,6 +752,69 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
     return result;
 }
 
+bool  PngEncoder::writeFast( const Mat& img, int mode, int level, int strategy )
+{
+    CV_Assert( img.depth() == CV_8U || img.depth() == CV_16U );
+    CV_Assert( img.channels() == 1 || img.channels() == 3 || img.channels() == 4 );
+
+    // bands of about 256KB of image data are big enough to keep the compression ratio
+    size_t rowBytes = img.cols*img.elemSize();
+    int bandRows = (int)std::max((size_t)1, std::min((size_t)img.rows, ((size_t)1 << 18)/rowBytes));
+    int nbands = (img.rows + bandRows - 1)/bandRows;
+    std::vector<PngBand> bands(nbands);
+    parallel_for_( Range(0, nbands), PngBandEncoder(img, mode, level, strategy, bandRows, bands), nbands );
+
+    std::vector<uchar> out;
+    const uchar signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    out.insert( out.end(), signature, signature + sizeof(signature) );
+
+    std::vector<uchar> ihdr;
+    putUInt32BE( ihdr, img.cols );
+    putUInt32BE( ihdr, img.rows );
+    ihdr.push_back( img.depth() == CV_8U ? 8 : 16 );
+    ihdr.push_back( img.channels() == 1 ? PNG_COLOR_TYPE_GRAY :
+                    img.channels() == 3 ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGBA );
+    ihdr.push_back( PNG_COMPRESSION_TYPE_DEFAULT );
+    ihdr.push_back( PNG_FILTER_TYPE_DEFAULT );
+    ihdr.push_back( PNG_INTERLACE_NONE );
+    writeChunk( out, "IHDR", &ihdr[0], ihdr.size() );
+
+    // zlib header for 32K window with the compression level hint, followed by the bands
+    // and the adler32 of all the filtered data
+    int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    unsigned header = (0x78 << 8) | (flevel << 6);
+    header += 31 - header % 31;
+    uchar zheader[] = { (uchar)(header >> 8), (uchar)header };
+    bands[0].data.insert( bands[0].data.begin(), zheader, zheader + 2 );
+
+    uLong adler = adler32( 0, 0, 0 );
+    for( int b = 0; b < nbands; b++ )
+        adler = adler32_combine( adler, bands[b].adler, (z_off_t)bands[b].length );
+    std::vector<uchar> trailer;
+    putUInt32BE( trailer, (unsigned)adler );
+    bands[nbands - 1].data.insert( bands[nbands - 1].data.end(), trailer.begin(), trailer.end() );
+
+    for( int b = 0; b < nbands; b++ )
+    {
+        writeChunk( out, "IDAT", &bands[b].data[0], bands[b].data.size() );
+        std::vector<uchar>().swap( bands[b].data );
+    }
+    writeChunk( out, "IEND", 0, 0 );
+
+    if( m_buf )
+    {
+        m_buf->swap( out );
+        return true;
+    }
+
+    FILE* f = fopen( m_filename.c_str(), "wb" );
+    if( !f )
+        return false;
+    bool result = fwrite( &out[0], 1, out.size(), f ) == out.size();
+    result = fclose( f ) == 0 && result;
+    return result;
+}
+
 }
 
 #endif
@@ -67,6 +67,7 @@ public:
 protected:
 
     static void readDataFromBuf(void* png_ptr, uchar* dst, size_t size);
+    static void readDataFromStream(void* png_ptr, uchar* dst, size_t size);
 
     int   m_bit_depth;
     void* m_png_ptr;  // pointer to decompression structure
@@ -92,6 +93,8 @@ public:
 protected:
     static void writeDataToBuf(void* png_ptr, uchar* src, size_t size);
     static void flushBuf(void* png_ptr);
+
+    bool  writeFast( const Mat& img, int mode, int level, int strategy );
 };
 
 }
@@ -345,7 +345,7 @@ bad_decoding_end:
                     if( m_type == RAS_FORMAT_RGB )
                         icvCvt_RGB2BGR_8u_C3R(src, 0, data, 0, cvSize(m_width,1) );
                     else
-                        memcpy(data, src, std::min(step, (size_t)src_pitch));
+                        memcpy(data, src, std::min(step, (size_t)width3));
                 }
                 else
                 {
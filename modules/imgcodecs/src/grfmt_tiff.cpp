@@ -80,6 +80,7 @@ TiffDecoder::TiffDecoder()
     }
     m_hdr = false;
     m_buf_supported = true;
+    m_roi_supported = true;
     m_buf_pos = 0;
 }
 
@@ -288,15 +289,25 @@ bool TiffDecoder::nextPage()
            readHeader();
 }
 
+bool TiffDecoder::setPage( int page )
+{
+    return m_tif &&
+           TIFFSetDirectory(static_cast<TIFF*>(m_tif), (uint16)page) &&
+           readHeader();
+}
+
 bool  TiffDecoder::readData( Mat& img )
 {
-    if(m_hdr && img.type() == CV_32FC3)
+    if((m_hdr && img.type() == CV_32FC3) || img.type() == CV_32FC1)
     {
-        return readData_32FC3(img);
-    }
-    if(img.type() == CV_32FC1)
-    {
-        return readData_32FC1(img);
+        // these formats are read by strips into continuous memory,
+        // so the region is cropped from the whole image
+        const bool direct = m_roi.empty() && img.isContinuous();
+        Mat full = direct ? img : Mat(m_height, m_width, img.type());
+        bool ok = img.type() == CV_32FC3 ? readData_32FC3(full) : readData_32FC1(full);
+        if( ok && !direct )
+            (m_roi.empty() ? full : full(m_roi)).copyTo(img);
+        return ok;
     }
     bool result = false;
     bool color = img.channels() > 1;
@@ -359,7 +370,11 @@ bool  TiffDecoder::readData( Mat& img )
             ushort* buffer16 = (ushort*)buffer;
             float* buffer32 = (float*)buffer;
             double* buffer64 = (double*)buffer;
-            int tileidx = 0;
+            const int tiles_across = (m_width + tile_width0 - 1) / tile_width0;
+            const int cn = img.channels();
+
+            // only the tiles (strips) intersecting the region are read
+            const Rect roi = m_roi.empty() ? Rect(0, 0, m_width, m_height) : m_roi;
 
             for( y = 0; y < m_height; y += tile_height0 )
             {
@@ -368,15 +383,25 @@ bool  TiffDecoder::readData( Mat& img )
                 if( y + tile_height > m_height )
                     tile_height = m_height - y;
 
-                uchar* data = img.ptr(vert_flip ? m_height - y - tile_height : y);
+                const int dst_y = vert_flip ? m_height - y - tile_height : y;
+                if( dst_y >= roi.y + roi.height || dst_y + tile_height <= roi.y )
+                    continue;
 
-                for( x = 0; x < m_width; x += tile_width0, tileidx++ )
+                for( x = 0; x < m_width; x += tile_width0 )
                 {
                     int tile_width = tile_width0, ok;
 
                     if( x + tile_width > m_width )
                         tile_width = m_width - x;
 
+                    const int x0 = std::max(x, roi.x), x1 = std::min(x + tile_width, roi.x + roi.width);
+                    if( x0 >= x1 )
+                        continue;
+
+                    const int tileidx = (y / tile_height0) * tiles_across + x / tile_width0;
+                    const int src_x = x0 - x, dst_x = x0 - roi.x;
+                    const CvSize roi_size = cvSize(x1 - x0, 1);
+
                     switch(dst_bpp)
                     {
                         case 8:
@@ -397,25 +422,26 @@ bool  TiffDecoder::readData( Mat& img )
                             }
 
                             for( i = 0; i < tile_height; i++ )
+                            {
+                                const int row = dst_y + tile_height - i - 1;
+                                if( row < roi.y || row >= roi.y + roi.height )
+                                    continue;
+                                const uchar* src = bstart + (i*tile_width0 + src_x)*4;
+                                uchar* dst = img.ptr(row - roi.y) + dst_x*cn;
                                 if( color )
                                 {
                                     if (wanted_channels == 4)
                                     {
-                                        icvCvt_BGRA2RGBA_8u_C4R( bstart + i*tile_width0*4, 0,
-                                                             data + x*4 + img.step*(tile_height - i - 1), 0,
-                                                             cvSize(tile_width,1) );
+                                        icvCvt_BGRA2RGBA_8u_C4R( src, 0, dst, 0, roi_size );
                                     }
                                     else
                                     {
-                                        icvCvt_BGRA2BGR_8u_C4C3R( bstart + i*tile_width0*4, 0,
-                                                             data + x*3 + img.step*(tile_height - i - 1), 0,
-                                                             cvSize(tile_width,1), 2 );
+                                        icvCvt_BGRA2BGR_8u_C4C3R( src, 0, dst, 0, roi_size, 2 );
                                     }
                                 }
                                 else
-                                    icvCvt_BGRA2Gray_8u_C4C1R( bstart + i*tile_width0*4, 0,
-                                                              data + x + img.step*(tile_height - i - 1), 0,
-                                                              cvSize(tile_width,1), 2 );
+                                    icvCvt_BGRA2Gray_8u_C4C1R( src, 0, dst, 0, roi_size, 2 );
+                            }
                             break;
                         }
 
@@ -434,55 +460,46 @@ bool  TiffDecoder::readData( Mat& img )
 
                             for( i = 0; i < tile_height; i++ )
                             {
+                                const int row = dst_y + i;
+                                if( row < roi.y || row >= roi.y + roi.height )
+                                    continue;
+                                const ushort* src = buffer16 + (i*tile_width0 + src_x)*ncn;
+                                ushort* dst = img.ptr<ushort>(row - roi.y) + dst_x*cn;
                                 if( color )
                                 {
                                     if( ncn == 1 )
                                     {
-                                        icvCvt_Gray2BGR_16u_C1C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                                  (ushort*)(data + img.step*i) + x*3, 0,
-                                                                  cvSize(tile_width,1) );
+                                        icvCvt_Gray2BGR_16u_C1C3R(src, 0, dst, 0, roi_size );
                                     }
                                     else if( ncn == 3 )
                                     {
-                                        icvCvt_RGB2BGR_16u_C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
-                                                               cvSize(tile_width,1) );
+                                        icvCvt_RGB2BGR_16u_C3R(src, 0, dst, 0, roi_size );
                                     }
                                     else if (ncn == 4)
                                     {
                                         if (wanted_channels == 4)
                                         {
-                                            icvCvt_BGRA2RGBA_16u_C4R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 4, 0,
-                                                cvSize(tile_width, 1));
+                                            icvCvt_BGRA2RGBA_16u_C4R(src, 0, dst, 0, roi_size);
                                         }
                                         else
                                         {
-                                            icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 3, 0,
-                                                cvSize(tile_width, 1), 2);
+                                            icvCvt_BGRA2BGR_16u_C4C3R(src, 0, dst, 0, roi_size, 2);
                                         }
                                     }
                                     else
                                     {
-                                        icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
-                                                               cvSize(tile_width,1), 2 );
+                                        icvCvt_BGRA2BGR_16u_C4C3R(src, 0, dst, 0, roi_size, 2 );
                                     }
                                 }
                                 else
                                 {
                                     if( ncn == 1 )
                                     {
-                                        memcpy((ushort*)(data + img.step*i)+x,
-                                               buffer16 + i*tile_width0*ncn,
-                                               tile_width*sizeof(buffer16[0]));
+                                        memcpy(dst, src, roi_size.width*sizeof(buffer16[0]));
                                     }
                                     else
                                     {
-                                        icvCvt_BGRA2Gray_16u_CnC1R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x, 0,
-                                                               cvSize(tile_width,1), ncn, 2 );
+                                        icvCvt_BGRA2Gray_16u_CnC1R(src, 0, dst, 0, roi_size, ncn, 2 );
                                     }
                                 }
                             }
@@ -505,17 +522,20 @@ bool  TiffDecoder::readData( Mat& img )
 
                             for( i = 0; i < tile_height; i++ )
                             {
+                                const int row = dst_y + i;
+                                if( row < roi.y || row >= roi.y + roi.height )
+                                    continue;
                                 if(dst_bpp == 32)
                                 {
-                                    memcpy((float*)(data + img.step*i)+x,
-                                           buffer32 + i*tile_width0*ncn,
-                                           tile_width*sizeof(buffer32[0]));
+                                    memcpy(img.ptr<float>(row - roi.y) + dst_x,
+                                           buffer32 + i*tile_width0 + src_x,
+                                           roi_size.width*sizeof(buffer32[0]));
                                 }
                                 else
                                 {
-                                    memcpy((double*)(data + img.step*i)+x,
-                                         buffer64 + i*tile_width0*ncn,
-                                         tile_width*sizeof(buffer64[0]));
+                                    memcpy(img.ptr<double>(row - roi.y) + dst_x,
+                                           buffer64 + i*tile_width0 + src_x,
+                                           roi_size.width*sizeof(buffer64[0]));
                                 }
                             }
 
@@ -997,6 +1017,419 @@ bool  TiffEncoder::write( const Mat& img, const std::vector<int>& params)
     return writeLibTiff(img_vec, params);
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Tiled multi-resolution TIFF
+
+static bool setTiledTags( TIFF* tif, Size size, int type, Size tileSize, int level,
+                          int compression, int predictor, int resUnit, int dpiX, int dpiY )
+{
+    int channels = CV_MAT_CN(type);
+    float scale = 1.f/(1 << level);
+    return TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, size.width)
+        && TIFFSetField(tif, TIFFTAG_IMAGELENGTH, size.height)
+        && TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, CV_MAT_DEPTH(type) == CV_8U ? 8 : 16)
+        && TIFFSetField(tif, TIFFTAG_COMPRESSION, compression)
+        && TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK)
+        && TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels)
+        && TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
+        && TIFFSetField(tif, TIFFTAG_TILEWIDTH, tileSize.width)
+        && TIFFSetField(tif, TIFFTAG_TILELENGTH, tileSize.height)
+        && (level == 0 || TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE))
+        && (compression == COMPRESSION_NONE || TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor))
+        && (!(resUnit >= RESUNIT_NONE && resUnit <= RESUNIT_CENTIMETER) || TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, resUnit))
+        && (dpiX < 0 || TIFFSetField(tif, TIFFTAG_XRESOLUTION, dpiX*scale))
+        && (dpiY < 0 || TIFFSetField(tif, TIFFTAG_YRESOLUTION, dpiY*scale));
+}
+
+class TiledTiffWriterImpl CV_FINAL : public TiledTiffWriter
+{
+public:
+    TiledTiffWriterImpl( const String& filename, Size size, int type, int levels, Size tileSize,
+                         const std::vector<int>& params )
+        : tileSize_(tileSize), type_(type), nextTile_(0, 0), released_(false)
+    {
+        CV_Assert( size.width > 0 && size.height > 0 );
+        CV_Assert( (CV_MAT_DEPTH(type) == CV_8U || CV_MAT_DEPTH(type) == CV_16U) &&
+                   (CV_MAT_CN(type) == 1 || CV_MAT_CN(type) == 3 || CV_MAT_CN(type) == 4) );
+        CV_Assert( tileSize.width > 0 && tileSize.height > 0 && tileSize.width % 16 == 0 && tileSize.height % 16 == 0 );
+        CV_Assert( levels >= 0 );
+
+        compression_ = COMPRESSION_LZW;
+        predictor_ = PREDICTOR_HORIZONTAL;
+        resUnit_ = dpiX_ = dpiY_ = -1;
+        readParam(params, TIFFTAG_COMPRESSION, compression_);
+        readParam(params, TIFFTAG_PREDICTOR, predictor_);
+        readParam(params, IMWRITE_TIFF_RESUNIT, resUnit_);
+        readParam(params, IMWRITE_TIFF_XDPI, dpiX_);
+        readParam(params, IMWRITE_TIFF_YDPI, dpiY_);
+
+        // the same sizes as pyrDown produces
+        double total = 0;
+        for( Size s = size; ; s = Size((s.width + 1)/2, (s.height + 1)/2) )
+        {
+            levels_.push_back(Level());
+            levels_.back().size = s;
+            total += (double)s.area()*CV_ELEM_SIZE(type);
+            if( levels > 0 ? (int)levels_.size() == levels :
+                s.width <= tileSize.width && s.height <= tileSize.height )
+                break;
+            if( s.width == 1 && s.height == 1 )
+                break;
+        }
+
+        // compressed data may be a bit larger than the image data, keep the safety margin
+        const bool bigTiff = total >= (double)(1u << 31);
+        for( size_t i = 0; i < levels_.size(); i++ )
+        {
+            Level& l = levels_[i];
+            // do NOT put "wb" as the mode, because the b means "big endian" mode, not "binary" mode.
+            if( i == 0 )
+                l.tif = TIFFOpen(filename.c_str(), bigTiff ? "w8" : "w");
+            else
+            {
+                l.filename = tempfile(".tif");
+                l.tif = TIFFOpen(l.filename.c_str(), "w8");
+            }
+            if( !l.tif || !setTiledTags(l.tif, l.size, type, tileSize, (int)i,
+                                        compression_, predictor_, resUnit_, dpiX_, dpiY_) )
+            {
+                closeFiles();
+                CV_Error( Error::StsError, "Can't create TIFF file " + (i == 0 ? filename : l.filename) );
+            }
+            l.band.create(tileSize.height, l.size.width, type);
+        }
+        tileBuf_.allocate((size_t)tileSize.area()*CV_ELEM_SIZE(type));
+    }
+
+    ~TiledTiffWriterImpl() CV_OVERRIDE
+    {
+        if( !released_ )
+            closeFiles();
+    }
+
+    void writeTile( InputArray _tile ) CV_OVERRIDE
+    {
+        Level& l = levels_[0];
+        CV_Assert( !released_ && l.received < l.size.height );
+
+        Rect r(nextTile_.x*tileSize_.width, 0, 0, 0);
+        r.width = std::min(tileSize_.width, l.size.width - r.x);
+        r.height = std::min(tileSize_.height, l.size.height - l.received);
+        Mat tile = _tile.getMat();
+        CV_Assert( tile.type() == type_ && tile.size() == r.size() );
+        tile.copyTo(l.band(r));
+
+        if( r.x + r.width < l.size.width )
+        {
+            nextTile_.x++;
+            return;
+        }
+        nextTile_ = Point(0, nextTile_.y + 1);
+        l.bandRows = r.height;
+        l.received += r.height;
+        flushBand(0);
+    }
+
+    void release() CV_OVERRIDE
+    {
+        CV_Assert( !released_ );
+        if( levels_[0].received < levels_[0].size.height )
+        {
+            closeFiles();
+            released_ = true;
+            CV_Error( Error::StsError, "Not all the tiles are written" );
+        }
+
+        TIFF* tif = levels_[0].tif;
+        bool ok = TIFFWriteDirectory(tif) != 0;
+        std::vector<uchar> buf;
+        // copy compressed tiles of the lower levels
+        for( size_t i = 1; i < levels_.size() && ok; i++ )
+        {
+            Level& l = levels_[i];
+            CV_Assert( l.received == l.size.height );
+            TIFFClose(l.tif);
+            l.tif = TIFFOpen(l.filename.c_str(), "r");
+            toff_t* counts = 0;
+            ok = l.tif && setTiledTags(tif, l.size, type_, tileSize_, (int)i,
+                                       compression_, predictor_, resUnit_, dpiX_, dpiY_) &&
+                 TIFFGetField(l.tif, TIFFTAG_TILEBYTECOUNTS, &counts);
+            for( ttile_t t = 0, n = ok ? TIFFNumberOfTiles(l.tif) : 0; t < n && ok; t++ )
+            {
+                buf.resize((size_t)counts[t] + 1);
+                ok = TIFFReadRawTile(l.tif, t, &buf[0], (tmsize_t)counts[t]) == (tmsize_t)counts[t] &&
+                     TIFFWriteRawTile(tif, t, &buf[0], (tmsize_t)counts[t]) == (tmsize_t)counts[t];
+            }
+            ok = ok && TIFFWriteDirectory(tif);
+        }
+        closeFiles();
+        released_ = true;
+        if( !ok )
+            CV_Error( Error::StsError, "Can't write TIFF pyramid levels" );
+    }
+
+private:
+    struct Level
+    {
+        Level() : tif(0), bandRows(0), received(0), pyrStart(0), produced(0) {}
+
+        Size size;
+        TIFF* tif;
+        String filename;  // temporary file of a reduced level
+        Mat band;         // row of tiles being filled
+        int bandRows;     // rows filled in the band
+        int received;     // rows of the level received so far
+        Mat pyr;          // rows kept to produce the next level
+        int pyrStart;     // index of the first row of pyr
+        int produced;     // rows of the next level produced so far
+    };
+
+    void pushRows( int level, const Mat& rows )
+    {
+        Level& l = levels_[level];
+        for( int i = 0; i < rows.rows; )
+        {
+            int n = std::min(rows.rows - i, tileSize_.height - l.bandRows);
+            rows.rowRange(i, i + n).copyTo(l.band.rowRange(l.bandRows, l.bandRows + n));
+            l.bandRows += n;
+            l.received += n;
+            i += n;
+            if( l.bandRows == tileSize_.height || l.received == l.size.height )
+                flushBand(level);
+        }
+    }
+
+    // Writes the band as a row of tiles and passes its rows to the next level
+    void flushBand( int level )
+    {
+        Level& l = levels_[level];
+        int y = l.received - l.bandRows;
+        int channels = CV_MAT_CN(type_);
+        Mat tile(tileSize_, type_, tileBuf_.data());
+        for( int x = 0; x < l.size.width; x += tileSize_.width )
+        {
+            Rect r(x, 0, std::min(tileSize_.width, l.size.width - x), l.bandRows);
+            if( r.size() != tileSize_ )
+                tile.setTo(Scalar::all(0));
+            Mat dst = tile(Rect(Point(), r.size()));
+            if( channels == 3 )
+                cvtColor(l.band(r), dst, COLOR_BGR2RGB);
+            else if( channels == 4 )
+                cvtColor(l.band(r), dst, COLOR_BGRA2RGBA);
+            else
+                l.band(r).copyTo(dst);
+
+            if( TIFFWriteEncodedTile(l.tif, TIFFComputeTile(l.tif, x, y, 0, 0),
+                                     tile.data, (tmsize_t)(tile.total()*tile.elemSize())) < 0 )
+                CV_Error( Error::StsError, "Can't write TIFF tile" );
+        }
+
+        if( level + 1 < (int)levels_.size() )
+        {
+            Mat rows = l.band.rowRange(0, l.bandRows);
+            if( l.pyr.empty() )
+                rows.copyTo(l.pyr);
+            else
+            {
+                Mat joined;
+                vconcat(l.pyr, rows, joined);
+                l.pyr = joined;
+            }
+            l.bandRows = 0;
+            pyrDownRows(level);
+        }
+        l.bandRows = 0;
+    }
+
+    // Produces rows of the next level which depend only on the received rows. pyrDown of a window of rows
+    // starting at an even row gives the same rows as pyrDown of the whole image, except the rows
+    // which 5-tap vertical kernel goes over the window borders inside the image.
+    void pyrDownRows( int level )
+    {
+        Level& l = levels_[level];
+        int end = l.pyrStart + l.pyr.rows;
+        bool complete = end == l.size.height;
+        // the next level row o uses rows 2*o - 2 ... 2*o + 2
+        int outEnd = complete ? (l.size.height + 1)/2 : end >= 3 ? (end - 3)/2 + 1 : 0;
+        if( outEnd <= l.produced )
+            return;
+
+        int start = l.pyrStart;
+        int windowEnd = complete ? end : std::min(end, 2*outEnd + 1);
+        Mat window = windowEnd == end ? l.pyr : l.pyr.rowRange(0, windowEnd - start).clone();
+        Mat down;
+        pyrDown(window, down, Size((l.size.width + 1)/2, (window.rows + 1)/2));
+        Mat out = down.rowRange(l.produced - start/2, outEnd - start/2);
+        l.produced = outEnd;
+
+        int keep = complete ? end : std::max(0, 2*outEnd - 2);
+        if( keep > start )
+        {
+            l.pyr = keep < end ? l.pyr.rowRange(keep - start, end - start).clone() : Mat();
+            l.pyrStart = keep;
+        }
+        pushRows(level + 1, out);
+    }
+
+    void closeFiles()
+    {
+        for( size_t i = 0; i < levels_.size(); i++ )
+        {
+            Level& l = levels_[i];
+            if( l.tif )
+                TIFFClose(l.tif);
+            l.tif = 0;
+            if( !l.filename.empty() )
+                remove(l.filename.c_str());
+        }
+    }
+
+    std::vector<Level> levels_;
+    Size tileSize_;
+    int type_;
+    int compression_, predictor_, resUnit_, dpiX_, dpiY_;
+    Point nextTile_;
+    bool released_;
+    AutoBuffer<uchar> tileBuf_;
+};
+
+Ptr<TiledTiffWriter> TiledTiffWriter::create( const String& filename, Size size, int type, int levels,
+                                              Size tileSize, const std::vector<int>& params )
+{
+    return makePtr<TiledTiffWriterImpl>(filename, size, type, levels, tileSize, params);
+}
+
+class TiledTiffReaderImpl CV_FINAL : public TiledTiffReader
+{
+public:
+    explicit TiledTiffReaderImpl( const String& filename ) : current_(0)
+    {
+        TIFF* tif = TIFFOpen(filename.c_str(), "r");
+        if( !tif )
+            CV_Error( Error::StsError, "Can't open TIFF file " + filename );
+        // the first directory and the following reduced resolution ones
+        do
+        {
+            uint32 width = 0, height = 0, tileWidth = 0, tileHeight = 0, subfileType = 0;
+            TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+            TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+            TIFFGetField(tif, TIFFTAG_SUBFILETYPE, &subfileType);
+            if( !levels_.empty() && !(subfileType & FILETYPE_REDUCEDIMAGE) )
+                break;
+            if( TIFFIsTiled(tif) )
+            {
+                TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tileWidth);
+                TIFFGetField(tif, TIFFTAG_TILELENGTH, &tileHeight);
+            }
+            else
+            {
+                tileWidth = width;
+                tileHeight = height;
+                TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &tileHeight);
+                tileHeight = std::min(tileHeight, height);
+            }
+            Level l;
+            l.page = (int)TIFFCurrentDirectory(tif);
+            l.size = Size((int)width, (int)height);
+            l.tileSize = Size((int)tileWidth, (int)tileHeight);
+            levels_.push_back(l);
+        }
+        while( TIFFReadDirectory(tif) );
+        TIFFClose(tif);
+
+        if( !decoder_.setSource(filename) || !decoder_.readHeader() )
+            CV_Error( Error::StsError, "Can't read TIFF file " + filename );
+        type_ = decoder_.type();
+    }
+
+    int getLevels() const CV_OVERRIDE { return (int)levels_.size(); }
+    int getType() const CV_OVERRIDE { return type_; }
+
+    Size getSize( int level ) const CV_OVERRIDE
+    {
+        CV_Assert( 0 <= level && level < (int)levels_.size() );
+        return levels_[level].size;
+    }
+
+    Size getTileSize( int level ) const CV_OVERRIDE
+    {
+        CV_Assert( 0 <= level && level < (int)levels_.size() );
+        return levels_[level].tileSize;
+    }
+
+    void readTile( int level, Point tile, OutputArray dst ) CV_OVERRIDE
+    {
+        Size size = getSize(level), tileSize = getTileSize(level);
+        Rect r = Rect(Point(tile.x*tileSize.width, tile.y*tileSize.height), tileSize) & Rect(Point(), size);
+        CV_Assert( tile.x >= 0 && tile.y >= 0 && !r.empty() );
+        readRegion(level, r, dst);
+    }
+
+    void readRegion( int level, const Rect& roi, OutputArray dst ) CV_OVERRIDE
+    {
+        Size size = getSize(level);
+        if( roi.empty() || (roi & Rect(Point(), size)) != roi )
+            CV_Error_( Error::StsBadArg, ("region (%d, %d, %d x %d) is outside of the %d x %d level %d",
+                       roi.x, roi.y, roi.width, roi.height, size.width, size.height, level) );
+        if( level != current_ )
+        {
+            if( !decoder_.setPage(levels_[level].page) )
+                CV_Error( Error::StsError, "Can't read TIFF directory" );
+            current_ = level;
+        }
+        decoder_.setROI(roi);
+        dst.create(roi.size(), decoder_.type());
+        Mat img = dst.getMat();
+        if( !decoder_.readData(img) )
+            CV_Error( Error::StsError, "Can't read TIFF image data" );
+    }
+
+private:
+    struct Level
+    {
+        int page;
+        Size size;
+        Size tileSize;
+    };
+
+    std::vector<Level> levels_;
+    TiffDecoder decoder_;
+    int type_;
+    int current_;
+};
+
+Ptr<TiledTiffReader> TiledTiffReader::create( const String& filename )
+{
+    return makePtr<TiledTiffReaderImpl>(filename);
+}
+
 } // namespace
 
-#endif
+#else // HAVE_TIFF
+
+namespace cv
+{
+
+Ptr<TiledTiffWriter> TiledTiffWriter::create( const String&, Size, int, int, Size, const std::vector<int>& )
+{
+    CV_Error( Error::StsNotImplemented, "OpenCV is built without TIFF support" );
+}
+
+Ptr<TiledTiffReader> TiledTiffReader::create( const String& )
+{
+    CV_Error( Error::StsNotImplemented, "OpenCV is built without TIFF support" );
+}
+
+} // namespace
+
+#endif // HAVE_TIFF
+
+namespace cv
+{
+
+TiledTiffWriter::~TiledTiffWriter() {}
+
+TiledTiffReader::~TiledTiffReader() {}
+
+} // namespace
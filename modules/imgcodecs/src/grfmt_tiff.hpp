@@ -100,6 +100,7 @@ public:
     bool  readData( Mat& img ) CV_OVERRIDE;
     void  close();
     bool  nextPage() CV_OVERRIDE;
+    bool  setPage( int page );
 
     size_t signatureLength() const CV_OVERRIDE;
     bool checkSignature( const String& signature ) const CV_OVERRIDE;
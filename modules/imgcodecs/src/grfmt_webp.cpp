@@ -165,31 +165,39 @@ bool WebPDecoder::readData(Mat &img)
     {
         bool convert_grayscale = (img.type() == CV_8UC1); // IMREAD_GRAYSCALE requested
 
+        // grayscale image is converted into img, which may be a part of the caller's matrix
+        Mat read_img = img;
         if (img.cols != m_width || img.rows != m_height || img.type() != m_type)
         {
-            img.create(m_height, m_width, m_type);
+            if (convert_grayscale)
+                read_img.create(m_height, m_width, m_type);
+            else
+            {
+                img.create(m_height, m_width, m_type);
+                read_img = img;
+            }
         }
 
-        uchar* out_data = img.ptr();
-        size_t out_data_size = img.cols * img.rows * img.elemSize();
+        uchar* out_data = read_img.ptr();
+        size_t out_data_size = read_img.step * (read_img.rows - 1) + read_img.cols * read_img.elemSize();
 
         uchar *res_ptr = 0;
         if (channels == 3)
         {
             res_ptr = WebPDecodeBGRInto(data.ptr(), data.total(), out_data,
-                                        (int)out_data_size, (int)img.step);
+                                        (int)out_data_size, (int)read_img.step);
         }
         else if (channels == 4)
         {
             res_ptr = WebPDecodeBGRAInto(data.ptr(), data.total(), out_data,
-                                         (int)out_data_size, (int)img.step);
+                                         (int)out_data_size, (int)read_img.step);
         }
 
         if(res_ptr == out_data)
         {
             if (convert_grayscale)
             {
-                cvtColor(img, img, COLOR_BGR2GRAY);
+                cvtColor(read_img, img, COLOR_BGR2GRAY);
             }
             return true;
         }
@@ -47,6 +47,7 @@
 #include "grfmts.hpp"
 #include "utils.hpp"
 #include "exif.hpp"
+#include <opencv2/core/utils/logger.hpp>
 #undef min
 #undef max
 #include <iostream>
@@ -76,6 +77,14 @@ static Size validateInputImageSize(const Size& size)
 }
 
 
+static void validateROI(const Rect& roi, const Size& size)
+{
+    if( roi.empty() || (roi & Rect(Point(), size)) != roi )
+        CV_Error_(Error::StsBadArg, ("region (%d, %d, %d x %d) is outside of the %d x %d image",
+                  roi.x, roi.y, roi.width, roi.height, size.width, size.height));
+}
+
+
 namespace {
 
 class ByteStreamBuffer: public std::streambuf
@@ -257,6 +266,16 @@ static ImageDecoder findDecoder( const Mat& buf )
     return ImageDecoder();
 }
 
+static ImageDecoder findDecoder( ImageStream& stream )
+{
+    size_t maxlen = 0;
+    for( size_t i = 0; i < codecs.decoders.size(); i++ )
+        maxlen = std::max(maxlen, codecs.decoders[i]->signatureLength());
+
+    const std::vector<uchar>& head = stream.peek( maxlen );
+    return head.empty() ? ImageDecoder() : findDecoder( Mat(head) );
+}
+
 static ImageEncoder findEncoder( const String& _ext )
 {
     if( _ext.size() <= 1 )
@@ -358,7 +377,7 @@ static void ApplyExifOrientation(const String& filename, Mat& img)
     ExifTransform(orientation, img);
 }
 
-static void ApplyExifOrientation(const Mat& buf, Mat& img)
+static int GetExifOrientation(const Mat& buf)
 {
     int orientation = IMAGE_ORIENTATION_TL;
 
@@ -377,9 +396,17 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
         }
     }
 
-    ExifTransform(orientation, img);
+    return orientation;
+}
+
+static void ApplyExifOrientation(const Mat& buf, Mat& img)
+{
+    ExifTransform(GetExifOrientation(buf), img);
 }
 
+// EXIF data (APP1 segment) is expected within this number of first bytes of the stream
+static const size_t EXIF_STREAM_HEAD_SIZE = 1 << 17;
+
 /**
  * Read an image into memory and return the information
  *
@@ -390,11 +417,11 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
  *                      LOAD_MAT=2
  *                    }
  * @param[in] mat Reference to C++ Mat object (If LOAD_MAT)
- * @param[in] scale_denom Scale value
+ * @param[in] roi Region of the image to load (LOAD_MAT only)
  *
 */
 static void*
-imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
+imread_( const String& filename, int flags, int hdrtype, Mat* mat=0, const Rect* roi=0 )
 {
     IplImage* image = 0;
     CvMat *matrix = 0;
@@ -456,6 +483,21 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     // established the required input image size
     Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
 
+    // decoders which can't reduce the image on their own return the requested scale
+    bool resizeAfterRead = decoder->setScale( scale_denom ) > 1;
+
+    // the region is decoded natively if the decoder supports it,
+    // otherwise the whole image is decoded and cropped
+    bool roiDecoded = false;
+    if( roi && !resizeAfterRead )
+    {
+        CV_Assert( hdrtype == LOAD_MAT );
+        validateROI( *roi, size );
+        roiDecoded = decoder->setROI( *roi );
+        if( roiDecoded )
+            size = roi->size();
+    }
+
     // grab the decoded type
     int type = decoder->type();
     if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
@@ -513,11 +555,17 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
         return 0;
     }
 
-    if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+    if( resizeAfterRead ) // if decoder is JpegDecoder then decoder->setScale always returns 1
     {
         resize( *mat, *mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
     }
 
+    if( roi && !roiDecoded )
+    {
+        validateROI( *roi, mat->size() );
+        *mat = (*mat)(*roi).clone();
+    }
+
     return hdrtype == LOAD_CVMAT ? (void*)matrix :
         hdrtype == LOAD_IMAGE ? (void*)image : (void*)mat;
 }
@@ -656,6 +704,15 @@ Mat imread( const String& filename, int flags )
     return img;
 }
 
+Mat imread( const String& filename, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat img;
+    imread_( filename, flags, LOAD_MAT, &img, &roi );
+    return img;
+}
+
 /**
 * Read a multi-page image
 *
@@ -731,20 +788,42 @@ bool imwrite( const String& filename, InputArray _img,
     return imwrite_(filename, img_vec, params, false);
 }
 
+/**
+ * Decode an image from a buffer or a stream
+ *
+ * @param[in] buf Encoded image (unless stream is used)
+ * @param[in] flags Flags
+ * @param[in] hdrtype { LOAD_CVMAT=0, LOAD_IMAGE=1, LOAD_MAT=2 }
+ * @param[in] mat Reference to C++ Mat object (If LOAD_MAT)
+ * @param[in] roi Region of the image to decode (LOAD_MAT only)
+ * @param[in] stream Source of the encoded image instead of buf
+ * @param[in] fixedDst If set, mat is not reallocated, the image must have its size and type
+ *
+*/
 static void*
-imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
+imdecode_( const Mat& _buf, int flags, int hdrtype, Mat* mat=0, const Rect* roi=0,
+           ImageStream* stream=0, bool fixedDst=false )
 {
-    CV_Assert(!buf.empty() && buf.isContinuous());
+    CV_Assert(stream || (!_buf.empty() && _buf.isContinuous()));
+    CV_Assert(!fixedDst || (hdrtype == LOAD_MAT && !roi));
     IplImage* image = 0;
     CvMat *matrix = 0;
     Mat temp, *data = &temp;
     String filename;
+    Mat buf = _buf;
 
-    ImageDecoder decoder = findDecoder(buf);
+    ImageDecoder decoder = stream ? findDecoder(*stream) : findDecoder(buf);
     if( !decoder )
         return 0;
 
-    if( !decoder->setSource(buf) )
+    if( stream && !decoder->setSource(stream) )
+    {
+        // the decoder needs the whole encoded image
+        buf = stream->readAll();
+        stream = 0;
+    }
+
+    if( !stream && !decoder->setSource(buf) )
     {
         filename = tempfile();
         FILE* f = fopen( filename.c_str(), "wb" );
@@ -763,6 +842,18 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
         decoder->setSource(filename);
     }
 
+    int scale_denom = 1;
+    if( flags > IMREAD_LOAD_GDAL )
+    {
+    if( flags & IMREAD_REDUCED_GRAYSCALE_2 )
+        scale_denom = 2;
+    else if( flags & IMREAD_REDUCED_GRAYSCALE_4 )
+        scale_denom = 4;
+    else if( flags & IMREAD_REDUCED_GRAYSCALE_8 )
+        scale_denom = 8;
+    }
+    decoder->setScale( scale_denom );
+
     bool success = false;
     CV_TRY
     {
@@ -777,68 +868,97 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     {
         std::cerr << "imdecode_('" << filename << "'): can't read header: unknown exception" << std::endl << std::flush;
     }
-    if (!success)
+
+    Size size, dstSize;
+    int type = -1;
+    bool resizeAfterRead = false, roiDecoded = false, roiInvalid = false;
+    if( success )
     {
-        decoder.release();
-        if (!filename.empty())
+        // established the required input image size
+        size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+
+        // decoders which can't reduce the image on their own return the requested scale
+        resizeAfterRead = decoder->setScale( scale_denom ) > 1;
+        dstSize = resizeAfterRead ? Size(size.width / scale_denom, size.height / scale_denom) : size;
+
+        // invalid region fails before decoding, it's reported after the temporary file is removed
+        if( roi && (roi->empty() || (*roi & Rect(Point(), dstSize)) != *roi) )
+            roiInvalid = true;
+        else if( roi && !resizeAfterRead )
         {
-            if (0 != remove(filename.c_str()))
-            {
-                std::cerr << "unable to remove temporary file:" << filename << std::endl << std::flush;
-            }
+            CV_Assert( hdrtype == LOAD_MAT );
+            roiDecoded = decoder->setROI( *roi );
+            if( roiDecoded )
+                size = roi->size();
         }
-        return 0;
-    }
 
-    // established the required input image size
-    Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+        type = decoder->type();
+        if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
+        {
+            if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
+                type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
 
-    int type = decoder->type();
-    if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
-    {
-        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+            if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
+               ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
+                type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
+            else
+                type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+        }
 
-        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+        // the caller's matrix is never reallocated
+        if( roiInvalid || (fixedDst && (mat->size() != dstSize || mat->type() != type)) )
+            success = false;
     }
 
-    if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
+    if( success )
     {
-        if( hdrtype == LOAD_CVMAT )
+        if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
         {
-            matrix = cvCreateMat( size.height, size.width, type );
-            temp = cvarrToMat(matrix);
+            if( hdrtype == LOAD_CVMAT )
+            {
+                matrix = cvCreateMat( size.height, size.width, type );
+                temp = cvarrToMat(matrix);
+            }
+            else if( fixedDst )
+            {
+                // the decoder may reallocate the destination, the caller's header is kept intact
+                if( resizeAfterRead )
+                    temp.create( size.height, size.width, type );
+                else
+                    temp = *mat;
+            }
+            else
+            {
+                mat->create( size.height, size.width, type );
+                data = mat;
+            }
         }
         else
         {
-            mat->create( size.height, size.width, type );
-            data = mat;
+            image = cvCreateImage( size, cvIplDepth(type), CV_MAT_CN(type) );
+            temp = cvarrToMat(image);
         }
-    }
-    else
-    {
-        image = cvCreateImage( size, cvIplDepth(type), CV_MAT_CN(type) );
-        temp = cvarrToMat(image);
-    }
 
-    success = false;
-    CV_TRY
-    {
-        if (decoder->readData(*data))
-            success = true;
-    }
-    CV_CATCH (cv::Exception, e)
-    {
-        std::cerr << "imdecode_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
-    }
-    CV_CATCH_ALL
-    {
-        std::cerr << "imdecode_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+        success = false;
+        CV_TRY
+        {
+            if (decoder->readData(*data))
+                success = true;
+        }
+        CV_CATCH (cv::Exception, e)
+        {
+            std::cerr << "imdecode_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+        }
+        CV_CATCH_ALL
+        {
+            std::cerr << "imdecode_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+        }
+
+        if( success && fixedDst && !resizeAfterRead &&
+            (temp.data != mat->data || temp.size() != mat->size() || temp.type() != mat->type()) )
+            success = false;
     }
+
     decoder.release();
     if (!filename.empty())
     {
@@ -852,11 +972,22 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     {
         cvReleaseImage( &image );
         cvReleaseMat( &matrix );
-        if( mat )
+        if( mat && !fixedDst )
             mat->release();
+        if( roiInvalid )
+            validateROI( *roi, dstSize );
         return 0;
     }
 
+    if( resizeAfterRead && hdrtype == LOAD_MAT )
+    {
+        // writes into the caller's matrix if the size and type are the same
+        resize( *data, *mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
+    }
+
+    if( roi && !roiDecoded )
+        *mat = (*mat)(*roi).clone();
+
     return hdrtype == LOAD_CVMAT ? (void*)matrix :
         hdrtype == LOAD_IMAGE ? (void*)image : (void*)mat;
 }
@@ -895,6 +1026,177 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
     return *dst;
 }
 
+Mat imdecode( IStreamReader& reader, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    ImageStream stream( reader, EXIF_STREAM_HEAD_SIZE );
+    Mat img;
+    imdecode_( Mat(), flags, LOAD_MAT, &img, 0, &stream );
+
+    /// optionally rotate the data if EXIF' orientation flag says so
+    if( !img.empty() && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+    {
+        ApplyExifOrientation(Mat(stream.peek(0)), img);
+    }
+
+    return img;
+}
+
+static bool imdecodeTo_( const Mat& buf, ImageStream* stream, int flags, Mat& dst )
+{
+    int orientation = IMAGE_ORIENTATION_TL;
+    if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+    {
+        orientation = stream ? GetExifOrientation( Mat(stream->peek(EXIF_STREAM_HEAD_SIZE)) )
+                             : GetExifOrientation( buf );
+    }
+
+    if( orientation < IMAGE_ORIENTATION_LT )
+    {
+        // flips are done in place
+        if( !imdecode_( buf, flags, LOAD_MAT, &dst, 0, stream, true ) )
+            return false;
+        ExifTransform( orientation, dst );
+        return true;
+    }
+
+    Mat img;
+    imdecode_( buf, flags, LOAD_MAT, &img, 0, stream );
+    if( img.empty() )
+        return false;
+    ExifTransform( orientation, img );
+    if( img.size() != dst.size() || img.type() != dst.type() )
+        return false;
+    img.copyTo( dst );
+    return true;
+}
+
+bool imdecodeTo( InputArray _buf, int flags, Mat& dst )
+{
+    CV_TRACE_FUNCTION();
+
+    return imdecodeTo_( _buf.getMat(), 0, flags, dst );
+}
+
+bool imdecodeTo( IStreamReader& reader, int flags, Mat& dst )
+{
+    CV_TRACE_FUNCTION();
+
+    ImageStream stream( reader, EXIF_STREAM_HEAD_SIZE );
+    return imdecodeTo_( Mat(), &stream, flags, dst );
+}
+
+Mat imdecode( InputArray _buf, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat(), img;
+    imdecode_( buf, flags, LOAD_MAT, &img, &roi );
+    return img;
+}
+
+namespace {
+
+// Images of a batch are decoded independently, one image per stripe,
+// since their sizes (and so decoding times) are different.
+class BatchDecoder : public ParallelLoopBody
+{
+public:
+    BatchDecoder(const std::vector<String>* filenames, const std::vector<Mat>* bufs,
+                 int flags, std::vector<Mat>& mats, std::vector<int>& status)
+        : filenames_(filenames), bufs_(bufs), flags_(flags), mats_(mats), status_(status)
+    {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            Mat& img = mats_[i];
+            CV_TRY
+            {
+                if (filenames_)
+                {
+                    imread_((*filenames_)[i], flags_, LOAD_MAT, &img);
+                    if (!img.empty() && (flags_ & IMREAD_IGNORE_ORIENTATION) == 0 && flags_ != IMREAD_UNCHANGED)
+                        ApplyExifOrientation((*filenames_)[i], img);
+                }
+                else
+                {
+                    const Mat& buf = (*bufs_)[i];
+                    if (!buf.empty())
+                        imdecode(buf, flags_, &img);
+                    else
+                        img.release();
+                }
+            }
+            CV_CATCH (cv::Exception, e)
+            {
+                CV_LOG_WARNING(NULL, describe(i) << ": " << e.what());
+                img.release();
+            }
+            CV_CATCH_ALL
+            {
+                CV_LOG_WARNING(NULL, describe(i) << ": unknown exception");
+                img.release();
+            }
+            status_[i] = !img.empty();
+        }
+    }
+
+private:
+    String describe(int i) const
+    {
+        if (filenames_)
+            return cv::format("imreadBatch('%s'): can't read image %d", (*filenames_)[i].c_str(), i);
+        return cv::format("imdecodeBatch: can't decode image %d", i);
+    }
+
+    const std::vector<String>* filenames_;
+    const std::vector<Mat>* bufs_;
+    int flags_;
+    std::vector<Mat>& mats_;
+    std::vector<int>& status_;
+};
+
+}
+
+int imreadBatch( const std::vector<String>& filenames, std::vector<Mat>& mats,
+                 std::vector<int>& status, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    const int n = (int)filenames.size();
+    mats.resize(n);
+    status.assign(n, 0);
+    parallel_for_(Range(0, n), BatchDecoder(&filenames, 0, flags, mats, status), n);
+    return (int)std::count(status.begin(), status.end(), 1);
+}
+
+int imdecodeBatch( InputArrayOfArrays _bufs, std::vector<Mat>& mats,
+                   std::vector<int>& status, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<Mat> bufs;
+    _bufs.getMatVector(bufs);
+    for (size_t i = 0; i < bufs.size(); i++)
+    {
+        // buffers are passed to decoders as a single row of bytes
+        if (!bufs[i].empty())
+        {
+            CV_Assert(bufs[i].isContinuous());
+            bufs[i] = Mat(1, (int)(bufs[i].total() * bufs[i].elemSize()), CV_8U, bufs[i].data);
+        }
+    }
+
+    const int n = (int)bufs.size();
+    mats.resize(n);
+    status.assign(n, 0);
+    parallel_for_(Range(0, n), BatchDecoder(0, &bufs, flags, mats, status), n);
+    return (int)std::count(status.begin(), status.end(), 1);
+}
+
 bool imencode( const String& ext, InputArray _image,
                std::vector<uchar>& buf, const std::vector<int>& params )
 {
@@ -178,6 +178,47 @@ TEST(Imgcodecs_Jpeg, encode_decode_rst_jpeg)
     EXPECT_EQ(0, remove(output_normal.c_str()));
 }
 
+typedef testing::TestWithParam<tuple<int, int> > Imgcodecs_Jpeg_Parallel;
+
+TEST_P(Imgcodecs_Jpeg_Parallel, encode)
+{
+    const int channels = get<0>(GetParam()), rst_interval = get<1>(GetParam());
+    Mat img(1031, 517, CV_8UC(channels));
+    randu(img, 0, 256);
+    GaussianBlur(img, img, Size(9, 9), 0);
+
+    std::vector<int> params;
+    params.push_back(IMWRITE_JPEG_RST_INTERVAL);
+    params.push_back(rst_interval);
+    std::vector<uchar> serial, parallel;
+    ASSERT_TRUE(imencode(".jpg", img, serial, params));
+    params.push_back(IMWRITE_JPEG_PARALLEL);
+    params.push_back(1);
+    ASSERT_TRUE(imencode(".jpg", img, parallel, params));
+
+    if (rst_interval > 0)
+    {
+        // bands are aligned to the restart intervals, so the stream is the same
+        EXPECT_TRUE(serial == parallel);
+    }
+    else
+    {
+        // restart markers don't change the image
+        Mat expected = imdecode(serial, IMREAD_UNCHANGED), actual = imdecode(parallel, IMREAD_UNCHANGED);
+        ASSERT_FALSE(actual.empty());
+        EXPECT_EQ(0, cvtest::norm(expected, actual, NORM_INF));
+    }
+
+    const string filename = cv::tempfile(".jpg");
+    ASSERT_TRUE(imwrite(filename, img, params));
+    EXPECT_EQ(0, cvtest::norm(imdecode(parallel, IMREAD_UNCHANGED), imread(filename, IMREAD_UNCHANGED), NORM_INF));
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Imgcodecs_Jpeg_Parallel, Combine(
+    Values(1, 3, 4),
+    Values(0, 1, 7, 100)));
+
 #endif // HAVE_JPEG
 
 }} // namespace
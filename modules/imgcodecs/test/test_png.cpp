@@ -35,6 +35,44 @@ TEST(Imgcodecs_Png, encode)
     EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, img_gt);
 }
 
+typedef testing::TestWithParam<tuple<perf::MatType, int> > Imgcodecs_Png_Fast;
+
+TEST_P(Imgcodecs_Png_Fast, encode_decode)
+{
+    const int type = get<0>(GetParam()), mode = get<1>(GetParam());
+    // odd sizes, several bands, random noise over a gradient to make all filters useful
+    Mat img(1031, 517, type), noise(img.size(), type);
+    for (int y = 0; y < img.rows; y++)
+        img.row(y).setTo(Scalar::all(y % 256 * (CV_MAT_DEPTH(type) == CV_16U ? 251 : 1)));
+    randu(noise, 0, 8);
+    img += noise;
+
+    std::vector<int> params;
+    params.push_back(IMWRITE_PNG_FAST);
+    params.push_back(mode);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".png", img, buf, params));
+    Mat decoded = imdecode(buf, IMREAD_UNCHANGED);
+    ASSERT_FALSE(decoded.empty());
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, decoded);
+
+    params.push_back(IMWRITE_PNG_COMPRESSION);
+    params.push_back(3);
+    ASSERT_TRUE(imencode(".png", img, buf, params));
+    decoded = imdecode(buf, IMREAD_UNCHANGED);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, decoded);
+
+    const string filename = cv::tempfile(".png");
+    ASSERT_TRUE(imwrite(filename, img, params));
+    decoded = imread(filename, IMREAD_UNCHANGED);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, decoded);
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Imgcodecs_Png_Fast, Combine(
+    Values(CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_16UC4),
+    Values((int)IMWRITE_PNG_FAST_SUB, (int)IMWRITE_PNG_FAST_ADAPTIVE)));
+
 TEST(Imgcodecs_Png, regression_ImreadVSCvtColor)
 {
     const string root = cvtest::TS::ptr()->get_data_path();
@@ -122,6 +122,211 @@ const string exts[] = {
 
 INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image, testing::ValuesIn(exts));
 
+typedef testing::TestWithParam<Ext> Imgcodecs_Image_ROI;
+
+TEST_P(Imgcodecs_Image_ROI, read)
+{
+    const string ext = this->GetParam();
+    const string filename = cv::tempfile(ext.c_str());
+    const Rect rois[] = { Rect(0, 0, 131, 97), Rect(45, 70, 33, 1), Rect(17, 9, 1, 80),
+                          Rect(101, 51, 30, 46), Rect(0, 0, 131, 1), Rect(64, 32, 16, 16) };
+
+    Mat image(97, 131, CV_8UC3);
+    RNG& rng = theRNG();
+    rng.fill(image, RNG::UNIFORM, 0, 256);
+    GaussianBlur(image, image, Size(5, 5), 0);
+    ASSERT_TRUE(imwrite(filename, image));
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode("." + ext, image, buf));
+
+    for (int flags = IMREAD_GRAYSCALE; flags <= IMREAD_COLOR; flags++)
+    {
+        Mat full = imread(filename, flags);
+        ASSERT_FALSE(full.empty());
+        for (size_t i = 0; i < sizeof(rois) / sizeof(rois[0]); i++)
+        {
+            SCOPED_TRACE(cv::format("flags=%d roi=%d", flags, (int)i));
+            Mat region = imread(filename, rois[i], flags);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), full(rois[i]), region);
+            region = imdecode(buf, rois[i], flags);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), full(rois[i]), region);
+        }
+    }
+    EXPECT_THROW(imread(filename, Rect(100, 0, 32, 10)), cv::Exception);
+    EXPECT_THROW(imdecode(buf, Rect(0, 0, 0, 10), IMREAD_COLOR), cv::Exception);
+    EXPECT_THROW(imdecode(buf, Rect(100, 0, 32, 10), IMREAD_COLOR), cv::Exception);
+    // the region is checked against the reduced image
+    EXPECT_THROW(imdecode(buf, Rect(60, 0, 10, 10), IMREAD_REDUCED_COLOR_2), cv::Exception);
+    EXPECT_EQ(Size(10, 10), imdecode(buf, Rect(50, 0, 10, 10), IMREAD_REDUCED_COLOR_2).size());
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image_ROI, testing::ValuesIn(exts));
+
+TEST(Imgcodecs_Image, decode_batch)
+{
+    const int n = (int)(sizeof(exts) / sizeof(exts[0]));
+    vector<vector<uchar> > bufs(n + 2);
+    vector<String> filenames(n + 1);
+    for (int i = 0; i < n; i++)
+    {
+        Mat image(32 + i * 7, 48 + i * 5, CV_8UC3);
+        randu(image, 0, 256);
+        ASSERT_TRUE(imencode("." + exts[i], image, bufs[i]));
+        filenames[i] = cv::tempfile(("." + exts[i]).c_str());
+        ASSERT_TRUE(imwrite(filenames[i], image));
+    }
+    bufs[n].assign(100, 0x55);  // unknown format
+    filenames[n] = cv::tempfile(".bmp");  // missing file
+
+    // reused output
+    vector<Mat> mats(2);
+    mats[0].create(32, 48, CV_8UC3);
+    const uchar* data0 = mats[0].data;
+
+    vector<int> status;
+    EXPECT_EQ(n, imdecodeBatch(bufs, mats, status, IMREAD_COLOR));
+    ASSERT_EQ((size_t)(n + 2), mats.size());
+    ASSERT_EQ((size_t)(n + 2), status.size());
+    EXPECT_EQ(data0, mats[0].data);
+    for (int i = 0; i < n; i++)
+    {
+        SCOPED_TRACE(exts[i]);
+        EXPECT_EQ(1, status[i]);
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), imdecode(bufs[i], IMREAD_COLOR), mats[i]);
+    }
+    EXPECT_EQ(0, status[n]);
+    EXPECT_TRUE(mats[n].empty());
+    EXPECT_EQ(0, status[n + 1]);
+    EXPECT_TRUE(mats[n + 1].empty());
+
+    EXPECT_EQ(n, imreadBatch(filenames, mats, status, IMREAD_GRAYSCALE));
+    ASSERT_EQ((size_t)(n + 1), mats.size());
+    for (int i = 0; i < n; i++)
+    {
+        SCOPED_TRACE(exts[i]);
+        EXPECT_EQ(1, status[i]);
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), imread(filenames[i], IMREAD_GRAYSCALE), mats[i]);
+        EXPECT_EQ(0, remove(filenames[i].c_str()));
+    }
+    EXPECT_EQ(0, status[n]);
+    EXPECT_TRUE(mats[n].empty());
+}
+
+TEST(Imgcodecs_Image, decode_to_roi)
+{
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++)
+    {
+        SCOPED_TRACE(exts[i]);
+        Mat image(37, 53, CV_8UC3);
+        randu(image, 0, 256);
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode("." + exts[i], image, buf));
+
+        for (int flags = IMREAD_GRAYSCALE; flags <= IMREAD_COLOR; flags++)
+        {
+            Mat expected = imdecode(buf, flags);
+            ASSERT_FALSE(expected.empty());
+
+            // the second image of the batch
+            Mat batch(3 * expected.rows, expected.cols + 10, expected.type(), Scalar::all(7));
+            Mat dst = batch(Rect(5, expected.rows, expected.cols, expected.rows));
+            const uchar* data = dst.data;
+            ASSERT_TRUE(imdecodeTo(buf, flags, dst));
+            EXPECT_EQ(data, dst.data);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, dst);
+            dst.setTo(Scalar::all(7));
+            EXPECT_EQ(0, cvtest::norm(batch, Mat(batch.size(), batch.type(), Scalar::all(7)), NORM_INF));
+
+            // size or type mismatch
+            Mat wrong = batch(Rect(0, 0, expected.cols - 1, expected.rows));
+            EXPECT_FALSE(imdecodeTo(buf, flags, wrong));
+            EXPECT_EQ(wrong.cols, expected.cols - 1);
+            Mat wrongType(expected.size(), CV_MAKETYPE(CV_16U, expected.channels()));
+            EXPECT_FALSE(imdecodeTo(buf, flags, wrongType));
+        }
+    }
+}
+
+TEST(Imgcodecs_Image, decode_reduced)
+{
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++)
+    {
+        SCOPED_TRACE(exts[i]);
+        Mat image(64, 96, CV_8UC3);
+        randu(image, 0, 256);
+        const string filename = cv::tempfile(("." + exts[i]).c_str());
+        ASSERT_TRUE(imwrite(filename, image));
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode("." + exts[i], image, buf));
+
+        const int modes[] = { IMREAD_REDUCED_GRAYSCALE_2, IMREAD_REDUCED_COLOR_4, IMREAD_REDUCED_COLOR_8 };
+        for (size_t j = 0; j < sizeof(modes) / sizeof(modes[0]); j++)
+        {
+            Mat expected = imread(filename, modes[j]);
+            ASSERT_FALSE(expected.empty());
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, imdecode(buf, modes[j]));
+            Mat dst(expected.size(), expected.type());
+            ASSERT_TRUE(imdecodeTo(buf, modes[j], dst));
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, dst);
+        }
+        EXPECT_EQ(0, remove(filename.c_str()));
+    }
+}
+
+// Returns the data by chunks of random size
+class ChunkedReader : public IStreamReader
+{
+public:
+    ChunkedReader(const vector<uchar>& data) : data_(data), pos_(0) {}
+
+    size_t read(char* buffer, size_t size) CV_OVERRIDE
+    {
+        size_t count = std::min(size, data_.size() - pos_);
+        count = std::min(count, (size_t)theRNG().uniform(1, 1000));
+        memcpy(buffer, data_.data() + pos_, count);
+        pos_ += count;
+        return count;
+    }
+
+private:
+    const vector<uchar>& data_;
+    size_t pos_;
+};
+
+TEST(Imgcodecs_Image, decode_stream)
+{
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++)
+    {
+        SCOPED_TRACE(exts[i]);
+        Mat image(117, 91, CV_8UC3);
+        randu(image, 0, 256);
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode("." + exts[i], image, buf));
+
+        for (int flags = IMREAD_GRAYSCALE; flags <= IMREAD_COLOR; flags++)
+        {
+            Mat expected = imdecode(buf, flags);
+            ChunkedReader reader(buf);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, imdecode(reader, flags));
+
+            Mat dst(expected.size(), expected.type());
+            ChunkedReader reader2(buf);
+            ASSERT_TRUE(imdecodeTo(reader2, flags, dst));
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, dst);
+        }
+
+        // truncated stream
+        vector<uchar> truncated(buf.begin(), buf.begin() + buf.size() / 2);
+        ChunkedReader reader(truncated);
+        EXPECT_NO_THROW(imdecode(reader, IMREAD_COLOR));
+    }
+    vector<uchar> empty;
+    ChunkedReader reader(empty);
+    EXPECT_TRUE(imdecode(reader, IMREAD_COLOR).empty());
+}
+
 TEST(Imgcodecs_Image, regression_9376)
 {
     String path = findDataFile("readwrite/regression_9376.bmp");
@@ -117,6 +117,47 @@ TEST(Imgcodecs_Tiff, decode_tile_remainder)
     // What about 32, 64 bit?
 }
 
+TEST(Imgcodecs_Tiff, decode_tile_roi)
+{
+    const string root = cvtest::TS::ptr()->get_data_path();
+    const Rect roi(100, 120, 60, 150); // crosses tiles boundaries
+    const char* files[] = { "readwrite/tiled_8.tif", "readwrite/tiled_16.tif" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+        cv::Mat img = imread(root + files[i], IMREAD_UNCHANGED);
+        ASSERT_FALSE(img.empty());
+        cv::Mat region = imread(root + files[i], roi, IMREAD_UNCHANGED);
+        ASSERT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img(roi), region);
+    }
+}
+
+TEST(Imgcodecs_Tiff, decode_strips_roi)
+{
+    const string filename = cv::tempfile(".tiff");
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_32FC1 };
+    const Rect rois[] = { Rect(0, 0, 50, 40), Rect(13, 7, 20, 1), Rect(49, 0, 1, 40), Rect(5, 11, 40, 21) };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        Mat image(40, 50, types[i]);
+        randu(image, 0, CV_MAT_DEPTH(types[i]) == CV_8U ? 256 : 65536);
+
+        std::vector<int> params;
+        params.push_back(TIFFTAG_ROWSPERSTRIP);
+        params.push_back(3);
+        ASSERT_TRUE(imwrite(filename, image, params));
+
+        Mat img = imread(filename, IMREAD_UNCHANGED);
+        ASSERT_FALSE(img.empty());
+        for (size_t j = 0; j < sizeof(rois) / sizeof(rois[0]); j++)
+        {
+            SCOPED_TRACE(cv::format("type=%d roi=%d", types[i], (int)j));
+            Mat region = imread(filename, rois[j], IMREAD_UNCHANGED);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img(rois[j]), region);
+        }
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 TEST(Imgcodecs_Tiff, decode_infinite_rowsperstrip)
 {
     const uchar sample_data[142] = {
@@ -251,6 +292,85 @@ TEST(Imgcodecs_Tiff, imdecode_no_exception_temporary_file_removed)
     EXPECT_NO_THROW(cv::imdecode(buf, IMREAD_UNCHANGED));
 }
 
+typedef testing::TestWithParam<perf::MatType> Imgcodecs_Tiff_Pyramid;
+
+TEST_P(Imgcodecs_Tiff_Pyramid, write_read)
+{
+    const int type = GetParam();
+    const Size tileSize(64, 32);
+    Mat img(333, 517, type);
+    randu(img, 0, CV_MAT_DEPTH(type) == CV_8U ? 256 : 65536);
+    GaussianBlur(img, img, Size(5, 5), 0);
+
+    const string filename = cv::tempfile(".tiff");
+    Ptr<TiledTiffWriter> writer = TiledTiffWriter::create(filename, img.size(), type, 0, tileSize);
+    for (int y = 0; y < img.rows; y += tileSize.height)
+        for (int x = 0; x < img.cols; x += tileSize.width)
+            writer->writeTile(img(Rect(Point(x, y), tileSize) & Rect(Point(), img.size())));
+    writer->release();
+
+    // the full resolution level is the first page
+    Mat page = imread(filename, IMREAD_UNCHANGED);
+    EXPECT_EQ(0, cvtest::norm(img, page, NORM_INF));
+
+    Ptr<TiledTiffReader> reader = TiledTiffReader::create(filename);
+    ASSERT_EQ(5, reader->getLevels());  // 517x333 ... 33x21
+    EXPECT_EQ(type, reader->getType());
+    Mat expected = img, actual;
+    for (int level = 0; level < reader->getLevels(); level++)
+    {
+        SCOPED_TRACE(level);
+        if (level > 0)
+            pyrDown(expected, expected);
+        ASSERT_EQ(expected.size(), reader->getSize(level));
+        EXPECT_EQ(tileSize, reader->getTileSize(level));
+
+        reader->readRegion(level, Rect(Point(), expected.size()), actual);
+        EXPECT_EQ(0, cvtest::norm(expected, actual, NORM_INF));
+
+        Rect roi(expected.cols/3, expected.rows/4, expected.cols/2, expected.rows/2);
+        reader->readRegion(level, roi, actual);
+        EXPECT_EQ(0, cvtest::norm(expected(roi), actual, NORM_INF));
+
+        Point last((expected.cols - 1)/tileSize.width, (expected.rows - 1)/tileSize.height);
+        reader->readTile(level, last, actual);
+        Rect tile = Rect(Point(last.x*tileSize.width, last.y*tileSize.height), tileSize) & Rect(Point(), expected.size());
+        EXPECT_EQ(0, cvtest::norm(expected(tile), actual, NORM_INF));
+    }
+    reader.release();
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Imgcodecs_Tiff_Pyramid, Values(CV_8UC1, CV_8UC3, CV_16UC1, CV_16UC4));
+
+TEST(Imgcodecs_Tiff, pyramid_write_errors)
+{
+    const string filename = cv::tempfile(".tiff");
+    EXPECT_ANY_THROW(TiledTiffWriter::create(filename, Size(100, 100), CV_32FC1));
+    EXPECT_ANY_THROW(TiledTiffWriter::create(filename, Size(100, 100), CV_8UC1, 0, Size(100, 100)));
+
+    Ptr<TiledTiffWriter> writer = TiledTiffWriter::create(filename, Size(100, 50), CV_8UC1, 2, Size(64, 64));
+    EXPECT_ANY_THROW(writer->writeTile(Mat::zeros(64, 64, CV_8UC1)));  // cropped to the image height
+    writer->writeTile(Mat::zeros(50, 64, CV_8UC1));
+    EXPECT_ANY_THROW(writer->release());
+    writer.release();
+
+    writer = TiledTiffWriter::create(filename, Size(100, 50), CV_8UC1, 1, Size(64, 64));
+    writer->writeTile(Mat::zeros(50, 64, CV_8UC1));
+    writer->writeTile(Mat::zeros(50, 36, CV_8UC1));
+    writer->release();
+    Ptr<TiledTiffReader> reader = TiledTiffReader::create(filename);
+    Mat dst;
+    EXPECT_THROW(reader->readRegion(0, Rect(), dst), cv::Exception);
+    EXPECT_THROW(reader->readRegion(0, Rect(90, 0, 20, 10), dst), cv::Exception);
+    EXPECT_THROW(reader->readRegion(0, Rect(-1, 0, 20, 10), dst), cv::Exception);
+    EXPECT_ANY_THROW(reader->readRegion(reader->getLevels(), Rect(0, 0, 20, 10), dst));
+    EXPECT_NO_THROW(reader->readRegion(0, Rect(80, 40, 20, 10), dst));
+    EXPECT_EQ(Size(20, 10), dst.size());
+    reader.release();
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 #endif
 
 }} // namespace
@@ -444,6 +444,30 @@ public:
     /** @copybrief getEmax @see getEmax */
     CV_WRAP virtual void setEmax(int val) = 0;
 
+    /** Parameter for HNSW implementation: the maximum number of links of a sample in the graph.
+    The bottom layer allows twice more links. Larger values give better recall on high-dimensional
+    data at the cost of memory and training time. It is applied when the graph is built from
+    scratch. Default value is 16. */
+    /** @see setMaxConnections */
+    CV_WRAP virtual int getMaxConnections() const = 0;
+    /** @copybrief getMaxConnections @see getMaxConnections */
+    CV_WRAP virtual void setMaxConnections(int val) = 0;
+
+    /** Parameter for HNSW implementation: the number of candidates considered when a sample is
+    linked into the graph. It is applied when the graph is built from scratch. Default value is 200. */
+    /** @see setConstructionWidth */
+    CV_WRAP virtual int getConstructionWidth() const = 0;
+    /** @copybrief getConstructionWidth @see getConstructionWidth */
+    CV_WRAP virtual void setConstructionWidth(int val) = 0;
+
+    /** Parameter for HNSW implementation: the number of candidates kept while searching the graph
+    (at least k are always kept). Larger values give better recall, smaller values give faster
+    search. It can be changed at any time. Default value is 64. */
+    /** @see setSearchWidth */
+    CV_WRAP virtual int getSearchWidth() const = 0;
+    /** @copybrief getSearchWidth @see getSearchWidth */
+    CV_WRAP virtual void setSearchWidth(int val) = 0;
+
     /** %Algorithm type, one of KNearest::Types. */
     /** @see setAlgorithmType */
     CV_WRAP virtual int getAlgorithmType() const = 0;
@@ -486,7 +510,11 @@ public:
     enum Types
     {
         BRUTE_FORCE=1,
-        KDTREE=2
+        KDTREE=2,
+        /** Approximate search in the Hierarchical Navigable Small World graph.
+        The samples added with StatModel::UPDATE_MODEL are inserted into the existing graph.
+        The recall is controlled by KNearest::setSearchWidth. */
+        HNSW=3
     };
 
     /** @brief Creates the empty model
@@ -583,6 +611,15 @@ public:
     /** @copybrief getTermCriteria @see getTermCriteria */
     CV_WRAP virtual void setTermCriteria(const cv::TermCriteria &val) = 0;
 
+    /** Size of the kernel matrix cache used by the training procedure, in megabytes.
+    The most recently used rows of the kernel matrix are kept in the cache. When the one-vs-one
+    classifiers of a multi-class problem are trained in parallel, they share this amount.
+    Default value is 0, the size is chosen from the number of training samples (40 to 500 MB).*/
+    /** @see setKernelCacheSize */
+    CV_WRAP virtual int getKernelCacheSize() const = 0;
+    /** @copybrief getKernelCacheSize @see getKernelCacheSize */
+    CV_WRAP virtual void setKernelCacheSize(int val) = 0;
+
     /** Type of a %SVM kernel.
     See SVM::KernelTypes. Default value is SVM::RBF. */
     CV_WRAP virtual int getKernelType() const = 0;
@@ -1133,6 +1170,19 @@ public:
     /** @copybrief getPriors @see getPriors */
     CV_WRAP virtual void setPriors(const cv::Mat &val) = 0;
 
+    /** @brief The number of bins the ordered variables are quantized into before the training.
+
+    If it is greater than 0, the values of every ordered variable are mapped once to at most this
+    number of bins (2..256), and the best split of a node is found by scanning the histograms of
+    the node samples over the bins, instead of sorting the samples for every node and variable.
+    This is much faster on big training sets, the split thresholds are then restricted to the bin
+    boundaries (a variable with no more distinct values than bins is split exactly).
+    Default value is 0, the splits are searched over all the sorted values.*/
+    /** @see setHistogramBins */
+    CV_WRAP virtual int getHistogramBins() const = 0;
+    /** @copybrief getHistogramBins @see getHistogramBins */
+    CV_WRAP virtual void setHistogramBins(int val) = 0;
+
     /** @brief The class represents a decision tree node.
      */
     class CV_EXPORTS Node
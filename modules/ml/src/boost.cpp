@@ -356,20 +356,32 @@ public:
         }
     }
 
+    float sumToResponse( float val, int flags0 ) const
+    {
+        int ival = (int)(val > 0);
+        if( !(flags0 & RAW_OUTPUT) )
+            ival = classLabels[ival];
+        return (float)ival;
+    }
+
     float predictTrees( const Range& range, const Mat& sample, int flags0 ) const CV_OVERRIDE
     {
         int flags = (flags0 & ~PREDICT_MASK) | PREDICT_SUM;
         float val = DTreesImpl::predictTrees(range, sample, flags);
         if( flags != flags0 )
-        {
-            int ival = (int)(val > 0);
-            if( !(flags0 & RAW_OUTPUT) )
-                ival = classLabels[ival];
-            val = (float)ival;
-        }
+            val = sumToResponse(val, flags0);
         return val;
     }
 
+    void predictTreesBatch( const Range& range, const Mat& samples, float* results, int flags0 ) const CV_OVERRIDE
+    {
+        int flags = (flags0 & ~PREDICT_MASK) | PREDICT_SUM;
+        DTreesImpl::predictTreesBatch(range, samples, results, flags);
+        if( flags != flags0 )
+            for( int i = 0; i < samples.rows; i++ )
+                results[i] = sumToResponse(results[i], flags0);
+    }
+
     void writeTrainingParams( FileStorage& fs ) const CV_OVERRIDE
     {
         fs << "boosting_type" <<
@@ -439,6 +451,7 @@ public:
             FileNode nfn = (*it)["nodes"];
             readTree(nfn);
         }
+        compileTrees();
     }
 
     BoostTreeParams bparams;
@@ -477,6 +490,8 @@ public:
     inline void setRegressionAccuracy(float val) CV_OVERRIDE { impl.params.setRegressionAccuracy(val); }
     inline cv::Mat getPriors() const CV_OVERRIDE { return impl.params.getPriors(); }
     inline void setPriors(const cv::Mat& val) CV_OVERRIDE { impl.params.setPriors(val); }
+    inline int getHistogramBins() const CV_OVERRIDE { return impl.params.getHistogramBins(); }
+    inline void setHistogramBins(int val) CV_OVERRIDE { impl.params.setHistogramBins(val); }
 
     String getDefaultName() const CV_OVERRIDE { return "opencv_ml_boost"; }
 
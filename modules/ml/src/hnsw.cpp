@@ -0,0 +1,324 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+#include "hnsw.hpp"
+#include "opencv2/core/hal/hal.hpp"
+
+#include <queue>
+
+namespace cv
+{
+namespace ml
+{
+
+static inline float distL2Sqr(const Mat& points, int idx, const float* vec)
+{
+    return hal::normL2Sqr_(points.ptr<float>(idx), vec, points.cols);
+}
+
+HNSWIndex::HNSWIndex()
+{
+    clear(16, 200);
+}
+
+void HNSWIndex::clear(int _maxConnections, int _constructionWidth)
+{
+    CV_Assert( _maxConnections >= 2 && _constructionWidth >= 1 );
+    maxConnections = _maxConnections;
+    constructionWidth = _constructionWidth;
+    entryPoint = -1;
+    maxLevel = -1;
+    levels.clear();
+    links0.clear();
+    upperLinks.clear();
+}
+
+const int* HNSWIndex::getLinks(int idx, int level) const
+{
+    return level == 0 ? &links0[(size_t)idx*(maxLinks(0) + 1)] :
+                        &upperLinks[idx][(level - 1)*(maxLinks(level) + 1)];
+}
+
+int* HNSWIndex::getLinks(int idx, int level)
+{
+    return level == 0 ? &links0[(size_t)idx*(maxLinks(0) + 1)] :
+                        &upperLinks[idx][(level - 1)*(maxLinks(level) + 1)];
+}
+
+// The level only depends on the index of the point,
+// so the graph is the same whatever the points are added in one or several steps.
+int HNSWIndex::randomLevel(int idx) const
+{
+    RNG rng((uint64)(idx + 1)*CV_BIG_UINT(0x9E3779B97F4A7C15));
+    rng.next();
+    double u = std::max(rng.uniform(0., 1.), DBL_EPSILON);
+    return std::min(cvFloor(-std::log(u)/std::log((double)maxConnections)), 31);
+}
+
+// greedy search for the closest point on the levels (toLevel, fromLevel]
+int HNSWIndex::searchUpperLayers(const Mat& points, const float* vec, int fromLevel, int toLevel, float& d) const
+{
+    int cur = entryPoint;
+    d = distL2Sqr(points, cur, vec);
+    for( int level = fromLevel; level > toLevel; level-- )
+    {
+        bool changed = true;
+        while( changed )
+        {
+            changed = false;
+            const int* links = getLinks(cur, level);
+            for( int i = 1; i <= links[0]; i++ )
+            {
+                float t = distL2Sqr(points, links[i], vec);
+                if( t < d )
+                {
+                    d = t;
+                    cur = links[i];
+                    changed = true;
+                }
+            }
+        }
+    }
+    return cur;
+}
+
+// finds ef closest points to vec on the level; the result is sorted by the distance
+void HNSWIndex::searchLayer(const Mat& points, const float* vec, int entry, float entryDist, int ef, int level,
+                            SearchBuffer& buf, std::vector<DistIdx>& result) const
+{
+    if( buf.visited.size() < levels.size() || ++buf.epoch == 0 )
+    {
+        buf.visited.assign(std::max(levels.size(), buf.visited.size()), 0u);
+        buf.epoch = 1;
+    }
+    unsigned* visited = &buf.visited[0];
+    unsigned epoch = buf.epoch;
+
+    std::priority_queue<DistIdx, std::vector<DistIdx>, std::greater<DistIdx> > candidates;
+    std::priority_queue<DistIdx> best;
+    candidates.push(DistIdx(entryDist, entry));
+    best.push(DistIdx(entryDist, entry));
+    visited[entry] = epoch;
+
+    while( !candidates.empty() )
+    {
+        DistIdx c = candidates.top();
+        if( c.first > best.top().first && (int)best.size() >= ef )
+            break;
+        candidates.pop();
+
+        const int* links = getLinks(c.second, level);
+        for( int i = 1; i <= links[0]; i++ )
+        {
+            int idx = links[i];
+            if( visited[idx] == epoch )
+                continue;
+            visited[idx] = epoch;
+            float d = distL2Sqr(points, idx, vec);
+            if( (int)best.size() < ef || d < best.top().first )
+            {
+                candidates.push(DistIdx(d, idx));
+                best.push(DistIdx(d, idx));
+                if( (int)best.size() > ef )
+                    best.pop();
+            }
+        }
+    }
+
+    result.resize(best.size());
+    for( int i = (int)result.size() - 1; i >= 0; i-- )
+    {
+        result[i] = best.top();
+        best.pop();
+    }
+}
+
+// keeps the candidates that are closer to the point than to the already selected neighbors,
+// it makes the links spread in all the directions
+void HNSWIndex::selectNeighbors(const Mat& points, const std::vector<DistIdx>& candidates, int M,
+                                std::vector<int>& neighbors) const
+{
+    neighbors.clear();
+    for( size_t i = 0; i < candidates.size() && (int)neighbors.size() < M; i++ )
+    {
+        const float* vec = points.ptr<float>(candidates[i].second);
+        bool good = true;
+        for( size_t j = 0; j < neighbors.size(); j++ )
+            if( distL2Sqr(points, neighbors[j], vec) < candidates[i].first )
+            {
+                good = false;
+                break;
+            }
+        if( good )
+            neighbors.push_back(candidates[i].second);
+    }
+}
+
+void HNSWIndex::addLink(const Mat& points, int from, int to, int level)
+{
+    int* links = getLinks(from, level);
+    int M = maxLinks(level);
+    if( links[0] < M )
+    {
+        links[++links[0]] = to;
+        return;
+    }
+
+    // too many links: choose again among the old ones and the new one
+    const float* vec = points.ptr<float>(from);
+    std::vector<DistIdx> candidates;
+    std::vector<int> neighbors;
+    for( int i = 1; i <= links[0]; i++ )
+        candidates.push_back(DistIdx(distL2Sqr(points, links[i], vec), links[i]));
+    candidates.push_back(DistIdx(distL2Sqr(points, to, vec), to));
+    std::sort(candidates.begin(), candidates.end());
+    selectNeighbors(points, candidates, M, neighbors);
+    links[0] = (int)neighbors.size();
+    std::copy(neighbors.begin(), neighbors.end(), links + 1);
+}
+
+void HNSWIndex::insert(const Mat& points, int idx, SearchBuffer& buf)
+{
+    int level = levels[idx];
+    if( entryPoint < 0 )
+    {
+        entryPoint = idx;
+        maxLevel = level;
+        return;
+    }
+
+    const float* vec = points.ptr<float>(idx);
+    float d = 0.f;
+    int cur = searchUpperLayers(points, vec, maxLevel, level, d);
+    std::vector<DistIdx> candidates;
+    std::vector<int> neighbors;
+
+    for( int lc = std::min(level, maxLevel); lc >= 0; lc-- )
+    {
+        searchLayer(points, vec, cur, d, constructionWidth, lc, buf, candidates);
+        selectNeighbors(points, candidates, maxConnections, neighbors);
+
+        int* links = getLinks(idx, lc);
+        links[0] = (int)neighbors.size();
+        std::copy(neighbors.begin(), neighbors.end(), links + 1);
+        for( size_t i = 0; i < neighbors.size(); i++ )
+            addLink(points, neighbors[i], idx, lc);
+
+        cur = candidates[0].second;
+        d = candidates[0].first;
+    }
+
+    if( level > maxLevel )
+    {
+        entryPoint = idx;
+        maxLevel = level;
+    }
+}
+
+void HNSWIndex::add(const Mat& points)
+{
+    CV_Assert( points.type() == CV_32F && points.rows >= size() );
+    int i, n0 = size(), n = points.rows;
+    SearchBuffer buf;
+
+    levels.resize(n);
+    links0.resize((size_t)n*(maxLinks(0) + 1), 0);
+    upperLinks.resize(n);
+    for( i = n0; i < n; i++ )
+    {
+        levels[i] = randomLevel(i);
+        upperLinks[i].assign(levels[i]*(maxLinks(1) + 1), 0);
+    }
+
+    for( i = n0; i < n; i++ )
+        insert(points, i, buf);
+}
+
+int HNSWIndex::findNearest(const Mat& points, const float* vec, int K, int searchWidth,
+                           int* neighborsIdx, float* dist, SearchBuffer& buf) const
+{
+    if( entryPoint < 0 || K <= 0 )
+        return 0;
+
+    float d = 0.f;
+    int cur = searchUpperLayers(points, vec, maxLevel, 0, d);
+    std::vector<DistIdx> candidates;
+    searchLayer(points, vec, cur, d, std::max(searchWidth, K), 0, buf, candidates);
+
+    int i, count = std::min(K, (int)candidates.size());
+    for( i = 0; i < count; i++ )
+    {
+        neighborsIdx[i] = candidates[i].second;
+        dist[i] = candidates[i].first;
+    }
+    return count;
+}
+
+void HNSWIndex::write(FileStorage& fs) const
+{
+    std::vector<int> upper;
+    for( size_t i = 0; i < upperLinks.size(); i++ )
+        upper.insert(upper.end(), upperLinks[i].begin(), upperLinks[i].end());
+
+    fs << "max_connections" << maxConnections;
+    fs << "construction_width" << constructionWidth;
+    fs << "entry_point" << entryPoint;
+    fs << "max_level" << maxLevel;
+    fs << "levels" << levels;
+    fs << "links" << links0;
+    fs << "upper_links" << upper;
+}
+
+bool HNSWIndex::read(const FileNode& fn, int npoints)
+{
+    std::vector<int> upper;
+    if( fn.empty() || (int)fn["max_connections"] < 2 || (int)fn["construction_width"] < 1 )
+        return false;
+    clear((int)fn["max_connections"], (int)fn["construction_width"]);
+    entryPoint = (int)fn["entry_point"];
+    maxLevel = (int)fn["max_level"];
+    fn["levels"] >> levels;
+    fn["links"] >> links0;
+    fn["upper_links"] >> upper;
+
+    int n = size();
+    size_t i, ofs = 0, stride = maxLinks(1) + 1;
+    bool ok = n == npoints && links0.size() == (size_t)n*(maxLinks(0) + 1) &&
+              (n == 0 ? entryPoint < 0 : 0 <= entryPoint && entryPoint < n && levels[entryPoint] == maxLevel);
+    upperLinks.resize(n);
+    for( i = 0; ok && i < (size_t)n; i++ )
+    {
+        size_t len = levels[i]*stride;
+        ok = 0 <= levels[i] && levels[i] <= maxLevel && ofs + len <= upper.size();
+        if( ok )
+            upperLinks[i].assign(upper.begin() + ofs, upper.begin() + ofs + len);
+        ofs += len;
+    }
+    ok = ok && ofs == upper.size();
+    for( i = 0; ok && i < links0.size(); i += maxLinks(0) + 1 )
+    {
+        ok = 0 <= links0[i] && links0[i] <= maxLinks(0);
+        for( int j = 1; ok && j <= links0[i]; j++ )
+            ok = 0 <= links0[i+j] && links0[i+j] < n;
+    }
+    // the points linked on an upper level must be present on that level
+    for( i = 0; ok && i < (size_t)n; i++ )
+    {
+        for( int level = 1; ok && level <= levels[i]; level++ )
+        {
+            const int* links = getLinks((int)i, level);
+            ok = 0 <= links[0] && links[0] <= maxLinks(level);
+            for( int j = 1; ok && j <= links[0]; j++ )
+                ok = 0 <= links[j] && links[j] < n && levels[links[j]] >= level;
+        }
+    }
+
+    if( !ok )
+        clear(maxConnections, constructionWidth);
+    return ok;
+}
+
+}
+}
@@ -0,0 +1,89 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#ifndef OPENCV_ML_HNSW_HPP
+#define OPENCV_ML_HNSW_HPP
+
+#include "precomp.hpp"
+
+namespace cv
+{
+namespace ml
+{
+
+/*!
+ Hierarchical Navigable Small World graph for the approximate nearest neighbor search.
+
+ The algorithm is taken from:
+ Yu. A. Malkov, D. A. Yashunin. Efficient and robust approximate nearest neighbor search using
+ Hierarchical Navigable Small World graphs. arXiv:1603.09320, 2016.
+
+ Every point is linked to its close neighbors on the bottom layer of the graph, a random subset
+ of the points (exponentially smaller on every level) forms the upper layers. The search greedily
+ descends from the top layer and then explores the bottom layer keeping `ef` best candidates:
+ the wider the search, the better the recall.
+
+ The index doesn't keep the points, they are the rows of a CV_32F matrix passed to every method.
+ The matrix may only grow: add() links the rows that are not in the graph yet.
+ The search doesn't modify the index, so it can be run from several threads at once.
+*/
+class HNSWIndex
+{
+public:
+    //! the scratch memory of a search, one per thread
+    struct SearchBuffer
+    {
+        SearchBuffer() : epoch(0) {}
+        std::vector<unsigned> visited;
+        unsigned epoch;
+    };
+
+    HNSWIndex();
+
+    //! removes all the points; the parameters are applied to the next points
+    void clear(int maxConnections, int constructionWidth);
+    //! links the points [size(), points.rows) into the graph
+    void add(const Mat& points);
+    //! finds (at most) K approximate nearest neighbors of vec; the squared distances are sorted
+    int findNearest(const Mat& points, const float* vec, int K, int searchWidth,
+                    int* neighborsIdx, float* dist, SearchBuffer& buf) const;
+
+    //! number of the points in the graph
+    int size() const { return (int)levels.size(); }
+
+    void write(FileStorage& fs) const;
+    //! returns false if the stored graph doesn't match the points
+    bool read(const FileNode& fn, int npoints);
+
+    int maxConnections;     //!< maximum number of the links of a point on the upper layers, twice more on the bottom one
+    int constructionWidth;  //!< number of the candidates considered when a point is linked
+
+protected:
+    typedef std::pair<float, int> DistIdx;
+
+    int maxLinks(int level) const { return level == 0 ? maxConnections*2 : maxConnections; }
+    const int* getLinks(int idx, int level) const;
+    int* getLinks(int idx, int level);
+    int randomLevel(int idx) const;
+    int searchUpperLayers(const Mat& points, const float* vec, int fromLevel, int toLevel, float& d) const;
+    void searchLayer(const Mat& points, const float* vec, int entry, float entryDist, int ef, int level,
+                     SearchBuffer& buf, std::vector<DistIdx>& result) const;
+    void selectNeighbors(const Mat& points, const std::vector<DistIdx>& candidates, int M,
+                         std::vector<int>& neighbors) const;
+    void addLink(const Mat& points, int from, int to, int level);
+    void insert(const Mat& points, int idx, SearchBuffer& buf);
+
+    int entryPoint;
+    int maxLevel;
+    std::vector<int> levels;
+    //! the links of every point on the bottom layer: the count followed by maxLinks(0) indices
+    std::vector<int> links0;
+    //! the links of every point on the layers 1..levels[i], the same layout
+    std::vector<std::vector<int> > upperLinks;
+};
+
+}
+}
+
+#endif
@@ -42,6 +42,7 @@
 
 #include "precomp.hpp"
 #include "kdtree.hpp"
+#include "hnsw.hpp"
 
 /****************************************************************************************\
 *                              K-Nearest Neighbors Classifier                            *
@@ -52,6 +53,7 @@ namespace ml {
 
 const String NAME_BRUTE_FORCE = "opencv_ml_knn";
 const String NAME_KDTREE = "opencv_ml_knn_kd";
+const String NAME_HNSW = "opencv_ml_knn_hnsw";
 
 class Impl
 {
@@ -61,6 +63,9 @@ public:
         defaultK = 10;
         isclassifier = true;
         Emax = INT_MAX;
+        maxConnections = 16;
+        constructionWidth = 200;
+        searchWidth = 64;
     }
 
     virtual ~Impl() {}
@@ -100,13 +105,48 @@ public:
 
     virtual void doTrain(InputArray points) { (void)points; }
 
-    void clear()
+    virtual void clear()
     {
         samples.release();
         responses.release();
     }
 
-    void read( const FileNode& fn )
+    // computes the result of prediction from the responses of k neighbors; they are reordered
+    float calcResult( float* rp, int k ) const
+    {
+        float result;
+        if( !isclassifier || k == 1 )
+        {
+            float s = 0.f;
+            for( int j = 0; j < k; j++ )
+                s += rp[j];
+            result = (float)(s*(1.f/k));
+        }
+        else
+        {
+            std::sort(rp, rp+k);
+
+            result = rp[0];
+            int prev_start = 0;
+            int best_count = 0;
+            for( int j = 1; j <= k; j++ )
+            {
+                if( j == k || rp[j] != rp[j-1] )
+                {
+                    int count = j - prev_start;
+                    if( best_count < count )
+                    {
+                        best_count = count;
+                        result = rp[j-1];
+                    }
+                    prev_start = j;
+                }
+            }
+        }
+        return result;
+    }
+
+    virtual void read( const FileNode& fn )
     {
         clear();
         isclassifier = (int)fn["is_classifier"] != 0;
@@ -116,7 +156,7 @@ public:
         fn["responses"] >> responses;
     }
 
-    void write( FileStorage& fs ) const
+    virtual void write( FileStorage& fs ) const
     {
         fs << "is_classifier" << (int)isclassifier;
         fs << "default_k" << defaultK;
@@ -129,6 +169,9 @@ public:
     int defaultK;
     bool isclassifier;
     int Emax;
+    int maxConnections;
+    int constructionWidth;
+    int searchWidth;
 
     Mat samples;
     Mat responses;
@@ -206,7 +249,6 @@ public:
         }
 
         float result = 0.f;
-        float inv_scale = 1.f/k;
 
         for( testidx = 0; testidx < testcount; testidx++ )
         {
@@ -230,35 +272,7 @@ public:
 
             if( results || testidx+range.start == 0 )
             {
-                if( !isclassifier || k == 1 )
-                {
-                    float s = 0.f;
-                    for( j = 0; j < k; j++ )
-                        s += rbuf[testidx*k + j];
-                    result = (float)(s*inv_scale);
-                }
-                else
-                {
-                    float* rp = rbuf + testidx*k;
-                    std::sort(rp, rp+k);
-
-                    result = rp[0];
-                    int prev_start = 0;
-                    int best_count = 0;
-                    for( j = 1; j <= k; j++ )
-                    {
-                        if( j == k || rp[j] != rp[j-1] )
-                        {
-                            int count = j - prev_start;
-                            if( best_count < count )
-                            {
-                                best_count = count;
-                                result = rp[j-1];
-                            }
-                            prev_start = j;
-                        }
-                    }
-                }
+                result = calcResult( rbuf + testidx*k, k );
                 if( results )
                     results->at<float>(testidx + range.start) = result;
                 if( presult && testidx+range.start == 0 )
@@ -417,6 +431,166 @@ public:
     KDTree tr;
 };
 
+
+class HNSWImpl CV_FINAL : public Impl
+{
+public:
+    String getModelName() const CV_OVERRIDE { return NAME_HNSW; }
+    int getType() const CV_OVERRIDE { return ml::KNearest::HNSW; }
+
+    void clear() CV_OVERRIDE
+    {
+        Impl::clear();
+        index.clear(maxConnections, constructionWidth);
+    }
+
+    // only the new samples are linked when the model is updated
+    void doTrain(InputArray points) CV_OVERRIDE
+    {
+        index.add(points.getMat());
+    }
+
+    void read( const FileNode& fn ) CV_OVERRIDE
+    {
+        Impl::read(fn);
+        FileNode fnindex = fn["hnsw"];
+        if( index.read(fnindex, samples.rows) )
+        {
+            maxConnections = index.maxConnections;
+            constructionWidth = index.constructionWidth;
+            searchWidth = (int)fnindex["search_width"];
+            if( searchWidth < 1 )
+                searchWidth = 64;
+        }
+        else
+        {
+            // the graph is missing or doesn't match the samples
+            index.clear(maxConnections, constructionWidth);
+            if( !samples.empty() )
+                index.add(samples);
+        }
+    }
+
+    void write( FileStorage& fs ) const CV_OVERRIDE
+    {
+        Impl::write(fs);
+        fs << "hnsw" << "{";
+        index.write(fs);
+        fs << "search_width" << searchWidth;
+        fs << "}";
+    }
+
+    struct findKNearestInvoker : public ParallelLoopBody
+    {
+        findKNearestInvoker(const HNSWImpl* _p, int _k, const Mat& _samples,
+                            Mat* _results, Mat* _neighborResponses, Mat* _dists)
+            : p(_p), k(_k), samples(_samples), results(_results),
+              neighborResponses(_neighborResponses), dists(_dists)
+        {}
+
+        void operator()(const Range& range) const CV_OVERRIDE
+        {
+            // kept by the thread, so the visited marks are not cleared for every stripe
+            HNSWIndex::SearchBuffer& buf = p->searchBuffers.getRef();
+            AutoBuffer<int> _idx(k);
+            AutoBuffer<float> _buf(k*2);
+            int* idx = _idx.data();
+            float* dbuf = _buf.data();
+            float* rbuf = dbuf + k;
+            const float* rptr = p->responses.ptr<float>();
+
+            for( int i = range.start; i < range.end; i++ )
+            {
+                int j, count = p->index.findNearest(p->samples, samples.ptr<float>(i), k, p->searchWidth,
+                                                    idx, dbuf, buf);
+                for( j = 0; j < count; j++ )
+                    rbuf[j] = rptr[idx[j]];
+
+                if( neighborResponses )
+                {
+                    float* nr = neighborResponses->ptr<float>(i);
+                    for( j = 0; j < count; j++ )
+                        nr[j] = rbuf[j];
+                    for( ; j < k; j++ )
+                        nr[j] = 0.f;
+                }
+
+                if( dists )
+                {
+                    float* dptr = dists->ptr<float>(i);
+                    for( j = 0; j < count; j++ )
+                        dptr[j] = dbuf[j];
+                    for( ; j < k; j++ )
+                        dptr[j] = 0.f;
+                }
+
+                if( results )
+                    results->at<float>(i) = count > 0 ? p->calcResult(rbuf, count) : 0.f;
+            }
+        }
+
+        const HNSWImpl* p;
+        int k;
+        const Mat& samples;
+        Mat* results;
+        Mat* neighborResponses;
+        Mat* dists;
+
+    private:
+        findKNearestInvoker& operator=(const findKNearestInvoker&);
+    };
+
+    float findNearest( InputArray _samples, int k,
+                       OutputArray _results,
+                       OutputArray _neighborResponses,
+                       OutputArray _dists ) const CV_OVERRIDE
+    {
+        CV_Assert( 0 < k );
+
+        Mat test_samples = _samples.getMat();
+        CV_Assert( test_samples.type() == CV_32F && test_samples.cols == samples.cols );
+        int testcount = test_samples.rows;
+
+        if( testcount == 0 )
+        {
+            _results.release();
+            _neighborResponses.release();
+            _dists.release();
+            return 0.f;
+        }
+
+        // the results are always computed, the first one is returned
+        Mat res, nr, d, *pnr = 0, *pd = 0;
+        if( _results.needed() )
+        {
+            _results.create(testcount, 1, CV_32F);
+            res = _results.getMat();
+        }
+        else
+            res.create(testcount, 1, CV_32F);
+        if( _neighborResponses.needed() )
+        {
+            _neighborResponses.create(testcount, k, CV_32F);
+            pnr = &(nr = _neighborResponses.getMat());
+        }
+        if( _dists.needed() )
+        {
+            _dists.create(testcount, k, CV_32F);
+            pd = &(d = _dists.getMat());
+        }
+
+        findKNearestInvoker invoker(this, k, test_samples, &res, pnr, pd);
+        parallel_for_(Range(0, testcount), invoker, (testcount + QUERY_BLOCK_SIZE - 1)/QUERY_BLOCK_SIZE);
+        return res.at<float>(0);
+    }
+
+    enum { QUERY_BLOCK_SIZE = 16 };
+
+    HNSWIndex index;
+    //! the search buffers of the threads, they are as long as the samples
+    mutable TLSData<HNSWIndex::SearchBuffer> searchBuffers;
+};
+
 //================================================================
 
 class KNearestImpl CV_FINAL : public KNearest
@@ -427,6 +601,12 @@ class KNearestImpl CV_FINAL : public KNearest
     inline void setIsClassifier(bool val) CV_OVERRIDE { impl->isclassifier = val; }
     inline int getEmax() const CV_OVERRIDE { return impl->Emax; }
     inline void setEmax(int val) CV_OVERRIDE { impl->Emax = val; }
+    inline int getMaxConnections() const CV_OVERRIDE { return impl->maxConnections; }
+    inline void setMaxConnections(int val) CV_OVERRIDE { CV_Assert( val >= 2 ); impl->maxConnections = val; }
+    inline int getConstructionWidth() const CV_OVERRIDE { return impl->constructionWidth; }
+    inline void setConstructionWidth(int val) CV_OVERRIDE { CV_Assert( val >= 1 ); impl->constructionWidth = val; }
+    inline int getSearchWidth() const CV_OVERRIDE { return impl->searchWidth; }
+    inline void setSearchWidth(int val) CV_OVERRIDE { CV_Assert( val >= 1 ); impl->searchWidth = val; }
 
 public:
     int getAlgorithmType() const CV_OVERRIDE
@@ -435,18 +615,24 @@ public:
     }
     void setAlgorithmType(int val) CV_OVERRIDE
     {
-        if (val != BRUTE_FORCE && val != KDTREE)
+        if (val != BRUTE_FORCE && val != KDTREE && val != HNSW)
             val = BRUTE_FORCE;
 
         int k = getDefaultK();
         int e = getEmax();
         bool c = getIsClassifier();
+        int m = getMaxConnections();
+        int cw = getConstructionWidth();
+        int sw = getSearchWidth();
 
         initImpl(val);
 
         setDefaultK(k);
         setEmax(e);
         setIsClassifier(c);
+        setMaxConnections(m);
+        setConstructionWidth(cw);
+        setSearchWidth(sw);
     }
 
 public:
@@ -474,6 +660,8 @@ public:
         int algorithmType = BRUTE_FORCE;
         if (fn.name() == NAME_KDTREE)
             algorithmType = KDTREE;
+        else if (fn.name() == NAME_HNSW)
+            algorithmType = HNSW;
         initImpl(algorithmType);
         impl->read(fn);
     }
@@ -501,10 +689,12 @@ public:
 protected:
     void initImpl(int algorithmType)
     {
-        if (algorithmType != KDTREE)
-            impl = makePtr<BruteForceImpl>();
-        else
+        if (algorithmType == KDTREE)
             impl = makePtr<KDTreeImpl>();
+        else if (algorithmType == HNSW)
+            impl = makePtr<HNSWImpl>();
+        else
+            impl = makePtr<BruteForceImpl>();
     }
     Ptr<Impl> impl;
 };
@@ -166,12 +166,19 @@ namespace ml
                 CV_Error( CV_StsOutOfRange, "params.regression_accuracy should be >= 0" );
             regressionAccuracy = val;
         }
+        inline void setHistogramBins(int val)
+        {
+            if( val < 0 || val == 1 || val > 256 )
+                CV_Error( CV_StsOutOfRange, "params.histogram_bins should be 0 (exact splits) or within [2, 256]" );
+            histogramBins = val;
+        }
 
         inline int getMaxCategories() const { return maxCategories; }
         inline int getMaxDepth() const { return maxDepth; }
         inline int getMinSampleCount() const { return minSampleCount; }
         inline int getCVFolds() const { return CVFolds; }
         inline float getRegressionAccuracy() const { return regressionAccuracy; }
+        inline int getHistogramBins() const { return histogramBins; }
 
         inline bool getUseSurrogates() const { return useSurrogates; }
         inline void setUseSurrogates(bool val) { useSurrogates = val; }
@@ -194,6 +201,7 @@ namespace ml
         int   minSampleCount;
         int   CVFolds;
         float regressionAccuracy;
+        int   histogramBins;
     };
 
     struct RTreeParams
@@ -283,6 +291,29 @@ namespace ml
             vector<double> ord_responses;
             vector<int> sidx;
             int maxSubsetSize;
+
+            // histogram mode: the bins of the samples (row compVarIdx[vi] for the variable vi)
+            // and the upper bounds of the bins of every ordered variable
+            Mat binIdx;
+            vector<vector<float> > binBounds;
+        };
+
+        // Flattened copy of the trained trees used for the batch prediction.
+        // The split nodes of every tree are stored breadth-first in parallel arrays.
+        // A non-negative child (or root) index refers to a split node, ~i refers to the leaf i.
+        // Only the trees without categorical splits are compiled.
+        struct CompiledTrees
+        {
+            void clear();
+
+            vector<int> roots;
+            vector<int> var;         // variable index in the compressed layout
+            vector<int> col;         // column of the variable in the original samples
+            vector<float> thresh;
+            vector<schar> defaultDir;
+            vector<int> child;       // left and right child of every split node
+            vector<double> leafValue;
+            vector<int> leafClassIdx;
         };
 
         inline int getMaxCategories() const CV_OVERRIDE { return params.getMaxCategories(); }
@@ -303,6 +334,8 @@ namespace ml
         inline void setRegressionAccuracy(float val) CV_OVERRIDE { params.setRegressionAccuracy(val); }
         inline cv::Mat getPriors() const CV_OVERRIDE { return params.getPriors(); }
         inline void setPriors(const cv::Mat& val) CV_OVERRIDE { params.setPriors(val); }
+        inline int getHistogramBins() const CV_OVERRIDE { return params.getHistogramBins(); }
+        inline void setHistogramBins(int val) CV_OVERRIDE { params.setHistogramBins(val); }
 
         DTreesImpl();
         virtual ~DTreesImpl() CV_OVERRIDE;
@@ -328,6 +361,10 @@ namespace ml
         virtual void calcValue( int nidx, const vector<int>& _sidx );
 
         virtual WSplit findSplitOrdClass( int vi, const vector<int>& _sidx, double initQuality );
+        virtual void initHistogramBins();
+        virtual WSplit findSplitHistClass( int vi, const vector<int>& _sidx, double initQuality );
+        virtual WSplit findSplitHistReg( int vi, const vector<int>& _sidx, double initQuality );
+        WSplit findSplit( int vi, const vector<int>& _sidx, int* subset );
 
         // simple k-means, slightly modified to take into account the "weight" (L1-norm) of each vector.
         virtual void clusterCategories( const double* vectors, int n, int m, double* csums, int k, int* labels );
@@ -342,6 +379,8 @@ namespace ml
         virtual double updateTreeRNC( int root, double T, int fold );
         virtual bool cutTree( int root, double T, int fold, double min_alpha );
         virtual float predictTrees( const Range& range, const Mat& sample, int flags ) const;
+        virtual void compileTrees();
+        virtual void predictTreesBatch( const Range& range, const Mat& samples, float* results, int flags ) const;
         virtual float predict( InputArray inputs, OutputArray outputs, int flags ) const CV_OVERRIDE;
 
         virtual void writeTrainingParams( FileStorage& fs ) const;
@@ -377,6 +416,7 @@ namespace ml
         vector<float> missingSubst;
         vector<int> varMapping;
         bool _isClassifier;
+        CompiledTrees compiled;
 
         Ptr<WorkData> w;
     };
@@ -121,6 +121,76 @@ public:
             allVars[i] = varIdx[i];
     }
 
+    // builds a tree on a bootstrap sample, the out-of-bag samples are marked in oobmask
+    void buildTree( uint64 seed )
+    {
+        CV_TRACE_FUNCTION();
+        int i, j, n = (int)w->sidx.size();
+        rng = RNG(seed);
+        // getActiveVars() shuffles allVars, start every tree from the same order
+        for( i = 0; i < (int)allVars.size(); i++ )
+            allVars[i] = varIdx[i];
+        roots.clear();
+        nodes.clear();
+        splits.clear();
+        subsets.clear();
+        sidx.resize(n);
+        oobmask.assign(n, (uchar)1);
+
+        for( i = 0; i < n; i++ )
+        {
+            j = rng.uniform(0, n);
+            sidx[i] = w->sidx[j];
+            oobmask[j] = (uchar)0;
+        }
+        if( addTree( sidx ) < 0 )
+            roots.clear();
+    }
+
+    // appends the tree built by another instance
+    void addTreeFrom( const DTreesImplForRTrees& builder )
+    {
+        int nodeOfs = (int)nodes.size(), splitOfs = (int)splits.size(), subsetOfs = (int)subsets.size();
+        size_t i;
+        for( i = 0; i < builder.nodes.size(); i++ )
+        {
+            Node node = builder.nodes[i];
+            if( node.parent >= 0 ) node.parent += nodeOfs;
+            if( node.left >= 0 ) node.left += nodeOfs;
+            if( node.right >= 0 ) node.right += nodeOfs;
+            if( node.split >= 0 ) node.split += splitOfs;
+            nodes.push_back(node);
+        }
+        for( i = 0; i < builder.splits.size(); i++ )
+        {
+            Split split = builder.splits[i];
+            if( split.next >= 0 ) split.next += splitOfs;
+            if( split.subsetOfs >= 0 ) split.subsetOfs += subsetOfs;
+            splits.push_back(split);
+        }
+        subsets.insert(subsets.end(), builder.subsets.begin(), builder.subsets.end());
+        roots.push_back(builder.roots[0] + nodeOfs);
+    }
+
+    class TreeBuilder : public ParallelLoopBody
+    {
+    public:
+        TreeBuilder(vector<Ptr<DTreesImplForRTrees> >& _builders, const vector<uint64>& _seeds)
+            : builders(_builders), seeds(_seeds) {}
+
+        void operator()(const Range& range) const CV_OVERRIDE
+        {
+            for( int k = range.start; k < range.end; k++ )
+                builders[k]->buildTree(seeds[k]);
+        }
+
+    private:
+        TreeBuilder& operator=(const TreeBuilder&);
+
+        vector<Ptr<DTreesImplForRTrees> >& builders;
+        const vector<uint64>& seeds;
+    };
+
     void endTraining() CV_OVERRIDE
     {
         CV_TRACE_FUNCTION();
@@ -140,8 +210,6 @@ public:
         int nclasses = (int)classLabels.size();
         double eps = (rparams.termCrit.type & TermCriteria::EPS) != 0 &&
             rparams.termCrit.epsilon > 0 ? rparams.termCrit.epsilon : 0.;
-        vector<int> sidx(n);
-        vector<uchar> oobmask(n);
         vector<int> oobidx;
         vector<int> oobperm;
         vector<double> oobres(n, 0.);
@@ -175,112 +243,130 @@ public:
         if( rparams.calcVarImportance )
             varImportance.resize(nallvars, 0.f);
 
-        for( treeidx = 0; treeidx < ntrees; treeidx++ )
+        // the trees are built in parallel, in batches of one tree per thread. Every tree has its own
+        // random generator seeded from rng in the order of trees, so the forest doesn't depend
+        // on the number of threads
+        int nbuilders = std::max(std::min(getNumThreads(), ntrees), 1);
+        vector<Ptr<DTreesImplForRTrees> > builders(nbuilders);
+        for( k = 0; k < nbuilders; k++ )
         {
-            for( i = 0; i < n; i++ )
-                oobmask[i] = (uchar)1;
+            builders[k] = makePtr<DTreesImplForRTrees>(*this);
+            builders[k]->w = makePtr<WorkData>(*w);
+        }
+        vector<uint64> seeds(nbuilders);
+        bool stop = false;
 
-            for( i = 0; i < n; i++ )
-            {
-                j = rng.uniform(0, n);
-                sidx[i] = w->sidx[j];
-                oobmask[j] = (uchar)0;
-            }
-            int root = addTree( sidx );
-            if( root < 0 )
-                return false;
+        for( treeidx = 0; treeidx < ntrees && !stop; )
+        {
+            int batch = std::min(nbuilders, ntrees - treeidx);
+            for( k = 0; k < batch; k++ )
+                seeds[k] = rng.next();
+            parallel_for_(Range(0, batch), TreeBuilder(builders, seeds));
 
-            if( calcOOBError )
+            for( int bi = 0; bi < batch; bi++, treeidx++ )
             {
-                oobidx.clear();
-                for( i = 0; i < n; i++ )
+                DTreesImplForRTrees& builder = *builders[bi];
+                if( builder.roots.empty() )
+                    return false;
+                addTreeFrom(builder);
+                const vector<uchar>& treeOOBMask = builder.oobmask;
+                RNG& trng = builder.rng;
+
+                if( calcOOBError )
                 {
-                    if( oobmask[i] )
-                        oobidx.push_back(i);
-                }
-                int n_oob = (int)oobidx.size();
-                // if there is no out-of-bag samples, we can not compute OOB error
-                // nor update the variable importance vector; so we proceed to the next tree
-                if( n_oob == 0 )
-                    continue;
-                double ncorrect_responses = 0.;
-
-                oobError = 0.;
-                for( i = 0; i < n_oob; i++ )
-                {
-                    j = oobidx[i];
-                    sample = Mat( nallvars, 1, CV_32F, psamples + sstep0*w->sidx[j], sstep1*sizeof(psamples[0]) );
-
-                    double val = predictTrees(Range(treeidx, treeidx+1), sample, predictFlags);
-                    if( !_isClassifier )
-                    {
-                        oobres[j] += val;
-                        oobcount[j]++;
-                        double true_val = w->ord_responses[w->sidx[j]];
-                        double a = oobres[j]/oobcount[j] - true_val;
-                        oobError += a*a;
-                        val = (val - true_val)/max_response;
-                        ncorrect_responses += std::exp( -val*val );
-                    }
-                    else
+                    oobidx.clear();
+                    for( i = 0; i < n; i++ )
                     {
-                        int ival = cvRound(val);
-                        //Voting scheme to combine OOB errors of each tree
-                        int* votes = &oobvotes[j*nclasses];
-                        votes[ival]++;
-                        int best_class = 0;
-                        for( k = 1; k < nclasses; k++ )
-                            if( votes[best_class] < votes[k] )
-                                best_class = k;
-                        int diff = best_class != w->cat_responses[w->sidx[j]];
-                        oobError += diff;
-                        ncorrect_responses += diff == 0;
+                        if( treeOOBMask[i] )
+                            oobidx.push_back(i);
                     }
-                }
-
-                oobError /= n_oob;
-                if( rparams.calcVarImportance && n_oob > 1 )
-                {
-                    Mat sample_clone;
-                    oobperm.resize(n_oob);
+                    int n_oob = (int)oobidx.size();
+                    // if there is no out-of-bag samples, we can not compute OOB error
+                    // nor update the variable importance vector; so we proceed to the next tree
+                    if( n_oob == 0 )
+                        continue;
+                    double ncorrect_responses = 0.;
+
+                    oobError = 0.;
                     for( i = 0; i < n_oob; i++ )
-                        oobperm[i] = oobidx[i];
-                    for (i = n_oob - 1; i > 0; --i)  //Randomly shuffle indices so we can permute features
                     {
-                        int r_i = rng.uniform(0, n_oob);
-                        std::swap(oobperm[i], oobperm[r_i]);
+                        j = oobidx[i];
+                        sample = Mat( nallvars, 1, CV_32F, psamples + sstep0*w->sidx[j], sstep1*sizeof(psamples[0]) );
+
+                        double val = predictTrees(Range(treeidx, treeidx+1), sample, predictFlags);
+                        if( !_isClassifier )
+                        {
+                            oobres[j] += val;
+                            oobcount[j]++;
+                            double true_val = w->ord_responses[w->sidx[j]];
+                            double a = oobres[j]/oobcount[j] - true_val;
+                            oobError += a*a;
+                            val = (val - true_val)/max_response;
+                            ncorrect_responses += std::exp( -val*val );
+                        }
+                        else
+                        {
+                            int ival = cvRound(val);
+                            //Voting scheme to combine OOB errors of each tree
+                            int* votes = &oobvotes[j*nclasses];
+                            votes[ival]++;
+                            int best_class = 0;
+                            for( k = 1; k < nclasses; k++ )
+                                if( votes[best_class] < votes[k] )
+                                    best_class = k;
+                            int diff = best_class != w->cat_responses[w->sidx[j]];
+                            oobError += diff;
+                            ncorrect_responses += diff == 0;
+                        }
                     }
 
-                    for( vi_ = 0; vi_ < nvars; vi_++ )
+                    oobError /= n_oob;
+                    if( rparams.calcVarImportance && n_oob > 1 )
                     {
-                        vi = vidx ? vidx[vi_] : vi_; //Ensure that only the user specified predictors are used for training
-                        double ncorrect_responses_permuted = 0;
-
+                        Mat sample_clone;
+                        oobperm.resize(n_oob);
                         for( i = 0; i < n_oob; i++ )
+                            oobperm[i] = oobidx[i];
+                        for (i = n_oob - 1; i > 0; --i)  //Randomly shuffle indices so we can permute features
                         {
-                            j = oobidx[i];
-                            int vj = oobperm[i];
-                            sample0 = Mat( nallvars, 1, CV_32F, psamples + sstep0*w->sidx[j], sstep1*sizeof(psamples[0]) );
-                            sample0.copyTo(sample_clone); //create a copy so we don't mess up the original data
-                            sample_clone.at<float>(vi) = psamples[sstep0*w->sidx[vj] + sstep1*vi];
-
-                            double val = predictTrees(Range(treeidx, treeidx+1), sample_clone, predictFlags);
-                            if( !_isClassifier )
-                            {
-                                val = (val - w->ord_responses[w->sidx[j]])/max_response;
-                                ncorrect_responses_permuted += exp( -val*val );
-                            }
-                            else
+                            int r_i = trng.uniform(0, n_oob);
+                            std::swap(oobperm[i], oobperm[r_i]);
+                        }
+
+                        for( vi_ = 0; vi_ < nvars; vi_++ )
+                        {
+                            vi = vidx ? vidx[vi_] : vi_; //Ensure that only the user specified predictors are used for training
+                            double ncorrect_responses_permuted = 0;
+
+                            for( i = 0; i < n_oob; i++ )
                             {
-                                ncorrect_responses_permuted += cvRound(val) == w->cat_responses[w->sidx[j]];
+                                j = oobidx[i];
+                                int vj = oobperm[i];
+                                sample0 = Mat( nallvars, 1, CV_32F, psamples + sstep0*w->sidx[j], sstep1*sizeof(psamples[0]) );
+                                sample0.copyTo(sample_clone); //create a copy so we don't mess up the original data
+                                sample_clone.at<float>(vi) = psamples[sstep0*w->sidx[vj] + sstep1*vi];
+
+                                double val = predictTrees(Range(treeidx, treeidx+1), sample_clone, predictFlags);
+                                if( !_isClassifier )
+                                {
+                                    val = (val - w->ord_responses[w->sidx[j]])/max_response;
+                                    ncorrect_responses_permuted += exp( -val*val );
+                                }
+                                else
+                                {
+                                    ncorrect_responses_permuted += cvRound(val) == w->cat_responses[w->sidx[j]];
+                                }
                             }
+                            varImportance[vi] += (float)(ncorrect_responses - ncorrect_responses_permuted);
                         }
-                        varImportance[vi] += (float)(ncorrect_responses - ncorrect_responses_permuted);
                     }
                 }
+                if( calcOOBError && oobError < eps )
+                {
+                    stop = true;
+                    break;
+                }
             }
-            if( calcOOBError && oobError < eps )
-                break;
         }
 
         if( rparams.calcVarImportance )
@@ -360,6 +446,7 @@ public:
             FileNode nfn = (*it)["nodes"];
             readTree(nfn);
         }
+        compileTrees();
     }
 
     void getVotes( InputArray input, OutputArray output, int flags ) const
@@ -377,21 +464,20 @@ public:
                 PREDICT_SUM : PREDICT_MAX_VOTE;
         }
 
+        // the responses of every tree to all the samples, one row per tree
+        Mat treeResults(ntrees, nsamples, CV_32F);
+        if( nsamples > 0 )
+            for( j = 0; j < ntrees; j++ )
+                predictTreesBatch( Range(j, j+1), samples, treeResults.ptr<float>(j), flags );
+
         if( predictType == PREDICT_SUM )
         {
             output.create(nsamples, ntrees, CV_32F);
             results = output.getMat();
-            for( i = 0; i < nsamples; i++ )
-            {
-                for( j = 0; j < ntrees; j++ )
-                {
-                    float val = predictTrees( Range(j, j+1), samples.row(i), flags);
-                    results.at<float> (i, j) = val;
-                }
-            }
+            if( nsamples > 0 )
+                transpose(treeResults, results);
         } else
         {
-            vector<int> votes;
             output.create(nsamples+1, nclasses, CV_32S);
             results = output.getMat();
 
@@ -402,16 +488,14 @@ public:
 
             for( i = 0; i < nsamples; i++ )
             {
-                votes.clear();
-                for( j = 0; j < ntrees; j++ )
-                {
-                    int val = (int)predictTrees( Range(j, j+1), samples.row(i), flags);
-                    votes.push_back(val);
-                }
-
                 for ( j = 0; j < nclasses; j++)
+                    results.at<int> (i+1, j) = 0;
+                for( j = 0; j < ntrees; j++ )
                 {
-                    results.at<int> (i+1, j) = (int)std::count(votes.begin(), votes.end(), classLabels[j]);
+                    int val = (int)treeResults.at<float>(j, i);
+                    for( int k = 0; k < nclasses; k++ )
+                        if( classLabels[k] == val )
+                            results.at<int> (i+1, k)++;
                 }
             }
         }
@@ -422,6 +506,10 @@ public:
     vector<float> varImportance;
     vector<int> allVars, activeVars;
     RNG rng;
+
+    // tree building data of the training threads
+    vector<int> sidx;
+    vector<uchar> oobmask;
 };
 
 
@@ -453,6 +541,8 @@ public:
     inline void setRegressionAccuracy(float val) CV_OVERRIDE { impl.params.setRegressionAccuracy(val); }
     inline cv::Mat getPriors() const CV_OVERRIDE { return impl.params.getPriors(); }
     inline void setPriors(const cv::Mat& val) CV_OVERRIDE { impl.params.setPriors(val); }
+    inline int getHistogramBins() const CV_OVERRIDE { return impl.params.getHistogramBins(); }
+    inline void setHistogramBins(int val) CV_OVERRIDE { impl.params.setHistogramBins(val); }
     inline void getVotes(InputArray input, OutputArray output, int flags) const CV_OVERRIDE {return impl.getVotes(input,output,flags);}
 
     RTreesImpl() {}
@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <stdarg.h>
 #include <ctype.h>
@@ -115,6 +116,7 @@ struct SvmParams
     double      p;
     Mat         classWeights;
     TermCriteria termCrit;
+    int         kernelCacheSize;
 
     SvmParams()
     {
@@ -127,6 +129,7 @@ struct SvmParams
         nu = 0;
         p = 0;
         termCrit = TermCriteria( CV_TERMCRIT_ITER+CV_TERMCRIT_EPS, 1000, FLT_EPSILON );
+        kernelCacheSize = 0;
     }
 
     SvmParams( int _svmType, int _kernelType,
@@ -144,6 +147,7 @@ struct SvmParams
         p = _p;
         classWeights = _classWeights;
         termCrit = _termCrit;
+        kernelCacheSize = 0;
     }
 
 };
@@ -171,9 +175,22 @@ public:
         {
             const float* sample = &vecs[j*var_count];
             double s = 0;
-            for( k = 0; k <= var_count - 4; k += 4 )
+            k = 0;
+#if CV_SIMD128_64F
+            // the products are rounded to float as in the scalar code, the sums are accumulated in double
+            v_float64x2 s0 = v_setzero_f64(), s1 = v_setzero_f64();
+            for( ; k <= var_count - 4; k += 4 )
+            {
+                v_float32x4 t = v_load(sample + k)*v_load(another + k);
+                s0 += v_cvt_f64(t);
+                s1 += v_cvt_f64_high(t);
+            }
+            s = reduceSum(s0 + s1);
+#else
+            for( ; k <= var_count - 4; k += 4 )
                 s += sample[k]*another[k] + sample[k+1]*another[k+1] +
                 sample[k+2]*another[k+2] + sample[k+3]*another[k+3];
+#endif
             for( ; k < var_count; k++ )
                 s += sample[k]*another[k];
             results[j] = (Qfloat)(s*alpha + beta);
@@ -198,11 +215,15 @@ public:
     void calc_sigmoid( int vcount, int var_count, const float* vecs,
                        const float* another, Qfloat* results )
     {
-        int j;
         calc_non_rbf_base( vcount, var_count, vecs, another, results,
                           -2*params.gamma, -2*params.coef0 );
+        calc_sigmoid_tail( vcount, results );
+    }
+
+    static void calc_sigmoid_tail( int vcount, Qfloat* results )
+    {
         // TODO: speedup this
-        for( j = 0; j < vcount; j++ )
+        for( int j = 0; j < vcount; j++ )
         {
             Qfloat t = results[j];
             Qfloat e = std::exp(-std::abs(t));
@@ -224,8 +245,20 @@ public:
         {
             const float* sample = &vecs[j*var_count];
             double s = 0;
+            k = 0;
 
-            for( k = 0; k <= var_count - 4; k += 4 )
+#if CV_SIMD128_64F
+            v_float64x2 s0 = v_setzero_f64(), s1 = v_setzero_f64();
+            for( ; k <= var_count - 4; k += 4 )
+            {
+                v_float32x4 t = v_load(sample + k) - v_load(another + k);
+                v_float64x2 t0 = v_cvt_f64(t), t1 = v_cvt_f64_high(t);
+                s0 += t0*t0;
+                s1 += t1*t1;
+            }
+            s = reduceSum(s0 + s1);
+#else
+            for( ; k <= var_count - 4; k += 4 )
             {
                 double t0 = sample[k] - another[k];
                 double t1 = sample[k+1] - another[k+1];
@@ -237,6 +270,7 @@ public:
 
                 s += t0*t0 + t1*t1;
             }
+#endif
 
             for( ; k < var_count; k++ )
             {
@@ -325,6 +359,56 @@ public:
         default:
             CV_Error(CV_StsBadArg, "Unknown kernel type");
         }
+        clamp_results( vcount, results );
+    }
+
+    /// True for the kernels that depend only on the dot product or on the distance of the vectors
+    bool supportsDotProducts() const
+    {
+        int kernelType = params.kernelType;
+        return kernelType == SVM::LINEAR || kernelType == SVM::POLY ||
+               kernelType == SVM::SIGMOID || kernelType == SVM::RBF;
+    }
+
+    /// Computes the kernel values from the dot products of the vectors and another one.
+    /// RBF also needs the squared norms of the vectors and of another one; the distances
+    /// are formed in double, since they are small differences of the large norms.
+    void calcFromDotProducts( int vcount, const double* dots, Qfloat* results,
+                              const double* vecNorms, double anotherNorm )
+    {
+        int j;
+        Mat R( 1, vcount, QFLOAT_TYPE, results );
+        switch( params.kernelType )
+        {
+        case SVM::LINEAR:
+            for( j = 0; j < vcount; j++ )
+                results[j] = (Qfloat)dots[j];
+            break;
+        case SVM::POLY:
+            for( j = 0; j < vcount; j++ )
+                results[j] = (Qfloat)(dots[j]*params.gamma + params.coef0);
+            if( vcount > 0 )
+                pow( R, params.degree, R );
+            break;
+        case SVM::SIGMOID:
+            for( j = 0; j < vcount; j++ )
+                results[j] = (Qfloat)(dots[j]*(-2*params.gamma) - 2*params.coef0);
+            calc_sigmoid_tail( vcount, results );
+            break;
+        case SVM::RBF:
+            for( j = 0; j < vcount; j++ )
+                results[j] = (Qfloat)(std::max(anotherNorm + vecNorms[j] - 2.*dots[j], 0.)*(-params.gamma));
+            if( vcount > 0 )
+                exp( R, R );
+            break;
+        default:
+            CV_Error(CV_StsBadArg, "The kernel can not be computed from the dot products");
+        }
+        clamp_results( vcount, results );
+    }
+
+    static void clamp_results( int vcount, Qfloat* results )
+    {
         const Qfloat max_val = (Qfloat)(FLT_MAX*1e-3);
         for( int j = 0; j < vcount; j++ )
         {
@@ -333,6 +417,15 @@ public:
         }
     }
 
+#if CV_SIMD128_64F
+    static double reduceSum( const v_float64x2& s )
+    {
+        double CV_DECL_ALIGNED(16) buf[2];
+        v_store_aligned(buf, s);
+        return buf[0] + buf[1];
+    }
+#endif
+
     SvmParams params;
 };
 
@@ -446,6 +539,28 @@ public:
     class Solver
     {
     public:
+        // computes a part of the kernel matrix row
+        class KernelRowBody : public ParallelLoopBody
+        {
+        public:
+            KernelRowBody( const Ptr<SVM::Kernel>& _kernel, const Mat& _samples, const float* _another, Qfloat* _results )
+                : kernel(_kernel), samples(_samples), another(_another), results(_results) {}
+
+            void operator()( const Range& range ) const CV_OVERRIDE
+            {
+                kernel->calc( range.end - range.start, samples.cols, samples.ptr<float>(range.start),
+                              another, results + range.start );
+            }
+
+        private:
+            KernelRowBody& operator=(const KernelRowBody&);
+
+            const Ptr<SVM::Kernel>& kernel;
+            const Mat& samples;
+            const float* another;
+            Qfloat* results;
+        };
+
         enum { MIN_CACHE_SIZE = (40 << 20) /* 40Mb */, MAX_CACHE_SIZE = (500 << 20) /* 500Mb */ };
 
         typedef bool (Solver::*SelectWorkingSet)( int& i, int& j );
@@ -485,7 +600,7 @@ public:
                 double _Cp, double _Cn,
                 const Ptr<SVM::Kernel>& _kernel, GetRow _get_row,
                 SelectWorkingSet _select_working_set, CalcRho _calc_rho,
-                TermCriteria _termCrit )
+                TermCriteria _termCrit, int64 _cacheSize )
         {
             clear();
 
@@ -518,10 +633,12 @@ public:
             get_row_func = _get_row;
             CV_Assert(get_row_func != 0);
 
-            // assume that for large training sets ~25% of Q matrix is used
-            int64 csize = (int64)sample_count*sample_count/4;
-            csize = std::max(csize, (int64)(MIN_CACHE_SIZE/sizeof(Qfloat)) );
-            csize = std::min(csize, (int64)(MAX_CACHE_SIZE/sizeof(Qfloat)) );
+            // the built-in kernels can compute the parts of a row concurrently
+            parallel_kernel = dynamic_cast<SVMKernelImpl*>(kernel.get()) != 0 &&
+                              (int64)sample_count*var_count >= (1 << 16);
+
+            int64 csize = (_cacheSize > 0 ? _cacheSize :
+                           defaultCacheSize(sample_count, MAX_CACHE_SIZE))/(int64)sizeof(Qfloat);
             max_cache_size = (int)((csize + sample_count-1)/sample_count);
             max_cache_size = std::min(std::max(max_cache_size, 1), sample_count);
             cache_size = 0;
@@ -532,6 +649,15 @@ public:
             lru_cache_data.create(max_cache_size, sample_count, QFLOAT_TYPE);
         }
 
+        // the kernel cache size in bytes when it is not given, at most max_size
+        static int64 defaultCacheSize( int sample_count, int64 max_size )
+        {
+            // assume that for large training sets ~25% of Q matrix is used
+            int64 csize = (int64)sample_count*sample_count/4*(int64)sizeof(Qfloat);
+            csize = std::max(csize, (int64)MIN_CACHE_SIZE);
+            return std::min(csize, max_size);
+        }
+
         Qfloat* get_row_base( int i, bool* _existed )
         {
             int i1 = i < sample_count ? i : i - sample_count;
@@ -557,8 +683,11 @@ public:
                     last.prev = 0;
                     last.next = 0;
                 }
-                kernel->calc( sample_count, var_count, samples.ptr<float>(),
-                              samples.ptr<float>(i1), lru_cache_data.ptr<Qfloat>(kr.idx) );
+                KernelRowBody body( kernel, samples, samples.ptr<float>(i1), lru_cache_data.ptr<Qfloat>(kr.idx) );
+                if( parallel_kernel )
+                    parallel_for_( Range(0, sample_count), body, (sample_count + 1023)/1024 );
+                else
+                    body( Range(0, sample_count) );
             }
             else
             {
@@ -1014,7 +1143,8 @@ public:
         */
         static bool solve_c_svc( const Mat& _samples, const vector<schar>& _y,
                                  double _Cp, double _Cn, const Ptr<SVM::Kernel>& _kernel,
-                                 vector<double>& _alpha, SolutionInfo& _si, TermCriteria termCrit )
+                                 vector<double>& _alpha, SolutionInfo& _si,
+                                 TermCriteria termCrit, int64 cacheSize )
         {
             int sample_count = _samples.rows;
 
@@ -1025,7 +1155,7 @@ public:
                            &Solver::get_row_svc,
                            &Solver::select_working_set,
                            &Solver::calc_rho,
-                           termCrit );
+                           termCrit, cacheSize );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1040,7 +1170,7 @@ public:
         static bool solve_nu_svc( const Mat& _samples, const vector<schar>& _y,
                                   double nu, const Ptr<SVM::Kernel>& _kernel,
                                   vector<double>& _alpha, SolutionInfo& _si,
-                                  TermCriteria termCrit )
+                                  TermCriteria termCrit, int64 cacheSize )
         {
             int sample_count = _samples.rows;
 
@@ -1070,7 +1200,7 @@ public:
                            &Solver::get_row_svc,
                            &Solver::select_working_set_nu_svm,
                            &Solver::calc_rho_nu_svm,
-                           termCrit );
+                           termCrit, cacheSize );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1091,7 +1221,7 @@ public:
         static bool solve_one_class( const Mat& _samples, double nu,
                                      const Ptr<SVM::Kernel>& _kernel,
                                      vector<double>& _alpha, SolutionInfo& _si,
-                                     TermCriteria termCrit )
+                                     TermCriteria termCrit, int64 cacheSize )
         {
             int sample_count = _samples.rows;
             vector<schar> _y(sample_count, 1);
@@ -1112,7 +1242,7 @@ public:
                            &Solver::get_row_one_class,
                            &Solver::select_working_set,
                            &Solver::calc_rho,
-                           termCrit );
+                           termCrit, cacheSize );
 
             return solver.solve_generic(_si);
         }
@@ -1120,7 +1250,7 @@ public:
         static bool solve_eps_svr( const Mat& _samples, const vector<float>& _yf,
                                    double p, double C, const Ptr<SVM::Kernel>& _kernel,
                                    vector<double>& _alpha, SolutionInfo& _si,
-                                   TermCriteria termCrit )
+                                   TermCriteria termCrit, int64 cacheSize )
         {
             int sample_count = _samples.rows;
             int alpha_count = sample_count*2;
@@ -1144,7 +1274,7 @@ public:
                            &Solver::get_row_svr,
                            &Solver::select_working_set,
                            &Solver::calc_rho,
-                           termCrit );
+                           termCrit, cacheSize );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1159,7 +1289,7 @@ public:
         static bool solve_nu_svr( const Mat& _samples, const vector<float>& _yf,
                                   double nu, double C, const Ptr<SVM::Kernel>& _kernel,
                                   vector<double>& _alpha, SolutionInfo& _si,
-                                  TermCriteria termCrit )
+                                  TermCriteria termCrit, int64 cacheSize )
         {
             int sample_count = _samples.rows;
             int alpha_count = sample_count*2;
@@ -1187,7 +1317,7 @@ public:
                            &Solver::get_row_svr,
                            &Solver::select_working_set_nu_svm,
                            &Solver::calc_rho_nu_svm,
-                           termCrit );
+                           termCrit, cacheSize );
 
             if( !solver.solve_generic( _si ))
                 return false;
@@ -1202,6 +1332,7 @@ public:
         int var_count;
         int cache_size;
         int max_cache_size;
+        bool parallel_kernel;
         Mat samples;
         SvmParams params;
         vector<KernelRow> lru_cache;
@@ -1278,6 +1409,8 @@ public:
     inline void setClassWeights(const cv::Mat& val) CV_OVERRIDE { params.classWeights = val; }
     inline cv::TermCriteria getTermCriteria() const CV_OVERRIDE { return params.termCrit; }
     inline void setTermCriteria(const cv::TermCriteria& val) CV_OVERRIDE { params.termCrit = val; }
+    inline int getKernelCacheSize() const CV_OVERRIDE { return params.kernelCacheSize; }
+    inline void setKernelCacheSize(int val) CV_OVERRIDE { params.kernelCacheSize = val; }
 
     int getKernelType() const CV_OVERRIDE { return params.kernelType; }
     void setKernel(int kernelType) CV_OVERRIDE
@@ -1351,6 +1484,9 @@ public:
         if( svmType != C_SVC )
             params.classWeights.release();
 
+        if( params.kernelCacheSize < 0 )
+            CV_Error( CV_StsOutOfRange, "The kernel cache size must be positive or zero" );
+
         if( !(params.termCrit.type & TermCriteria::EPS) )
             params.termCrit.epsilon = DBL_EPSILON;
         params.termCrit.epsilon = std::max(params.termCrit.epsilon, DBL_EPSILON);
@@ -1371,6 +1507,89 @@ public:
                 (int)df_index.size()) - decision_func[i].ofs;
     }
 
+    struct PairSolution
+    {
+        PairSolution() : rho(0.), ok(false) {}
+        vector<double> alpha;
+        double rho;
+        bool ok;
+    };
+
+    // trains the one-vs-one classifiers of the given pairs of classes
+    class TrainPairsBody : public ParallelLoopBody
+    {
+    public:
+        TrainPairsBody( const SVMImpl* _svm, const Mat& _samples, const vector<int>& _sidx_all,
+                        const vector<int>& _class_ranges, const Mat& _class_weights,
+                        const vector<Vec2i>& _pairs, int64 _cacheSize, int64 _maxCacheSize,
+                        vector<PairSolution>& _solutions )
+            : svm(_svm), samples(_samples), sidx_all(_sidx_all), class_ranges(_class_ranges),
+              class_weights(_class_weights), pairs(_pairs), cacheSize(_cacheSize),
+              maxCacheSize(_maxCacheSize), solutions(_solutions)
+        {}
+
+        void operator()( const Range& range ) const CV_OVERRIDE
+        {
+            const SvmParams& params = svm->params;
+            size_t samplesize = samples.cols*samples.elemSize();
+            Mat temp_samples;
+            vector<schar> temp_y;
+            Solver::SolutionInfo sinfo;
+
+            for( int p = range.start; p < range.end; p++ )
+            {
+                int i = pairs[p][0], j = pairs[p][1];
+                int si = class_ranges[i], ci = class_ranges[i+1] - si;
+                int sj = class_ranges[j], cj = class_ranges[j+1] - sj;
+                double Cp = params.C, Cn = Cp;
+
+                temp_samples.create(ci + cj, samples.cols, samples.type());
+                temp_y.resize(ci + cj);
+
+                // form input for the binary classification problem
+                for( int k = 0; k < ci+cj; k++ )
+                {
+                    int idx = k < ci ? si+k : sj+k-ci;
+                    memcpy(temp_samples.ptr(k), samples.ptr(sidx_all[idx]), samplesize);
+                    temp_y[k] = k < ci ? 1 : -1;
+                }
+
+                if( !class_weights.empty() )
+                {
+                    Cp = class_weights.at<double>(i);
+                    Cn = class_weights.at<double>(j);
+                }
+
+                // unless given, the cache is sized from the pair, within the share of the thread
+                int64 pairCacheSize = cacheSize > 0 ? cacheSize :
+                                      Solver::defaultCacheSize(ci + cj, maxCacheSize);
+
+                PairSolution& sol = solutions[p];
+                sol.ok = params.svmType == C_SVC ?
+                            Solver::solve_c_svc( temp_samples, temp_y, Cp, Cn, svm->kernel,
+                                                 sol.alpha, sinfo, params.termCrit, pairCacheSize ) :
+                         params.svmType == NU_SVC ?
+                            Solver::solve_nu_svc( temp_samples, temp_y, params.nu, svm->kernel,
+                                                  sol.alpha, sinfo, params.termCrit, pairCacheSize ) :
+                         false;
+                sol.rho = sinfo.rho;
+            }
+        }
+
+    private:
+        TrainPairsBody& operator=(const TrainPairsBody&);
+
+        const SVMImpl* svm;
+        const Mat& samples;
+        const vector<int>& sidx_all;
+        const vector<int>& class_ranges;
+        const Mat& class_weights;
+        const vector<Vec2i>& pairs;
+        int64 cacheSize;
+        int64 maxCacheSize;
+        vector<PairSolution>& solutions;
+    };
+
     bool do_train( const Mat& _samples, const Mat& _responses )
     {
         int svmType = params.svmType;
@@ -1380,6 +1599,7 @@ public:
 
         CV_Assert( _samples.type() == CV_32F );
         var_count = _samples.cols;
+        int64 cacheSize = (int64)params.kernelCacheSize << 20;
 
         if( svmType == ONE_CLASS || svmType == EPS_SVR || svmType == NU_SVR )
         {
@@ -1391,9 +1611,9 @@ public:
                 _responses.convertTo(_yf, CV_32F);
 
             bool ok =
-            svmType == ONE_CLASS ? Solver::solve_one_class( _samples, params.nu, kernel, _alpha, sinfo, params.termCrit ) :
-            svmType == EPS_SVR ? Solver::solve_eps_svr( _samples, _yf, params.p, params.C, kernel, _alpha, sinfo, params.termCrit ) :
-            svmType == NU_SVR ? Solver::solve_nu_svr( _samples, _yf, params.nu, params.C, kernel, _alpha, sinfo, params.termCrit ) : false;
+            svmType == ONE_CLASS ? Solver::solve_one_class( _samples, params.nu, kernel, _alpha, sinfo, params.termCrit, cacheSize ) :
+            svmType == EPS_SVR ? Solver::solve_eps_svr( _samples, _yf, params.p, params.C, kernel, _alpha, sinfo, params.termCrit, cacheSize ) :
+            svmType == NU_SVR ? Solver::solve_nu_svr( _samples, _yf, params.nu, params.C, kernel, _alpha, sinfo, params.termCrit, cacheSize ) : false;
 
             if( !ok )
                 return false;
@@ -1423,10 +1643,9 @@ public:
         else
         {
             int class_count = (int)class_labels.total();
-            vector<int> svidx, sidx, sidx_all, sv_tab(sample_count, 0);
-            Mat temp_samples, class_weights;
+            vector<int> svidx, sidx_all, sv_tab(sample_count, 0);
+            Mat class_weights;
             vector<int> class_ranges;
-            vector<schar> temp_y;
             double nu = params.nu;
             CV_Assert( svmType == C_SVC || svmType == NU_SVC );
 
@@ -1474,56 +1693,51 @@ public:
             size_t samplesize = _samples.cols*_samples.elemSize();
 
             // train n*(n-1)/2 classifiers
+            vector<Vec2i> pairs;
             for( i = 0; i < class_count; i++ )
-            {
                 for( j = i+1; j < class_count; j++ )
-                {
-                    int si = class_ranges[i], ci = class_ranges[i+1] - si;
-                    int sj = class_ranges[j], cj = class_ranges[j+1] - sj;
-                    double Cp = params.C, Cn = Cp;
-
-                    temp_samples.create(ci + cj, _samples.cols, _samples.type());
-                    sidx.resize(ci + cj);
-                    temp_y.resize(ci + cj);
-
-                    // form input for the binary classification problem
-                    for( k = 0; k < ci+cj; k++ )
-                    {
-                        int idx = k < ci ? si+k : sj+k-ci;
-                        memcpy(temp_samples.ptr(k), _samples.ptr(sidx_all[idx]), samplesize);
-                        sidx[k] = sidx_all[idx];
-                        temp_y[k] = k < ci ? 1 : -1;
-                    }
+                    pairs.push_back(Vec2i(i, j));
+
+            // the classifiers are independent; with a user-defined kernel, that is not known
+            // to be thread-safe, they are trained one by one
+            int npairs = (int)pairs.size();
+            int nconcurrent = dynamic_cast<SVMKernelImpl*>(kernel.get()) != 0 ?
+                std::max(std::min(getNumThreads(), npairs), 1) : 1;
+            int64 maxCacheSize = (int64)Solver::MAX_CACHE_SIZE/nconcurrent;
+            if( cacheSize > 0 )
+                cacheSize = std::max(cacheSize/nconcurrent, (int64)1);
+
+            vector<PairSolution> solutions(npairs);
+            TrainPairsBody body( this, _samples, sidx_all, class_ranges, class_weights,
+                                 pairs, cacheSize, maxCacheSize, solutions );
+            if( nconcurrent > 1 )
+                parallel_for_( Range(0, npairs), body );
+            else
+                body( Range(0, npairs) );
 
-                    if( !class_weights.empty() )
-                    {
-                        Cp = class_weights.at<double>(i);
-                        Cn = class_weights.at<double>(j);
-                    }
+            for( int p = 0; p < npairs; p++ )
+            {
+                i = pairs[p][0];
+                j = pairs[p][1];
+                int si = class_ranges[i], ci = class_ranges[i+1] - si;
+                int sj = class_ranges[j], cj = class_ranges[j+1] - sj;
+                const PairSolution& sol = solutions[p];
 
-                    DecisionFunc df;
-                    bool ok = params.svmType == C_SVC ?
-                                Solver::solve_c_svc( temp_samples, temp_y, Cp, Cn,
-                                                     kernel, _alpha, sinfo, params.termCrit ) :
-                              params.svmType == NU_SVC ?
-                                Solver::solve_nu_svc( temp_samples, temp_y, params.nu,
-                                                      kernel, _alpha, sinfo, params.termCrit ) :
-                              false;
-                    if( !ok )
-                        return false;
-                    df.rho = sinfo.rho;
-                    df.ofs = (int)df_index.size();
-                    decision_func.push_back(df);
+                if( !sol.ok )
+                    return false;
+                DecisionFunc df;
+                df.rho = sol.rho;
+                df.ofs = (int)df_index.size();
+                decision_func.push_back(df);
 
-                    for( k = 0; k < ci + cj; k++ )
+                for( k = 0; k < ci + cj; k++ )
+                {
+                    if( std::abs(sol.alpha[k]) > 0 )
                     {
-                        if( std::abs(_alpha[k]) > 0 )
-                        {
-                            int idx = k < ci ? si+k : sj+k-ci;
-                            sv_tab[sidx_all[idx]] = 1;
-                            df_index.push_back(sidx_all[idx]);
-                            df_alpha.push_back(_alpha[k]);
-                        }
+                        int idx = k < ci ? si+k : sj+k-ci;
+                        sv_tab[sidx_all[idx]] = 1;
+                        df_index.push_back(sidx_all[idx]);
+                        df_alpha.push_back(sol.alpha[k]);
                     }
                 }
             }
@@ -1899,87 +2113,124 @@ public:
 
     struct PredictBody : ParallelLoopBody
     {
-        PredictBody( const SVMImpl* _svm, const Mat& _samples, Mat& _results, bool _returnDFVal )
+        enum { BLOCK_SIZE = 64 };
+
+        PredictBody( const SVMImpl* _svm, const Mat& _samples, Mat& _results, bool _returnDFVal,
+                     const Mat& _sv64f, const Mat& _svNorms )
         {
             svm = _svm;
             results = &_results;
             samples = &_samples;
             returnDFVal = _returnDFVal;
+            sv64f = &_sv64f;
+            svNorms = &_svNorms;
         }
 
+        // With the kernels depending only on the dot products (the support vectors converted
+        // to double and their squared norms are given in sv64f and svNorms then), the kernel values
+        // of a block of samples are computed from a single matrix product with the support vectors.
+        // The product is computed in double to match the kernel values of a single sample.
         void operator()(const Range& range) const CV_OVERRIDE
         {
             int svmType = svm->params.svmType;
             int sv_total = svm->sv.rows;
             int class_count = !svm->class_labels.empty() ? (int)svm->class_labels.total() : svmType == ONE_CLASS ? 1 : 0;
+            SVMKernelImpl* kernelImpl = !svNorms->empty() ? static_cast<SVMKernelImpl*>(svm->kernel.get()) : 0;
 
             AutoBuffer<float> _buffer(sv_total + (class_count+1)*2);
             float* buffer = _buffer.data();
+            int* vote = (int*)(buffer + sv_total);
+            Mat block, dots;
 
-            int i, j, dfi, k, si;
+            if( svmType != EPS_SVR && svmType != NU_SVR && svmType != ONE_CLASS &&
+                svmType != C_SVC && svmType != NU_SVC )
+                CV_Error( CV_StsBadArg, "INTERNAL ERROR: Unknown SVM type, "
+                         "the SVM structure is probably corrupted" );
 
-            if( svmType == EPS_SVR || svmType == NU_SVR || svmType == ONE_CLASS )
+            for( int start = range.start; start < range.end; start += BLOCK_SIZE )
             {
-                for( si = range.start; si < range.end; si++ )
+                int end = std::min(start + BLOCK_SIZE, range.end);
+                if( kernelImpl )
+                {
+                    samples->rowRange(start, end).convertTo(block, CV_64F);
+                    gemm( block, *sv64f, 1, noArray(), 0, dots, GEMM_2_T );
+                }
+
+                for( int si = start; si < end; si++ )
                 {
                     const float* row_sample = samples->ptr<float>(si);
-                    svm->kernel->calc( sv_total, svm->var_count, svm->sv.ptr<float>(), row_sample, buffer );
-
-                    const SVMImpl::DecisionFunc* df = &svm->decision_func[0];
-                    double sum = -df->rho;
-                    for( i = 0; i < sv_total; i++ )
-                        sum += buffer[i]*svm->df_alpha[i];
-                    float result = svm->params.svmType == ONE_CLASS && !returnDFVal ? (float)(sum > 0) : (float)sum;
-                    results->at<float>(si) = result;
+                    float* kvalues = buffer;
+                    if( kernelImpl )
+                    {
+                        double norm = svm->params.kernelType == RBF ? normSquared(row_sample, svm->var_count) : 0.;
+                        kernelImpl->calcFromDotProducts( sv_total, dots.ptr<double>(si - start), kvalues,
+                                                         svNorms->ptr<double>(), norm );
+                    }
+                    else
+                        svm->kernel->calc( sv_total, svm->var_count, svm->sv.ptr<float>(), row_sample, kvalues );
+
+                    results->at<float>(si) = svmType == C_SVC || svmType == NU_SVC ?
+                        predictClass( kvalues, vote, class_count ) : predictValue( kvalues );
                 }
             }
-            else if( svmType == C_SVC || svmType == NU_SVC )
-            {
-                int* vote = (int*)(buffer + sv_total);
+        }
 
-                for( si = range.start; si < range.end; si++ )
-                {
-                    svm->kernel->calc( sv_total, svm->var_count, svm->sv.ptr<float>(),
-                                       samples->ptr<float>(si), buffer );
-                    double sum = 0.;
+        float predictValue( const float* kvalues ) const
+        {
+            int sv_total = svm->sv.rows;
+            const SVMImpl::DecisionFunc* df = &svm->decision_func[0];
+            double sum = -df->rho;
+            for( int i = 0; i < sv_total; i++ )
+                sum += kvalues[i]*svm->df_alpha[i];
+            return svm->params.svmType == ONE_CLASS && !returnDFVal ? (float)(sum > 0) : (float)sum;
+        }
 
-                    memset( vote, 0, class_count*sizeof(vote[0]));
+        float predictClass( const float* kvalues, int* vote, int class_count ) const
+        {
+            int i, j, dfi, k;
+            double sum = 0.;
 
-                    for( i = dfi = 0; i < class_count; i++ )
-                    {
-                        for( j = i+1; j < class_count; j++, dfi++ )
-                        {
-                            const DecisionFunc& df = svm->decision_func[dfi];
-                            sum = -df.rho;
-                            int sv_count = svm->getSVCount(dfi);
-                            const double* alpha = &svm->df_alpha[df.ofs];
-                            const int* sv_index = &svm->df_index[df.ofs];
-                            for( k = 0; k < sv_count; k++ )
-                                sum += alpha[k]*buffer[sv_index[k]];
-
-                            vote[sum > 0 ? i : j]++;
-                        }
-                    }
+            memset( vote, 0, class_count*sizeof(vote[0]));
 
-                    for( i = 1, k = 0; i < class_count; i++ )
-                    {
-                        if( vote[i] > vote[k] )
-                            k = i;
-                    }
-                    float result = returnDFVal && class_count == 2 ?
-                        (float)sum : (float)(svm->class_labels.at<int>(k));
-                    results->at<float>(si) = result;
+            for( i = dfi = 0; i < class_count; i++ )
+            {
+                for( j = i+1; j < class_count; j++, dfi++ )
+                {
+                    const DecisionFunc& df = svm->decision_func[dfi];
+                    sum = -df.rho;
+                    int sv_count = svm->getSVCount(dfi);
+                    const double* alpha = &svm->df_alpha[df.ofs];
+                    const int* sv_index = &svm->df_index[df.ofs];
+                    for( k = 0; k < sv_count; k++ )
+                        sum += alpha[k]*kvalues[sv_index[k]];
+
+                    vote[sum > 0 ? i : j]++;
                 }
             }
-            else
-                CV_Error( CV_StsBadArg, "INTERNAL ERROR: Unknown SVM type, "
-                         "the SVM structure is probably corrupted" );
+
+            for( i = 1, k = 0; i < class_count; i++ )
+            {
+                if( vote[i] > vote[k] )
+                    k = i;
+            }
+            return returnDFVal && class_count == 2 ?
+                (float)sum : (float)(svm->class_labels.at<int>(k));
+        }
+
+        static double normSquared( const float* v, int n )
+        {
+            double s = 0;
+            for( int k = 0; k < n; k++ )
+                s += (double)v[k]*v[k];
+            return s;
         }
 
         const SVMImpl* svm;
         const Mat* samples;
         Mat* results;
         bool returnDFVal;
+        const Mat* sv64f;
+        const Mat* svNorms;
     };
 
     bool trainAuto(InputArray samples, int layout,
@@ -2020,11 +2271,25 @@ public:
             results = Mat(1, 1, CV_32F, &result);
         }
 
-        PredictBody invoker(this, samples, results, returnDFVal);
+        // many samples: compute the kernel values from the matrix products with the support vectors
+        Mat sv64f, svNorms;
+        double nstripes = -1;
+        SVMKernelImpl* kernelImpl = dynamic_cast<SVMKernelImpl*>(kernel.get());
+        if( nsamples >= 16 && kernelImpl && kernelImpl->supportsDotProducts() && sv.rows > 0 )
+        {
+            sv.convertTo(sv64f, CV_64F);
+            svNorms.create(1, sv.rows, CV_64F);
+            for( int i = 0; i < sv.rows; i++ )
+                svNorms.at<double>(i) = PredictBody::normSquared(sv.ptr<float>(i), var_count);
+            // a stripe per block of samples, so that the matrix products are not split
+            nstripes = (double)(nsamples + PredictBody::BLOCK_SIZE - 1)/PredictBody::BLOCK_SIZE;
+        }
+
+        PredictBody invoker(this, samples, results, returnDFVal, sv64f, svNorms);
         if( nsamples < 10 )
             invoker(Range(0, nsamples));
         else
-            parallel_for_(Range(0, nsamples), invoker);
+            parallel_for_(Range(0, nsamples), invoker, nstripes);
         return result;
     }
 
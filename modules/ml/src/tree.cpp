@@ -59,6 +59,7 @@ TreeParams::TreeParams()
     use1SERule = true;
     truncatePrunedTree = true;
     priors = Mat();
+    histogramBins = 0;
 }
 
 TreeParams::TreeParams(int _maxDepth, int _minSampleCount,
@@ -76,6 +77,7 @@ TreeParams::TreeParams(int _maxDepth, int _minSampleCount,
     use1SERule = _use1SERule;
     truncatePrunedTree = _truncatePrunedTree;
     priors = _priors;
+    histogramBins = 0;
 }
 
 DTrees::Node::Node()
@@ -129,6 +131,7 @@ void DTreesImpl::clear()
     splits.clear();
     subsets.clear();
     classLabels.clear();
+    compiled.clear();
 
     w.release();
     _isClassifier = false;
@@ -199,6 +202,71 @@ void DTreesImpl::startTraining( const Ptr<TrainData>& data, int )
     }
     else
         data->getResponses().copyTo(w->ord_responses);
+
+    if( params.getHistogramBins() > 0 )
+        initHistogramBins();
+}
+
+class HistogramBinsInvoker : public ParallelLoopBody
+{
+public:
+    HistogramBinsInvoker(const DTreesImpl* _tree, int _nbins) : tree(_tree), nbins(_nbins) {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        DTreesImpl::WorkData* w = tree->w.get();
+        const vector<int>& sidx = w->sidx;
+        int i, n = (int)sidx.size();
+        vector<float> values(n), sorted, distinct;
+
+        for( int vi_ = range.start; vi_ < range.end; vi_++ )
+        {
+            int vi = tree->varIdx[vi_];
+            if( tree->varType[vi] == VAR_CATEGORICAL || n == 0 )
+                continue;
+            w->data->getValues(vi, sidx, &values[0]);
+            sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+
+            // bin b keeps the values from (bounds[b-1], bounds[b]], so the split "value <= bounds[b]"
+            // sends the bins 0..b to the left. The bounds are put between the distinct values,
+            // near the quantiles when there are more distinct values than bins.
+            vector<float>& bounds = w->binBounds[vi_];
+            bounds.clear();
+            distinct.resize(n);
+            distinct.resize(std::unique_copy(sorted.begin(), sorted.end(), distinct.begin()) - distinct.begin());
+            int ndistinct = (int)distinct.size();
+            for( int b = 1; b < std::min(ndistinct, nbins); b++ )
+            {
+                float v = ndistinct <= nbins ? distinct[b - 1] : sorted[(int)((int64)b*n/nbins) - 1];
+                vector<float>::const_iterator next = std::upper_bound(distinct.begin(), distinct.end(), v);
+                if( next == distinct.end() )
+                    break;
+                float c = (v + *next)*0.5f;
+                if( !(c < *next) )
+                    c = v;
+                if( bounds.empty() || bounds.back() < c )
+                    bounds.push_back(c);
+            }
+
+            uchar* bins = w->binIdx.ptr<uchar>(vi_);
+            for( i = 0; i < n; i++ )
+                bins[sidx[i]] = (uchar)(std::lower_bound(bounds.begin(), bounds.end(), values[i]) - bounds.begin());
+        }
+    }
+
+private:
+    const DTreesImpl* tree;
+    int nbins;
+};
+
+// quantizes the ordered variables once, see DTrees::setHistogramBins
+void DTreesImpl::initHistogramBins()
+{
+    int nvars = (int)varIdx.size();
+    w->binIdx.create(nvars, w->data->getNSamples(), CV_8U);
+    w->binBounds.assign(nvars, vector<float>());
+    parallel_for_(Range(0, nvars), HistogramBinsInvoker(this, params.getHistogramBins()));
 }
 
 
@@ -219,6 +287,7 @@ void DTreesImpl::initCompVarIdx()
 void DTreesImpl::endTraining()
 {
     w.release();
+    compileTrees();
 }
 
 bool DTreesImpl::train( const Ptr<TrainData>& trainData, int flags )
@@ -411,37 +480,76 @@ int DTreesImpl::addNodeAndTrySplit( int parent, const vector<int>& sidx )
     return nidx;
 }
 
+DTreesImpl::WSplit DTreesImpl::findSplit( int vi, const vector<int>& _sidx, int* subset )
+{
+    if( varType[vi] == VAR_CATEGORICAL )
+    {
+        if( _isClassifier )
+            return findSplitCatClass(vi, _sidx, 0, subset);
+        return findSplitCatReg(vi, _sidx, 0, subset);
+    }
+    if( !w->binIdx.empty() )
+    {
+        if( _isClassifier )
+            return findSplitHistClass(vi, _sidx, 0);
+        return findSplitHistReg(vi, _sidx, 0);
+    }
+    if( _isClassifier )
+        return findSplitOrdClass(vi, _sidx, 0);
+    return findSplitOrdReg(vi, _sidx, 0);
+}
+
+class FindSplitInvoker : public ParallelLoopBody
+{
+public:
+    FindSplitInvoker(DTreesImpl* _tree, const vector<int>& _activeVars, const vector<int>& _sidx,
+                     DTreesImpl::WSplit* _splits, int* _subsets) :
+        tree(_tree), activeVars(_activeVars), sidx(_sidx), splits(_splits), subsets(_subsets)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        int subsetSize = tree->w->maxSubsetSize;
+        for( int i = range.start; i < range.end; i++ )
+            splits[i] = tree->findSplit(activeVars[i], sidx, subsets + i*subsetSize);
+    }
+
+private:
+    FindSplitInvoker& operator=(const FindSplitInvoker&);
+
+    DTreesImpl* tree;
+    const vector<int>& activeVars;
+    const vector<int>& sidx;
+    DTreesImpl::WSplit* splits;
+    int* subsets;
+};
+
 int DTreesImpl::findBestSplit( const vector<int>& _sidx )
 {
     const vector<int>& activeVars = getActiveVars();
     int splitidx = -1;
     int vi_, nv = (int)activeVars.size();
-    AutoBuffer<int> buf(w->maxSubsetSize*2);
-    int *subset = buf.data(), *best_subset = subset + w->maxSubsetSize;
-    WSplit split, best_split;
+    AutoBuffer<WSplit> splitbuf(nv);
+    AutoBuffer<int> buf(w->maxSubsetSize*nv);
+    WSplit best_split;
     best_split.quality = 0.;
+    int* best_subset = 0;
+
+    // the variables are evaluated in parallel for the big nodes only,
+    // the best split is then selected in the order of the variables as before
+    FindSplitInvoker invoker(this, activeVars, _sidx, splitbuf.data(), buf.data());
+    if( nv > 1 && (int64)nv*(int64)_sidx.size() >= (1 << 14) )
+        parallel_for_(Range(0, nv), invoker);
+    else
+        invoker(Range(0, nv));
 
     for( vi_ = 0; vi_ < nv; vi_++ )
     {
-        int vi = activeVars[vi_];
-        if( varType[vi] == VAR_CATEGORICAL )
+        if( splitbuf[vi_].quality > best_split.quality )
         {
-            if( _isClassifier )
-                split = findSplitCatClass(vi, _sidx, 0, subset);
-            else
-                split = findSplitCatReg(vi, _sidx, 0, subset);
-        }
-        else
-        {
-            if( _isClassifier )
-                split = findSplitOrdClass(vi, _sidx, 0);
-            else
-                split = findSplitOrdReg(vi, _sidx, 0);
-        }
-        if( split.quality > best_split.quality )
-        {
-            best_split = split;
-            std::swap(subset, best_subset);
+            best_split = splitbuf[vi_];
+            best_subset = buf.data() + vi_*w->maxSubsetSize;
         }
     }
 
@@ -984,6 +1092,161 @@ DTreesImpl::WSplit DTreesImpl::findSplitCatClass( int vi, const vector<int>& _si
     return split;
 }
 
+DTreesImpl::WSplit DTreesImpl::findSplitHistClass( int vi, const vector<int>& _sidx, double initQuality )
+{
+    int vi_ = compVarIdx[vi];
+    const vector<float>& bounds = w->binBounds[vi_];
+    const uchar* bins = w->binIdx.ptr<uchar>(vi_);
+    int n = (int)_sidx.size();
+    int m = (int)classLabels.size();
+    int nbins = (int)bounds.size() + 1;
+
+    cv::AutoBuffer<double> buf(nbins*m + m*2);
+    cv::AutoBuffer<int> countbuf(nbins);
+    double* hist = buf.data();
+    double* lcw = hist + nbins*m;
+    double* rcw = lcw + m;
+    int* counts = countbuf.data();
+    const int* sidx = &_sidx[0];
+    const int* responses = &w->cat_responses[0];
+    const double* weights = &w->sample_weights[0];
+    int i, b, best_b = -1, last_b = -1;
+    double best_val = initQuality;
+
+    for( i = 0; i < nbins*m; i++ )
+        hist[i] = 0.;
+    for( i = 0; i < m; i++ )
+        lcw[i] = rcw[i] = 0.;
+    for( b = 0; b < nbins; b++ )
+        counts[b] = 0;
+
+    // a single pass over the samples instead of sorting them
+    for( i = 0; i < n; i++ )
+    {
+        int si = sidx[i];
+        b = bins[si];
+        hist[b*m + responses[si]] += weights[si];
+        rcw[responses[si]] += weights[si];
+        counts[b]++;
+    }
+
+    double L = 0, R = 0, lsum2 = 0, rsum2 = 0;
+    for( i = 0; i < m; i++ )
+    {
+        double wval = rcw[i];
+        R += wval;
+        rsum2 += wval*wval;
+    }
+    for( b = 0; b < nbins; b++ )
+        if( counts[b] > 0 )
+            last_b = b;
+
+    for( b = 0; b < last_b; b++ )
+    {
+        if( counts[b] == 0 )
+            continue;
+        const double* h = hist + b*m;
+        for( i = 0; i < m; i++ )
+        {
+            double wval = h[i];
+            if( wval == 0 )
+                continue;
+            double lv = lcw[i], rv = rcw[i];
+            L += wval; R -= wval;
+            lsum2 += 2*lv*wval + wval*wval;
+            rsum2 -= 2*rv*wval - wval*wval;
+            lcw[i] = lv + wval; rcw[i] = rv - wval;
+        }
+
+        if( L > 0 && R > 0 )
+        {
+            double val = (lsum2*R + rsum2*L)/(L*R);
+            if( best_val < val )
+            {
+                best_val = val;
+                best_b = b;
+            }
+        }
+    }
+
+    WSplit split;
+    if( best_b >= 0 )
+    {
+        split.varIdx = vi;
+        split.c = bounds[best_b];
+        split.inversed = false;
+        split.quality = (float)best_val;
+    }
+    return split;
+}
+
+DTreesImpl::WSplit DTreesImpl::findSplitHistReg( int vi, const vector<int>& _sidx, double initQuality )
+{
+    int vi_ = compVarIdx[vi];
+    const vector<float>& bounds = w->binBounds[vi_];
+    const uchar* bins = w->binIdx.ptr<uchar>(vi_);
+    int n = (int)_sidx.size();
+    int nbins = (int)bounds.size() + 1;
+
+    cv::AutoBuffer<double> buf(nbins*2);
+    cv::AutoBuffer<int> countbuf(nbins);
+    double* hist = buf.data();
+    int* counts = countbuf.data();
+    const double* weights = &w->sample_weights[0];
+    const double* responses = &w->ord_responses[0];
+    int i, b, best_b = -1, last_b = -1;
+    double L = 0, R = 0;
+    double best_val = initQuality, lsum = 0, rsum = 0;
+
+    for( i = 0; i < nbins*2; i++ )
+        hist[i] = 0.;
+    for( b = 0; b < nbins; b++ )
+        counts[b] = 0;
+
+    for( i = 0; i < n; i++ )
+    {
+        int si = _sidx[i];
+        b = bins[si];
+        double wval = weights[si];
+        hist[b*2] += wval;
+        hist[b*2+1] += wval*responses[si];
+        R += wval;
+        rsum += wval*responses[si];
+        counts[b]++;
+    }
+    for( b = 0; b < nbins; b++ )
+        if( counts[b] > 0 )
+            last_b = b;
+
+    for( b = 0; b < last_b; b++ )
+    {
+        if( counts[b] == 0 )
+            continue;
+        L += hist[b*2]; R -= hist[b*2];
+        lsum += hist[b*2+1]; rsum -= hist[b*2+1];
+
+        if( L > 0 && R > 0 )
+        {
+            double val = (lsum*lsum*R + rsum*rsum*L)/(L*R);
+            if( best_val < val )
+            {
+                best_val = val;
+                best_b = b;
+            }
+        }
+    }
+
+    WSplit split;
+    if( best_b >= 0 )
+    {
+        split.varIdx = vi;
+        split.c = bounds[best_b];
+        split.inversed = false;
+        split.quality = (float)best_val;
+    }
+    return split;
+}
+
 DTreesImpl::WSplit DTreesImpl::findSplitOrdReg( int vi, const vector<int>& _sidx, double initQuality )
 {
     const double* weights = &w->sample_weights[0];
@@ -1493,6 +1756,218 @@ float DTreesImpl::predictTrees( const Range& range, const Mat& sample, int flags
 }
 
 
+void DTreesImpl::CompiledTrees::clear()
+{
+    roots.clear();
+    var.clear();
+    col.clear();
+    thresh.clear();
+    defaultDir.clear();
+    child.clear();
+    leafValue.clear();
+    leafClassIdx.clear();
+}
+
+void DTreesImpl::compileTrees()
+{
+    compiled.clear();
+    size_t i, nsplits = 0;
+
+    for( i = 0; i < nodes.size(); i++ )
+    {
+        const Node& node = nodes[i];
+        if( node.split < 0 )
+            continue;
+        if( varType[splits[node.split].varIdx] != VAR_ORDERED )
+            return;
+        nsplits++;
+    }
+
+    compiled.var.reserve(nsplits);
+    compiled.col.reserve(nsplits);
+    compiled.thresh.reserve(nsplits);
+    compiled.defaultDir.reserve(nsplits);
+    compiled.child.reserve(nsplits*2);
+    compiled.leafValue.reserve(nodes.size() - nsplits);
+    compiled.leafClassIdx.reserve(nodes.size() - nsplits);
+
+    // every tree is laid out breadth-first, so the top levels shared by all the samples are compact
+    vector<int> queue, nodeMap(nodes.size());
+    for( size_t ti = 0; ti < roots.size(); ti++ )
+    {
+        queue.clear();
+        queue.push_back(roots[ti]);
+
+        for( i = 0; i < queue.size(); i++ )
+        {
+            const Node& node = nodes[queue[i]];
+            if( node.split < 0 )
+            {
+                nodeMap[queue[i]] = ~(int)compiled.leafValue.size();
+                compiled.leafValue.push_back(node.value);
+                compiled.leafClassIdx.push_back(node.classIdx);
+                continue;
+            }
+            int vi = splits[node.split].varIdx;
+            nodeMap[queue[i]] = (int)compiled.var.size();
+            compiled.var.push_back(vi);
+            compiled.col.push_back(!compVarIdx.empty() ? compVarIdx[vi] : vi);
+            compiled.thresh.push_back(splits[node.split].c);
+            compiled.defaultDir.push_back((schar)(node.defaultDir < 0 ? 0 : 1));
+            queue.push_back(node.left);
+            queue.push_back(node.right);
+        }
+
+        compiled.roots.push_back(nodeMap[roots[ti]]);
+        for( i = 0; i < queue.size(); i++ )
+        {
+            const Node& node = nodes[queue[i]];
+            if( node.split >= 0 )
+            {
+                compiled.child.push_back(nodeMap[node.left]);
+                compiled.child.push_back(nodeMap[node.right]);
+            }
+        }
+    }
+}
+
+class PredictTreesInvoker : public ParallelLoopBody
+{
+public:
+    enum { BLOCK_SIZE = 64 };
+
+    PredictTreesInvoker(const DTreesImpl* _tree, const Range& _trees, const Mat& _samples, float* _results, int _flags) :
+        tree(_tree), trees(_trees), samples(_samples), results(_results), flags(_flags)
+    {
+        predictType = flags & DTrees::PREDICT_MASK;
+        if( predictType == DTrees::PREDICT_AUTO )
+        {
+            predictType = !tree->_isClassifier || (tree->classLabels.size() == 2 && (flags & DTrees::RAW_OUTPUT) != 0) ?
+                DTrees::PREDICT_SUM : DTrees::PREDICT_MAX_VOTE;
+        }
+    }
+
+    // The samples are processed in blocks: every tree is run over all the samples of the block
+    // while its nodes are in cache. The split is chosen without branches, the only branch left
+    // in the inner loop is the missing value check.
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const DTreesImpl::CompiledTrees& ct = tree->compiled;
+        bool compressed = (flags & (StatModel::COMPRESSED_INPUT|StatModel::PREPROCESSED_INPUT)) != 0 || tree->varIdx.empty();
+        const int* cols = compressed ? ct.var.data() : ct.col.data();
+        const int* vars = ct.var.data();
+        const float* thresh = ct.thresh.data();
+        const schar* defaultDir = ct.defaultDir.data();
+        const int* child = ct.child.data();
+        const double* leafValue = ct.leafValue.data();
+        const int* leafClassIdx = ct.leafClassIdx.data();
+        const float* missingSubstPtr = !tree->missingSubst.empty() ? &tree->missingSubst[0] : 0;
+        const float MISSED_VAL = TrainData::missingValue();
+        int nsamples = samples.rows, nclasses = (int)tree->classLabels.size();
+        bool sumMode = predictType == DTrees::PREDICT_SUM;
+
+        const float* rows[BLOCK_SIZE];
+        double sums[BLOCK_SIZE];
+        int lastClassIdx[BLOCK_SIZE];
+        AutoBuffer<int> _votes(sumMode ? 1 : BLOCK_SIZE*nclasses);
+        int* votes = _votes.data();
+
+        for( int start = range.start*BLOCK_SIZE; start < std::min(range.end*BLOCK_SIZE, nsamples); start += BLOCK_SIZE )
+        {
+            int i, k, n = std::min((int)BLOCK_SIZE, nsamples - start);
+            for( k = 0; k < n; k++ )
+            {
+                rows[k] = samples.ptr<float>(start + k);
+                sums[k] = 0.;
+                lastClassIdx[k] = -1;
+            }
+            if( !sumMode )
+                for( i = 0; i < n*nclasses; i++ )
+                    votes[i] = 0;
+
+            for( int ti = trees.start; ti < trees.end; ti++ )
+            {
+                int root = ct.roots[ti];
+                for( k = 0; k < n; k++ )
+                {
+                    const float* psample = rows[k];
+                    int nidx = root;
+                    while( nidx >= 0 )
+                    {
+                        float val = psample[cols[nidx]];
+                        if( val == MISSED_VAL )
+                        {
+                            if( !missingSubstPtr )
+                            {
+                                nidx = child[nidx*2 + defaultDir[nidx]];
+                                continue;
+                            }
+                            val = missingSubstPtr[vars[nidx]];
+                        }
+                        nidx = child[nidx*2 + !(val <= thresh[nidx])];
+                    }
+
+                    if( sumMode )
+                        sums[k] += leafValue[~nidx];
+                    else
+                    {
+                        lastClassIdx[k] = leafClassIdx[~nidx];
+                        votes[k*nclasses + lastClassIdx[k]]++;
+                    }
+                }
+            }
+
+            for( k = 0; k < n; k++ )
+            {
+                double sum = sums[k];
+                if( !sumMode )
+                {
+                    int best_idx = lastClassIdx[k];
+                    if( trees.end - trees.start > 1 )
+                    {
+                        const int* v = votes + k*nclasses;
+                        best_idx = 0;
+                        for( i = 1; i < nclasses; i++ )
+                            if( v[best_idx] < v[i] )
+                                best_idx = i;
+                    }
+                    sum = (flags & DTrees::RAW_OUTPUT) ? (float)best_idx : tree->classLabels[best_idx];
+                }
+                results[start + k] = (float)sum;
+            }
+        }
+    }
+
+private:
+    PredictTreesInvoker& operator=(const PredictTreesInvoker&);
+
+    const DTreesImpl* tree;
+    Range trees;
+    const Mat& samples;
+    float* results;
+    int flags;
+    int predictType;
+};
+
+// Computes predictTrees() for every row of samples.
+// The compiled trees are run in parallel, the models with categorical splits fall back to predictTrees().
+void DTreesImpl::predictTreesBatch( const Range& range, const Mat& samples, float* results, int flags ) const
+{
+    CV_Assert( samples.type() == CV_32F );
+    int nsamples = samples.rows;
+
+    if( compiled.roots.empty() )
+    {
+        for( int i = 0; i < nsamples; i++ )
+            results[i] = DTreesImpl::predictTrees(range, samples.row(i), flags);
+        return;
+    }
+
+    CV_Assert( 0 <= range.start && range.end <= (int)compiled.roots.size() );
+    int nblocks = (nsamples + PredictTreesInvoker::BLOCK_SIZE - 1)/PredictTreesInvoker::BLOCK_SIZE;
+    parallel_for_(Range(0, nblocks), PredictTreesInvoker(this, range, samples, results, flags));
+}
+
 float DTreesImpl::predict( InputArray _samples, OutputArray _results, int flags ) const
 {
     CV_Assert( !roots.empty() );
@@ -1515,9 +1990,13 @@ float DTreesImpl::predict( InputArray _samples, OutputArray _results, int flags
     else
         nsamples = std::min(nsamples, 1);
 
+    AutoBuffer<float> buf(nsamples);
+    if( nsamples > 0 )
+        predictTreesBatch( Range(0, (int)roots.size()), samples.rowRange(0, nsamples), buf.data(), flags );
+
     for( i = 0; i < nsamples; i++ )
     {
-        float val = predictTrees( Range(0, (int)roots.size()), samples.row(i), flags )*scale;
+        float val = buf[i]*scale;
         if( needresults )
         {
             if( rtype == CV_32F )
@@ -1546,6 +2025,9 @@ void DTreesImpl::writeTrainingParams(FileStorage& fs) const
 
     if( !params.priors.empty() )
         fs << "priors" << params.priors;
+
+    if( params.getHistogramBins() > 0 )
+        fs << "histogram_bins" << params.getHistogramBins();
 }
 
 void DTreesImpl::writeParams(FileStorage& fs) const
@@ -1715,6 +2197,8 @@ void DTreesImpl::readParams( const FileNode& fn )
         }
 
         tparams_node["priors"] >> params0.priors;
+        if( !tparams_node["histogram_bins"].empty() )
+            params0.setHistogramBins((int)tparams_node["histogram_bins"]);
     }
 
     readVectorOrMat(fn["var_idx"], varIdx);
@@ -1936,6 +2420,7 @@ void DTreesImpl::read( const FileNode& fn )
     FileNode fnodes = fn["nodes"];
     CV_Assert( !fnodes.empty() );
     readTree(fnodes);
+    compileTrees();
 }
 
 Ptr<DTrees> DTrees::create()
@@ -343,6 +343,22 @@ void CV_KNearestTest::run( int /*start_from*/ )
         code = cvtest::TS::FAIL_BAD_ACCURACY;
     }
 
+    // KNearest HNSW implementation
+    Ptr<KNearest> knearestHnsw = KNearest::create();
+    knearestHnsw->setAlgorithmType(KNearest::HNSW);
+    knearestHnsw->train(trainData, ml::ROW_SAMPLE, trainLabels);
+    knearestHnsw->findNearest(testData, 4, bestLabels);
+    if( !calcErr( bestLabels, testLabels, sizes, err, true ) )
+    {
+        ts->printf( cvtest::TS::LOG, "Bad output labels.\n" );
+        code = cvtest::TS::FAIL_INVALID_OUTPUT;
+    }
+    else if( err > 0.01f )
+    {
+        ts->printf( cvtest::TS::LOG, "Bad accuracy (%f) on test data.\n", err );
+        code = cvtest::TS::FAIL_BAD_ACCURACY;
+    }
+
     ts->set_failed_test_info( code );
 }
 
@@ -698,6 +714,116 @@ protected:
 
 TEST(ML_KMeans, accuracy) { CV_KMeansTest test; test.safe_run(); }
 TEST(ML_KNearest, accuracy) { CV_KNearestTest test; test.safe_run(); }
+
+TEST(ML_KNearest, hnsw_recall)
+{
+    const int ntrain = 3000, ntest = 200, dims = 32, K = 10;
+    RNG& rng = theRNG();
+    Mat trainData(ntrain, dims, CV_32F), testData(ntest, dims, CV_32F);
+    rng.fill(trainData, RNG::UNIFORM, 0.f, 1.f);
+    rng.fill(testData, RNG::UNIFORM, 0.f, 1.f);
+    Mat responses(ntrain, 1, CV_32F);
+    for( int i = 0; i < ntrain; i++ )
+        responses.at<float>(i) = (float)i;
+
+    Ptr<KNearest> bf = KNearest::create();
+    bf->setIsClassifier(false);
+    bf->train(trainData, ml::ROW_SAMPLE, responses);
+    Mat bfIdx, bfDist;
+    bf->findNearest(testData, K, noArray(), bfIdx, bfDist);
+
+    Ptr<KNearest> hnsw = KNearest::create();
+    hnsw->setAlgorithmType(KNearest::HNSW);
+    hnsw->setIsClassifier(false);
+    hnsw->train(trainData, ml::ROW_SAMPLE, responses);
+
+    double recall[2];
+    int widths[] = { 10, 200 };
+    for( int w = 0; w < 2; w++ )
+    {
+        hnsw->setSearchWidth(widths[w]);
+        Mat idx, dist;
+        hnsw->findNearest(testData, K, noArray(), idx, dist);
+        ASSERT_EQ(bfIdx.size(), idx.size());
+
+        int found = 0;
+        for( int i = 0; i < ntest; i++ )
+        {
+            const float* d = dist.ptr<float>(i);
+            for( int j = 0; j < K; j++ )
+            {
+                if( j > 0 )
+                {
+                    EXPECT_LE(d[j-1], d[j]);
+                }
+                for( int l = 0; l < K; l++ )
+                    if( idx.at<float>(i, j) == bfIdx.at<float>(i, l) )
+                    {
+                        EXPECT_NEAR(bfDist.at<float>(i, l), d[j], 1e-4);
+                        found++;
+                        break;
+                    }
+            }
+        }
+        recall[w] = (double)found/(ntest*K);
+    }
+    EXPECT_GE(recall[1], 0.95);
+    EXPECT_GE(recall[1], recall[0]);
+}
+
+TEST(ML_KNearest, hnsw_update_and_save_load)
+{
+    const int ntrain = 1000, ntest = 100, dims = 8, K = 5;
+    RNG rng(12345);
+    Mat trainData(ntrain, dims, CV_32F), testData(ntest, dims, CV_32F), responses(ntrain, 1, CV_32F);
+    rng.fill(trainData, RNG::UNIFORM, 0.f, 1.f);
+    rng.fill(testData, RNG::UNIFORM, 0.f, 1.f);
+    rng.fill(responses, RNG::UNIFORM, 0, 4);
+
+    Ptr<KNearest> full = KNearest::create();
+    full->setAlgorithmType(KNearest::HNSW);
+    full->train(trainData, ml::ROW_SAMPLE, responses);
+
+    Ptr<KNearest> updated = KNearest::create();
+    updated->setAlgorithmType(KNearest::HNSW);
+    updated->train(trainData.rowRange(0, ntrain/2), ml::ROW_SAMPLE, responses.rowRange(0, ntrain/2));
+    updated->train(TrainData::create(trainData.rowRange(ntrain/2, ntrain), ml::ROW_SAMPLE,
+                                     responses.rowRange(ntrain/2, ntrain)), StatModel::UPDATE_MODEL);
+
+    Mat res1, idx1, dist1, res2, idx2, dist2;
+    full->findNearest(testData, K, res1, idx1, dist1);
+    updated->findNearest(testData, K, res2, idx2, dist2);
+    EXPECT_EQ(0, cvtest::norm(res1, res2, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(idx1, idx2, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(dist1, dist2, NORM_INF));
+
+    // without the results the first one is returned
+    EXPECT_EQ(res1.at<float>(0), updated->findNearest(testData, K, noArray(), idx2, dist2));
+    EXPECT_EQ(0, cvtest::norm(idx1, idx2, NORM_INF));
+
+    // the results don't depend on the number of threads
+    int nthreads = getNumThreads();
+    setNumThreads(1);
+    full->findNearest(testData, K, res2, idx2, dist2);
+    setNumThreads(nthreads);
+    EXPECT_EQ(0, cvtest::norm(res1, res2, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(dist1, dist2, NORM_INF));
+
+    String filename = cv::tempfile(".yml");
+    full->setSearchWidth(32);
+    full->save(filename);
+    Ptr<KNearest> loaded = Algorithm::load<KNearest>(filename);
+    remove(filename.c_str());
+    ASSERT_FALSE(loaded.empty());
+    EXPECT_EQ(KNearest::HNSW, loaded->getAlgorithmType());
+    EXPECT_EQ(32, loaded->getSearchWidth());
+    full->findNearest(testData, K, res1, idx1, dist1);
+    loaded->findNearest(testData, K, res2, idx2, dist2);
+    EXPECT_EQ(0, cvtest::norm(res1, res2, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(idx1, idx2, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(dist1, dist2, NORM_INF));
+}
+
 TEST(ML_EM, accuracy) { CV_EMTest test; test.safe_run(); }
 TEST(ML_EM, save_load) { CV_EMTest_SaveLoad test; test.safe_run(); }
 TEST(ML_EM, classification) { CV_EMTest_Classification test; test.safe_run(); }
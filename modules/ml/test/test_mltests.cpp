@@ -220,5 +220,178 @@ TEST(ML_RTrees, getVotes)
     EXPECT_EQ(result.at<float>(0, predicted_class), rt->predict(test));
 }
 
+// two noisy classes separated by x0 + x1 = 10, the other variables are noise
+static void makeTreesData(int n, bool integer_values, Mat& samples, Mat& responses)
+{
+    RNG rng(12345);
+    samples.create(n, 5, CV_32F);
+    responses.create(n, 1, CV_32S);
+    for (int i = 0; i < n; i++)
+    {
+        float* x = samples.ptr<float>(i);
+        for (int j = 0; j < samples.cols; j++)
+            x[j] = integer_values ? (float)rng.uniform(0, 10) : rng.uniform(0.f, 10.f);
+        responses.at<int>(i) = x[0] + x[1] > 10 ? 1 : 0;
+        if (rng.uniform(0, 20) == 0)
+            responses.at<int>(i) ^= 1;
+    }
+}
+
+TEST(ML_DTrees, histogram_bins)
+{
+    Mat samples, responses, exact_results, hist_results;
+    makeTreesData(2000, true, samples, responses);
+
+    Ptr<DTrees> exact = DTrees::create(), hist = DTrees::create();
+    exact->setMaxDepth(8);
+    exact->setCVFolds(0);
+    hist->setMaxDepth(8);
+    hist->setCVFolds(0);
+    EXPECT_EQ(0, hist->getHistogramBins());
+    EXPECT_THROW(hist->setHistogramBins(1), cv::Exception);
+    EXPECT_THROW(hist->setHistogramBins(257), cv::Exception);
+    hist->setHistogramBins(16);
+    EXPECT_EQ(16, hist->getHistogramBins());
+
+    // with less distinct values than bins the splits are exact
+    ASSERT_TRUE(exact->train(samples, ROW_SAMPLE, responses));
+    ASSERT_TRUE(hist->train(samples, ROW_SAMPLE, responses));
+    exact->predict(samples, exact_results);
+    hist->predict(samples, hist_results);
+    EXPECT_EQ(0, cvtest::norm(exact_results, hist_results, NORM_INF));
+    EXPECT_EQ(exact->getNodes().size(), hist->getNodes().size());
+
+    // quantized continuous values
+    makeTreesData(4000, false, samples, responses);
+    Ptr<TrainData> data = TrainData::create(samples, ROW_SAMPLE, responses);
+    data->setTrainTestSplitRatio(0.5, false);
+    hist->setHistogramBins(64);
+    ASSERT_TRUE(hist->train(data));
+    ASSERT_TRUE(exact->train(data));
+    EXPECT_LT(hist->calcError(data, true, noArray()), exact->calcError(data, true, noArray()) + 3);
+
+    // regression
+    Mat fresponses;
+    samples.col(0).convertTo(fresponses, CV_32F, 2, 1);
+    hist->setRegressionAccuracy(0.01f);
+    ASSERT_TRUE(hist->train(samples, ROW_SAMPLE, fresponses));
+    hist->predict(samples, hist_results);
+    EXPECT_LT(cvtest::norm(hist_results, fresponses, NORM_L1) / samples.rows, 0.5);
+}
+
+TEST(ML_RTrees, parallel_training)
+{
+    Mat samples, responses;
+    makeTreesData(3000, false, samples, responses);
+    Ptr<TrainData> data = TrainData::create(samples, ROW_SAMPLE, responses);
+    data->setTrainTestSplitRatio(0.5, false);
+
+    for (int bins = 0; bins <= 32; bins += 32)
+    {
+        SCOPED_TRACE(cv::format("bins=%d", bins));
+        Mat results[2];
+        int nodes[2] = { 0, 0 };
+        int nthreads = getNumThreads();
+        for (int k = 0; k < 2; k++)
+        {
+            // the forest doesn't depend on the number of threads
+            setNumThreads(k == 0 ? 1 : std::max(nthreads, 4));
+            Ptr<RTrees> rtrees = RTrees::create();
+            rtrees->setMaxDepth(10);
+            rtrees->setHistogramBins(bins);
+            rtrees->setCalculateVarImportance(true);
+            rtrees->setTermCriteria(TermCriteria(TermCriteria::COUNT, 20, 0));
+            ASSERT_TRUE(rtrees->train(data));
+            EXPECT_EQ(20, (int)rtrees->getRoots().size());
+            EXPECT_LT(rtrees->calcError(data, true, noArray()), 12);
+            rtrees->predict(samples, results[k]);
+            nodes[k] = (int)rtrees->getNodes().size();
+        }
+        setNumThreads(nthreads);
+        EXPECT_EQ(nodes[0], nodes[1]);
+        EXPECT_EQ(0, cvtest::norm(results[0], results[1], NORM_INF));
+    }
+}
+
+// walks the tree through the public node and split arrays (ordered variables only)
+static const DTrees::Node& findLeaf(const Ptr<DTrees>& model, int tree, const float* x)
+{
+    const std::vector<DTrees::Node>& nodes = model->getNodes();
+    const std::vector<DTrees::Split>& splits = model->getSplits();
+    int nidx = model->getRoots()[tree];
+    while (nodes[nidx].split >= 0)
+    {
+        const DTrees::Split& split = splits[nodes[nidx].split];
+        nidx = x[split.varIdx] <= split.c ? nodes[nidx].left : nodes[nidx].right;
+    }
+    return nodes[nidx];
+}
+
+TEST(ML_RTrees, compiled_prediction)
+{
+    Mat samples, responses, fresponses, results, row_result;
+    makeTreesData(1000, false, samples, responses);
+    samples.col(0).convertTo(fresponses, CV_32F, 2, 1);
+    int ntrees = 15;
+
+    // regression forest: the mean of the leaf values, one sample or a batch
+    Ptr<RTrees> rtrees = RTrees::create();
+    rtrees->setMaxDepth(8);
+    rtrees->setTermCriteria(TermCriteria(TermCriteria::COUNT, ntrees, 0));
+    ASSERT_TRUE(rtrees->train(samples, ROW_SAMPLE, fresponses));
+    ASSERT_EQ(ntrees, (int)rtrees->getRoots().size());
+    rtrees->predict(samples, results);
+    ASSERT_EQ(samples.rows, results.rows);
+    for (int i = 0; i < samples.rows; i++)
+    {
+        double sum = 0;
+        for (int t = 0; t < ntrees; t++)
+            sum += findLeaf(rtrees, t, samples.ptr<float>(i)).value;
+        ASSERT_EQ((float)sum*(1.f/ntrees), results.at<float>(i)) << "sample " << i;
+        ASSERT_EQ(results.at<float>(i), rtrees->predict(samples.row(i)));
+    }
+
+    // classification forest: the votes of the trees
+    ASSERT_TRUE(rtrees->train(samples, ROW_SAMPLE, responses));
+    Mat votes;
+    rtrees->getVotes(samples, votes, 0);
+    ASSERT_EQ(samples.rows + 1, votes.rows);
+    for (int i = 0; i < samples.rows; i++)
+    {
+        int counts[2] = { 0, 0 };
+        for (int t = 0; t < ntrees; t++)
+            counts[cvRound(findLeaf(rtrees, t, samples.ptr<float>(i)).value)]++;
+        ASSERT_EQ(counts[0], votes.at<int>(i + 1, 0)) << "sample " << i;
+        ASSERT_EQ(counts[1], votes.at<int>(i + 1, 1)) << "sample " << i;
+    }
+
+    // boosting: the raw sum of the leaf values, also after reloading the model
+    Ptr<Boost> boost = Boost::create();
+    boost->setBoostType(Boost::REAL);
+    boost->setWeakCount(ntrees);
+    boost->setMaxDepth(4);
+    ASSERT_TRUE(boost->train(samples, ROW_SAMPLE, responses));
+    boost->predict(samples, results, DTrees::PREDICT_SUM | StatModel::RAW_OUTPUT);
+    for (int i = 0; i < samples.rows; i++)
+    {
+        double sum = 0;
+        for (int t = 0; t < (int)boost->getRoots().size(); t++)
+            sum += findLeaf(boost, t, samples.ptr<float>(i)).value;
+        ASSERT_EQ((float)sum, results.at<float>(i)) << "sample " << i;
+    }
+
+    Mat labels, loaded_labels;
+    boost->predict(samples, labels);
+    FileStorage fs(".xml", FileStorage::WRITE + FileStorage::MEMORY);
+    boost->write(fs);
+    FileStorage fs_read(fs.releaseAndGetString(), FileStorage::READ + FileStorage::MEMORY);
+    Ptr<Boost> loaded = Algorithm::read<Boost>(fs_read.root());
+    loaded->predict(samples, loaded_labels);
+    EXPECT_EQ(0, cvtest::norm(labels, loaded_labels, NORM_INF));
+    Mat labels_i;
+    labels.convertTo(labels_i, CV_32S);
+    EXPECT_LT(cvtest::norm(labels_i, responses, NORM_L1), samples.rows * 0.15);
+}
+
 }} // namespace
 /* End of file. */
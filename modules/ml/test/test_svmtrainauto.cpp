@@ -167,4 +167,100 @@ void CV_SVMGetSupportVectorsTest::run(int /*startFrom*/ )
 
 TEST(ML_SVM, getSupportVectors) { CV_SVMGetSupportVectorsTest test; test.safe_run(); }
 
+static void makeBlobs(int n, int nclasses, Mat& samples, Mat& responses)
+{
+    RNG rng(42);
+    samples.create(n, 6, CV_32F);
+    responses.create(n, 1, CV_32S);
+    for (int i = 0; i < n; i++)
+    {
+        int label = rng.uniform(0, nclasses);
+        float* x = samples.ptr<float>(i);
+        for (int j = 0; j < samples.cols; j++)
+            x[j] = (float)rng.gaussian(1.0) + (j % nclasses == label ? 3.f : 0.f);
+        responses.at<int>(i) = label;
+    }
+}
+
+TEST(ML_SVM, parallel_training)
+{
+    Mat samples, responses;
+    makeBlobs(1200, 4, samples, responses);
+
+    Mat sv[2], results[2];
+    int nthreads = getNumThreads();
+    for (int k = 0; k < 2; k++)
+    {
+        // the one-vs-one classifiers don't depend on the order they are trained in, nor on the cache
+        setNumThreads(k == 0 ? 1 : std::max(nthreads, 4));
+        Ptr<SVM> svm = SVM::create();
+        svm->setGamma(0.2);
+        EXPECT_EQ(0, svm->getKernelCacheSize());
+        svm->setKernelCacheSize(k == 0 ? 0 : 1);
+        ASSERT_TRUE(svm->train(samples, ROW_SAMPLE, responses));
+        sv[k] = svm->getSupportVectors();
+        svm->predict(samples, results[k]);
+    }
+    setNumThreads(nthreads);
+    ASSERT_EQ(sv[0].size(), sv[1].size());
+    EXPECT_EQ(0, cvtest::norm(sv[0], sv[1], NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(results[0], results[1], NORM_INF));
+
+    Mat iresults;
+    results[0].convertTo(iresults, CV_32S);
+    EXPECT_LT(countNonZero(iresults != responses), samples.rows * 0.1);
+
+    Ptr<SVM> svm = SVM::create();
+    svm->setKernelCacheSize(-1);
+    EXPECT_THROW(svm->train(samples, ROW_SAMPLE, responses), cv::Exception);
+}
+
+typedef testing::TestWithParam<int> ML_SVM_Kernel;
+
+TEST_P(ML_SVM_Kernel, batch_predict)
+{
+    Mat samples, responses;
+    makeBlobs(500, 2, samples, responses);
+
+    Ptr<SVM> svm = SVM::create();
+    svm->setKernel(GetParam());
+    svm->setGamma(0.1);
+    svm->setDegree(2);
+    svm->setCoef0(0.5);
+    ASSERT_TRUE(svm->train(samples, ROW_SAMPLE, responses));
+
+    // the batch is evaluated through a matrix product, single samples are not
+    Mat batch;
+    svm->predict(samples, batch, StatModel::RAW_OUTPUT);
+    ASSERT_EQ(samples.rows, batch.rows);
+    for (int i = 0; i < samples.rows; i++)
+    {
+        float single = svm->predict(samples.row(i), noArray(), StatModel::RAW_OUTPUT);
+        ASSERT_NEAR(single, batch.at<float>(i), 1e-5 * std::max(1.f, std::abs(single))) << "sample " << i;
+    }
+}
+
+TEST(ML_SVM, batch_predict_far_from_origin)
+{
+    Mat samples, responses;
+    makeBlobs(300, 2, samples, responses);
+    // the norms are large compared to the distances here
+    samples += Scalar::all(1000);
+
+    Ptr<SVM> svm = SVM::create();
+    svm->setGamma(0.1);
+    ASSERT_TRUE(svm->train(samples, ROW_SAMPLE, responses));
+
+    Mat batch;
+    svm->predict(samples, batch, StatModel::RAW_OUTPUT);
+    for (int i = 0; i < samples.rows; i++)
+    {
+        float single = svm->predict(samples.row(i), noArray(), StatModel::RAW_OUTPUT);
+        ASSERT_NEAR(single, batch.at<float>(i), 1e-5 * std::max(1.f, std::abs(single))) << "sample " << i;
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, ML_SVM_Kernel, testing::Values(
+    (int)SVM::LINEAR, (int)SVM::POLY, (int)SVM::SIGMOID, (int)SVM::RBF));
+
 }} // namespace
@@ -144,6 +144,7 @@ enum VideoCaptureProperties {
        CAP_PROP_GAIN          =14, //!< Gain of the image (only for those cameras that support).
        CAP_PROP_EXPOSURE      =15, //!< Exposure (only for those cameras that support).
        CAP_PROP_CONVERT_RGB   =16, //!< Boolean flags indicating whether images should be converted to RGB.
+                                    //!< FFmpeg: when 0, frames are returned as single-channel 'I420', 'NV12' or 'GREY' images without color conversion (YUV in the limited range).
        CAP_PROP_WHITE_BALANCE_BLUE_U =17, //!< Currently unsupported.
        CAP_PROP_RECTIFICATION =18, //!< Rectification flag for stereo cameras (note: only supported by DC1394 v 2.x backend currently).
        CAP_PROP_MONOCHROME    =19,
@@ -168,6 +169,12 @@ enum VideoCaptureProperties {
        CAP_PROP_AUTOFOCUS     =39,
        CAP_PROP_SAR_NUM       =40, //!< Sample aspect ratio: num/den (num)
        CAP_PROP_SAR_DEN       =41, //!< Sample aspect ratio: num/den (den)
+       CAP_PROP_N_THREADS     =42, //!< (FFmpeg, MJPEG) Number of threads used for decoding and color conversion. 0 selects the number of CPUs. The built-in MJPEG decoder decodes this many frames at once.
+       CAP_PROP_FRAME_FOURCC  =43, //!< (read-only) FourCC of the pixel layout returned by VideoCapture::retrieve(), see CAP_PROP_CONVERT_RGB.
+       CAP_PROP_ASYNC_BUFFER_SIZE    =44, //!< Number of frames grabbed and decoded ahead on a background thread. 0 (default) disables prefetching. Works with all backends.
+       CAP_PROP_ASYNC_LATEST_ONLY    =45, //!< Prefetching policy for live streams: the oldest queued frame is overwritten instead of waiting, and grab() skips to the newest frame.
+       CAP_PROP_ASYNC_QUEUE_DEPTH    =46, //!< (read-only) Number of prefetched frames waiting to be grabbed.
+       CAP_PROP_ASYNC_DROPPED_FRAMES =47, //!< (read-only) Number of prefetched frames discarded by the CAP_PROP_ASYNC_LATEST_ONLY policy.
 #ifndef CV_DOXYGEN
        CV__CAP_PROP_LATEST
 #endif
@@ -190,7 +197,8 @@ enum VideoCaptureModes {
 enum VideoWriterProperties {
   VIDEOWRITER_PROP_QUALITY = 1,    //!< Current quality (0..100%) of the encoded videostream. Can be adjusted dynamically in some codecs.
   VIDEOWRITER_PROP_FRAMEBYTES = 2, //!< (Read-only): Size of just encoded video frame. Note that the encoding order may be different from representation order.
-  VIDEOWRITER_PROP_NSTRIPES = 3    //!< Number of stripes for parallel encoding. -1 for auto detection.
+  VIDEOWRITER_PROP_NSTRIPES = 3,   //!< Number of stripes for parallel encoding. -1 for auto detection.
+  VIDEOWRITER_PROP_PARALLEL_FRAMES = 4 //!< (MJPEG) Number of frames encoded concurrently, 0 selects the number of threads. The frames are buffered and written in order, when enough of them are collected or on release(). 1 by default.
 };
 
 //! @} videoio_flags_base
@@ -593,6 +601,11 @@ The class provides C++ API for capturing video from cameras or for reading video
 Here is how the class can be used:
 @include samples/cpp/videocapture_basic.cpp
 
+Grabbing and decoding can be moved to a background thread by setting #CAP_PROP_ASYNC_BUFFER_SIZE
+to the number of frames to prefetch. grab() then takes the next frame from the queue, while
+#CAP_PROP_ASYNC_LATEST_ONLY lets live streams skip frames that the processing could not keep up with.
+Only channel 0 can be retrieved in this mode.
+
 @note In @ref videoio_c "C API" the black-box structure `CvCapture` is used instead of %VideoCapture.
 @note
 -   (C++) A basic sample on using the %VideoCapture interface can be found at
@@ -766,6 +779,20 @@ public:
      */
     CV_WRAP virtual bool read(OutputArray image);
 
+    /** @brief Reads a set of video frames by their indices.
+
+    @param indices 0-based indices of the frames (CAP_PROP_POS_FRAMES numbering), in any order,
+    repeated indices are allowed.
+    @param [out] frames the frames, frames[i] corresponds to indices[i].
+    @return `false` if some of the frames could not be read, they are left empty.
+
+    The frames are read in the ascending order of indices, so the stream is only repositioned
+    (see CAP_PROP_POS_FRAMES) when the next requested frame doesn't follow the previous one.
+    Backends with the keyframe index (FFmpeg) start decoding from the nearest preceding keyframe.
+    The position of the stream after the call is undefined.
+     */
+    CV_WRAP bool readFrames(const std::vector<int>& indices, CV_OUT std::vector<Mat>& frames);
+
     /** @brief Sets a property in the VideoCapture.
 
     @param propId Property identifier from cv::VideoCaptureProperties (eg. cv::CAP_PROP_POS_MSEC, cv::CAP_PROP_POS_FRAMES, ...)
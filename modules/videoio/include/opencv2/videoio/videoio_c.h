@@ -207,6 +207,12 @@ enum
     CV_CAP_PROP_AUTOFOCUS     =39,
     CV_CAP_PROP_SAR_NUM       =40,
     CV_CAP_PROP_SAR_DEN       =41,
+    CV_CAP_PROP_N_THREADS     =42,
+    CV_CAP_PROP_FRAME_FOURCC  =43,
+    CV_CAP_PROP_ASYNC_BUFFER_SIZE    =44,
+    CV_CAP_PROP_ASYNC_LATEST_ONLY    =45,
+    CV_CAP_PROP_ASYNC_QUEUE_DEPTH    =46,
+    CV_CAP_PROP_ASYNC_DROPPED_FRAMES =47,
 
     CV_CAP_PROP_AUTOGRAB      =1024, // property for videoio class CvCapture_Android only
     CV_CAP_PROP_SUPPORTED_PREVIEW_SIZES_STRING=1025, // readonly, tricky property, returns cpnst char* indeed
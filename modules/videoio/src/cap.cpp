@@ -51,6 +51,40 @@ template<> void DefaultDeleter<CvCapture>::operator ()(CvCapture* obj) const
 template<> void DefaultDeleter<CvVideoWriter>::operator ()(CvVideoWriter* obj) const
 { cvReleaseVideoWriter(&obj); }
 
+namespace {
+
+// Exposes a capture of the C API through IVideoCapture
+class LegacyCapture CV_FINAL : public IVideoCapture
+{
+public:
+    LegacyCapture(const Ptr<CvCapture>& _cap) : cap(_cap) {}
+
+    virtual double getProperty(int propId) const CV_OVERRIDE { return cap->getProperty(propId); }
+    virtual bool setProperty(int propId, double value) CV_OVERRIDE { return cvSetCaptureProperty(cap, propId, value) != 0; }
+    virtual bool grabFrame() CV_OVERRIDE { return cvGrabFrame(cap) != 0; }
+    virtual bool retrieveFrame(int channel, OutputArray image) CV_OVERRIDE
+    {
+        IplImage* _img = cvRetrieveFrame(cap, channel);
+        if( !_img )
+        {
+            image.release();
+            return false;
+        }
+        if(_img->origin == IPL_ORIGIN_TL)
+            cv::cvarrToMat(_img).copyTo(image);
+        else
+            flip(cv::cvarrToMat(_img), image, 0);
+        return true;
+    }
+    virtual bool isOpened() const CV_OVERRIDE { return true; }
+    virtual int getCaptureDomain() CV_OVERRIDE { return cap->getCaptureDomain(); }
+
+protected:
+    Ptr<CvCapture> cap;
+};
+
+} // namespace
+
 
 
 VideoCapture::VideoCapture()
@@ -222,6 +256,52 @@ bool VideoCapture::read(OutputArray image)
     return !image.empty();
 }
 
+bool VideoCapture::readFrames(const std::vector<int>& indices, std::vector<Mat>& frames)
+{
+    CV_INSTRUMENT_REGION()
+
+    size_t n = indices.size();
+    frames.assign(n, Mat());
+    if (n == 0)
+        return true;
+
+    std::vector<std::pair<int, int> > order(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        CV_Assert(indices[i] >= 0);
+        order[i] = std::make_pair(indices[i], (int)i);
+    }
+    std::sort(order.begin(), order.end());
+
+    bool ok = true;
+    int next = cvRound(get(CAP_PROP_POS_FRAMES));
+    for (size_t i = 0; i < n; i++)
+    {
+        int index = order[i].first;
+        Mat& frame = frames[order[i].second];
+        if (i > 0 && index == order[i - 1].first)
+        {
+            // repeated frames don't share data
+            frames[order[i - 1].second].copyTo(frame);
+            continue;
+        }
+        if (index != next && !set(CAP_PROP_POS_FRAMES, index))
+        {
+            ok = false;
+            next = -1;
+            continue;
+        }
+        if (!read(frame))
+        {
+            ok = false;
+            next = -1;
+            continue;
+        }
+        next = index + 1;
+    }
+    return ok;
+}
+
 VideoCapture& VideoCapture::operator >> (Mat& image)
 {
 #ifdef WINRT_VIDEO
@@ -260,6 +340,16 @@ VideoCapture& VideoCapture::operator >> (UMat& image)
 
 bool VideoCapture::set(int propId, double value)
 {
+    if (propId == CAP_PROP_ASYNC_BUFFER_SIZE && value > 0 && isOpened())
+    {
+        if (!cap.empty())
+        {
+            icap = makePtr<LegacyCapture>(cap);
+            cap.release();
+        }
+        icap = createAsyncCapture(icap, cvRound(value));
+        return true;
+    }
     if (!icap.empty())
         return icap->setProperty(propId, value);
     return cvSetCaptureProperty(cap, propId, value) != 0;
@@ -0,0 +1,300 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace cv {
+
+namespace {
+
+/*
+   Runs grab() + retrieve() of the wrapped capture on a background thread.
+
+   Decoded frames are kept in a ring of bufferSize + 1 slots: the slot handed out to
+   the caller by the last grab(), the slot being decoded and the queued ones.
+   The matrices of the slots are reused, so after the first frames no allocations happen.
+   All calls to the wrapped capture are serialized with captureMutex.
+*/
+class AsyncCapture CV_FINAL : public IVideoCapture
+{
+public:
+    AsyncCapture(const Ptr<IVideoCapture>& _capture)
+        : capture(_capture), bufferSize(0), latestOnly(false), dropped(0), current(-1),
+          stopping(false), finished(false), posFrames(0), posMsec(0)
+    {}
+
+    virtual ~AsyncCapture() { stop(); }
+
+    virtual double getProperty(int propId) const CV_OVERRIDE
+    {
+        switch (propId)
+        {
+        case CAP_PROP_ASYNC_BUFFER_SIZE:
+            return bufferSize;
+        case CAP_PROP_ASYNC_LATEST_ONLY:
+            return latestOnly ? 1 : 0;
+        case CAP_PROP_ASYNC_QUEUE_DEPTH:
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return (double)ready.size();
+        }
+        case CAP_PROP_ASYNC_DROPPED_FRAMES:
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return (double)dropped;
+        }
+        case CAP_PROP_POS_FRAMES:
+        case CAP_PROP_POS_MSEC:
+            // the wrapped capture is ahead by the prefetched frames
+            if (bufferSize > 0)
+                return propId == CAP_PROP_POS_FRAMES ? posFrames : posMsec;
+            break;
+        default:
+            break;
+        }
+        std::lock_guard<std::mutex> lock(captureMutex);
+        return capture->getProperty(propId);
+    }
+
+    virtual bool setProperty(int propId, double value) CV_OVERRIDE
+    {
+        switch (propId)
+        {
+        case CAP_PROP_ASYNC_BUFFER_SIZE:
+        {
+            int size = cvRound(value);
+            if (size < 0)
+                return false;
+            stop();
+            bufferSize = size;
+            if (bufferSize > 0)
+                start();
+            return true;
+        }
+        case CAP_PROP_ASYNC_LATEST_ONLY:
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            latestOnly = value != 0;
+            slotFree.notify_all();
+            return true;
+        }
+        case CAP_PROP_ASYNC_QUEUE_DEPTH:
+        case CAP_PROP_ASYNC_DROPPED_FRAMES:
+            return false;
+        case CAP_PROP_POS_FRAMES:
+        case CAP_PROP_POS_MSEC:
+        case CAP_PROP_POS_AVI_RATIO:
+        {
+            // prefetched frames are invalidated by seeking
+            bool async = bufferSize > 0;
+            stop();
+            bool ok;
+            {
+                std::lock_guard<std::mutex> lock(captureMutex);
+                ok = capture->setProperty(propId, value);
+            }
+            if (async)
+                start();
+            return ok;
+        }
+        default:
+            break;
+        }
+        std::lock_guard<std::mutex> lock(captureMutex);
+        return capture->setProperty(propId, value);
+    }
+
+    virtual bool grabFrame() CV_OVERRIDE
+    {
+        if (bufferSize == 0)
+        {
+            std::lock_guard<std::mutex> lock(captureMutex);
+            return capture->grabFrame();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        releaseCurrent();
+        while (ready.empty() && !finished)
+            frameReady.wait(lock);
+        if (ready.empty())
+            return false;
+        if (latestOnly)
+        {
+            for (; ready.size() > 1; dropped++)
+            {
+                freeSlots.push_back(ready.front());
+                ready.pop_front();
+            }
+            slotFree.notify_one();
+        }
+        current = ready.front();
+        ready.pop_front();
+        posFrames = slots[current].posFrames;
+        posMsec = slots[current].posMsec;
+        return true;
+    }
+
+    virtual bool retrieveFrame(int channel, OutputArray image) CV_OVERRIDE
+    {
+        if (bufferSize == 0)
+        {
+            std::lock_guard<std::mutex> lock(captureMutex);
+            return capture->retrieveFrame(channel, image);
+        }
+
+        // the current slot is not touched by the background thread until the next grab()
+        if (current < 0 || channel != 0)
+            return false;
+        slots[current].frame.copyTo(image);
+        return true;
+    }
+
+    virtual bool isOpened() const CV_OVERRIDE
+    {
+        std::lock_guard<std::mutex> lock(captureMutex);
+        return capture->isOpened();
+    }
+
+    virtual int getCaptureDomain() CV_OVERRIDE
+    {
+        std::lock_guard<std::mutex> lock(captureMutex);
+        return capture->getCaptureDomain();
+    }
+
+protected:
+    struct Slot
+    {
+        Mat frame;
+        double posFrames, posMsec;
+    };
+
+    void start()
+    {
+        CV_Assert(!thread.joinable() && bufferSize > 0);
+        slots.resize(bufferSize + 1);
+        freeSlots.clear();
+        for (int i = 0; i <= bufferSize; i++)
+            freeSlots.push_back(i);
+        ready.clear();
+        current = -1;
+        stopping = finished = false;
+        {
+            std::lock_guard<std::mutex> lock(captureMutex);
+            posFrames = capture->getProperty(CAP_PROP_POS_FRAMES);
+            posMsec = capture->getProperty(CAP_PROP_POS_MSEC);
+        }
+        thread = std::thread(&AsyncCapture::run, this);
+    }
+
+    void stop()
+    {
+        if (!thread.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            slotFree.notify_all();
+        }
+        thread.join();
+        ready.clear();
+        current = -1;
+    }
+
+    void releaseCurrent()
+    {
+        if (current >= 0)
+        {
+            freeSlots.push_back(current);
+            current = -1;
+            slotFree.notify_one();
+        }
+    }
+
+    void run()
+    {
+        for (;;)
+        {
+            int slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!stopping && freeSlots.empty() && !latestOnly)
+                    slotFree.wait(lock);
+                if (stopping)
+                    break;
+                if (freeSlots.empty())
+                {
+                    // latest-only policy: overwrite the oldest queued frame
+                    slot = ready.front();
+                    ready.pop_front();
+                    dropped++;
+                }
+                else
+                {
+                    slot = freeSlots.back();
+                    freeSlots.pop_back();
+                }
+            }
+
+            Slot& s = slots[slot];
+            bool ok;
+            {
+                std::lock_guard<std::mutex> lock(captureMutex);
+                ok = capture->grabFrame() && capture->retrieveFrame(0, s.frame);
+                if (ok)
+                {
+                    s.posFrames = capture->getProperty(CAP_PROP_POS_FRAMES);
+                    s.posMsec = capture->getProperty(CAP_PROP_POS_MSEC);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ok)
+            {
+                freeSlots.push_back(slot);
+                finished = true;
+                frameReady.notify_all();
+                break;
+            }
+            ready.push_back(slot);
+            frameReady.notify_one();
+        }
+    }
+
+    Ptr<IVideoCapture> capture;
+    mutable std::mutex captureMutex;
+
+    int bufferSize;
+    bool latestOnly;
+    int64 dropped;
+
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    std::deque<int> ready;
+    int current;
+    bool stopping, finished;
+    double posFrames, posMsec;
+
+    mutable std::mutex mutex;
+    std::condition_variable frameReady, slotFree;
+    std::thread thread;
+};
+
+} // namespace
+
+Ptr<IVideoCapture> createAsyncCapture(const Ptr<IVideoCapture>& capture, int bufferSize)
+{
+    CV_Assert(capture);
+    Ptr<IVideoCapture> async = capture;
+    if (!dynamic_cast<AsyncCapture*>(capture.get()))
+        async = makePtr<AsyncCapture>(capture);
+    async->setProperty(CAP_PROP_ASYNC_BUFFER_SIZE, bufferSize);
+    return async;
+}
+
+} // namespace cv
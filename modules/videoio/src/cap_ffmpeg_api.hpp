@@ -24,8 +24,11 @@ enum
     CV_FFMPEG_CAP_PROP_FPS=5,
     CV_FFMPEG_CAP_PROP_FOURCC=6,
     CV_FFMPEG_CAP_PROP_FRAME_COUNT=7,
+    CV_FFMPEG_CAP_PROP_CONVERT_RGB=16,
     CV_FFMPEG_CAP_PROP_SAR_NUM=40,
-    CV_FFMPEG_CAP_PROP_SAR_DEN=41
+    CV_FFMPEG_CAP_PROP_SAR_DEN=41,
+    CV_FFMPEG_CAP_PROP_N_THREADS=42,
+    CV_FFMPEG_CAP_PROP_FRAME_FOURCC=43
 };
 
 typedef struct CvCapture_FFMPEG CvCapture_FFMPEG;
@@ -45,8 +45,10 @@
 # include <pthread.h>
 #endif
 #include <assert.h>
+#include <sys/stat.h>
 #include <algorithm>
 #include <limits>
+#include <string>
 
 #define CALC_FFMPEG_VERSION(a,b,c) ( a<<16 | b<<8 | c )
 
@@ -75,6 +77,11 @@ extern "C" {
 #include <libavutil/imgutils.h>
 #endif
 
+#if LIBAVUTIL_BUILD >= (LIBAVUTIL_VERSION_MICRO >= 100 \
+    ? CALC_FFMPEG_VERSION(52, 38, 100) : CALC_FFMPEG_VERSION(52, 13, 0))
+#include <libavutil/pixdesc.h>
+#endif
+
 #include <libavcodec/avcodec.h>
 #include <libswscale/swscale.h>
 
@@ -147,6 +154,8 @@ extern "C" {
 #define AV_PIX_FMT_YUVJ420P PIX_FMT_YUVJ420P
 #define AV_PIX_FMT_GRAY16LE PIX_FMT_GRAY16LE
 #define AV_PIX_FMT_GRAY16BE PIX_FMT_GRAY16BE
+#define AV_PIX_FMT_NV12 PIX_FMT_NV12
+#define AV_PIX_FMT_NONE PIX_FMT_NONE
 #endif
 
 #ifndef PKT_FLAG_KEY
@@ -164,6 +173,17 @@ extern "C" {
 #endif
 
 
+// color conversion of horizontal bands on several threads needs the pixel format descriptors
+// and the OpenCV thread pool (not available to the standalone FFmpeg wrapper library)
+#ifndef USE_SWS_SLICE_THREADS
+#if LIBAVUTIL_BUILD >= (LIBAVUTIL_VERSION_MICRO >= 100 \
+    ? CALC_FFMPEG_VERSION(52, 38, 100) : CALC_FFMPEG_VERSION(52, 13, 0)) && defined __OPENCV_BUILD
+#define USE_SWS_SLICE_THREADS 1
+#else
+#define USE_SWS_SLICE_THREADS 0
+#endif
+#endif
+
 #ifndef USE_AV_INTERRUPT_CALLBACK
 #if LIBAVFORMAT_BUILD >= CALC_FFMPEG_VERSION(53, 21, 0)
 #define USE_AV_INTERRUPT_CALLBACK 1
@@ -328,6 +348,225 @@ static int get_number_of_cpus(void)
 }
 
 
+static int get_thread_count(int requested)
+{
+    return requested > 0 ? requested : get_number_of_cpus();
+}
+
+
+/*
+   Color conversion of a whole frame is split into horizontal bands,
+   each band is converted by its own SwsContext on the OpenCV thread pool.
+   Band borders are aligned to the vertical chroma subsampling of both formats,
+   so every band starts on a full chroma row.
+*/
+#define CV_FFMPEG_MAX_SLICES 16
+#define CV_FFMPEG_MIN_SLICE_ROWS 64
+
+#if USE_SWS_SLICE_THREADS
+#ifndef AV_PIX_FMT_FLAG_PAL
+#define AV_PIX_FMT_FLAG_PAL       PIX_FMT_PAL
+#define AV_PIX_FMT_FLAG_HWACCEL   PIX_FMT_HWACCEL
+#define AV_PIX_FMT_FLAG_BITSTREAM PIX_FMT_BITSTREAM
+#endif
+
+struct SwsSliceJob_FFMPEG
+{
+    struct SwsContext* ctx;
+    uint8_t* src[4];
+    int src_step[4];
+    uint8_t* dst[4];
+    int dst_step[4];
+    int rows;
+};
+
+class SwsSliceInvoker_FFMPEG : public cv::ParallelLoopBody
+{
+public:
+    SwsSliceInvoker_FFMPEG(const SwsSliceJob_FFMPEG* jobs) : jobs_(jobs) {}
+
+    void operator()(const cv::Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            const SwsSliceJob_FFMPEG& job = jobs_[i];
+            sws_scale(job.ctx, job.src, job.src_step, 0, job.rows, job.dst, job.dst_step);
+        }
+    }
+
+private:
+    const SwsSliceJob_FFMPEG* jobs_;
+};
+
+static bool is_sliceable_pix_fmt(AVPixelFormat fmt)
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(fmt);
+    if (!desc)
+        return false;
+    uint64_t unsupported = AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM;
+#if defined AV_PIX_FMT_FLAG_PSEUDOPAL
+    unsupported |= AV_PIX_FMT_FLAG_PSEUDOPAL;
+#elif defined PIX_FMT_PSEUDOPAL
+    unsupported |= PIX_FMT_PSEUDOPAL;
+#endif
+    return (desc->flags & unsupported) == 0;
+}
+
+// moves the plane pointers of a frame down to row 'y' of the luma plane
+static void offset_planes(AVPixelFormat fmt, uint8_t* const data[], const int step[], int y, uint8_t* dst[])
+{
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(fmt);
+    for (int p = 0; p < 4; p++)
+    {
+        int shift = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+        dst[p] = data[p] ? data[p] + (ptrdiff_t)(y >> shift) * step[p] : 0;
+    }
+}
+
+static void run_sws_slice_jobs(const SwsSliceJob_FFMPEG* jobs, int count)
+{
+    cv::parallel_for_(cv::Range(0, count), SwsSliceInvoker_FFMPEG(jobs), count);
+}
+#endif // USE_SWS_SLICE_THREADS
+
+// The structure is allocated with malloc() together with CvCapture_FFMPEG, so it has no constructor
+struct SwsScaler_FFMPEG
+{
+    void init();
+    void release();
+    bool prepare(int width, int height, AVPixelFormat src_fmt, AVPixelFormat dst_fmt, int threads);
+    void scale(uint8_t* const src[], const int src_step[], uint8_t* const dst[], const int dst_step[]);
+
+    struct SwsContext* ctx[CV_FFMPEG_MAX_SLICES];
+    int slice_y[CV_FFMPEG_MAX_SLICES + 1];
+    int count;
+    int width, height, threads;
+    AVPixelFormat src_fmt, dst_fmt;
+};
+
+void SwsScaler_FFMPEG::init()
+{
+    memset(ctx, 0, sizeof(ctx));
+    memset(slice_y, 0, sizeof(slice_y));
+    count = 0;
+    width = height = threads = 0;
+    src_fmt = dst_fmt = AV_PIX_FMT_NONE;
+}
+
+void SwsScaler_FFMPEG::release()
+{
+    for (int i = 0; i < CV_FFMPEG_MAX_SLICES; i++)
+    {
+        if (ctx[i])
+            sws_freeContext(ctx[i]);
+    }
+    init();
+}
+
+bool SwsScaler_FFMPEG::prepare(int _width, int _height, AVPixelFormat _src_fmt, AVPixelFormat _dst_fmt, int _threads)
+{
+    if (count > 0 && width == _width && height == _height &&
+        src_fmt == _src_fmt && dst_fmt == _dst_fmt && threads == _threads)
+        return true;
+
+    int slices = 1, align = 1;
+#if USE_SWS_SLICE_THREADS
+    if (is_sliceable_pix_fmt(_src_fmt) && is_sliceable_pix_fmt(_dst_fmt))
+    {
+        slices = std::min(std::min(_threads, (int)CV_FFMPEG_MAX_SLICES), _height / CV_FFMPEG_MIN_SLICE_ROWS);
+        align = 1 << std::max(av_pix_fmt_desc_get(_src_fmt)->log2_chroma_h,
+                              av_pix_fmt_desc_get(_dst_fmt)->log2_chroma_h);
+    }
+#endif
+    slices = std::max(slices, 1);
+    int slice_rows = ((_height + slices - 1) / slices + align - 1) & -align;
+    slices = (_height + slice_rows - 1) / slice_rows;
+
+    for (int i = 0; i < slices; i++)
+    {
+        slice_y[i] = i * slice_rows;
+        slice_y[i + 1] = std::min((i + 1) * slice_rows, _height);
+        ctx[i] = sws_getCachedContext(
+                ctx[i],
+                _width, slice_y[i + 1] - slice_y[i], _src_fmt,
+                _width, slice_y[i + 1] - slice_y[i], _dst_fmt,
+                SWS_BICUBIC,
+                NULL, NULL, NULL
+                );
+        if (!ctx[i])
+        {
+            release();
+            return false;
+        }
+    }
+    for (int i = slices; i < CV_FFMPEG_MAX_SLICES; i++)
+    {
+        if (ctx[i])
+        {
+            sws_freeContext(ctx[i]);
+            ctx[i] = 0;
+        }
+    }
+
+    count = slices;
+    width = _width;
+    height = _height;
+    threads = _threads;
+    src_fmt = _src_fmt;
+    dst_fmt = _dst_fmt;
+    return true;
+}
+
+void SwsScaler_FFMPEG::scale(uint8_t* const src[], const int src_step[], uint8_t* const dst[], const int dst_step[])
+{
+    if (count == 1)
+    {
+        sws_scale(ctx[0], src, src_step, 0, height, dst, dst_step);
+        return;
+    }
+#if USE_SWS_SLICE_THREADS
+    SwsSliceJob_FFMPEG jobs[CV_FFMPEG_MAX_SLICES];
+    for (int i = 0; i < count; i++)
+    {
+        SwsSliceJob_FFMPEG& job = jobs[i];
+        job.ctx = ctx[i];
+        job.rows = slice_y[i + 1] - slice_y[i];
+        offset_planes(src_fmt, src, src_step, slice_y[i], job.src);
+        offset_planes(dst_fmt, dst, dst_step, slice_y[i], job.dst);
+        memcpy(job.src_step, src_step, sizeof(job.src_step));
+        memcpy(job.dst_step, dst_step, sizeof(job.dst_step));
+    }
+    run_sws_slice_jobs(jobs, count);
+#endif
+}
+
+
+// A keyframe of the video stream, 'frame' uses the numbering of CAP_PROP_POS_FRAMES
+struct KeyFrame_FFMPEG
+{
+    int64_t frame;
+    int64_t pts;
+    int64_t dts;
+};
+
+static bool operator < (const KeyFrame_FFMPEG& a, const KeyFrame_FFMPEG& b)
+{
+    return a.frame < b.frame;
+}
+
+#define CV_FFMPEG_KEYFRAME_INDEX_EXT ".cvkeyframes"
+#define CV_FFMPEG_KEYFRAME_INDEX_VERSION 2
+
+// modification time of the indexed file, -1 if it is not available
+static int64_t getFileModificationTime_FFMPEG(const char* path)
+{
+    struct stat st;
+    if( stat(path, &st) != 0 )
+        return -1;
+    return (int64_t)st.st_mtime;
+}
+
+
 struct Image_FFMPEG
 {
     unsigned char* data;
@@ -439,12 +678,19 @@ struct CvCapture_FFMPEG
     bool setProperty(int, double);
     bool grabFrame();
     bool retrieveFrame(int, unsigned char** data, int* step, int* width, int* height, int* cn);
+    bool retrieveRawFrame(AVPixelFormat format, unsigned char** data, int* step, int* width, int* height, int* cn);
+    bool setThreadCount(int count);
+    AVPixelFormat getOutputFormat() const;
 
     void init();
 
-    void    seek(int64_t frame_number);
-    void    seek(double sec);
+    bool    seek(int64_t frame_number);
+    bool    seek(double sec);
     bool    slowSeek( int framenumber );
+    int     seekKeyFrame(int64_t frame_number);
+    bool    buildKeyFrameIndex();
+    bool    loadKeyFrameIndex(int64_t file_size, int64_t file_mtime);
+    void    saveKeyFrameIndex(int64_t file_size, int64_t file_mtime) const;
 
     int64_t get_total_frames() const;
     double  get_duration_sec() const;
@@ -465,7 +711,17 @@ struct CvCapture_FFMPEG
 
     AVPacket          packet;
     Image_FFMPEG      frame;
-    struct SwsContext *img_convert_ctx;
+    SwsScaler_FFMPEG  scaler;
+
+    int               thread_count;  // 0 means the number of CPUs
+    bool              convert_rgb;
+    uint8_t         * raw_buffer;
+    size_t            raw_buffer_size;
+
+    KeyFrame_FFMPEG * keyframes;      // sorted by frame number
+    int               keyframes_count;
+    int               keyframes_state; // 0 - not built yet, 1 - ready, -1 - not available
+    char            * keyframes_path;  // where the index is cached, NULL if caching is disabled
 
     int64_t frame_number, first_frame_number;
 
@@ -500,7 +756,17 @@ void CvCapture_FFMPEG::init()
     filename = 0;
     memset(&packet, 0, sizeof(packet));
     av_init_packet(&packet);
-    img_convert_ctx = 0;
+    scaler.init();
+
+    thread_count = 0;
+    convert_rgb = true;
+    raw_buffer = 0;
+    raw_buffer_size = 0;
+
+    keyframes = 0;
+    keyframes_count = 0;
+    keyframes_state = 0;
+    keyframes_path = 0;
 
     avcodec = 0;
     frame_number = 0;
@@ -514,12 +780,17 @@ void CvCapture_FFMPEG::init()
 
 void CvCapture_FFMPEG::close()
 {
-    if( img_convert_ctx )
+    scaler.release();
+
+    if( raw_buffer )
     {
-        sws_freeContext(img_convert_ctx);
-        img_convert_ctx = 0;
+        free( raw_buffer );
+        raw_buffer = 0;
     }
 
+    free( keyframes );
+    free( keyframes_path );
+
     if( picture )
     {
 #if LIBAVCODEC_BUILD >= (LIBAVCODEC_VERSION_MICRO >= 100 \
@@ -879,8 +1150,11 @@ bool CvCapture_FFMPEG::open( const char* _filename )
 //#ifdef FF_API_THREAD_INIT
 //        avcodec_thread_init(enc, get_number_of_cpus());
 //#else
-        enc->thread_count = get_number_of_cpus();
+        enc->thread_count = get_thread_count(thread_count);
 //#endif
+#ifdef FF_THREAD_FRAME
+        enc->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
 
 #if LIBAVFORMAT_BUILD < CALC_FFMPEG_VERSION(53, 2, 0)
 #define AVMEDIA_TYPE_VIDEO CODEC_TYPE_VIDEO
@@ -911,6 +1185,7 @@ bool CvCapture_FFMPEG::open( const char* _filename )
             if (enc_width && (enc->width != enc_width)) { enc->width = enc_width; }
             if (enc_height && (enc->height != enc_height)) { enc->height = enc_height; }
 
+            avcodec = codec;
             video_stream = i;
             video_st = ic->streams[i];
 #if LIBAVCODEC_BUILD >= (LIBAVCODEC_VERSION_MICRO >= 100 \
@@ -931,6 +1206,23 @@ bool CvCapture_FFMPEG::open( const char* _filename )
 
     if(video_stream >= 0) valid = true;
 
+#ifndef NO_GETENV
+    {
+        // the keyframe index of local files can be kept next to the file
+        const char* cache_option = getenv("OPENCV_FFMPEG_KEYFRAME_INDEX_CACHE");
+        if( valid && cache_option && strcmp(cache_option, "0") != 0 && !strstr(_filename, "://") )
+        {
+            size_t len = strlen(_filename);
+            keyframes_path = (char*)malloc(len + sizeof(CV_FFMPEG_KEYFRAME_INDEX_EXT));
+            if( keyframes_path )
+            {
+                memcpy(keyframes_path, _filename, len);
+                memcpy(keyframes_path + len, CV_FFMPEG_KEYFRAME_INDEX_EXT, sizeof(CV_FFMPEG_KEYFRAME_INDEX_EXT));
+            }
+        }
+    }
+#endif
+
 exit_func:
 
 #if USE_AV_INTERRUPT_CALLBACK
@@ -1044,28 +1336,22 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
     if( !video_st || !picture->data[0] )
         return false;
 
-    if( img_convert_ctx == NULL ||
-        frame.width != video_st->codec->width ||
-        frame.height != video_st->codec->height ||
-        frame.data == NULL )
-    {
-        // Some sws_scale optimizations have some assumptions about alignment of data/step/width/height
-        // Also we use coded_width/height to workaround problem with legacy ffmpeg versions (like n0.8)
-        int buffer_width = video_st->codec->coded_width, buffer_height = video_st->codec->coded_height;
+    AVPixelFormat output_format = getOutputFormat();
+    if( output_format != AV_PIX_FMT_BGR24 )
+        return retrieveRawFrame(output_format, data, step, width, height, cn);
 
-        img_convert_ctx = sws_getCachedContext(
-                img_convert_ctx,
-                buffer_width, buffer_height,
-                video_st->codec->pix_fmt,
-                buffer_width, buffer_height,
-                AV_PIX_FMT_BGR24,
-                SWS_BICUBIC,
-                NULL, NULL, NULL
-                );
+    // Some sws_scale optimizations have some assumptions about alignment of data/step/width/height
+    // Also we use coded_width/height to workaround problem with legacy ffmpeg versions (like n0.8)
+    int buffer_width = video_st->codec->coded_width, buffer_height = video_st->codec->coded_height;
 
-        if (img_convert_ctx == NULL)
-            return false;//CV_Error(0, "Cannot initialize the conversion context!");
+    if( !scaler.prepare(buffer_width, buffer_height, video_st->codec->pix_fmt,
+                        AV_PIX_FMT_BGR24, get_thread_count(thread_count)) )
+        return false;//CV_Error(0, "Cannot initialize the conversion context!");
 
+    if( frame.width != video_st->codec->width ||
+        frame.height != video_st->codec->height ||
+        frame.data == NULL )
+    {
 #if USE_AV_FRAME_GET_BUFFER
         av_frame_unref(&rgb_picture);
         rgb_picture.format = AV_PIX_FMT_BGR24;
@@ -1092,14 +1378,7 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
         frame.step = rgb_picture.linesize[0];
     }
 
-    sws_scale(
-            img_convert_ctx,
-            picture->data,
-            picture->linesize,
-            0, video_st->codec->coded_height,
-            rgb_picture.data,
-            rgb_picture.linesize
-            );
+    scaler.scale(picture->data, picture->linesize, rgb_picture.data, rgb_picture.linesize);
 
     *data = frame.data;
     *step = frame.step;
@@ -1110,6 +1389,128 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
     return true;
 }
 
+// The layout of the frames returned by retrieveFrame(). Without RGB conversion
+// the decoded planes are returned as is when they are I420, NV12 or gray,
+// other formats are converted to I420 which is still much cheaper than BGR.
+AVPixelFormat CvCapture_FFMPEG::getOutputFormat() const
+{
+    if( convert_rgb )
+        return AV_PIX_FMT_BGR24;
+
+    // cv::cvtColor needs even sizes for the 4:2:0 layouts
+    bool even = (video_st->codec->width & 1) == 0 && (video_st->codec->height & 1) == 0;
+    switch( video_st->codec->pix_fmt )
+    {
+    case AV_PIX_FMT_GRAY8:
+        return AV_PIX_FMT_GRAY8;
+    case AV_PIX_FMT_NV12:
+        return even ? AV_PIX_FMT_NV12 : AV_PIX_FMT_BGR24;
+    default:
+        return even ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_BGR24;
+    }
+}
+
+bool CvCapture_FFMPEG::retrieveRawFrame(AVPixelFormat format, unsigned char** data, int* step, int* width, int* height, int* cn)
+{
+    const int w = video_st->codec->width, h = video_st->codec->height;
+    const AVPixelFormat src_format = video_st->codec->pix_fmt;
+
+    // the BGR buffer has to be set up again when the conversion is switched back on
+    frame.data = NULL;
+
+    if( format == AV_PIX_FMT_GRAY8 )
+    {
+        *data = picture->data[0];
+        *step = picture->linesize[0];
+        *width = w;
+        *height = h;
+        *cn = 1;
+        return true;
+    }
+
+    // a single-channel image with the chroma planes stacked below the luma plane
+    size_t size = (size_t)w * (h + h / 2);
+    if( raw_buffer_size < size )
+    {
+        uint8_t* buffer = (uint8_t*)realloc(raw_buffer, size);
+        if( !buffer )
+        {
+            CV_WARN("OutOfMemory");
+            return false;
+        }
+        raw_buffer = buffer;
+        raw_buffer_size = size;
+    }
+
+    uint8_t* dst[4] = { raw_buffer, raw_buffer + (size_t)w * h, 0, 0 };
+    int dst_step[4] = { w, w, 0, 0 };
+    if( format == AV_PIX_FMT_YUV420P )
+    {
+        dst[2] = dst[1] + (size_t)(w / 2) * (h / 2);
+        dst_step[1] = dst_step[2] = w / 2;
+    }
+
+    // full range YUVJ420P frames are converted by swscale to the limited range of I420
+    if( src_format == format )
+    {
+        int planes = format == AV_PIX_FMT_NV12 ? 2 : 3;
+        for( int p = 0; p < planes; p++ )
+        {
+            int rows = p == 0 ? h : h / 2;
+            for( int y = 0; y < rows; y++ )
+                memcpy(dst[p] + (size_t)y * dst_step[p], picture->data[p] + (size_t)y * picture->linesize[p], dst_step[p]);
+        }
+    }
+    else
+    {
+        if( !scaler.prepare(w, h, src_format, format, get_thread_count(thread_count)) )
+            return false;
+        scaler.scale(picture->data, picture->linesize, dst, dst_step);
+    }
+
+    *data = raw_buffer;
+    *step = w;
+    *width = w;
+    *height = h + h / 2;
+    *cn = 1;
+    return true;
+}
+
+bool CvCapture_FFMPEG::setThreadCount(int count)
+{
+    if( count < 0 )
+        return false;
+    if( count == thread_count )
+        return true;
+
+    {
+        AutoLock lock(_mutex);
+        AVCodecContext* ctx = video_st->codec;
+
+        // the thread count can only be changed while the decoder is closed
+        avcodec_close(ctx);
+        thread_count = count;
+        ctx->thread_count = get_thread_count(thread_count);
+        if( !avcodec ||
+#if LIBAVCODEC_VERSION_INT >= ((53<<16)+(8<<8)+0)
+            avcodec_open2(ctx, avcodec, NULL)
+#else
+            avcodec_open(ctx, avcodec)
+#endif
+            < 0 )
+        {
+            CV_WARN("Could not reopen the decoder");
+            video_st = NULL;
+            return false;
+        }
+    }
+
+    // the decoder has lost its references, so decode again up to the current position
+    if( frame_number > 0 )
+        seek(frame_number);
+    return true;
+}
+
 
 double CvCapture_FFMPEG::getProperty( int property_id ) const
 {
@@ -1141,6 +1542,22 @@ double CvCapture_FFMPEG::getProperty( int property_id ) const
         return _opencv_ffmpeg_get_sample_aspect_ratio(ic->streams[video_stream]).num;
     case CV_FFMPEG_CAP_PROP_SAR_DEN:
         return _opencv_ffmpeg_get_sample_aspect_ratio(ic->streams[video_stream]).den;
+    case CV_FFMPEG_CAP_PROP_CONVERT_RGB:
+        return convert_rgb ? 1 : 0;
+    case CV_FFMPEG_CAP_PROP_N_THREADS:
+        return (double)get_thread_count(thread_count);
+    case CV_FFMPEG_CAP_PROP_FRAME_FOURCC:
+        switch( getOutputFormat() )
+        {
+        case AV_PIX_FMT_GRAY8:
+            return (double)MKTAG('G', 'R', 'E', 'Y');
+        case AV_PIX_FMT_NV12:
+            return (double)MKTAG('N', 'V', '1', '2');
+        case AV_PIX_FMT_YUV420P:
+            return (double)MKTAG('I', '4', '2', '0');
+        default:
+            return (double)MKTAG('B', 'G', 'R', '3');
+        }
     default:
         break;
     }
@@ -1219,7 +1636,7 @@ double CvCapture_FFMPEG::dts_to_sec(int64_t dts)
         r2d(ic->streams[video_stream]->time_base);
 }
 
-void CvCapture_FFMPEG::seek(int64_t _frame_number)
+bool CvCapture_FFMPEG::seek(int64_t _frame_number)
 {
     _frame_number = std::min(_frame_number, get_total_frames());
     int delta = 16;
@@ -1229,6 +1646,12 @@ void CvCapture_FFMPEG::seek(int64_t _frame_number)
     if( first_frame_number < 0 && get_total_frames() > 1 )
         grabFrame();
 
+    int keyframe_seek = seekKeyFrame(_frame_number);
+    if( keyframe_seek >= 0 )
+        return keyframe_seek > 0;
+
+    bool ok = true;
+
     for(;;)
     {
         int64_t _frame_number_temp = std::max(_frame_number-delta, (int64_t)0);
@@ -1258,7 +1681,10 @@ void CvCapture_FFMPEG::seek(int64_t _frame_number)
                 while( frame_number < _frame_number-1 )
                 {
                     if(!grabFrame())
+                    {
+                        ok = false;
                         break;
+                    }
                 }
                 frame_number++;
                 break;
@@ -1275,11 +1701,193 @@ void CvCapture_FFMPEG::seek(int64_t _frame_number)
             break;
         }
     }
+    return ok;
+}
+
+bool CvCapture_FFMPEG::seek(double sec)
+{
+    return seek((int64_t)(sec * get_fps() + 0.5));
+}
+
+/*
+   Positions the stream so that the next grabFrame() returns frame '_frame_number'.
+   The decoder starts from the nearest preceding keyframe found in the index,
+   and when the current position is already inside the group of pictures
+   of the requested frame it only decodes forward without seeking.
+   Returns 1 on success, 0 when the stream ends before the requested frame
+   and -1 when the index can't be used, the generic search is used then.
+*/
+int CvCapture_FFMPEG::seekKeyFrame(int64_t _frame_number)
+{
+    if( _frame_number <= 0 || first_frame_number < 0 || !buildKeyFrameIndex() )
+        return -1;
+
+    // the frame to be held by 'picture' after seeking
+    int64_t target = _frame_number - 1;
+    KeyFrame_FFMPEG key;
+    key.frame = target;
+    int k = (int)(std::upper_bound(keyframes, keyframes + keyframes_count, key) - keyframes) - 1;
+    if( k < 0 )
+        return -1;
+
+    int64_t current = frame_number - 1;
+    if( frame_number <= 0 || current > target || current < keyframes[k].frame )
+    {
+        int64_t ts = keyframes[k].dts != AV_NOPTS_VALUE_ ? keyframes[k].dts : keyframes[k].pts;
+        if( av_seek_frame(ic, video_stream, ts, AVSEEK_FLAG_BACKWARD) < 0 )
+            return -1;
+        avcodec_flush_buffers(ic->streams[video_stream]->codec);
+        if( !grabFrame() )
+            return -1;
+        current = dts_to_frame_number(picture_pts) - first_frame_number;
+        // timestamps of the decoded frames don't match the index
+        if( current < 0 || current > target )
+            return -1;
+    }
+
+    while( current < target )
+    {
+        if( !grabFrame() )
+        {
+            frame_number = current + 1;
+            return 0;
+        }
+        current++;
+    }
+    frame_number = current + 1;
+    return 1;
+}
+
+/*
+   Collects the keyframes of the video stream by demuxing the whole file once (no decoding).
+   Only seekable inputs are indexed, since the stream is rewound afterwards.
+*/
+bool CvCapture_FFMPEG::buildKeyFrameIndex()
+{
+    if( keyframes_state != 0 )
+        return keyframes_state > 0;
+    keyframes_state = -1;
+
+    if( !ic->pb || !ic->pb->seekable )
+        return false;
+
+    int64_t file_size = avio_size(ic->pb), file_mtime = -1;
+    if( keyframes_path )
+    {
+        // the cache file is named after the video file
+        std::string filename(keyframes_path, strlen(keyframes_path) - (sizeof(CV_FFMPEG_KEYFRAME_INDEX_EXT) - 1));
+        file_mtime = getFileModificationTime_FFMPEG(filename.c_str());
+    }
+    if( !keyframes_path || file_mtime < 0 || !loadKeyFrameIndex(file_size, file_mtime) )
+    {
+        int capacity = 0;
+        keyframes_count = 0;
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        pkt.data = NULL;
+        pkt.size = 0;
+        av_seek_frame(ic, video_stream, ic->streams[video_stream]->start_time, AVSEEK_FLAG_BACKWARD);
+        while( av_read_frame(ic, &pkt) >= 0 )
+        {
+            if( pkt.stream_index == video_stream && (pkt.flags & AV_PKT_FLAG_KEY) &&
+                (pkt.pts != AV_NOPTS_VALUE_ || pkt.dts != AV_NOPTS_VALUE_) )
+            {
+                if( keyframes_count == capacity )
+                {
+                    capacity = std::max(capacity * 2, 64);
+                    KeyFrame_FFMPEG* buffer = (KeyFrame_FFMPEG*)realloc(keyframes, capacity * sizeof(keyframes[0]));
+                    if( !buffer )
+                    {
+                        _opencv_ffmpeg_av_packet_unref(&pkt);
+                        keyframes_count = 0;
+                        break;
+                    }
+                    keyframes = buffer;
+                }
+                keyframes[keyframes_count].pts = pkt.pts;
+                keyframes[keyframes_count].dts = pkt.dts;
+                keyframes_count++;
+            }
+            _opencv_ffmpeg_av_packet_unref(&pkt);
+        }
+
+        // rewind, seekKeyFrame() or the generic search repositions the decoder
+        av_seek_frame(ic, video_stream, ic->streams[video_stream]->start_time, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(ic->streams[video_stream]->codec);
+        frame_number = 0;
+
+        if( keyframes_count > 0 && keyframes_path && file_mtime >= 0 )
+            saveKeyFrameIndex(file_size, file_mtime);
+    }
+
+    if( keyframes_count == 0 )
+        return false;
+
+    for( int i = 0; i < keyframes_count; i++ )
+    {
+        KeyFrame_FFMPEG& kf = keyframes[i];
+        kf.frame = dts_to_frame_number(kf.pts != AV_NOPTS_VALUE_ ? kf.pts : kf.dts) - first_frame_number;
+    }
+    std::sort(keyframes, keyframes + keyframes_count);
+
+    keyframes_state = 1;
+    return true;
+}
+
+// The cached index is only used for the file it was built from,
+// recognized by the file size and the modification time
+bool CvCapture_FFMPEG::loadKeyFrameIndex(int64_t file_size, int64_t file_mtime)
+{
+    FILE* f = fopen(keyframes_path, "rb");
+    if( !f )
+        return false;
+
+    char magic[4] = {0};
+    int32_t version = 0;
+    int64_t size = -1, mtime = -1, count = 0;
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, "CVKF", 4) == 0 &&
+              fread(&version, sizeof(version), 1, f) == 1 && version == CV_FFMPEG_KEYFRAME_INDEX_VERSION &&
+              fread(&size, sizeof(size), 1, f) == 1 && size == file_size &&
+              fread(&mtime, sizeof(mtime), 1, f) == 1 && mtime == file_mtime &&
+              fread(&count, sizeof(count), 1, f) == 1 && count > 0 && count < INT_MAX;
+    if( ok )
+    {
+        keyframes = (KeyFrame_FFMPEG*)malloc((size_t)count * sizeof(keyframes[0]));
+        ok = keyframes != NULL;
+        for( int64_t i = 0; ok && i < count; i++ )
+        {
+            ok = fread(&keyframes[i].pts, sizeof(int64_t), 1, f) == 1 &&
+                 fread(&keyframes[i].dts, sizeof(int64_t), 1, f) == 1;
+        }
+        keyframes_count = ok ? (int)count : 0;
+    }
+    fclose(f);
+    return ok;
 }
 
-void CvCapture_FFMPEG::seek(double sec)
+void CvCapture_FFMPEG::saveKeyFrameIndex(int64_t file_size, int64_t file_mtime) const
 {
-    seek((int64_t)(sec * get_fps() + 0.5));
+    FILE* f = fopen(keyframes_path, "wb");
+    if( !f )
+    {
+        CV_WARN("Can't write the keyframe index");
+        return;
+    }
+    int32_t version = CV_FFMPEG_KEYFRAME_INDEX_VERSION;
+    int64_t count = keyframes_count;
+    bool ok = fwrite("CVKF", 1, 4, f) == 4 &&
+              fwrite(&version, sizeof(version), 1, f) == 1 &&
+              fwrite(&file_size, sizeof(file_size), 1, f) == 1 &&
+              fwrite(&file_mtime, sizeof(file_mtime), 1, f) == 1 &&
+              fwrite(&count, sizeof(count), 1, f) == 1;
+    for( int i = 0; ok && i < keyframes_count; i++ )
+    {
+        ok = fwrite(&keyframes[i].pts, sizeof(int64_t), 1, f) == 1 &&
+             fwrite(&keyframes[i].dts, sizeof(int64_t), 1, f) == 1;
+    }
+    fclose(f);
+    if( !ok )
+        remove(keyframes_path);
 }
 
 bool CvCapture_FFMPEG::setProperty( int property_id, double value )
@@ -1292,24 +1900,32 @@ bool CvCapture_FFMPEG::setProperty( int property_id, double value )
     case CV_FFMPEG_CAP_PROP_POS_FRAMES:
     case CV_FFMPEG_CAP_PROP_POS_AVI_RATIO:
         {
+            bool ok = true;
             switch( property_id )
             {
             case CV_FFMPEG_CAP_PROP_POS_FRAMES:
-                seek((int64_t)value);
+                ok = seek((int64_t)value);
                 break;
 
             case CV_FFMPEG_CAP_PROP_POS_MSEC:
-                seek(value/1000.0);
+                ok = seek(value/1000.0);
                 break;
 
             case CV_FFMPEG_CAP_PROP_POS_AVI_RATIO:
-                seek((int64_t)(value*ic->duration));
+                ok = seek((int64_t)(value*ic->duration));
                 break;
             }
 
             picture_pts=(int64_t)value;
+            if( !ok )
+                return false;
         }
         break;
+    case CV_FFMPEG_CAP_PROP_CONVERT_RGB:
+        convert_rgb = value != 0;
+        break;
+    case CV_FFMPEG_CAP_PROP_N_THREADS:
+        return setThreadCount((int)value);
     default:
         return false;
     }
@@ -62,6 +62,8 @@ public:
 protected:
 
     inline uint64_t getFramePos() const;
+    bool setFramePos(double pos);
+    void decodeFrames(int first);
 
     Ptr<AVIReadContainer> m_avi_container;
     bool             m_is_first_frame;
@@ -70,6 +72,12 @@ protected:
     frame_iterator   m_frame_iterator;
     Mat              m_current_frame;
 
+    //frames decoded in parallel: m_decoded_frames[i] is the frame m_decoded_first + i
+    int              m_threads;
+    int              m_decoded_first;
+    std::vector<std::vector<char> > m_encoded_frames;
+    std::vector<Mat> m_decoded_frames;
+
     //frame width/height and fps could be different for
     //each frame/stream. At the moment we suppose that they
     //stays the same within single avi file.
@@ -89,22 +97,46 @@ uint64_t MotionJpegCapture::getFramePos() const
     return m_frame_iterator - m_mjpeg_frames.begin() + 1;
 }
 
+//frame offsets are known from the AVI index, so any frame is reached without reading the previous ones
+bool MotionJpegCapture::setFramePos(double value)
+{
+    if(int(value) == 0)
+    {
+        m_is_first_frame = true;
+        m_frame_iterator = m_mjpeg_frames.end();
+        return true;
+    }
+    else if(m_mjpeg_frames.size() > value)
+    {
+        m_frame_iterator = m_mjpeg_frames.begin() + int(value - 1);
+        m_is_first_frame = false;
+        return true;
+    }
+    return false;
+}
+
 bool MotionJpegCapture::setProperty(int property, double value)
 {
-    if(property == CAP_PROP_POS_FRAMES)
+    switch(property)
     {
-        if(int(value) == 0)
-        {
-            m_is_first_frame = true;
-            m_frame_iterator = m_mjpeg_frames.end();
-            return true;
-        }
-        else if(m_mjpeg_frames.size() > value)
+        case CAP_PROP_POS_FRAMES:
+            return setFramePos(value);
+        case CAP_PROP_POS_MSEC:
+            return m_fps > 0 && setFramePos(cvRound(value*m_fps*0.001));
+        case CAP_PROP_POS_AVI_RATIO:
+            return setFramePos(cvRound(value*m_mjpeg_frames.size()));
+        case CAP_PROP_N_THREADS:
         {
-            m_frame_iterator = m_mjpeg_frames.begin() + int(value - 1);
-            m_is_first_frame = false;
+            int threads = cvRound(value);
+            if(threads < 0)
+                return false;
+            m_threads = threads == 0 ? std::max(getNumThreads(), 1) : threads;
+            m_decoded_frames.clear();
+            m_decoded_first = 0;
             return true;
         }
+        default:
+            break;
     }
 
     return false;
@@ -118,6 +150,10 @@ double MotionJpegCapture::getProperty(int property) const
             return (double)getFramePos();
         case CAP_PROP_POS_AVI_RATIO:
             return double(getFramePos())/m_mjpeg_frames.size();
+        case CAP_PROP_POS_MSEC:
+            return m_fps > 0 ? double(getFramePos())*1000./m_fps : 0.;
+        case CAP_PROP_N_THREADS:
+            return (double)m_threads;
         case CAP_PROP_FRAME_WIDTH:
             return (double)m_frame_width;
         case CAP_PROP_FRAME_HEIGHT:
@@ -153,8 +189,64 @@ bool MotionJpegCapture::grabFrame()
     return m_frame_iterator != m_mjpeg_frames.end();
 }
 
+class MotionJpegDecoder : public ParallelLoopBody
+{
+public:
+    MotionJpegDecoder(const std::vector<std::vector<char> >& _encoded, std::vector<Mat>& _decoded) :
+        encoded(_encoded), decoded(_decoded)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for(int i = range.start; i < range.end; i++)
+        {
+            if(encoded[i].size())
+                decoded[i] = imdecode(encoded[i], CV_LOAD_IMAGE_ANYDEPTH | CV_LOAD_IMAGE_COLOR | IMREAD_IGNORE_ORIENTATION);
+            else
+                decoded[i].release();
+        }
+    }
+
+private:
+    MotionJpegDecoder& operator=(const MotionJpegDecoder&);
+
+    const std::vector<std::vector<char> >& encoded;
+    std::vector<Mat>& decoded;
+};
+
+//decodes m_threads frames starting from 'first' at once
+void MotionJpegCapture::decodeFrames(int first)
+{
+    int count = std::min(m_threads, (int)m_mjpeg_frames.size() - first);
+
+    //the file is read sequentially, only the decoding is parallel
+    m_encoded_frames.resize(count);
+    for(int i = 0; i < count; i++)
+        m_encoded_frames[i] = m_avi_container->readFrame(m_mjpeg_frames.begin() + first + i);
+
+    m_decoded_frames.resize(count);
+    parallel_for_(Range(0, count), MotionJpegDecoder(m_encoded_frames, m_decoded_frames));
+    m_decoded_first = first;
+}
+
 bool MotionJpegCapture::retrieveFrame(int, OutputArray output_frame)
 {
+    if(m_frame_iterator != m_mjpeg_frames.end() && m_threads > 1)
+    {
+        int index = (int)(m_frame_iterator - m_mjpeg_frames.begin());
+        if(index < m_decoded_first || index >= m_decoded_first + (int)m_decoded_frames.size())
+            decodeFrames(index);
+
+        const Mat& frame = m_decoded_frames[index - m_decoded_first];
+        if(!frame.empty())
+            m_current_frame = frame;
+
+        m_current_frame.copyTo(output_frame);
+
+        return true;
+    }
+
     if(m_frame_iterator != m_mjpeg_frames.end())
     {
         std::vector<char> data = m_avi_container->readFrame(m_frame_iterator);
@@ -178,6 +270,7 @@ MotionJpegCapture::~MotionJpegCapture()
 }
 
 MotionJpegCapture::MotionJpegCapture(const String& filename)
+    : m_threads(1), m_decoded_first(0)
 {
     m_avi_container = makePtr<AVIReadContainer>();
     m_avi_container->initStream(filename);
@@ -204,6 +297,8 @@ bool MotionJpegCapture::open(const String& filename)
 
     m_frame_iterator = m_mjpeg_frames.end();
     m_is_first_frame = true;
+    m_decoded_frames.clear();
+    m_decoded_first = 0;
 
     if(!m_avi_container->parseRiff(m_mjpeg_frames))
     {
@@ -378,6 +378,69 @@ private:
     int m_last_bit_len;
 };
 
+//writes the encoded frame directly to the AVI stream
+class mjpeg_stream_output
+{
+public:
+    mjpeg_stream_output(AVIWriteContainer& _container) : container(_container) {}
+
+    void putByte(int val) { container.putStreamByte(val); }
+    void putBytes(const uchar* buf, int count) { container.putStreamBytes(buf, count); }
+    void jputShort(int val) { container.jputStreamShort(val); }
+    void jput(unsigned currval) { container.jputStream(currval); }
+    void jflush(unsigned currval, int bitIdx) { container.jflushStream(currval, bitIdx); }
+
+private:
+    mjpeg_stream_output& operator=( const mjpeg_stream_output& ) { return *this; }
+
+    AVIWriteContainer& container;
+};
+
+//keeps the encoded frame in memory, used when several frames are encoded at once
+class mjpeg_memory_output
+{
+public:
+    void clear() { data.clear(); }
+
+    void putByte(int val) { data.push_back((uchar)val); }
+    void putBytes(const uchar* buf, int count) { data.insert(data.end(), buf, buf + count); }
+    void jputShort(int val)
+    {
+        putByte(val >> 8);
+        putByte(val);
+    }
+    void jput(unsigned currval)
+    {
+        for( int shift = 24; shift >= 0; shift -= 8 )
+            putStuffedByte((uchar)(currval >> shift));
+    }
+    void jflush(unsigned currval, int bitIdx)
+    {
+        currval |= (1 << bitIdx)-1;
+        for( ; bitIdx < 32; bitIdx += 8, currval <<= 8 )
+            putStuffedByte((uchar)(currval >> 24));
+    }
+
+    std::vector<uchar> data;
+
+private:
+    void putStuffedByte(uchar v)
+    {
+        data.push_back(v);
+        if( v == 255 )
+            data.push_back(0);
+    }
+};
+
+//a frame waiting to be encoded together with the next ones
+struct mjpeg_pending_frame
+{
+    Mat img;
+    int colorspace;
+    mjpeg_buffer_keeper buffers;
+    mjpeg_memory_output output;
+};
+
 class MotionJpegWriter : public IVideoWriter
 {
 public:
@@ -386,11 +449,15 @@ public:
         rawstream = false;
         nstripes = -1;
         quality = 0;
+        parallel_frames = 1;
+        pending_count = 0;
     }
 
     MotionJpegWriter(const String& filename, double fps, Size size, bool iscolor)
     {
         rawstream = false;
+        parallel_frames = 1;
+        pending_count = 0;
         open(filename, fps, size, iscolor);
         nstripes = -1;
     }
@@ -401,6 +468,8 @@ public:
         if( !container.isOpenedStream() )
             return;
 
+        writePendingFrames();
+
         if( !container.isEmptyFrameOffset() && !rawstream )
         {
             container.endWriteChunk(); // end LIST 'movi'
@@ -475,21 +544,22 @@ public:
         else
             CV_Error(CV_StsBadArg, "Invalid combination of specified video colorspace and the input image colorspace");
 
-        if( !rawstream ) {
-            int avi_index = container.getAVIIndex(0, dc);
-            container.startWriteChunk(avi_index);
+        if( parallel_frames > 1 )
+        {
+            // the frames are encoded when enough of them are collected
+            if( (int)pending_frames.size() <= pending_count )
+                pending_frames.resize(pending_count + 1);
+            mjpeg_pending_frame& frame = pending_frames[pending_count++];
+            img.copyTo(frame.img);
+            frame.colorspace = colorspace;
+            if( pending_count >= parallel_frames )
+                writePendingFrames();
+            return;
         }
 
+        startFrame();
         writeFrameData(img.data, (int)img.step, colorspace, input_channels);
-
-        if( !rawstream )
-        {
-            size_t tempChunkPointer = container.getStreamPos();
-            size_t moviPointer = container.getMoviPointer();
-            container.pushFrameOffset(chunkPointer - moviPointer);
-            container.pushFrameSize(tempChunkPointer - chunkPointer - 8);       // Size excludes '00dc' and size field
-            container.endWriteChunk(); // end '00dc'
-        }
+        finishFrame(chunkPointer);
     }
 
     double getProperty(int propId) const CV_OVERRIDE
@@ -503,6 +573,8 @@ public:
         }
         if( propId == VIDEOWRITER_PROP_NSTRIPES )
             return nstripes;
+        if( propId == VIDEOWRITER_PROP_PARALLEL_FRAMES )
+            return parallel_frames;
         return 0.;
     }
 
@@ -520,16 +592,59 @@ public:
             return true;
         }
 
+        if( propId == VIDEOWRITER_PROP_PARALLEL_FRAMES )
+        {
+            int n = cvRound(value);
+            if( n < 0 )
+                return false;
+            writePendingFrames();
+            parallel_frames = n == 0 ? std::max(cv::getNumThreads(), 1) : n;
+            return true;
+        }
+
         return false;
     }
 
     void writeFrameData( const uchar* data, int step, int colorspace, int input_channels );
 
 protected:
+    void startFrame()
+    {
+        if( !rawstream ) {
+            int avi_index = container.getAVIIndex(0, dc);
+            container.startWriteChunk(avi_index);
+        }
+    }
+
+    void finishFrame(size_t chunkPointer)
+    {
+        if( !rawstream )
+        {
+            size_t tempChunkPointer = container.getStreamPos();
+            size_t moviPointer = container.getMoviPointer();
+            container.pushFrameOffset(chunkPointer - moviPointer);
+            container.pushFrameSize(tempChunkPointer - chunkPointer - 8);       // Size excludes '00dc' and size field
+            container.endWriteChunk(); // end '00dc'
+        }
+    }
+
+    void padFrameData()
+    {
+        size_t pos = container.getStreamPos();
+        size_t pos1 = (pos + 3) & ~3;
+        for( ; pos < pos1; pos++ )
+            container.putStreamByte(0);
+    }
+
+    void writePendingFrames();
+
     double quality;
     bool rawstream;
     mjpeg_buffer_keeper buffers_list;
     double nstripes;
+    int parallel_frames;
+    std::vector<mjpeg_pending_frame> pending_frames;
+    int pending_count;
 
     AVIWriteContainer container;
 };
@@ -1373,27 +1488,32 @@ private:
 
 const int MjpegEncoder::default_stripes_count = 4;
 
-void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspace, int input_channels )
+struct MjpegCatTable
 {
-    //double total_cvt = 0, total_dct = 0;
-    static bool init_cat_table = false;
-    const int CAT_TAB_SIZE = 4096;
-    static uchar cat_table[CAT_TAB_SIZE*2+1];
-    if( !init_cat_table )
+    enum { CAT_TAB_SIZE = 4096 };
+
+    MjpegCatTable()
     {
         for( int i = -CAT_TAB_SIZE; i <= CAT_TAB_SIZE; i++ )
         {
             Cv32suf a;
             a.f = (float)i;
-            cat_table[i+CAT_TAB_SIZE] = ((a.i >> 23) & 255) - (126 & (i ? -1 : 0));
+            table[i+CAT_TAB_SIZE] = ((a.i >> 23) & 255) - (126 & (i ? -1 : 0));
         }
-        init_cat_table = true;
     }
 
-    //double total_dct = 0, total_cvt = 0;
-    int width = container.getWidth();
-    int height = container.getHeight();
-    int channels = container.getChannels();
+    uchar table[CAT_TAB_SIZE*2+1];
+};
+
+//encodes a single JPEG image, the output is either the AVI stream or a memory buffer
+template<typename Output> static void
+encodeMjpegFrame( Output& output, const uchar* data, int step, int width, int height, int channels,
+                  int colorspace, int input_channels, double quality, double nstripes,
+                  mjpeg_buffer_keeper& buffers_list )
+{
+    // initialized once, it is safe to encode several frames in parallel
+    static const MjpegCatTable cat_table_holder;
+    uchar* cat_table = (uchar*)cat_table_holder.table;
 
     CV_Assert( data && width > 0 && height > 0 );
 
@@ -1421,7 +1541,7 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
     double inv_quality = 1./_quality;
 
     // Encode header
-    container.putStreamBytes( (const uchar*)jpegHeader, sizeof(jpegHeader) - 1 );
+    output.putBytes( (const uchar*)jpegHeader, sizeof(jpegHeader) - 1 );
 
     // Encode quantization tables
     for( i = 0; i < (channels > 1 ? 2 : 1); i++ )
@@ -1429,9 +1549,9 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
         const uchar* qtable = i == 0 ? jpegTableK1_T : jpegTableK2_T;
         int chroma_scale = i > 0 ? luma_count : 1;
 
-        container.jputStreamShort( 0xffdb );   // DQT marker
-        container.jputStreamShort( 2 + 65*1 ); // put single qtable
-        container.putStreamByte( 0*16 + i );   // 8-bit table
+        output.jputShort( 0xffdb );   // DQT marker
+        output.jputShort( 2 + 65*1 ); // put single qtable
+        output.putByte( 0*16 + i );   // 8-bit table
 
         // put coefficients
         for( j = 0; j < 64; j++ )
@@ -1444,7 +1564,7 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
                 qval = 255;
             fdct_qtab[i][idx] = (short)(cvRound((1 << (postshift + 11)))/
                                 (qval*chroma_scale*idct_prescale[idx]));
-            container.putStreamByte( qval );
+            output.putByte( qval );
         }
     }
 
@@ -1457,10 +1577,10 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
         int idx = i >= 2;
         int tableSize = 16 + (is_ac_tab ? 162 : 12);
 
-        container.jputStreamShort( 0xFFC4 );      // DHT marker
-        container.jputStreamShort( 3 + tableSize ); // define one huffman table
-        container.putStreamByte( is_ac_tab*16 + idx ); // put DC/AC flag and table index
-        container.putStreamBytes( htable, tableSize ); // put table
+        output.jputShort( 0xFFC4 );      // DHT marker
+        output.jputShort( 3 + tableSize ); // define one huffman table
+        output.putByte( is_ac_tab*16 + idx ); // put DC/AC flag and table index
+        output.putBytes( htable, tableSize ); // put table
 
         createEncodeHuffmanTable(createSourceHuffmanTable( htable, hbuffer, 16, 9 ),
                                  is_ac_tab ? huff_ac_tab[idx] : huff_dc_tab[idx],
@@ -1468,38 +1588,38 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
     }
 
     // put frame header
-    container.jputStreamShort( 0xFFC0 );          // SOF0 marker
-    container.jputStreamShort( 8 + 3*channels );  // length of frame header
-    container.putStreamByte( 8 );               // sample precision
-    container.jputStreamShort( height );
-    container.jputStreamShort( width );
-    container.putStreamByte( channels );        // number of components
+    output.jputShort( 0xFFC0 );          // SOF0 marker
+    output.jputShort( 8 + 3*channels );  // length of frame header
+    output.putByte( 8 );               // sample precision
+    output.jputShort( height );
+    output.jputShort( width );
+    output.putByte( channels );        // number of components
 
     for( i = 0; i < channels; i++ )
     {
-        container.putStreamByte( i + 1 );  // (i+1)-th component id (Y,U or V)
+        output.putByte( i + 1 );  // (i+1)-th component id (Y,U or V)
         if( i == 0 )
-            container.putStreamByte(x_scale*16 + y_scale); // chroma scale factors
+            output.putByte(x_scale*16 + y_scale); // chroma scale factors
         else
-            container.putStreamByte(1*16 + 1);
-        container.putStreamByte( i > 0 ); // quantization table idx
+            output.putByte(1*16 + 1);
+        output.putByte( i > 0 ); // quantization table idx
     }
 
     // put scan header
-    container.jputStreamShort( 0xFFDA );          // SOS marker
-    container.jputStreamShort( 6 + 2*channels );  // length of scan header
-    container.putStreamByte( channels );          // number of components in the scan
+    output.jputShort( 0xFFDA );          // SOS marker
+    output.jputShort( 6 + 2*channels );  // length of scan header
+    output.putByte( channels );          // number of components in the scan
 
     for( i = 0; i < channels; i++ )
     {
-        container.putStreamByte( i+1 );             // component id
-        container.putStreamByte( (i>0)*16 + (i>0) );// selection of DC & AC tables
+        output.putByte( i+1 );             // component id
+        output.putByte( (i>0)*16 + (i>0) );// selection of DC & AC tables
     }
 
-    container.jputStreamShort(0*256 + 63); // start and end of spectral selection - for
+    output.jputShort(0*256 + 63); // start and end of spectral selection - for
     // sequential DCT start is 0 and end is 63
 
-    container.putStreamByte( 0 );  // successive approximation bit position
+    output.putByte( 0 );  // successive approximation bit position
     // high & low - (0,0) for sequential DCT
 
     buffers_list.reset();
@@ -1514,18 +1634,73 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
 
     for(unsigned k = 0; k < last_data_elem; ++k)
     {
-        container.jputStream(v[k]);
+        output.jput(v[k]);
     }
-    container.jflushStream(v[last_data_elem], 32 - buffers_list.get_last_bit_len());
-    container.jputStreamShort( 0xFFD9 ); // EOI marker
+    output.jflush(v[last_data_elem], 32 - buffers_list.get_last_bit_len());
+    output.jputShort( 0xFFD9 ); // EOI marker
     /*printf("total dct = %.1fms, total cvt = %.1fms\n",
      total_dct*1000./cv::getTickFrequency(),
      total_cvt*1000./cv::getTickFrequency());*/
+}
 
-    size_t pos = container.getStreamPos();
-    size_t pos1 = (pos + 3) & ~3;
-    for( ; pos < pos1; pos++ )
-        container.putStreamByte(0);
+void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspace, int input_channels )
+{
+    mjpeg_stream_output output(container);
+    encodeMjpegFrame(output, data, step, container.getWidth(), container.getHeight(), container.getChannels(),
+                     colorspace, input_channels, quality, nstripes, buffers_list);
+    padFrameData();
+}
+
+class MjpegFrameEncoder : public ParallelLoopBody
+{
+public:
+    MjpegFrameEncoder(std::vector<mjpeg_pending_frame>& _frames, int _width, int _height, int _channels, double _quality) :
+        frames(_frames), width(_width), height(_height), channels(_channels), quality(_quality)
+    {
+    }
+
+    void operator()( const cv::Range& range ) const CV_OVERRIDE
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            mjpeg_pending_frame& f = frames[i];
+            f.output.clear();
+            f.buffers.reset();
+            // the frames are the parallel units, each frame is encoded as a single stripe
+            encodeMjpegFrame(f.output, f.img.data, (int)f.img.step, width, height, channels,
+                             f.colorspace, f.img.channels(), quality, 1, f.buffers);
+        }
+    }
+
+private:
+    MjpegFrameEncoder& operator=( const MjpegFrameEncoder & ) { return *this; }
+
+    std::vector<mjpeg_pending_frame>& frames;
+    const int width;
+    const int height;
+    const int channels;
+    const double quality;
+};
+
+void MotionJpegWriter::writePendingFrames()
+{
+    if( pending_count == 0 )
+        return;
+
+    MjpegFrameEncoder frame_encoder(pending_frames, container.getWidth(), container.getHeight(), container.getChannels(), quality);
+    cv::parallel_for_(Range(0, pending_count), frame_encoder);
+
+    // the frames are stored in the order of write() calls
+    for( int i = 0; i < pending_count; i++ )
+    {
+        size_t chunkPointer = container.getStreamPos();
+        const std::vector<uchar>& data = pending_frames[i].output.data;
+        startFrame();
+        container.putStreamBytes(&data[0], (int)data.size());
+        padFrameData();
+        finishFrame(chunkPointer);
+    }
+    pending_count = 0;
 }
 
 }
@@ -180,6 +180,10 @@ namespace cv
         virtual void write(InputArray) = 0;
     };
 
+    //! Prefetches frames of the capture on a background thread, see CAP_PROP_ASYNC_BUFFER_SIZE.
+    //! An already asynchronous capture is returned with the new buffer size.
+    Ptr<IVideoCapture> createAsyncCapture(const Ptr<IVideoCapture>& capture, int bufferSize);
+
     Ptr<IVideoCapture> createMotionJpegCapture(const String& filename);
     Ptr<IVideoWriter> createMotionJpegWriter(const String& filename, int fourcc, double fps, Size frameSize, bool iscolor);
 
@@ -214,6 +214,103 @@ public:
 
 TEST(Videoio_Video, ffmpeg_image) { CV_FFmpegReadImageTest test; test.safe_run(); }
 
+TEST(Videoio_Video, ffmpeg_threads_and_raw_frames)
+{
+    const string filename = cv::tempfile(AVI_EXT);
+    const Size frameSize(640, 480);
+    const int frameCount = 10;
+    {
+        VideoWriter writer(filename, CAP_FFMPEG, VideoWriter::fourcc('m', 'p', '4', 'v'), 25, frameSize);
+        ASSERT_TRUE(writer.isOpened());
+        Mat img(frameSize, CV_8UC3);
+        for (int i = 0; i < frameCount; i++)
+        {
+            img.setTo(Scalar::all(0));
+            rectangle(img, Rect(i * 20, i * 10, 200, 150), Scalar(255, 128, 32), -1);
+            circle(img, Point(320, 240), 40 + i * 5, Scalar(16, 200, 100), -1);
+            writer << img;
+        }
+    }
+
+    VideoCapture serial(filename, CAP_FFMPEG), threaded(filename, CAP_FFMPEG), raw(filename, CAP_FFMPEG);
+    ASSERT_TRUE(serial.isOpened() && threaded.isOpened() && raw.isOpened());
+    ASSERT_TRUE(serial.set(CAP_PROP_N_THREADS, 1));
+    EXPECT_EQ(1, serial.get(CAP_PROP_N_THREADS));
+    ASSERT_TRUE(threaded.set(CAP_PROP_N_THREADS, 4));
+    ASSERT_TRUE(raw.set(CAP_PROP_CONVERT_RGB, 0));
+    EXPECT_EQ(VideoWriter::fourcc('B', 'G', 'R', '3'), (int)serial.get(CAP_PROP_FRAME_FOURCC));
+    EXPECT_EQ(VideoWriter::fourcc('I', '4', '2', '0'), (int)raw.get(CAP_PROP_FRAME_FOURCC));
+
+    for (int i = 0; i < frameCount; i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", i));
+        Mat expected, actual, yuv, converted;
+        ASSERT_TRUE(serial.read(expected));
+        ASSERT_TRUE(threaded.read(actual));
+        ASSERT_TRUE(raw.read(yuv));
+        // color conversion of separate bands must not change the image
+        EXPECT_EQ(0, cvtest::norm(expected, actual, NORM_INF));
+
+        ASSERT_EQ(CV_8UC1, yuv.type());
+        ASSERT_EQ(Size(frameSize.width, frameSize.height * 3 / 2), yuv.size());
+        cvtColor(yuv, converted, COLOR_YUV2BGR_I420);
+        EXPECT_LE(cvtest::norm(expected, converted, NORM_L1) / expected.total(), 3.0);
+
+        if (i == frameCount / 2)
+        {
+            // changing the number of threads reopens the decoder at the current position
+            ASSERT_TRUE(threaded.set(CAP_PROP_N_THREADS, 2));
+            EXPECT_EQ(i + 1, threaded.get(CAP_PROP_POS_FRAMES));
+        }
+    }
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+TEST(Videoio_Video, ffmpeg_keyframe_seek)
+{
+    const string filename = cv::tempfile(AVI_EXT);
+    const Size frameSize(320, 240);
+    const int frameCount = 60;
+    {
+        VideoWriter writer(filename, CAP_FFMPEG, VideoWriter::fourcc('m', 'p', '4', 'v'), 25, frameSize);
+        ASSERT_TRUE(writer.isOpened());
+        Mat img(frameSize, CV_8UC3);
+        for (int i = 0; i < frameCount; i++)
+        {
+            img.setTo(Scalar::all(i * 4));
+            rectangle(img, Rect(i * 4, i * 3, 60, 40), Scalar(255, 128, 32), -1);
+            writer << img;
+        }
+    }
+
+    VideoCapture cap(filename, CAP_FFMPEG);
+    ASSERT_TRUE(cap.isOpened());
+    std::vector<Mat> expected(frameCount);
+    for (int i = 0; i < frameCount; i++)
+        ASSERT_TRUE(cap.read(expected[i])) << "frame " << i;
+
+    // decoding from the preceding keyframe gives exactly the same pictures
+    int idx[] = { 37, 3, 59, 12, 13, 0, 58, 24, 24, 1, 45 };
+    for (size_t i = 0; i < sizeof(idx) / sizeof(idx[0]); i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", idx[i]));
+        Mat frame;
+        ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, idx[i]));
+        EXPECT_EQ(idx[i], cap.get(CAP_PROP_POS_FRAMES));
+        ASSERT_TRUE(cap.read(frame));
+        EXPECT_EQ(0, cvtest::norm(expected[idx[i]], frame, NORM_INF));
+    }
+
+    std::vector<int> indices(idx, idx + sizeof(idx) / sizeof(idx[0]));
+    std::vector<Mat> frames;
+    ASSERT_TRUE(cap.readFrames(indices, frames));
+    for (size_t i = 0; i < indices.size(); i++)
+        EXPECT_EQ(0, cvtest::norm(expected[indices[i]], frames[i], NORM_INF)) << "frame " << indices[i];
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 #endif
 
 #if defined(HAVE_FFMPEG)
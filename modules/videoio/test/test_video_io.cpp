@@ -42,6 +42,8 @@
 
 #include "test_precomp.hpp"
 #include "opencv2/videoio/videoio_c.h"
+#include <thread>
+#include <fstream>
 
 namespace opencv_test
 {
@@ -509,4 +511,175 @@ INSTANTIATE_TEST_CASE_P(videoio, Videoio_Synthetic,
                             testing::ValuesIn(all_sizes),
                             testing::ValuesIn(synthetic_params)));
 
+//==================================================================================================
+
+class Videoio_Async : public testing::Test
+{
+protected:
+    enum { frame_count = 30 };
+    std::string video_file;
+
+    void SetUp()
+    {
+        video_file = cv::tempfile(".avi");
+        VideoWriter writer(video_file, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, Size(64, 48));
+        ASSERT_TRUE(writer.isOpened());
+        for (int i = 0; i < frame_count; i++)
+            writer << Mat(48, 64, CV_8UC3, Scalar::all(i * 8 + 4));
+    }
+    void TearDown()
+    {
+        remove(video_file.c_str());
+    }
+    static int frameIndex(const Mat& frame)
+    {
+        return cvFloor(mean(frame)[0] / 8);
+    }
+};
+
+TEST_F(Videoio_Async, read_all_frames)
+{
+    VideoCapture cap(video_file, CAP_OPENCV_MJPEG);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFER_SIZE, 4));
+    EXPECT_EQ(4, cap.get(CAP_PROP_ASYNC_BUFFER_SIZE));
+
+    Mat frame;
+    for (int i = 0; i < frame_count; i++)
+    {
+        ASSERT_TRUE(cap.read(frame)) << "frame " << i;
+        EXPECT_EQ(i, frameIndex(frame));
+        EXPECT_EQ(i + 1, cap.get(CAP_PROP_POS_FRAMES));
+        EXPECT_LE(cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH), 4);
+        if (i == 10)
+        {
+            // seeking drops the prefetched frames
+            ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 20));
+            ASSERT_TRUE(cap.read(frame));
+            EXPECT_EQ(20, frameIndex(frame));
+            ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 11));
+        }
+    }
+    EXPECT_FALSE(cap.read(frame));
+    EXPECT_EQ(0, cap.get(CAP_PROP_ASYNC_DROPPED_FRAMES));
+
+    // back to synchronous reading
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFER_SIZE, 0));
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 5));
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(5, frameIndex(frame));
+}
+
+TEST_F(Videoio_Async, latest_only)
+{
+    const int buffer_size = 3;
+    VideoCapture cap(video_file, CAP_OPENCV_MJPEG);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFER_SIZE, buffer_size));
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_LATEST_ONLY, 1));
+
+    // without a consumer the queue keeps only the newest frames of the file
+    const int64 deadline = getTickCount() + 10 * (int64)getTickFrequency();
+    while (cap.get(CAP_PROP_ASYNC_DROPPED_FRAMES) < frame_count - buffer_size && getTickCount() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(frame_count - buffer_size, cap.get(CAP_PROP_ASYNC_DROPPED_FRAMES));
+    EXPECT_EQ(buffer_size, cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH));
+
+    Mat frame;
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(frame_count - 1, frameIndex(frame));
+    EXPECT_EQ(frame_count - 1, cap.get(CAP_PROP_ASYNC_DROPPED_FRAMES));
+    EXPECT_EQ(0, cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH));
+    EXPECT_FALSE(cap.read(frame));
+}
+
+TEST_F(Videoio_Async, read_frames_by_index)
+{
+    VideoCapture cap(video_file, CAP_OPENCV_MJPEG);
+    ASSERT_TRUE(cap.isOpened());
+
+    int idx[] = { 7, 2, 2, 25, 3, 0, 29 };
+    std::vector<int> indices(idx, idx + sizeof(idx) / sizeof(idx[0]));
+    std::vector<Mat> frames;
+    ASSERT_TRUE(cap.readFrames(indices, frames));
+    ASSERT_EQ(indices.size(), frames.size());
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        ASSERT_FALSE(frames[i].empty()) << "frame " << indices[i];
+        EXPECT_EQ(indices[i], frameIndex(frames[i]));
+    }
+    // repeated frames are independent copies
+    EXPECT_NE(frames[1].data, frames[2].data);
+
+    // the frames past the end are left empty
+    indices.push_back(frame_count + 5);
+    EXPECT_FALSE(cap.readFrames(indices, frames));
+    EXPECT_TRUE(frames.back().empty());
+    EXPECT_EQ(7, frameIndex(frames[0]));
+}
+
+static std::vector<uchar> readFileBytes(const std::string& filename)
+{
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    return std::vector<uchar>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+TEST(Videoio_MJPEG, parallel_frames)
+{
+    const Size size(320, 240);
+    const int frame_count = 11;
+    const std::string serial_file = cv::tempfile(".avi"), parallel_file = cv::tempfile(".avi");
+    {
+        VideoWriter serial(serial_file, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, size);
+        VideoWriter parallel(parallel_file, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, size);
+        ASSERT_TRUE(serial.isOpened() && parallel.isOpened());
+        ASSERT_TRUE(parallel.set(VIDEOWRITER_PROP_PARALLEL_FRAMES, 4));
+        EXPECT_EQ(4, parallel.get(VIDEOWRITER_PROP_PARALLEL_FRAMES));
+        Mat img(size, CV_8UC3);
+        for (int i = 0; i < frame_count; i++)
+        {
+            img.setTo(Scalar::all(i * 8 + 4));
+            rectangle(img, Rect(i * 10, i * 5, 100, 80), Scalar(255, 128, 32), -1);
+            serial << img;
+            parallel << img;
+        }
+    }
+    // the last frames are written on release()
+    std::vector<uchar> serial_data = readFileBytes(serial_file);
+    EXPECT_FALSE(serial_data.empty());
+    EXPECT_TRUE(serial_data == readFileBytes(parallel_file));
+
+    VideoCapture expected(serial_file, CAP_OPENCV_MJPEG), actual(serial_file, CAP_OPENCV_MJPEG);
+    ASSERT_TRUE(expected.isOpened() && actual.isOpened());
+    ASSERT_TRUE(actual.set(CAP_PROP_N_THREADS, 3));
+    EXPECT_EQ(3, actual.get(CAP_PROP_N_THREADS));
+    std::vector<Mat> frames(frame_count);
+    for (int i = 0; i < frame_count; i++)
+    {
+        Mat frame;
+        ASSERT_TRUE(expected.read(frames[i]));
+        ASSERT_TRUE(actual.read(frame));
+        EXPECT_EQ(0, cvtest::norm(frames[i], frame, NORM_INF)) << "frame " << i;
+    }
+    EXPECT_FALSE(actual.grab());
+
+    // random access by the index of the AVI file
+    int idx[] = { 9, 2, 3, 10, 0 };
+    for (size_t i = 0; i < sizeof(idx) / sizeof(idx[0]); i++)
+    {
+        Mat frame;
+        ASSERT_TRUE(actual.set(CAP_PROP_POS_FRAMES, idx[i]));
+        ASSERT_TRUE(actual.read(frame));
+        EXPECT_EQ(0, cvtest::norm(frames[idx[i]], frame, NORM_INF)) << "frame " << idx[i];
+        EXPECT_EQ(idx[i] + 1, actual.get(CAP_PROP_POS_FRAMES));
+    }
+    Mat frame;
+    ASSERT_TRUE(actual.set(CAP_PROP_POS_MSEC, 200));
+    ASSERT_TRUE(actual.read(frame));
+    EXPECT_EQ(0, cvtest::norm(frames[5], frame, NORM_INF));
+
+    EXPECT_EQ(0, remove(serial_file.c_str()));
+    EXPECT_EQ(0, remove(parallel_file.c_str()));
+}
+
 } // namespace